@@ -1,12 +1,24 @@
 // SPDX-License-Identifier: Apache-2.0 OR MIT
 
+use std::ops::Range;
+
 use bevy::{
 	asset::{AssetLoader, LoadContext, io::Reader},
 	reflect::TypePath,
 	tasks::ConditionalSendFuture,
 };
 use serde::{Deserialize, Serialize};
-use spz::{gaussian_splat::GaussianSplat, packed::PackedGaussianSplat};
+use spz::{
+	container,
+	coord::CoordinateSystem,
+	decoder::Decoder,
+	gaussian_splat::{AttributeMask, GaussianSplat, LoadOptions},
+	header::{HEADER_SIZE, Header},
+	layout::Layout,
+	math::dim_for_degree,
+	packed::{PackedGaussianSplatView, PackedGaussians},
+	transcode,
+};
 use thiserror::Error;
 
 #[derive(Default, TypePath)]
@@ -29,13 +41,16 @@ impl AssetLoader for SpzLoader {
 
 			reader.read_to_end(&mut buf).await?;
 
-			let gs = GaussianSplat::new_from_packed_gaussians(
-				&PackedGaussianSplat::from_bytes(&buf).map_err(Error::LoadError)?,
+			let opts = selected_load_opts(
 				&settings.load_opts,
-			)
-			.map_err(Error::LoadError)?;
+				settings.attributes,
+				settings.sh_degree,
+			);
 
-			Ok(crate::GaussianSplat(gs))
+			// only the selected attributes and degrees get dequantized
+			GaussianSplat::read_from_bytes(&buf, &opts)
+				.map(crate::GaussianSplat)
+				.map_err(Error::LoadError)
 		}
 	}
 
@@ -49,7 +64,251 @@ impl AssetLoader for SpzLoader {
 #[derive(Default, Clone, Serialize, Deserialize)]
 pub struct Settings {
 	/// Options for loading the Gaussian Splat.
-	pub load_opts: spz::gaussian_splat::LoadOptions,
+	pub load_opts: LoadOptions,
+	/// Attributes to decode, the others stay empty. Combined with the
+	/// selection of `load_opts`.
+	pub attributes: AttributeMask,
+	/// Highest spherical harmonics degree to keep, `None` keeps the
+	/// `load_opts` maximum.
+	pub sh_degree: Option<u8>,
+}
+
+/// Loads SPZ files into a [`SplatBuffer`], bytes ready to be copied into a
+/// GPU buffer, without decoding into a
+/// [`GaussianSplat`](spz::gaussian_splat::GaussianSplat) first.
+///
+/// Pick it over [`SpzLoader`] by the asset type, e.g.
+/// `asset_server.load::<SplatBuffer>("scene.spz")`.
+#[derive(Default, TypePath)]
+pub struct SpzBufferLoader;
+
+impl AssetLoader for SpzBufferLoader {
+	type Error = Error;
+	type Settings = BufferSettings;
+	type Asset = SplatBuffer;
+
+	#[inline]
+	fn load(
+		&self,
+		reader: &mut dyn Reader,
+		settings: &Self::Settings,
+		_load_context: &mut LoadContext,
+	) -> impl ConditionalSendFuture<Output = Result<Self::Asset, Self::Error>> {
+		async move {
+			let mut buf = Vec::new();
+
+			reader.read_to_end(&mut buf).await?;
+
+			SplatBuffer::from_bytes(&buf, settings).map_err(Error::LoadError)
+		}
+	}
+
+	#[inline]
+	fn extensions(&self) -> &[&str] {
+		crate::EXTENSIONS
+	}
+}
+
+/// Contents of a [`SplatBuffer`].
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq, Serialize, Deserialize)]
+pub enum BufferFormat {
+	/// The quantized sections of the file, for dequantizing in shaders.
+	#[default]
+	Packed,
+	/// Point records of the layout, see [`spz::layout`]. Records hold no
+	/// spherical harmonics.
+	Records(Layout),
+}
+
+/// [`SpzBufferLoader`] settings.
+#[derive(Default, Clone, Serialize, Deserialize)]
+pub struct BufferSettings {
+	/// Coordinate system, activation (for records) and decoding threads.
+	pub load_opts: LoadOptions,
+	pub format: BufferFormat,
+	/// Packed sections to keep, the others are dropped.
+	pub attributes: AttributeMask,
+	/// Highest spherical harmonics degree to keep, `None` keeps all.
+	pub sh_degree: Option<u8>,
+}
+
+/// Byte ranges of the packed attribute sections within
+/// [`SplatBuffer::data`], empty for the sections that were dropped.
+#[derive(Clone, Debug, Default, PartialEq, Eq)]
+pub struct Sections {
+	/// 24-bit fixed point `x, y, z`, see [`Header::fractional_bits`].
+	pub positions: Range<usize>,
+	pub alphas: Range<usize>,
+	pub colors: Range<usize>,
+	pub scales: Range<usize>,
+	/// 4 bytes per point if quaternions are encoded with the smallest three
+	/// components, 3 otherwise.
+	pub rotations: Range<usize>,
+	/// Degree 1 and up, `dim_for_degree(header.spherical_harmonics_degree)`
+	/// RGB coefficients per point.
+	pub spherical_harmonics: Range<usize>,
+}
+
+/// Splat data ready to upload to the GPU, e.g. as a
+/// `ShaderStorageBuffer::new(&buffer.data, RenderAssetUsages::RENDER_WORLD)`.
+#[derive(bevy::asset::Asset, TypePath, Clone, Debug)]
+pub struct SplatBuffer {
+	/// Describes [`SplatBuffer::data`]; the spherical harmonics degree is
+	/// the one kept.
+	pub header: Header,
+	pub format: BufferFormat,
+	/// For [`BufferFormat::Packed`], where the sections are in `data`.
+	pub sections: Sections,
+	pub data: Vec<u8>,
+}
+
+impl SplatBuffer {
+	/// Decompresses `compressed` and turns it into the buffer `settings`
+	/// describe.
+	///
+	/// Packed sections are inflated up to the last kept one, converted to
+	/// the coordinate system of the load options and compacted inside the
+	/// decompression buffer, which becomes [`SplatBuffer::data`]; records
+	/// are decoded by a [`Decoder`].
+	///
+	/// # Args
+	///
+	/// `compressed` - gzip or zstd compressed, packed gaussian data, or a
+	/// progressive file. A chunked file holds no single packed stream and is
+	/// rejected.
+	/// `settings` - what to keep and how.
+	pub fn from_bytes(compressed: &[u8], settings: &BufferSettings) -> anyhow::Result<Self> {
+		let compressed = container::stream(compressed)?;
+
+		match settings.format {
+			BufferFormat::Packed => Self::from_packed(compressed, settings),
+			BufferFormat::Records(layout) => {
+				let opts = LoadOptions {
+					layout,
+					..settings.load_opts.clone()
+				};
+				let mut data = Vec::new();
+				let mut header = Decoder::new()
+					.decode_records_into(compressed, &opts, &mut data)?;
+
+				header.spherical_harmonics_degree = 0;
+
+				Ok(Self {
+					header,
+					format: settings.format,
+					sections: Sections::default(),
+					data,
+				})
+			},
+		}
+	}
+
+	fn from_packed(compressed: &[u8], settings: &BufferSettings) -> anyhow::Result<Self> {
+		let opts = selected_load_opts(
+			&settings.load_opts,
+			settings.attributes,
+			settings.sh_degree,
+		);
+		let mut decompressed = Vec::new();
+		let inflated = opts.decompress_decoded(compressed, &mut decompressed, 0)?;
+
+		transcode::convert_prefix_in_place(
+			&mut decompressed,
+			inflated,
+			CoordinateSystem::RightUpBack,
+			settings.load_opts.coord_sys,
+		)?;
+		let view = PackedGaussianSplatView::from_prefix(&decompressed, inflated)?;
+		let mut header = view.to_header();
+		let num_points = view.num_points().max(0) as usize;
+		let sh_dim = dim_for_degree(header.spherical_harmonics_degree) as usize;
+		let kept = opts.decoded_attributes(header.spherical_harmonics_degree);
+
+		header.spherical_harmonics_degree =
+			opts.decoded_sh_degree(header.spherical_harmonics_degree);
+		let kept_dim = dim_for_degree(header.spherical_harmonics_degree) as usize;
+
+		// file order, each section moves down over the dropped ones before
+		// it, the sections after the last kept one weren't inflated
+		let lens = [
+			(AttributeMask::POSITIONS, view.positions.len()),
+			(AttributeMask::ALPHAS, view.alphas.len()),
+			(AttributeMask::COLORS, view.colors.len()),
+			(AttributeMask::SCALES, view.scales.len()),
+			(AttributeMask::ROTATIONS, view.rotations.len()),
+			(
+				AttributeMask::SPHERICAL_HARMONICS,
+				view.spherical_harmonics.len(),
+			),
+		];
+		let mut ranges: [Range<usize>; 6] = Default::default();
+		let mut src = HEADER_SIZE;
+		let mut dst = 0;
+
+		for ((attribute, len), range) in lens.into_iter().zip(&mut ranges) {
+			if !kept.contains(attribute) {
+				// dropped
+			} else if attribute == AttributeMask::SPHERICAL_HARMONICS
+				&& kept_dim < sh_dim
+			{
+				// keep the lower degree coefficients of every point
+				for point in 0..num_points {
+					decompressed.copy_within(
+						src + point * sh_dim * 3
+							..src + (point * sh_dim + kept_dim) * 3,
+						dst + point * kept_dim * 3,
+					);
+				}
+				*range = dst..dst + num_points * kept_dim * 3;
+			} else {
+				decompressed.copy_within(src..src + len, dst);
+				*range = dst..dst + len;
+			}
+			src += len;
+			dst = range.end.max(dst);
+		}
+		decompressed.truncate(dst);
+		decompressed.shrink_to_fit();
+
+		let [
+			positions,
+			alphas,
+			colors,
+			scales,
+			rotations,
+			spherical_harmonics,
+		] = ranges;
+
+		Ok(Self {
+			header,
+			format: BufferFormat::Packed,
+			sections: Sections {
+				positions,
+				alphas,
+				colors,
+				scales,
+				rotations,
+				spherical_harmonics,
+			},
+			data: decompressed,
+		})
+	}
+}
+
+/// `load_opts` with the `attributes` and `sh_degree` of loader settings
+/// folded into its selection.
+fn selected_load_opts(
+	load_opts: &LoadOptions,
+	attributes: AttributeMask,
+	sh_degree: Option<u8>,
+) -> LoadOptions {
+	LoadOptions {
+		attributes: load_opts.attributes & attributes,
+		max_sh_degree: sh_degree.map_or(load_opts.max_sh_degree, |degree| {
+			degree.min(load_opts.max_sh_degree)
+		}),
+		..load_opts.clone()
+	}
 }
 
 #[derive(Error, Debug)]
@@ -59,3 +318,127 @@ pub enum Error {
 	#[error("failed to load SPZ asset: {0}")]
 	LoadError(anyhow::Error),
 }
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+	use spz::{
+		chunked, compression,
+		gaussian_splat::SaveOptions,
+		lod::{self, LodOptions},
+		test_util::splat,
+	};
+
+	fn settings(attributes: AttributeMask, sh_degree: Option<u8>) -> BufferSettings {
+		BufferSettings {
+			load_opts: LoadOptions::builder()
+				.coord_sys(CoordinateSystem::RightUpBack)
+				.build(),
+			format: BufferFormat::Packed,
+			attributes,
+			sh_degree,
+		}
+	}
+
+	fn decompressed(compressed: &[u8]) -> Vec<u8> {
+		let mut decompressed = Vec::new();
+
+		compression::decompress(compressed, &mut decompressed, 1).unwrap();
+		decompressed
+	}
+
+	#[test]
+	fn test_from_packed_compacts_kept_sections() {
+		let compressed = splat(500, 3)
+			.serialize_to_packed_bytes(&SaveOptions::default())
+			.unwrap();
+		let whole = decompressed(&compressed);
+		let view = PackedGaussianSplatView::try_from(whole.as_slice()).unwrap();
+
+		let buffer = SplatBuffer::from_bytes(
+			&compressed,
+			&settings(AttributeMask::ALPHAS | AttributeMask::ROTATIONS, None),
+		)
+		.unwrap();
+		let sections = &buffer.sections;
+		let alphas = view.alphas.len();
+
+		assert_eq!(sections.alphas, 0..alphas);
+		assert_eq!(sections.rotations, alphas..alphas + view.rotations.len());
+		assert!(sections.positions.is_empty());
+		assert!(sections.colors.is_empty());
+		assert!(sections.scales.is_empty());
+		assert!(sections.spherical_harmonics.is_empty());
+		assert_eq!(&buffer.data[sections.alphas.clone()], view.alphas);
+		assert_eq!(&buffer.data[sections.rotations.clone()], view.rotations);
+		assert_eq!(buffer.data.len(), sections.rotations.end);
+		assert_eq!(buffer.header.spherical_harmonics_degree, 0);
+		assert_eq!(buffer.header.num_points, 500);
+	}
+
+	#[test]
+	fn test_from_packed_truncates_spherical_harmonics() {
+		let num_points = 500;
+		let compressed = splat(num_points, 3)
+			.serialize_to_packed_bytes(&SaveOptions::default())
+			.unwrap();
+		let whole = decompressed(&compressed);
+		let view = PackedGaussianSplatView::try_from(whole.as_slice()).unwrap();
+
+		let buffer = SplatBuffer::from_bytes(
+			&compressed,
+			&settings(
+				AttributeMask::POSITIONS | AttributeMask::SPHERICAL_HARMONICS,
+				Some(1),
+			),
+		)
+		.unwrap();
+		let sections = &buffer.sections;
+		let positions = view.positions.len();
+		// degree 1 keeps 3 of the 15 coefficients of degree 3
+		let (kept, all) = (3 * 3, 15 * 3);
+
+		assert_eq!(buffer.header.spherical_harmonics_degree, 1);
+		assert_eq!(sections.positions, 0..positions);
+		assert_eq!(
+			sections.spherical_harmonics,
+			positions..positions + num_points * kept
+		);
+		assert_eq!(&buffer.data[..positions], view.positions);
+
+		let spherical_harmonics = &buffer.data[sections.spherical_harmonics.clone()];
+
+		for point in 0..num_points {
+			assert_eq!(
+				spherical_harmonics[point * kept..(point + 1) * kept],
+				view.spherical_harmonics[point * all..point * all + kept],
+				"point {point}"
+			);
+		}
+	}
+
+	#[test]
+	fn test_from_bytes_resolves_containers() {
+		let gs = splat(300, 1);
+		let progressive = lod::serialize_progressive(
+			&gs,
+			&SaveOptions::default(),
+			&LodOptions::default(),
+		)
+		.unwrap();
+		let chunked =
+			chunked::serialize_chunked(&gs, &SaveOptions::default(), 100).unwrap();
+		let settings = settings(AttributeMask::all(), None);
+
+		let buffer = SplatBuffer::from_bytes(&progressive, &settings).unwrap();
+		let finest = SplatBuffer::from_bytes(
+			lod::finest_level(&progressive).unwrap(),
+			&settings,
+		)
+		.unwrap();
+
+		assert_eq!(buffer.data, finest.data);
+		assert_eq!(buffer.sections, finest.sections);
+		assert!(SplatBuffer::from_bytes(&chunked, &settings).is_err());
+	}
+}
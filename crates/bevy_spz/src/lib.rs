@@ -20,7 +20,10 @@ pub struct SpzPlugin;
 
 impl Plugin for SpzPlugin {
 	fn build(&self, app: &mut App) {
-		app.init_asset_loader::<asset::SpzLoader>();
+		app.init_asset::<GaussianSplat>()
+			.init_asset::<asset::SplatBuffer>()
+			.init_asset_loader::<asset::SpzLoader>()
+			.init_asset_loader::<asset::SpzBufferLoader>();
 	}
 }
 
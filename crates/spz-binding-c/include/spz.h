@@ -8,6 +8,41 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+/**
+ * Attribute mask bit selecting the positions.
+ */
+#define SPZ_ATTRIBUTE_POSITIONS (1 << 0)
+
+/**
+ * Attribute mask bit selecting the scales.
+ */
+#define SPZ_ATTRIBUTE_SCALES (1 << 1)
+
+/**
+ * Attribute mask bit selecting the rotations.
+ */
+#define SPZ_ATTRIBUTE_ROTATIONS (1 << 2)
+
+/**
+ * Attribute mask bit selecting the alphas.
+ */
+#define SPZ_ATTRIBUTE_ALPHAS (1 << 3)
+
+/**
+ * Attribute mask bit selecting the colors.
+ */
+#define SPZ_ATTRIBUTE_COLORS (1 << 4)
+
+/**
+ * Attribute mask bit selecting the spherical harmonics.
+ */
+#define SPZ_ATTRIBUTE_SPHERICAL_HARMONICS (1 << 5)
+
+/**
+ * Attribute mask selecting every attribute.
+ */
+#define SPZ_ATTRIBUTE_ALL ((1 << 6) - 1)
+
 /**
  * SPZ file format version.
  *
@@ -30,6 +65,61 @@ typedef enum SpzVersion
 	SpzVersion_V3 = 3,
 } SpzVersion;
 
+/**
+ * Compression format of saved data.
+ */
+typedef enum SpzCodec
+{
+	/**
+         * gzip, the SPZ file format (default).
+         */
+	SpzCodec_Gzip = 0,
+	/**
+         * A zstd frame, for caches only: not readable by other SPZ readers.
+         * Needs the library built with the `zstd` feature.
+         */
+	SpzCodec_Zstd = 1,
+} SpzCodec;
+
+/**
+ * Speed/ratio tradeoff of compression.
+ */
+typedef enum SpzCompressionPreset
+{
+	/**
+         * Fastest compression.
+         */
+	SpzCompressionPreset_Fast = 0,
+	/**
+         * The codec's default tradeoff (default).
+         */
+	SpzCompressionPreset_Default = 1,
+	/**
+         * Smallest output.
+         */
+	SpzCompressionPreset_Best = 2,
+} SpzCompressionPreset;
+
+/**
+ * Order to write the points in.
+ */
+typedef enum SpzPointOrder
+{
+	/**
+         * The order of the splat (default).
+         */
+	SpzPointOrder_Original = 0,
+	/**
+         * Z-order along the quantized positions, smaller files.
+         */
+	SpzPointOrder_Morton = 1,
+	/**
+         * Hilbert order along the quantized positions, slightly better
+         * locality than Morton.
+         */
+	SpzPointOrder_Hilbert = 2,
+} SpzPointOrder;
+
 /**
  * Coordinate system enumeration for 3D data.
  *
@@ -70,11 +160,98 @@ typedef enum SpzResult
          */
 	SpzResult_InvalidArgument = 2,
 	/**
-         * An I/O or parsing error occurred.
+         * An I/O error occurred, e.g. a file couldn't be opened or read.
          */
 	SpzResult_IoError = 3,
+	/**
+         * A caller-provided output buffer is too small for the data.
+         */
+	SpzResult_BufferTooSmall = 4,
+	/**
+         * The data is not valid SPZ, or exceeds the limits of the load options.
+         */
+	SpzResult_InvalidData = 5,
 } SpzResult;
 
+/**
+ * Memory layout of decoded point records, the README lists the fields of
+ * each record.
+ */
+typedef enum SpzLayout
+{
+	/**
+         * One float array per attribute, as in a splat; has no records.
+         */
+	SpzLayout_Columns = 0,
+	/**
+         * 64 byte records of floats: position, scale, rotation (xyzw) and RGBA,
+         * each 16 byte aligned.
+         */
+	SpzLayout_InterleavedF32 = 1,
+	/**
+         * 32 byte records of the same as IEEE 754 halves.
+         */
+	SpzLayout_InterleavedF16 = 2,
+	/**
+         * 32 byte records: float position, unorm8 RGBA, half scales and snorm16
+         * rotation.
+         */
+	SpzLayout_Quantized32 = 3,
+} SpzLayout;
+
+/**
+ * Transform applied to the values of point records.
+ */
+typedef enum SpzActivation
+{
+	/**
+         * The values a splat holds: log scales, alphas before the sigmoid and
+         * degree 0 spherical harmonics coefficients as colors.
+         */
+	SpzActivation_Raw = 0,
+	/**
+         * `exp` of the scales, sigmoid of the alphas and RGB colors.
+         */
+	SpzActivation_Activated = 1,
+	/**
+         * Like `SpzActivation_Activated`, with RGB multiplied by alpha.
+         */
+	SpzActivation_Premultiplied = 2,
+} SpzActivation;
+
+/**
+ * Opaque handle to a memory-mapped cache file, see `spz_cache_build`.
+ *
+ * The attribute arrays point into the mapping, opening a cache decodes
+ * nothing. The file must not be modified while the handle is alive.
+ *
+ * Must be freed with `spz_cached_gaussian_splat_free`.
+ */
+typedef struct SpzCachedGaussianSplat SpzCachedGaussianSplat;
+
+/**
+ * Opaque handle to a loading context.
+ *
+ * It decodes batches of files on its worker threads and recycles the
+ * decompression buffers and inflate state across files and calls. A context can be
+ * used from several threads at once.
+ *
+ * Must be freed with `spz_context_free`.
+ */
+typedef struct SpzContext SpzContext;
+
+/**
+ * Opaque handle to a decode context.
+ *
+ * It keeps its decompression buffer and inflate state between loads, and
+ * decodes into existing splats, reusing their float arrays. Once these have
+ * grown to fit, loading similarly sized data doesn't allocate. A context
+ * must be used by one thread at a time.
+ *
+ * Must be freed with `spz_decode_context_free`.
+ */
+typedef struct SpzDecodeContext SpzDecodeContext;
+
 /**
  * Opaque handle to a GaussianSplat object.
  *
@@ -92,6 +269,29 @@ typedef struct SpzGaussianSplat SpzGaussianSplat;
  */
 typedef struct SpzHeader SpzHeader;
 
+/**
+ * Opaque handle to a splat that decodes each attribute the first time its
+ * accessor is called.
+ *
+ * It keeps the decompressed, packed data alive. Attributes outside of the
+ * load mask are never decoded and report a length of 0.
+ *
+ * Must be freed with `spz_lazy_gaussian_splat_free`.
+ */
+typedef struct SpzLazyGaussianSplat SpzLazyGaussianSplat;
+
+/**
+ * Opaque handle to a spatial index over the points of a splat.
+ *
+ * The points are sorted along a Morton curve under a bounding volume
+ * hierarchy, each bounded by a sphere of 3 times its largest scale. The
+ * index doesn't reference the splat, it stays valid for as long as the
+ * positions and scales it was built from don't change.
+ *
+ * Must be freed with `spz_spatial_index_free`.
+ */
+typedef struct SpzSpatialIndex SpzSpatialIndex;
+
 /**
  * Axis-aligned bounding box of a Gaussian Splat.
  */
@@ -105,6 +305,193 @@ typedef struct SpzBoundingBox
 	float max_z;
 } SpzBoundingBox;
 
+/**
+ * Options for `spz_gaussian_splat_load_with`,
+ * `spz_gaussian_splat_load_from_bytes_with`,
+ * `spz_attribute_buffers_required_with` and `spz_decode_into_with`.
+ *
+ * Get the defaults from `spz_load_options_default` and change the fields
+ * needed.
+ */
+typedef struct SpzLoadOptions
+{
+	/**
+         * Coordinate system to convert the splat to.
+         */
+	enum SpzCoordinateSystem coord_sys;
+	/**
+         * Number of threads to decode with, `0` uses all available cores.
+         */
+	uintptr_t threads;
+	/**
+         * Highest degree of spherical harmonics to decode, the coefficients of
+         * higher degrees are skipped and the splat reports the lower degree.
+         */
+	uint8_t max_sh_degree;
+	/**
+         * Combination of `SPZ_ATTRIBUTE_*` bits selecting the attributes to
+         * decode, unknown bits are ignored. The others are neither decoded, nor
+         * allocated, nor inflated when the data allows it, and report a length
+         * of 0.
+         */
+	uint32_t attributes;
+	/**
+         * Most points a file may claim, larger ones fail before anything is
+         * allocated. `SIZE_MAX` allows any.
+         */
+	uintptr_t max_points;
+	/**
+         * Most bytes a file may inflate to, larger ones fail before anything is
+         * inflated. `SIZE_MAX` allows any.
+         */
+	uintptr_t max_decompressed_len;
+} SpzLoadOptions;
+
+/**
+ * Options for `spz_gaussian_splat_save_with` and
+ * `spz_gaussian_splat_to_bytes_with`.
+ *
+ * Get the defaults from `spz_save_options_default` and change the fields
+ * needed.
+ */
+typedef struct SpzSaveOptions
+{
+	/**
+         * Source coordinate system of the splat.
+         */
+	enum SpzCoordinateSystem coord_sys;
+	/**
+         * Compression format.
+         */
+	enum SpzCodec codec;
+	/**
+         * Compression preset, used when `level` is negative.
+         */
+	enum SpzCompressionPreset preset;
+	/**
+         * Codec specific compression level, clamped to the codec's range, or
+         * negative to use `preset`.
+         */
+	int32_t level;
+	/**
+         * Number of threads to encode with, `0` uses all available cores.
+         */
+	uintptr_t threads;
+	/**
+         * Compresses into a multi-member gzip stream on `threads` threads.
+         */
+	bool parallel_compression;
+	/**
+         * Order to write the points in, loading the file yields them in it.
+         */
+	enum SpzPointOrder order;
+} SpzSaveOptions;
+
+/**
+ * Callback that supplies compressed SPZ bytes to
+ * `spz_gaussian_splat_load_from_reader`.
+ *
+ * Must write at most `len` bytes into `buf` and return the number of bytes
+ * written, `0` at the end of the stream, or a negative value on error.
+ */
+typedef intptr_t (*SpzReadCallback)(void *user_data, uint8_t *buf, uintptr_t len);
+
+/**
+ * Callback receiving the outcome of `spz_context_load_async`.
+ *
+ * Called exactly once per accepted load, on a worker thread of the context.
+ * On success `result` is `SpzResult_Success` and `splat` a handle the
+ * callback takes ownership of, to free with `spz_gaussian_splat_free`. On
+ * failure `splat` is NULL and `error` a message valid only during the call.
+ */
+typedef void (*SpzLoadCallback)(
+    void *user_data, enum SpzResult result, struct SpzGaussianSplat *splat, const char *error);
+
+/**
+ * Caller-owned output buffers for `spz_decode_into`.
+ *
+ * Each array has the same layout as the matching `spz_gaussian_splat_*`
+ * accessor, and each `*_len` field is the capacity of its array in floats.
+ * An array may be NULL only if its capacity is 0 and no data is expected
+ * for it (e.g. `spherical_harmonics` for SH degree 0).
+ *
+ * Use `spz_attribute_buffers_required` to get the capacities needed.
+ */
+typedef struct SpzAttributeBuffers
+{
+	float *positions;
+	uintptr_t positions_len;
+	float *scales;
+	uintptr_t scales_len;
+	float *rotations;
+	uintptr_t rotations_len;
+	float *alphas;
+	uintptr_t alphas_len;
+	float *colors;
+	uintptr_t colors_len;
+	float *spherical_harmonics;
+	uintptr_t spherical_harmonics_len;
+} SpzAttributeBuffers;
+
+/**
+ * What one stage of loading or saving did, summed over the times it ran.
+ */
+typedef struct SpzStageStats
+{
+	/**
+         * Number of times the stage ran.
+         */
+	uint32_t calls;
+	/**
+         * Most threads the stage ran on at once.
+         */
+	uint32_t threads;
+	uint64_t wall_ns;
+	uint64_t bytes_in;
+	uint64_t bytes_out;
+	/**
+         * Bytes of the buffers the stage allocated for its output.
+         */
+	uint64_t allocated;
+} SpzStageStats;
+
+/**
+ * Per-stage statistics recorded between `spz_load_stats_begin` and
+ * `spz_load_stats_end`.
+ *
+ * Stages fused into one pass are reported as one: decoding in memory
+ * converts coordinates while dequantizing.
+ */
+typedef struct SpzLoadStats
+{
+	/**
+         * Reading or mapping the file.
+         */
+	struct SpzStageStats read;
+	/**
+         * Decompressing.
+         */
+	struct SpzStageStats inflate;
+	/**
+         * Reading the header and sections of decompressed data.
+         */
+	struct SpzStageStats parse;
+	struct SpzStageStats dequantize;
+	/**
+         * Axis flips applied as a pass of their own.
+         */
+	struct SpzStageStats convert_coordinates;
+	struct SpzStageStats quantize;
+	/**
+         * Compressing.
+         */
+	struct SpzStageStats deflate;
+	/**
+         * Writing the file.
+         */
+	struct SpzStageStats write;
+} SpzLoadStats;
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -128,6 +515,9 @@ extern "C"
 	/**
  * Reads a header from compressed SPZ bytes without loading the full splat data.
  *
+ * For a chunked or a progressive file `data` must hold the whole file, which
+ * gives the total points of its chunks or the header of its finest level.
+ *
  * Returns NULL on failure. Call `spz_last_error()` for error details.
  * The caller must free the returned handle with `spz_header_free`.
  *
@@ -226,6 +616,13 @@ extern "C"
  */
 	struct SpzGaussianSplat *spz_gaussian_splat_new(void);
 
+	/**
+ * Returns the default load options: every attribute and spherical
+ * harmonics degree, decoded on the calling thread, in an unspecified
+ * coordinate system, without limits.
+ */
+	struct SpzLoadOptions spz_load_options_default(void);
+
 	/**
  * Loads a GaussianSplat from an SPZ file.
  *
@@ -240,6 +637,21 @@ extern "C"
 
 	struct SpzGaussianSplat *spz_gaussian_splat_load(const char *filepath, enum SpzCoordinateSystem coord_sys);
 
+	/**
+ * Loads a GaussianSplat from an SPZ file with the given options.
+ *
+ * Returns NULL on failure. Call `spz_last_error()` for error details.
+ * The caller must free the returned handle with `spz_gaussian_splat_free`.
+ *
+ * # Safety
+ *
+ * `filepath` must be a valid, non-null pointer to a NUL-terminated string
+ * and `opts` a valid pointer to `SpzLoadOptions` for the duration of this
+ * call.
+ */
+
+	struct SpzGaussianSplat *spz_gaussian_splat_load_with(const char *filepath, const struct SpzLoadOptions *opts);
+
 	/**
  * Loads a GaussianSplat from a byte buffer containing SPZ data.
  *
@@ -255,6 +667,53 @@ extern "C"
 	struct SpzGaussianSplat *
 	spz_gaussian_splat_load_from_bytes(const uint8_t *data, uintptr_t len, enum SpzCoordinateSystem coord_sys);
 
+	/**
+ * Loads a GaussianSplat from a byte buffer containing SPZ data with the
+ * given options.
+ *
+ * Returns NULL on failure. Call `spz_last_error()` for error details.
+ * The caller must free the returned handle with `spz_gaussian_splat_free`.
+ *
+ * # Safety
+ *
+ * `data` must be a valid, non-null pointer to `len` readable bytes and
+ * `opts` a valid pointer to `SpzLoadOptions` for the duration of this call.
+ */
+
+	struct SpzGaussianSplat *
+	spz_gaussian_splat_load_from_bytes_with(const uint8_t *data, uintptr_t len, const struct SpzLoadOptions *opts);
+
+	/**
+ * Loads a GaussianSplat from a stream of SPZ data supplied by `read`.
+ *
+ * The data is inflated and decoded while it is read: every attribute is
+ * decoded straight into its final array and only a small, fixed-size window
+ * of inflated bytes is buffered, so the whole file is never held in memory.
+ * A chunked or a progressive file is read to its end and then loaded.
+ *
+ * `read` is called on the calling thread, repeatedly, until it signals the
+ * end of the stream or enough data has been read. `user_data` is passed to
+ * it unchanged.
+ *
+ * Returns NULL on failure. Call `spz_last_error()` for error details.
+ * The caller must free the returned handle with `spz_gaussian_splat_free`.
+ *
+ * # Safety
+ *
+ * `read` must be a valid callback honoring the `SpzReadCallback` contract
+ * for `user_data` for the duration of this call.
+ */
+
+	struct SpzGaussianSplat *
+	spz_gaussian_splat_load_from_reader(SpzReadCallback read, void *user_data, enum SpzCoordinateSystem coord_sys);
+
+	/**
+ * Returns the default save options: gzip at the default preset, encoded on
+ * the calling thread in the original point order, from an unspecified
+ * coordinate system.
+ */
+	struct SpzSaveOptions spz_save_options_default(void);
+
 	/**
  * Saves a GaussianSplat to an SPZ file.
  *
@@ -269,6 +728,21 @@ extern "C"
 	enum SpzResult spz_gaussian_splat_save(
 	    const struct SpzGaussianSplat *splat, const char *filepath, enum SpzCoordinateSystem coord_sys);
 
+	/**
+ * Saves a GaussianSplat to an SPZ file with the given options.
+ *
+ * Returns `SpzResult_Success` on success. Call `spz_last_error()` on failure.
+ *
+ * # Safety
+ *
+ * `splat` must be a valid live handle returned by this library, `filepath`
+ * must be a valid, non-null pointer to a NUL-terminated string and `opts`
+ * must be a valid pointer to `SpzSaveOptions` for this call.
+ */
+
+	enum SpzResult spz_gaussian_splat_save_with(
+	    const struct SpzGaussianSplat *splat, const char *filepath, const struct SpzSaveOptions *opts);
+
 	/**
  * Serializes a GaussianSplat to a heap-allocated byte buffer.
  *
@@ -287,6 +761,26 @@ extern "C"
 	    uint8_t **out_data,
 	    uintptr_t *out_len);
 
+	/**
+ * Serializes a GaussianSplat to a heap-allocated byte buffer with the given
+ * options.
+ *
+ * Returns `SpzResult_Success` on success. Call `spz_last_error()` on failure.
+ * The caller must free the returned buffer with `spz_free_bytes`.
+ *
+ * # Safety
+ *
+ * `splat` must be a valid live handle returned by this library. `opts` must
+ * be a valid pointer to `SpzSaveOptions`, and `out_data` and `out_len` valid
+ * writable pointers for this call.
+ */
+
+	enum SpzResult spz_gaussian_splat_to_bytes_with(
+	    const struct SpzGaussianSplat *splat,
+	    const struct SpzSaveOptions *opts,
+	    uint8_t **out_data,
+	    uintptr_t *out_len);
+
 	/**
  * Frees a byte buffer previously returned by `spz_gaussian_splat_to_bytes`.
  *
@@ -306,29 +800,186 @@ extern "C"
 	void spz_gaussian_splat_free(struct SpzGaussianSplat *splat);
 
 	/**
- * Returns the number of points (gaussians) in the splat.
- *
- * # Safety
+ * Creates a loading context decoding up to `threads` files at once, `0`
+ * uses all available cores.
  *
- * `splat` must be null or a valid live splat handle returned by this library.
+ * The caller must free the returned handle with `spz_context_free`.
  */
-	int32_t spz_gaussian_splat_num_points(const struct SpzGaussianSplat *splat);
+	struct SpzContext *spz_context_new(uintptr_t threads);
 
 	/**
- * Returns the spherical harmonics degree (0-3).
+ * Frees a context, after waiting for its pending asynchronous loads: their
+ * callbacks have all run once this returns.
  *
  * # Safety
  *
- * `splat` must be null or a valid live splat handle returned by this library.
+ * `ctx` must be null or a pointer previously returned by this library and
+ * not already freed. No batch may be running on it and it must not be
+ * freed from one of its load callbacks.
  */
-	uint8_t spz_gaussian_splat_sh_degree(const struct SpzGaussianSplat *splat);
+	void spz_context_free(struct SpzContext *ctx);
 
 	/**
- * Returns the SPZ format version of the splat.
+ * Loads a GaussianSplat from an SPZ file on the calling thread, with a
+ * recycled decoder of `ctx`.
+ *
+ * Returns NULL on failure. Call `spz_last_error()` for error details.
+ * The caller must free the returned handle with `spz_gaussian_splat_free`.
  *
  * # Safety
  *
- * `splat` must be null or a valid live splat handle returned by this library.
+ * `ctx` must be a valid live context handle returned by this library.
+ * `filepath` must be a valid, non-null pointer to a NUL-terminated string
+ * for the duration of this call.
+ */
+	struct SpzGaussianSplat *spz_context_load(
+	    const struct SpzContext *ctx, const char *filepath, enum SpzCoordinateSystem coord_sys);
+
+	/**
+ * Queues a load of an SPZ file on the worker threads of `ctx` and returns
+ * immediately.
+ *
+ * Reading and decoding run on a fixed set of background workers, one per
+ * context thread, so any number of loads can be in flight without
+ * oversubscribing the cores. `callback` reports the outcome, see
+ * `SpzLoadCallback`.
+ *
+ * Returns `SpzResult_Success` if the load was queued, in which case
+ * `callback` will be called exactly once. Otherwise it is never called, call
+ * `spz_last_error()` for error details.
+ *
+ * # Safety
+ *
+ * `ctx` must be a valid live context handle returned by this library.
+ * `filepath` must be a valid, non-null pointer to a NUL-terminated string
+ * for the duration of this call. `callback` must be safe to call with
+ * `user_data` from another thread until it has been called.
+ */
+	enum SpzResult spz_context_load_async(const struct SpzContext *ctx,
+	    const char *filepath,
+	    enum SpzCoordinateSystem coord_sys,
+	    SpzLoadCallback callback,
+	    void *user_data);
+
+	/**
+ * Loads `n` SPZ files concurrently on the worker threads of `ctx`.
+ *
+ * `out_splats[i]` receives the splat loaded from `paths[i]`, or NULL if that
+ * file failed. If `out_results` is non-null, `out_results[i]` receives the
+ * status of `paths[i]`. A null `ctx` loads with a temporary context using
+ * all available cores.
+ *
+ * Returns `SpzResult_Success` if every file loaded, otherwise the status of
+ * the first failed file, whose message is available from `spz_last_error()`.
+ * The caller must free every non-null splat with `spz_gaussian_splat_free`.
+ *
+ * # Safety
+ *
+ * `ctx` must be null or a valid live context handle returned by this library.
+ * `paths` must point to `n` pointers, each null or a NUL-terminated string
+ * valid for the duration of this call. `out_splats` must point to `n`
+ * writable handles, and `out_results`, if non-null, to `n` writable results.
+ */
+	enum SpzResult spz_gaussian_splat_load_batch(const struct SpzContext *ctx,
+	    const char *const *paths,
+	    uintptr_t n,
+	    enum SpzCoordinateSystem coord_sys,
+	    struct SpzGaussianSplat **out_splats,
+	    enum SpzResult *out_results);
+
+	/**
+ * Writes the number of floats each attribute described by `header` needs
+ * into the `*_len` fields of `out`. The array pointers are left untouched.
+ *
+ * Pair with `spz_header_from_bytes` to size the buffers for
+ * `spz_decode_into` without decoding the data.
+ *
+ * # Safety
+ *
+ * `header` must be null or a valid live header handle returned by this
+ * library, and `out` must be null or a valid writable pointer for this call.
+ */
+
+	enum SpzResult spz_attribute_buffers_required(const struct SpzHeader *header, struct SpzAttributeBuffers *out);
+
+	/**
+ * Like `spz_attribute_buffers_required`, for the data decoded with `opts`:
+ * the attributes it leaves out need 0 floats and the spherical harmonics
+ * are cut to its `max_sh_degree`.
+ *
+ * # Safety
+ *
+ * `header` must be null or a valid live header handle returned by this
+ * library, `opts` null or a valid pointer to `SpzLoadOptions`, and `out`
+ * null or a valid writable pointer for this call.
+ */
+
+	enum SpzResult spz_attribute_buffers_required_with(
+	    const struct SpzHeader *header, const struct SpzLoadOptions *opts, struct SpzAttributeBuffers *out);
+
+	/**
+ * Decodes SPZ data straight into caller-owned float arrays.
+ *
+ * No splat handle is created and no float arrays are allocated by the
+ * library; the decoded attributes are written to the arrays in `out`,
+ * converted to `coord_sys`. Arrays larger than needed are only partially
+ * written.
+ *
+ * Returns `SpzResult_BufferTooSmall` if any array is smaller than required,
+ * see `spz_attribute_buffers_required`. Call `spz_last_error()` on failure.
+ *
+ * # Safety
+ *
+ * `data` must be a valid, non-null pointer to `len` readable bytes for the
+ * duration of this call. `out` must be a valid pointer whose arrays are
+ * writable for their `*_len` floats and do not overlap each other or `data`.
+ */
+
+	enum SpzResult spz_decode_into(
+	    const uint8_t *data, uintptr_t len, enum SpzCoordinateSystem coord_sys, const struct SpzAttributeBuffers *out);
+
+	/**
+ * Like `spz_decode_into`, decoding with `opts`.
+ *
+ * Only the attributes selected by `opts` are written, size the arrays with
+ * `spz_attribute_buffers_required_with`. The sections of the data after
+ * the last selected attribute are not inflated when the data allows it.
+ *
+ * # Safety
+ *
+ * `data` must be a valid, non-null pointer to `len` readable bytes and
+ * `opts` a valid pointer to `SpzLoadOptions` for the duration of this call.
+ * `out` must be a valid pointer whose arrays are writable for their
+ * `*_len` floats and do not overlap each other or `data`.
+ */
+
+	enum SpzResult spz_decode_into_with(
+	    const uint8_t *data, uintptr_t len, const struct SpzLoadOptions *opts, const struct SpzAttributeBuffers *out);
+
+	/**
+ * Returns the number of points (gaussians) in the splat.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live splat handle returned by this library.
+ */
+	int32_t spz_gaussian_splat_num_points(const struct SpzGaussianSplat *splat);
+
+	/**
+ * Returns the spherical harmonics degree (0-3).
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live splat handle returned by this library.
+ */
+	uint8_t spz_gaussian_splat_sh_degree(const struct SpzGaussianSplat *splat);
+
+	/**
+ * Returns the SPZ format version of the splat.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live splat handle returned by this library.
  */
 	enum SpzVersion spz_gaussian_splat_version(const struct SpzGaussianSplat *splat);
 
@@ -497,8 +1148,629 @@ extern "C"
 	char *spz_gaussian_splat_pretty_fmt(const struct SpzGaussianSplat *splat);
 
 	/**
- * Frees a string previously returned by `spz_gaussian_splat_pretty_fmt`
- * or `spz_header_pretty_fmt`.
+ * Loads a lazy GaussianSplat from an SPZ file, decompressing it without
+ * decoding any attribute.
+ *
+ * `mask` is a combination of `SPZ_ATTRIBUTE_*` bits, unknown bits are ignored.
+ *
+ * Returns NULL on failure. Call `spz_last_error()` for error details.
+ * The caller must free the returned handle with `spz_lazy_gaussian_splat_free`.
+ *
+ * # Safety
+ *
+ * `filepath` must be a valid, non-null pointer to a NUL-terminated string
+ * for the duration of this call.
+ */
+	struct SpzLazyGaussianSplat *spz_lazy_gaussian_splat_load(
+	    const char *filepath, enum SpzCoordinateSystem coord_sys, uint32_t mask);
+
+	/**
+ * Loads a lazy GaussianSplat from a byte buffer containing SPZ data.
+ *
+ * The bytes are decompressed into the handle, `data` can be released once
+ * this returns.
+ *
+ * Returns NULL on failure. Call `spz_last_error()` for error details.
+ * The caller must free the returned handle with `spz_lazy_gaussian_splat_free`.
+ *
+ * # Safety
+ *
+ * `data` must be a valid, non-null pointer to `len` readable bytes for the
+ * duration of this call.
+ */
+	struct SpzLazyGaussianSplat *spz_lazy_gaussian_splat_load_from_bytes(
+	    const uint8_t *data, uintptr_t len, enum SpzCoordinateSystem coord_sys, uint32_t mask);
+
+	/**
+ * # Safety
+ *
+ * `splat` must be null or a pointer previously returned by this library and
+ * not already freed.
+ */
+	void spz_lazy_gaussian_splat_free(struct SpzLazyGaussianSplat *splat);
+
+	/**
+ * Returns the number of points, or 0 if the handle is null.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live lazy splat handle returned by this library.
+ */
+	int32_t spz_lazy_gaussian_splat_num_points(const struct SpzLazyGaussianSplat *splat);
+
+	/**
+ * Returns the spherical harmonics degree, or 0 if the handle is null.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live lazy splat handle returned by this library.
+ */
+	uint8_t spz_lazy_gaussian_splat_sh_degree(const struct SpzLazyGaussianSplat *splat);
+
+	/**
+ * Returns the attribute mask the splat was loaded with, or 0 if the handle
+ * is null.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live lazy splat handle returned by this library.
+ */
+	uint32_t spz_lazy_gaussian_splat_mask(const struct SpzLazyGaussianSplat *splat);
+
+	/**
+ * Returns the bounding box of the positions, read from the quantized data
+ * without decoding them, also when they are masked out.
+ *
+ * Returns a zeroed bounding box if the handle is null.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live lazy splat handle returned by this library.
+ */
+	struct SpzBoundingBox spz_lazy_gaussian_splat_bbox(const struct SpzLazyGaussianSplat *splat);
+
+	/**
+ * Returns the median ellipsoid volume of the gaussians, read from the
+ * quantized scales without decoding them.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live lazy splat handle returned by this library.
+ */
+	float spz_lazy_gaussian_splat_median_volume(const struct SpzLazyGaussianSplat *splat);
+
+	/**
+ * Returns a heap-allocated summary like `spz_gaussian_splat_pretty_fmt`,
+ * without decoding any attribute.
+ *
+ * The caller must free the returned string with `spz_free_string`.
+ * Returns NULL if the handle is null.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live lazy splat handle returned by this library.
+ */
+	char *spz_lazy_gaussian_splat_pretty_fmt(const struct SpzLazyGaussianSplat *splat);
+
+	/**
+ * Returns a pointer to the positions array, decoding it on the first call.
+ *
+ * The layout matches `spz_gaussian_splat_positions`. The pointer is valid until the lazy splat is
+ * freed.
+ *
+ * If `out_len` is non-null it receives the total number of floats.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live lazy splat handle returned by this library.
+ * If `out_len` is non-null it must be a valid writable pointer for this call.
+ */
+	const float *spz_lazy_gaussian_splat_positions(const struct SpzLazyGaussianSplat *splat, uintptr_t *out_len);
+
+	/**
+ * Returns a pointer to the scales array, decoding it on the first call.
+ *
+ * The layout matches `spz_gaussian_splat_scales`. The pointer is valid until the lazy splat is
+ * freed.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live lazy splat handle returned by this library.
+ * If `out_len` is non-null it must be a valid writable pointer for this call.
+ */
+	const float *spz_lazy_gaussian_splat_scales(const struct SpzLazyGaussianSplat *splat, uintptr_t *out_len);
+
+	/**
+ * Returns a pointer to the rotations array, decoding it on the first call.
+ *
+ * The layout matches `spz_gaussian_splat_rotations`. The pointer is valid until the lazy splat is
+ * freed.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live lazy splat handle returned by this library.
+ * If `out_len` is non-null it must be a valid writable pointer for this call.
+ */
+	const float *spz_lazy_gaussian_splat_rotations(const struct SpzLazyGaussianSplat *splat, uintptr_t *out_len);
+
+	/**
+ * Returns a pointer to the alphas array, decoding it on the first call.
+ *
+ * The layout matches `spz_gaussian_splat_alphas`. The pointer is valid until the lazy splat is
+ * freed.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live lazy splat handle returned by this library.
+ * If `out_len` is non-null it must be a valid writable pointer for this call.
+ */
+	const float *spz_lazy_gaussian_splat_alphas(const struct SpzLazyGaussianSplat *splat, uintptr_t *out_len);
+
+	/**
+ * Returns a pointer to the colors array, decoding it on the first call.
+ *
+ * The layout matches `spz_gaussian_splat_colors`. The pointer is valid until the lazy splat is
+ * freed.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live lazy splat handle returned by this library.
+ * If `out_len` is non-null it must be a valid writable pointer for this call.
+ */
+	const float *spz_lazy_gaussian_splat_colors(const struct SpzLazyGaussianSplat *splat, uintptr_t *out_len);
+
+	/**
+ * Returns a pointer to the spherical harmonics array, decoding it on the
+ * first call.
+ *
+ * The layout matches `spz_gaussian_splat_spherical_harmonics`. The pointer
+ * is valid until the lazy splat is freed. Loading without
+ * `SPZ_ATTRIBUTE_SPHERICAL_HARMONICS` skips them entirely.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live lazy splat handle returned by this library.
+ * If `out_len` is non-null it must be a valid writable pointer for this call.
+ */
+	const float *spz_lazy_gaussian_splat_spherical_harmonics(
+	    const struct SpzLazyGaussianSplat *splat, uintptr_t *out_len);
+
+	/**
+ * Decodes the remaining attributes into a new, independent GaussianSplat.
+ *
+ * Attributes outside of the load mask are left empty.
+ *
+ * Returns NULL if the handle is null.
+ * The caller must free the returned handle with `spz_gaussian_splat_free`.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live lazy splat handle returned by this library.
+ */
+	struct SpzGaussianSplat *spz_lazy_gaussian_splat_to_splat(const struct SpzLazyGaussianSplat *splat);
+
+	/**
+ * Loads an SPZ file and writes its decoded attributes to a cache file, in
+ * `coord_sys`.
+ *
+ * If `output` is NULL the cache is written next to `source`, at
+ * `<source>.cache`, where `spz_cached_gaussian_splat_open_for` looks for it.
+ *
+ * Returns `SpzResult_Success` on success. Call `spz_last_error()` on failure.
+ *
+ * # Safety
+ *
+ * `source` must be a valid, non-null pointer to a NUL-terminated string for
+ * this call. `output` must be null or such a pointer.
+ */
+	enum SpzResult spz_cache_build(const char *source, const char *output, enum SpzCoordinateSystem coord_sys);
+
+	/**
+ * Maps a cache file into memory, checking its header and section sizes.
+ *
+ * Returns NULL on failure. Call `spz_last_error()` for error details.
+ * The caller must free the returned handle with `spz_cached_gaussian_splat_free`.
+ *
+ * # Safety
+ *
+ * `filepath` must be a valid, non-null pointer to a NUL-terminated string
+ * for the duration of this call.
+ */
+	struct SpzCachedGaussianSplat *spz_cached_gaussian_splat_open(const char *filepath);
+
+	/**
+ * Maps the cache file of the SPZ file `source` into memory, if it exists
+ * and was built from the file as it is now.
+ *
+ * Returns NULL with an empty `spz_last_error()` if there is no such cache,
+ * e.g. to fall back to `spz_gaussian_splat_load`, and NULL with an error
+ * message if opening it failed.
+ * The caller must free the returned handle with `spz_cached_gaussian_splat_free`.
+ *
+ * # Safety
+ *
+ * `source` must be a valid, non-null pointer to a NUL-terminated string for
+ * the duration of this call.
+ */
+	struct SpzCachedGaussianSplat *spz_cached_gaussian_splat_open_for(const char *source);
+
+	/**
+ * # Safety
+ *
+ * `splat` must be null or a pointer previously returned by this library and
+ * not already freed.
+ */
+	void spz_cached_gaussian_splat_free(struct SpzCachedGaussianSplat *splat);
+
+	/**
+ * Checks the CRC-32 of every section, reading the whole file.
+ *
+ * Returns `SpzResult_Success` if the data is intact. Call `spz_last_error()`
+ * on failure.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live cached splat handle returned by this library.
+ */
+	enum SpzResult spz_cached_gaussian_splat_verify(const struct SpzCachedGaussianSplat *splat);
+
+	/**
+ * Returns the number of points, or 0 if the handle is null.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live cached splat handle returned by this library.
+ */
+	int32_t spz_cached_gaussian_splat_num_points(const struct SpzCachedGaussianSplat *splat);
+
+	/**
+ * Returns the spherical harmonics degree, or 0 if the handle is null.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live cached splat handle returned by this library.
+ */
+	uint8_t spz_cached_gaussian_splat_sh_degree(const struct SpzCachedGaussianSplat *splat);
+
+	/**
+ * Returns the coordinate system the cache was built in, or
+ * `SpzCoordinateSystem_Unspecified` if the handle is null.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live cached splat handle returned by this library.
+ */
+	enum SpzCoordinateSystem spz_cached_gaussian_splat_coord_sys(const struct SpzCachedGaussianSplat *splat);
+
+	/**
+ * Returns a pointer into the mapping at the positions array.
+ *
+ * The layout matches `spz_gaussian_splat_positions`. The pointer is valid
+ * until the cached splat is freed.
+ *
+ * If `out_len` is non-null it receives the total number of floats.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live cached splat handle returned by this library.
+ * If `out_len` is non-null it must be a valid writable pointer for this call.
+ */
+	const float *spz_cached_gaussian_splat_positions(
+	    const struct SpzCachedGaussianSplat *splat, uintptr_t *out_len);
+
+	/**
+ * Returns a pointer into the mapping at the scales array.
+ *
+ * The layout matches `spz_gaussian_splat_scales`. The pointer is valid
+ * until the cached splat is freed.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live cached splat handle returned by this library.
+ * If `out_len` is non-null it must be a valid writable pointer for this call.
+ */
+	const float *spz_cached_gaussian_splat_scales(
+	    const struct SpzCachedGaussianSplat *splat, uintptr_t *out_len);
+
+	/**
+ * Returns a pointer into the mapping at the rotations array.
+ *
+ * The layout matches `spz_gaussian_splat_rotations`. The pointer is valid
+ * until the cached splat is freed.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live cached splat handle returned by this library.
+ * If `out_len` is non-null it must be a valid writable pointer for this call.
+ */
+	const float *spz_cached_gaussian_splat_rotations(
+	    const struct SpzCachedGaussianSplat *splat, uintptr_t *out_len);
+
+	/**
+ * Returns a pointer into the mapping at the alphas array.
+ *
+ * The layout matches `spz_gaussian_splat_alphas`. The pointer is valid
+ * until the cached splat is freed.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live cached splat handle returned by this library.
+ * If `out_len` is non-null it must be a valid writable pointer for this call.
+ */
+	const float *spz_cached_gaussian_splat_alphas(
+	    const struct SpzCachedGaussianSplat *splat, uintptr_t *out_len);
+
+	/**
+ * Returns a pointer into the mapping at the colors array.
+ *
+ * The layout matches `spz_gaussian_splat_colors`. The pointer is valid
+ * until the cached splat is freed.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live cached splat handle returned by this library.
+ * If `out_len` is non-null it must be a valid writable pointer for this call.
+ */
+	const float *spz_cached_gaussian_splat_colors(
+	    const struct SpzCachedGaussianSplat *splat, uintptr_t *out_len);
+
+	/**
+ * Returns a pointer into the mapping at the spherical harmonics array.
+ *
+ * The layout matches `spz_gaussian_splat_spherical_harmonics`. The pointer is valid
+ * until the cached splat is freed.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live cached splat handle returned by this library.
+ * If `out_len` is non-null it must be a valid writable pointer for this call.
+ */
+	const float *spz_cached_gaussian_splat_spherical_harmonics(
+	    const struct SpzCachedGaussianSplat *splat, uintptr_t *out_len);
+
+	/**
+ * Copies the attributes into a new, independent GaussianSplat.
+ *
+ * Returns NULL if the handle is null.
+ * The caller must free the returned handle with `spz_gaussian_splat_free`.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live cached splat handle returned by this library.
+ */
+	struct SpzGaussianSplat *spz_cached_gaussian_splat_to_splat(const struct SpzCachedGaussianSplat *splat);
+
+	/**
+ * Creates a decode context, its buffers grow on first use.
+ *
+ * The caller must free the returned handle with `spz_decode_context_free`.
+ */
+	struct SpzDecodeContext *spz_decode_context_new(void);
+
+	/**
+ * # Safety
+ *
+ * `ctx` must be null or a pointer previously returned by this library and
+ * not already freed.
+ */
+	void spz_decode_context_free(struct SpzDecodeContext *ctx);
+
+	/**
+ * Returns the bytes of scratch memory `ctx` keeps between loads, or 0 if the
+ * handle is null.
+ *
+ * # Safety
+ *
+ * `ctx` must be null or a valid live decode context handle returned by this
+ * library.
+ */
+	uintptr_t spz_decode_context_retained_bytes(const struct SpzDecodeContext *ctx);
+
+	/**
+ * Loads an SPZ file into an existing splat, replacing its contents and
+ * reusing its float arrays.
+ *
+ * On failure the contents of `splat` are unspecified but it stays a valid
+ * handle. Call `spz_last_error()` for error details.
+ *
+ * # Safety
+ *
+ * `ctx` and `splat` must be valid live handles returned by this library.
+ * `filepath` must be a valid, non-null pointer to a NUL-terminated string
+ * for the duration of this call.
+ */
+	enum SpzResult spz_decode_context_load(struct SpzDecodeContext *ctx, const char *filepath,
+	    enum SpzCoordinateSystem coord_sys, struct SpzGaussianSplat *splat);
+
+	/**
+ * Loads SPZ data from a byte buffer into an existing splat, replacing its
+ * contents and reusing its float arrays.
+ *
+ * On failure the contents of `splat` are unspecified but it stays a valid
+ * handle. Call `spz_last_error()` for error details.
+ *
+ * # Safety
+ *
+ * `ctx` and `splat` must be valid live handles returned by this library.
+ * `data` must be a valid, non-null pointer to `len` readable bytes for the
+ * duration of this call.
+ */
+	enum SpzResult spz_decode_context_load_from_bytes(struct SpzDecodeContext *ctx, const uint8_t *data,
+	    uintptr_t len, enum SpzCoordinateSystem coord_sys, struct SpzGaussianSplat *splat);
+
+	/**
+ * Like `spz_decode_into`, decompressing into the scratch buffer of `ctx`
+ * instead of a temporary one.
+ *
+ * # Safety
+ *
+ * `ctx` must be a valid live decode context handle returned by this library.
+ * `data` must be a valid, non-null pointer to `len` readable bytes for the
+ * duration of this call. `out` must be a valid pointer whose arrays are
+ * writable for their `*_len` floats and do not overlap each other or `data`.
+ */
+	enum SpzResult spz_decode_context_decode_into(struct SpzDecodeContext *ctx, const uint8_t *data,
+	    uintptr_t len, enum SpzCoordinateSystem coord_sys, const struct SpzAttributeBuffers *out);
+
+	/**
+ * Returns the bytes per point record of `layout`, 0 for
+ * `SpzLayout_Columns`.
+ */
+	uintptr_t spz_layout_record_size(enum SpzLayout layout);
+
+	/**
+ * Decodes SPZ data straight into caller-owned point records of `layout`,
+ * in one pass over the packed data, decompressing into the scratch buffer
+ * of `ctx`. Records hold no spherical harmonics.
+ *
+ * `out_len` receives the number of bytes the records take,
+ * `num_points * spz_layout_record_size(layout)`. If that exceeds `capacity`
+ * nothing is written to `out` and `SpzResult_BufferTooSmall` is returned.
+ * `out` needn't be aligned. Call `spz_last_error()` on failure.
+ *
+ * # Safety
+ *
+ * `ctx` must be a valid live decode context handle returned by this library.
+ * `data` must be a valid, non-null pointer to `len` readable bytes for the
+ * duration of this call. `out` must be writable for `capacity` bytes and
+ * not overlap `data`. `out_len` must be a valid, non-null pointer.
+ */
+	enum SpzResult spz_decode_context_decode_records(struct SpzDecodeContext *ctx,
+	    const uint8_t *data, uintptr_t len, enum SpzCoordinateSystem coord_sys, enum SpzLayout layout,
+	    enum SpzActivation activation, void *out, uintptr_t capacity, uintptr_t *out_len);
+
+	/**
+ * Builds a spatial index over the positions and scales of `splat`.
+ *
+ * `leaf_size` is the maximum number of points per leaf, 0 uses the default.
+ *
+ * Returns NULL on failure. Call `spz_last_error()` for error details.
+ * The caller must free the returned handle with `spz_spatial_index_free`.
+ *
+ * # Safety
+ *
+ * `splat` must be null or a valid live splat handle returned by this library.
+ */
+	struct SpzSpatialIndex *spz_spatial_index_build(const struct SpzGaussianSplat *splat,
+	    uintptr_t leaf_size);
+
+	/**
+ * # Safety
+ *
+ * `index` must be null or a pointer previously returned by this library and
+ * not already freed.
+ */
+	void spz_spatial_index_free(struct SpzSpatialIndex *index);
+
+	/**
+ * Returns a pointer to the point indices sorted along the Morton curve.
+ *
+ * The pointer is valid until the index is freed. If `out_len` is non-null
+ * it receives the number of indices.
+ *
+ * # Safety
+ *
+ * `index` must be null or a valid live spatial index handle returned by this
+ * library. If `out_len` is non-null it must be a valid writable pointer for
+ * this call.
+ */
+	const uint32_t *spz_spatial_index_order(const struct SpzSpatialIndex *index, uintptr_t *out_len);
+
+	/**
+ * Writes the indices of the points whose bounding sphere intersects `bbox`
+ * into `out`.
+ *
+ * `out_len` receives the number of matching points. If it exceeds
+ * `capacity` nothing is written to `out` and `SpzResult_BufferTooSmall` is
+ * returned, so calling with a `capacity` of 0 queries the size.
+ *
+ * # Safety
+ *
+ * `index` must be a valid live spatial index handle returned by this library.
+ * `bbox` and `out_len` must be valid pointers for this call, `out` must be
+ * writable for `capacity` indices or null if `capacity` is 0.
+ */
+	enum SpzResult spz_spatial_index_query_box(const struct SpzSpatialIndex *index,
+	    const struct SpzBoundingBox *bbox, uint32_t *out, uintptr_t capacity, uintptr_t *out_len);
+
+	/**
+ * Writes the indices of the points whose bounding sphere is at least partly
+ * inside the view frustum of `view_projection` into `out`.
+ *
+ * `view_projection` is a column-major 4x4 matrix mapping the splat's
+ * coordinates to clip space with `-w <= x, y, z <= w`. For a `0 <= z <= w`
+ * depth range the near plane is conservative. `out`, `capacity` and
+ * `out_len` behave as in `spz_spatial_index_query_box`.
+ *
+ * # Safety
+ *
+ * `index` must be a valid live spatial index handle returned by this library.
+ * `view_projection` must be readable for 16 floats and `out_len` a valid
+ * writable pointer for this call, `out` must be writable for `capacity`
+ * indices or null if `capacity` is 0.
+ */
+	enum SpzResult spz_spatial_index_query_frustum(const struct SpzSpatialIndex *index,
+	    const float *view_projection, uint32_t *out, uintptr_t capacity, uintptr_t *out_len);
+
+	/**
+ * Converts compressed SPZ data between coordinate systems without decoding
+ * it, flipping the signs of the quantized values. The result keeps the
+ * codec of the input, at the default compression level.
+ *
+ * Returns `SpzResult_Success` on success. Call `spz_last_error()` on failure.
+ * The caller must free the returned buffer with `spz_free_bytes`.
+ *
+ * # Safety
+ *
+ * `data` must be a valid, non-null pointer to `len` readable bytes, and
+ * `out_data` and `out_len` valid writable pointers for this call.
+ */
+	enum SpzResult spz_transcode_coordinates(const uint8_t *data,
+	    uintptr_t len,
+	    enum SpzCoordinateSystem from,
+	    enum SpzCoordinateSystem to,
+	    uint8_t **out_data,
+	    uintptr_t *out_len);
+
+	/**
+ * Converts an SPZ file between coordinate systems without decoding it, see
+ * `spz_transcode_coordinates`. `output` may be `input`.
+ *
+ * Returns `SpzResult_Success` on success. Call `spz_last_error()` on failure.
+ *
+ * # Safety
+ *
+ * `input` and `output` must be valid, non-null pointers to NUL-terminated
+ * strings for this call.
+ */
+	enum SpzResult spz_transcode_coordinates_file(const char *input,
+	    const char *output,
+	    enum SpzCoordinateSystem from,
+	    enum SpzCoordinateSystem to);
+
+	/**
+ * Starts recording the stages of the loads and saves made on the calling
+ * thread, dropping the ones recorded so far.
+ *
+ * Work handed to other threads, e.g. by a `SpzContext`, isn't recorded.
+ */
+	void spz_load_stats_begin(void);
+
+	/**
+ * Stops recording and writes the stages recorded on the calling thread
+ * since `spz_load_stats_begin` to `out_stats`.
+ *
+ * Returns `SpzResult_InvalidArgument` if recording wasn't started.
+ *
+ * # Safety
+ *
+ * `out_stats` must be a valid, non-null, writable pointer for this call.
+ */
+	enum SpzResult spz_load_stats_end(struct SpzLoadStats *out_stats);
+
+	/**
+ * Frees a string previously returned by `spz_gaussian_splat_pretty_fmt`,
+ * `spz_lazy_gaussian_splat_pretty_fmt` or `spz_header_pretty_fmt`.
  *
  * # Safety
  *
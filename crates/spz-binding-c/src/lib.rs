@@ -21,17 +21,28 @@
 #![deny(clippy::undocumented_unsafe_blocks)]
 #![deny(unsafe_op_in_unsafe_fn)]
 
-use std::ffi::{CStr, c_char};
+use std::ffi::{CStr, c_char, c_void};
+use std::io::Read;
 use std::ptr;
 use std::slice;
+use std::sync::{Arc, OnceLock};
 
+use spz::batch::{BatchLoader, LoadPool};
+use spz::cache::{self, CachedGaussianSplat as RustCachedGaussianSplat};
+use spz::compression::{Codec as RustCodec, CompressionLevel};
 use spz::coord::CoordinateSystem as RustCoordinateSystem;
+use spz::decoder::Decoder as RustDecoder;
 use spz::gaussian_splat::{
-	BoundingBox as RustBoundingBox, GaussianSplat as RustGaussianSplat, LoadOptions,
-	SaveOptions,
+	AttributeBuffersMut, AttributeLens, AttributeMask, BoundingBox as RustBoundingBox,
+	GaussianSplat as RustGaussianSplat, LoadOptions, SaveOptions,
 };
 use spz::header::{Header as RustHeader, Version as RustVersion};
-use spz::packed::PackedGaussianSplat;
+use spz::instrument::{self, LoadStats, Stage, StageStats};
+use spz::layout::{self, Activation, Layout};
+use spz::lazy::LazyGaussianSplat as RustLazyGaussianSplat;
+use spz::packed::{PackedGaussianSplatView, PackedGaussians, PointOrder};
+use spz::spatial::{DEFAULT_LEAF_SIZE, Frustum, SpatialIndex as RustSpatialIndex};
+use spz::transcode;
 
 // ---------------------------------------------------------------------------
 // Thread-local error handling
@@ -71,6 +82,51 @@ fn byte_slice_arg<'a>(data: *const u8, len: usize) -> std::result::Result<&'a [u
 	Ok(unsafe { slice::from_raw_parts(data, len) })
 }
 
+fn float_slice_mut_arg<'a>(
+	data: *mut f32,
+	len: usize,
+	name: &str,
+) -> std::result::Result<&'a mut [f32], String> {
+	if len == 0 {
+		return Ok(&mut []);
+	}
+	if data.is_null() {
+		return Err(format!("{name} is null"));
+	}
+
+	// SAFETY: `data` is checked for null above, and the FFI contract for callers
+	// requires that it points to `len` writable floats, not aliased by any other
+	// argument, for the duration of the call.
+	Ok(unsafe { slice::from_raw_parts_mut(data, len) })
+}
+
+fn attribute_buffers_arg<'a>(
+	out: &SpzAttributeBuffers,
+) -> std::result::Result<AttributeBuffersMut<'a>, String> {
+	Ok(AttributeBuffersMut {
+		positions: float_slice_mut_arg(out.positions, out.positions_len, "positions")?,
+		scales: float_slice_mut_arg(out.scales, out.scales_len, "scales")?,
+		rotations: float_slice_mut_arg(out.rotations, out.rotations_len, "rotations")?,
+		alphas: float_slice_mut_arg(out.alphas, out.alphas_len, "alphas")?,
+		colors: float_slice_mut_arg(out.colors, out.colors_len, "colors")?,
+		spherical_harmonics: float_slice_mut_arg(
+			out.spherical_harmonics,
+			out.spherical_harmonics_len,
+			"spherical_harmonics",
+		)?,
+	})
+}
+
+fn load_options_arg(opts: *const SpzLoadOptions) -> std::result::Result<LoadOptions, String> {
+	if opts.is_null() {
+		return Err("options pointer is null".to_string());
+	}
+
+	// SAFETY: `opts` is checked for null above, and the FFI contract for callers
+	// requires that it points to valid `SpzLoadOptions` for the duration of the call.
+	Ok(LoadOptions::from(unsafe { &*opts }))
+}
+
 fn header_ref(header: *const SpzHeader) -> Option<&'static SpzHeader> {
 	if header.is_null() {
 		return None;
@@ -101,6 +157,57 @@ fn splat_mut(splat: *mut SpzGaussianSplat) -> Option<&'static mut SpzGaussianSpl
 	Some(unsafe { &mut *splat })
 }
 
+fn context_ref(ctx: *const SpzContext) -> Option<&'static SpzContext> {
+	if ctx.is_null() {
+		return None;
+	}
+
+	// SAFETY: The public FFI API documents that non-null context handles must
+	// be live pointers previously returned by this library.
+	Some(unsafe { &*ctx })
+}
+
+fn decode_context_mut(ctx: *mut SpzDecodeContext) -> Option<&'static mut SpzDecodeContext> {
+	if ctx.is_null() {
+		return None;
+	}
+
+	// SAFETY: The public FFI API documents that non-null decode context handles
+	// must be live pointers returned by this library, used by one thread at a
+	// time.
+	Some(unsafe { &mut *ctx })
+}
+
+fn lazy_ref(splat: *const SpzLazyGaussianSplat) -> Option<&'static SpzLazyGaussianSplat> {
+	if splat.is_null() {
+		return None;
+	}
+
+	// SAFETY: The public FFI API documents that non-null lazy splat handles must
+	// be live pointers previously returned by this library.
+	Some(unsafe { &*splat })
+}
+
+fn cached_ref(splat: *const SpzCachedGaussianSplat) -> Option<&'static SpzCachedGaussianSplat> {
+	if splat.is_null() {
+		return None;
+	}
+
+	// SAFETY: The public FFI API documents that non-null cached splat handles
+	// must be live pointers previously returned by this library.
+	Some(unsafe { &*splat })
+}
+
+fn spatial_index_ref(index: *const SpzSpatialIndex) -> Option<&'static SpzSpatialIndex> {
+	if index.is_null() {
+		return None;
+	}
+
+	// SAFETY: The public FFI API documents that non-null spatial index handles
+	// must be live pointers previously returned by this library.
+	Some(unsafe { &*index })
+}
+
 fn write_out_len(out_len: *mut usize, len: usize) {
 	if out_len.is_null() {
 		return;
@@ -157,8 +264,33 @@ pub enum SpzResult {
 	NullPointer = 1,
 	/// A function argument was invalid (e.g. non-UTF-8 path).
 	InvalidArgument = 2,
-	/// An I/O or parsing error occurred.
+	/// An I/O error occurred, e.g. a file couldn't be opened or read.
 	IoError = 3,
+	/// A caller-provided output buffer is too small for the data.
+	BufferTooSmall = 4,
+	/// The data is not valid SPZ, or exceeds the limits of the load options.
+	InvalidData = 5,
+}
+
+impl SpzResult {
+	/// The status of a failed read, decode or conversion: `IoError` if
+	/// accessing a file failed, `InvalidData` if its contents did.
+	fn of_error(e: &anyhow::Error) -> Self {
+		let io = e
+			.chain()
+			.find_map(|cause| cause.downcast_ref::<std::io::Error>());
+
+		match io.map(std::io::Error::kind) {
+			// returned by the decompressors and short reads
+			None
+			| Some(
+				std::io::ErrorKind::InvalidInput
+				| std::io::ErrorKind::InvalidData
+				| std::io::ErrorKind::UnexpectedEof,
+			) => Self::InvalidData,
+			Some(_) => Self::IoError,
+		}
+	}
 }
 
 // ---------------------------------------------------------------------------
@@ -283,6 +415,199 @@ impl From<RustBoundingBox> for SpzBoundingBox {
 	}
 }
 
+impl From<SpzBoundingBox> for RustBoundingBox {
+	fn from(bbox: SpzBoundingBox) -> Self {
+		RustBoundingBox {
+			min_x: bbox.min_x,
+			max_x: bbox.max_x,
+			min_y: bbox.min_y,
+			max_y: bbox.max_y,
+			min_z: bbox.min_z,
+			max_z: bbox.max_z,
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------
+// Load options
+// ---------------------------------------------------------------------------
+
+/// Options for `spz_gaussian_splat_load_with`,
+/// `spz_gaussian_splat_load_from_bytes_with`,
+/// `spz_attribute_buffers_required_with` and `spz_decode_into_with`.
+///
+/// Get the defaults from `spz_load_options_default` and change the fields
+/// needed.
+#[repr(C)]
+#[derive(Clone, Copy, Debug)]
+pub struct SpzLoadOptions {
+	/// Coordinate system to convert the splat to.
+	pub coord_sys: SpzCoordinateSystem,
+	/// Number of threads to decode with, `0` uses all available cores.
+	pub threads: usize,
+	/// Highest degree of spherical harmonics to decode, the coefficients of
+	/// higher degrees are skipped and the splat reports the lower degree.
+	pub max_sh_degree: u8,
+	/// Combination of `SPZ_ATTRIBUTE_*` bits selecting the attributes to
+	/// decode, unknown bits are ignored. The others are neither decoded, nor
+	/// allocated, nor inflated when the data allows it, and report a length
+	/// of 0.
+	pub attributes: u32,
+	/// Most points a file may claim, larger ones fail before anything is
+	/// allocated. `SIZE_MAX` allows any.
+	pub max_points: usize,
+	/// Most bytes a file may inflate to, larger ones fail before anything is
+	/// inflated. `SIZE_MAX` allows any.
+	pub max_decompressed_len: usize,
+}
+
+impl From<&SpzLoadOptions> for LoadOptions {
+	fn from(opts: &SpzLoadOptions) -> Self {
+		LoadOptions::builder()
+			.coord_sys(opts.coord_sys.into())
+			.threads(opts.threads)
+			.max_sh_degree(opts.max_sh_degree)
+			.attributes(AttributeMask::from_bits_truncate(opts.attributes))
+			.max_points(opts.max_points)
+			.max_decompressed_len(opts.max_decompressed_len)
+			.build()
+	}
+}
+
+/// Returns the default load options: every attribute and spherical
+/// harmonics degree, decoded on the calling thread, in an unspecified
+/// coordinate system, without limits.
+#[unsafe(no_mangle)]
+pub extern "C" fn spz_load_options_default() -> SpzLoadOptions {
+	SpzLoadOptions {
+		coord_sys: SpzCoordinateSystem::Unspecified,
+		threads: 1,
+		max_sh_degree: 3,
+		attributes: SPZ_ATTRIBUTE_ALL,
+		max_points: usize::MAX,
+		max_decompressed_len: usize::MAX,
+	}
+}
+
+// ---------------------------------------------------------------------------
+// Save options
+// ---------------------------------------------------------------------------
+
+/// Compression format of saved data.
+#[repr(C)]
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum SpzCodec {
+	/// gzip, the SPZ file format (default).
+	Gzip = 0,
+	/// A zstd frame, for caches only: not readable by other SPZ readers.
+	/// Needs the library built with the `zstd` feature.
+	Zstd = 1,
+}
+
+impl From<SpzCodec> for RustCodec {
+	fn from(c: SpzCodec) -> Self {
+		match c {
+			SpzCodec::Gzip => RustCodec::Gzip,
+			SpzCodec::Zstd => RustCodec::Zstd,
+		}
+	}
+}
+
+/// Speed/ratio tradeoff of compression.
+#[repr(C)]
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum SpzCompressionPreset {
+	/// Fastest compression.
+	Fast = 0,
+	/// The codec's default tradeoff (default).
+	Default = 1,
+	/// Smallest output.
+	Best = 2,
+}
+
+/// Order to write the points in.
+#[repr(C)]
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum SpzPointOrder {
+	/// The order of the splat (default).
+	Original = 0,
+	/// Z-order along the quantized positions, smaller files.
+	Morton = 1,
+	/// Hilbert order along the quantized positions, slightly better
+	/// locality than Morton.
+	Hilbert = 2,
+}
+
+impl From<SpzPointOrder> for PointOrder {
+	fn from(order: SpzPointOrder) -> Self {
+		match order {
+			SpzPointOrder::Original => PointOrder::Original,
+			SpzPointOrder::Morton => PointOrder::Morton,
+			SpzPointOrder::Hilbert => PointOrder::Hilbert,
+		}
+	}
+}
+
+/// Options for `spz_gaussian_splat_save_with` and
+/// `spz_gaussian_splat_to_bytes_with`.
+///
+/// Get the defaults from `spz_save_options_default` and change the fields
+/// needed.
+#[repr(C)]
+#[derive(Clone, Copy, Debug)]
+pub struct SpzSaveOptions {
+	/// Source coordinate system of the splat.
+	pub coord_sys: SpzCoordinateSystem,
+	/// Compression format.
+	pub codec: SpzCodec,
+	/// Compression preset, used when `level` is negative.
+	pub preset: SpzCompressionPreset,
+	/// Codec specific compression level, clamped to the codec's range, or
+	/// negative to use `preset`.
+	pub level: i32,
+	/// Number of threads to encode with, `0` uses all available cores.
+	pub threads: usize,
+	/// Compresses into a multi-member gzip stream on `threads` threads.
+	pub parallel_compression: bool,
+	/// Order to write the points in, loading the file yields them in it.
+	pub order: SpzPointOrder,
+}
+
+impl From<&SpzSaveOptions> for SaveOptions {
+	fn from(opts: &SpzSaveOptions) -> Self {
+		let level = match (opts.level, opts.preset) {
+			(level @ 0.., _) => CompressionLevel::Level(level as u32),
+			(_, SpzCompressionPreset::Fast) => CompressionLevel::Fast,
+			(_, SpzCompressionPreset::Default) => CompressionLevel::Default,
+			(_, SpzCompressionPreset::Best) => CompressionLevel::Best,
+		};
+		SaveOptions::builder()
+			.coord_sys(opts.coord_sys.into())
+			.codec(opts.codec.into())
+			.level(level)
+			.threads(opts.threads)
+			.parallel_compression(opts.parallel_compression)
+			.order(opts.order.into())
+			.build()
+	}
+}
+
+/// Returns the default save options: gzip at the default preset, encoded on
+/// the calling thread in the original point order, from an unspecified
+/// coordinate system.
+#[unsafe(no_mangle)]
+pub extern "C" fn spz_save_options_default() -> SpzSaveOptions {
+	SpzSaveOptions {
+		coord_sys: SpzCoordinateSystem::Unspecified,
+		codec: SpzCodec::Gzip,
+		preset: SpzCompressionPreset::Default,
+		level: -1,
+		threads: 1,
+		parallel_compression: false,
+		order: SpzPointOrder::Original,
+	}
+}
+
 // ---------------------------------------------------------------------------
 // Header
 // ---------------------------------------------------------------------------
@@ -331,6 +656,9 @@ pub unsafe extern "C" fn spz_header_from_file(filepath: *const c_char) -> *mut S
 
 /// Reads a header from compressed SPZ bytes without loading the full splat data.
 ///
+/// For a chunked or a progressive file `data` must hold the whole file, which
+/// gives the total points of its chunks or the header of its finest level.
+///
 /// Returns NULL on failure. Call `spz_last_error()` for error details.
 /// The caller must free the returned handle with `spz_header_free`.
 ///
@@ -503,6 +831,31 @@ pub extern "C" fn spz_gaussian_splat_new() -> *mut SpzGaussianSplat {
 pub unsafe extern "C" fn spz_gaussian_splat_load(
 	filepath: *const c_char,
 	coord_sys: SpzCoordinateSystem,
+) -> *mut SpzGaussianSplat {
+	let opts = SpzLoadOptions {
+		coord_sys,
+		..spz_load_options_default()
+	};
+
+	// SAFETY: the caller upholds the contract of `spz_gaussian_splat_load`,
+	// which is that of `spz_gaussian_splat_load_with`, and `opts` is a local.
+	unsafe { spz_gaussian_splat_load_with(filepath, &opts) }
+}
+
+/// Loads a GaussianSplat from an SPZ file with the given options.
+///
+/// Returns NULL on failure. Call `spz_last_error()` for error details.
+/// The caller must free the returned handle with `spz_gaussian_splat_free`.
+///
+/// # Safety
+///
+/// `filepath` must be a valid, non-null pointer to a NUL-terminated string
+/// and `opts` a valid pointer to `SpzLoadOptions` for the duration of this
+/// call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_gaussian_splat_load_with(
+	filepath: *const c_char,
+	opts: *const SpzLoadOptions,
 ) -> *mut SpzGaussianSplat {
 	clear_last_error();
 
@@ -513,9 +866,12 @@ pub unsafe extern "C" fn spz_gaussian_splat_load(
 			return ptr::null_mut();
 		},
 	};
-
-	let opts = LoadOptions {
-		coord_sys: coord_sys.into(),
+	let opts = match load_options_arg(opts) {
+		Ok(opts) => opts,
+		Err(message) => {
+			set_last_error(message);
+			return ptr::null_mut();
+		},
 	};
 
 	match RustGaussianSplat::load_with(path, &opts) {
@@ -541,6 +897,33 @@ pub unsafe extern "C" fn spz_gaussian_splat_load_from_bytes(
 	data: *const u8,
 	len: usize,
 	coord_sys: SpzCoordinateSystem,
+) -> *mut SpzGaussianSplat {
+	let opts = SpzLoadOptions {
+		coord_sys,
+		..spz_load_options_default()
+	};
+
+	// SAFETY: the caller upholds the contract of
+	// `spz_gaussian_splat_load_from_bytes`, which is that of
+	// `spz_gaussian_splat_load_from_bytes_with`, and `opts` is a local.
+	unsafe { spz_gaussian_splat_load_from_bytes_with(data, len, &opts) }
+}
+
+/// Loads a GaussianSplat from a byte buffer containing SPZ data with the
+/// given options.
+///
+/// Returns NULL on failure. Call `spz_last_error()` for error details.
+/// The caller must free the returned handle with `spz_gaussian_splat_free`.
+///
+/// # Safety
+///
+/// `data` must be a valid, non-null pointer to `len` readable bytes and
+/// `opts` a valid pointer to `SpzLoadOptions` for the duration of this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_gaussian_splat_load_from_bytes_with(
+	data: *const u8,
+	len: usize,
+	opts: *const SpzLoadOptions,
 ) -> *mut SpzGaussianSplat {
 	clear_last_error();
 
@@ -551,21 +934,91 @@ pub unsafe extern "C" fn spz_gaussian_splat_load_from_bytes(
 			return ptr::null_mut();
 		},
 	};
+	let opts = match load_options_arg(opts) {
+		Ok(opts) => opts,
+		Err(message) => {
+			set_last_error(message);
+			return ptr::null_mut();
+		},
+	};
+
+	match RustGaussianSplat::read_from_bytes(bytes, &opts) {
+		Ok(gs) => Box::into_raw(Box::new(SpzGaussianSplat { inner: gs })),
+		Err(e) => {
+			set_last_error(format!("failed to load SPZ data: {e}"));
+			ptr::null_mut()
+		},
+	}
+}
+
+/// Callback that supplies compressed SPZ bytes to
+/// `spz_gaussian_splat_load_from_reader`.
+///
+/// Must write at most `len` bytes into `buf` and return the number of bytes
+/// written, `0` at the end of the stream, or a negative value on error.
+pub type SpzReadCallback =
+	Option<unsafe extern "C" fn(user_data: *mut c_void, buf: *mut u8, len: usize) -> isize>;
 
+/// Adapts a [`SpzReadCallback`] to [`std::io::Read`].
+struct CallbackReader {
+	read: unsafe extern "C" fn(user_data: *mut c_void, buf: *mut u8, len: usize) -> isize,
+	user_data: *mut c_void,
+}
+
+impl Read for CallbackReader {
+	fn read(&mut self, buf: &mut [u8]) -> std::io::Result<usize> {
+		// SAFETY: `buf` is a valid writable buffer of `buf.len()` bytes, and the
+		// FFI contract requires the callback to write at most that many bytes.
+		let n = unsafe { (self.read)(self.user_data, buf.as_mut_ptr(), buf.len()) };
+
+		if n < 0 {
+			return Err(std::io::Error::other(format!(
+				"read callback failed with {n}"
+			)));
+		}
+		Ok((n as usize).min(buf.len()))
+	}
+}
+
+/// Loads a GaussianSplat from a stream of SPZ data supplied by `read`.
+///
+/// The data is inflated and decoded while it is read: every attribute is
+/// decoded straight into its final array and only a small, fixed-size window
+/// of inflated bytes is buffered, so the whole file is never held in memory.
+/// A chunked or a progressive file is read to its end and then loaded.
+///
+/// `read` is called on the calling thread, repeatedly, until it signals the
+/// end of the stream or enough data has been read. `user_data` is passed to
+/// it unchanged.
+///
+/// Returns NULL on failure. Call `spz_last_error()` for error details.
+/// The caller must free the returned handle with `spz_gaussian_splat_free`.
+///
+/// # Safety
+///
+/// `read` must be a valid callback honoring the `SpzReadCallback` contract
+/// for `user_data` for the duration of this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_gaussian_splat_load_from_reader(
+	read: SpzReadCallback,
+	user_data: *mut c_void,
+	coord_sys: SpzCoordinateSystem,
+) -> *mut SpzGaussianSplat {
+	clear_last_error();
+
+	let Some(read) = read else {
+		set_last_error("read callback is null".to_string());
+		return ptr::null_mut();
+	};
 	let opts = LoadOptions {
 		coord_sys: coord_sys.into(),
+		..Default::default()
 	};
 
-	match PackedGaussianSplat::from_bytes(bytes) {
-		Ok(packed) => match RustGaussianSplat::new_from_packed_gaussians(&packed, &opts) {
-			Ok(gs) => Box::into_raw(Box::new(SpzGaussianSplat { inner: gs })),
-			Err(e) => {
-				set_last_error(format!("failed to unpack SPZ data: {e}"));
-				ptr::null_mut()
-			},
-		},
+	match RustGaussianSplat::read_from(CallbackReader { read, user_data }, &opts) {
+		Ok(gs) => Box::into_raw(Box::new(SpzGaussianSplat { inner: gs })),
 		Err(e) => {
-			set_last_error(format!("failed to decompress SPZ data: {e}"));
+			set_last_error(format!("failed to load SPZ stream: {e}"));
 			ptr::null_mut()
 		},
 	}
@@ -584,6 +1037,31 @@ pub unsafe extern "C" fn spz_gaussian_splat_save(
 	splat: *const SpzGaussianSplat,
 	filepath: *const c_char,
 	coord_sys: SpzCoordinateSystem,
+) -> SpzResult {
+	let opts = SpzSaveOptions {
+		coord_sys,
+		..spz_save_options_default()
+	};
+
+	// SAFETY: the caller upholds the contract of `spz_gaussian_splat_save`,
+	// which is that of `spz_gaussian_splat_save_with`, and `opts` is a local.
+	unsafe { spz_gaussian_splat_save_with(splat, filepath, &opts) }
+}
+
+/// Saves a GaussianSplat to an SPZ file with the given options.
+///
+/// Returns `SpzResult_Success` on success. Call `spz_last_error()` on failure.
+///
+/// # Safety
+///
+/// `splat` must be a valid live handle returned by this library, `filepath`
+/// must be a valid, non-null pointer to a NUL-terminated string and `opts`
+/// must be a valid pointer to `SpzSaveOptions` for this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_gaussian_splat_save_with(
+	splat: *const SpzGaussianSplat,
+	filepath: *const c_char,
+	opts: *const SpzSaveOptions,
 ) -> SpzResult {
 	clear_last_error();
 
@@ -591,6 +1069,10 @@ pub unsafe extern "C" fn spz_gaussian_splat_save(
 		set_last_error("splat handle is null".to_string());
 		return SpzResult::NullPointer;
 	};
+	if opts.is_null() {
+		set_last_error("options pointer is null".to_string());
+		return SpzResult::NullPointer;
+	}
 	let path = match cstr_arg(filepath, "filepath") {
 		Ok(path) => path,
 		Err(message) => {
@@ -598,10 +1080,9 @@ pub unsafe extern "C" fn spz_gaussian_splat_save(
 			return SpzResult::InvalidArgument;
 		},
 	};
-
-	let opts = SaveOptions {
-		coord_sys: coord_sys.into(),
-	};
+	// SAFETY: `opts` was checked for null above and the FFI contract requires
+	// it to point to valid `SpzSaveOptions` for this call.
+	let opts = SaveOptions::from(unsafe { &*opts });
 
 	match splat.inner.save(path, &opts) {
 		Ok(()) => SpzResult::Success,
@@ -627,6 +1108,35 @@ pub unsafe extern "C" fn spz_gaussian_splat_to_bytes(
 	coord_sys: SpzCoordinateSystem,
 	out_data: *mut *mut u8,
 	out_len: *mut usize,
+) -> SpzResult {
+	let opts = SpzSaveOptions {
+		coord_sys,
+		..spz_save_options_default()
+	};
+
+	// SAFETY: the caller upholds the contract of `spz_gaussian_splat_to_bytes`,
+	// which is that of `spz_gaussian_splat_to_bytes_with`, and `opts` is a
+	// local.
+	unsafe { spz_gaussian_splat_to_bytes_with(splat, &opts, out_data, out_len) }
+}
+
+/// Serializes a GaussianSplat to a heap-allocated byte buffer with the given
+/// options.
+///
+/// Returns `SpzResult_Success` on success. Call `spz_last_error()` on failure.
+/// The caller must free the returned buffer with `spz_free_bytes`.
+///
+/// # Safety
+///
+/// `splat` must be a valid live handle returned by this library. `opts` must
+/// be a valid pointer to `SpzSaveOptions`, and `out_data` and `out_len` valid
+/// writable pointers for this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_gaussian_splat_to_bytes_with(
+	splat: *const SpzGaussianSplat,
+	opts: *const SpzSaveOptions,
+	out_data: *mut *mut u8,
+	out_len: *mut usize,
 ) -> SpzResult {
 	clear_last_error();
 
@@ -634,13 +1144,13 @@ pub unsafe extern "C" fn spz_gaussian_splat_to_bytes(
 		set_last_error("null pointer argument".to_string());
 		return SpzResult::NullPointer;
 	};
-	if out_data.is_null() || out_len.is_null() {
+	if opts.is_null() || out_data.is_null() || out_len.is_null() {
 		set_last_error("null pointer argument".to_string());
 		return SpzResult::NullPointer;
 	}
-	let opts = SaveOptions {
-		coord_sys: coord_sys.into(),
-	};
+	// SAFETY: `opts` was checked for null above and the FFI contract requires
+	// it to point to valid `SpzSaveOptions` for this call.
+	let opts = SaveOptions::from(unsafe { &*opts });
 
 	match splat.inner.serialize_to_packed_bytes(&opts) {
 		Ok(bytes) => {
@@ -684,54 +1194,624 @@ pub unsafe extern "C" fn spz_gaussian_splat_free(splat: *mut SpzGaussianSplat) {
 }
 
 // ---------------------------------------------------------------------------
-// GaussianSplat — scalar accessors
+// Context — batch loading
 // ---------------------------------------------------------------------------
 
-/// Returns the number of points (gaussians) in the splat.
+/// Opaque handle to a loading context.
 ///
-/// # Safety
+/// It decodes batches of files on its worker threads and recycles the
+/// decompression buffers and inflate state across files and calls. A context can be
+/// used from several threads at once.
 ///
-/// `splat` must be null or a valid live splat handle returned by this library.
-#[unsafe(no_mangle)]
-pub unsafe extern "C" fn spz_gaussian_splat_num_points(splat: *const SpzGaussianSplat) -> i32 {
-	splat_ref(splat)
-		.map(|splat| splat.inner.header.num_points)
-		.unwrap_or(0)
+/// Must be freed with `spz_context_free`.
+pub struct SpzContext {
+	loader: Arc<BatchLoader>,
+	/// Background workers of `spz_context_load_async`, started on first use.
+	pool: OnceLock<LoadPool>,
 }
 
-/// Returns the spherical harmonics degree (0-3).
-///
-/// # Safety
+/// Creates a loading context decoding up to `threads` files at once, `0`
+/// uses all available cores.
 ///
-/// `splat` must be null or a valid live splat handle returned by this library.
+/// The caller must free the returned handle with `spz_context_free`.
 #[unsafe(no_mangle)]
-pub unsafe extern "C" fn spz_gaussian_splat_sh_degree(splat: *const SpzGaussianSplat) -> u8 {
-	splat_ref(splat)
-		.map(|splat| splat.inner.header.spherical_harmonics_degree)
-		.unwrap_or(0)
+pub extern "C" fn spz_context_new(threads: usize) -> *mut SpzContext {
+	clear_last_error();
+	Box::into_raw(Box::new(SpzContext {
+		loader: Arc::new(BatchLoader::new(threads)),
+		pool: OnceLock::new(),
+	}))
 }
 
-/// Returns the SPZ format version of the splat.
+/// Frees a context, after waiting for its pending asynchronous loads: their
+/// callbacks have all run once this returns.
 ///
 /// # Safety
 ///
-/// `splat` must be null or a valid live splat handle returned by this library.
+/// `ctx` must be null or a pointer previously returned by this library and
+/// not already freed. No batch may be running on it and it must not be
+/// freed from one of its load callbacks.
 #[unsafe(no_mangle)]
-pub unsafe extern "C" fn spz_gaussian_splat_version(splat: *const SpzGaussianSplat) -> SpzVersion {
-	splat_ref(splat)
-		.map(|splat| splat.inner.header.version.into())
-		.unwrap_or(SpzVersion::V3)
+pub unsafe extern "C" fn spz_context_free(ctx: *mut SpzContext) {
+	free_box_handle(ctx);
 }
 
-/// Returns the number of fractional bits used in position encoding.
+/// Loads a GaussianSplat from an SPZ file on the calling thread, with a
+/// recycled decoder of `ctx`.
 ///
-/// Standard value is 12, giving ~0.25 mm resolution.
+/// Returns NULL on failure. Call `spz_last_error()` for error details.
+/// The caller must free the returned handle with `spz_gaussian_splat_free`.
 ///
 /// # Safety
 ///
-/// `splat` must be null or a valid live splat handle returned by this library.
+/// `ctx` must be a valid live context handle returned by this library.
+/// `filepath` must be a valid, non-null pointer to a NUL-terminated string
+/// for the duration of this call.
 #[unsafe(no_mangle)]
-pub unsafe extern "C" fn spz_gaussian_splat_fractional_bits(splat: *const SpzGaussianSplat) -> u8 {
+pub unsafe extern "C" fn spz_context_load(
+	ctx: *const SpzContext,
+	filepath: *const c_char,
+	coord_sys: SpzCoordinateSystem,
+) -> *mut SpzGaussianSplat {
+	clear_last_error();
+
+	let Some(ctx) = context_ref(ctx) else {
+		set_last_error("ctx is null".to_string());
+		return ptr::null_mut();
+	};
+	let path = match cstr_arg(filepath, "filepath") {
+		Ok(path) => path,
+		Err(message) => {
+			set_last_error(message);
+			return ptr::null_mut();
+		},
+	};
+
+	let opts = LoadOptions {
+		coord_sys: coord_sys.into(),
+		..Default::default()
+	};
+
+	match ctx.loader.load_one(path, &opts) {
+		Ok(gs) => Box::into_raw(Box::new(SpzGaussianSplat { inner: gs })),
+		Err(e) => {
+			set_last_error(format!("failed to load SPZ file: {e}"));
+			ptr::null_mut()
+		},
+	}
+}
+
+/// Callback receiving the outcome of `spz_context_load_async`.
+///
+/// Called exactly once per accepted load, on a worker thread of the context.
+/// On success `result` is `SpzResult_Success` and `splat` a handle the
+/// callback takes ownership of, to free with `spz_gaussian_splat_free`. On
+/// failure `splat` is NULL and `error` a message valid only during the call.
+pub type SpzLoadCallback = Option<
+	unsafe extern "C" fn(
+		user_data: *mut c_void,
+		result: SpzResult,
+		splat: *mut SpzGaussianSplat,
+		error: *const c_char,
+	),
+>;
+
+/// A load callback and its user data, moved to the worker that completes the
+/// load.
+struct LoadCompletion {
+	callback: unsafe extern "C" fn(
+		user_data: *mut c_void,
+		result: SpzResult,
+		splat: *mut SpzGaussianSplat,
+		error: *const c_char,
+	),
+	user_data: *mut c_void,
+}
+
+// SAFETY: The FFI contract of `spz_context_load_async` requires `user_data` to
+// be usable from the context's worker threads, the library never reads it.
+unsafe impl Send for LoadCompletion {}
+
+impl LoadCompletion {
+	fn complete(self, result: anyhow::Result<RustGaussianSplat>) {
+		match result {
+			Ok(gs) => {
+				let splat = Box::into_raw(Box::new(SpzGaussianSplat { inner: gs }));
+
+				// SAFETY: The FFI contract requires `callback` to be a valid
+				// function for `user_data`, it takes ownership of `splat`.
+				unsafe {
+					(self.callback)(
+						self.user_data,
+						SpzResult::Success,
+						splat,
+						ptr::null(),
+					)
+				};
+			},
+			Err(e) => {
+				let result = SpzResult::of_error(&e);
+				let message = std::ffi::CString::new(format!(
+					"failed to load SPZ file: {e}"
+				))
+				.unwrap_or_default();
+
+				// SAFETY: The FFI contract requires `callback` to be a valid
+				// function for `user_data`, `message` outlives the call.
+				unsafe {
+					(self.callback)(
+						self.user_data,
+						result,
+						ptr::null_mut(),
+						message.as_ptr(),
+					)
+				};
+			},
+		}
+	}
+}
+
+/// Queues a load of an SPZ file on the worker threads of `ctx` and returns
+/// immediately.
+///
+/// Reading and decoding run on a fixed set of background workers, one per
+/// context thread, so any number of loads can be in flight without
+/// oversubscribing the cores. `callback` reports the outcome, see
+/// `SpzLoadCallback`.
+///
+/// Returns `SpzResult_Success` if the load was queued, in which case
+/// `callback` will be called exactly once. Otherwise it is never called, call
+/// `spz_last_error()` for error details.
+///
+/// # Safety
+///
+/// `ctx` must be a valid live context handle returned by this library.
+/// `filepath` must be a valid, non-null pointer to a NUL-terminated string
+/// for the duration of this call. `callback` must be safe to call with
+/// `user_data` from another thread until it has been called.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_context_load_async(
+	ctx: *const SpzContext,
+	filepath: *const c_char,
+	coord_sys: SpzCoordinateSystem,
+	callback: SpzLoadCallback,
+	user_data: *mut c_void,
+) -> SpzResult {
+	clear_last_error();
+
+	let Some(ctx) = context_ref(ctx) else {
+		set_last_error("ctx is null".to_string());
+		return SpzResult::NullPointer;
+	};
+	let Some(callback) = callback else {
+		set_last_error("callback is null".to_string());
+		return SpzResult::NullPointer;
+	};
+	let path = match cstr_arg(filepath, "filepath") {
+		Ok(path) => path,
+		Err(message) => {
+			set_last_error(message);
+			return SpzResult::InvalidArgument;
+		},
+	};
+	let pool = match ctx.pool.get() {
+		Some(pool) => pool,
+		None => match LoadPool::with_loader(Arc::clone(&ctx.loader)) {
+			// a racing call may have started the pool first, then ours is
+			// dropped unused
+			Ok(pool) => ctx.pool.get_or_init(|| pool),
+			Err(e) => {
+				set_last_error(format!("failed to start load workers: {e}"));
+				return SpzResult::IoError;
+			},
+		},
+	};
+	let opts = LoadOptions {
+		coord_sys: coord_sys.into(),
+		..Default::default()
+	};
+	let completion = LoadCompletion {
+		callback,
+		user_data,
+	};
+
+	match pool.submit(path, opts, move |result| completion.complete(result)) {
+		Ok(()) => SpzResult::Success,
+		Err(e) => {
+			set_last_error(format!("failed to queue load: {e}"));
+			SpzResult::IoError
+		},
+	}
+}
+
+/// Loads `n` SPZ files concurrently on the worker threads of `ctx`.
+///
+/// `out_splats[i]` receives the splat loaded from `paths[i]`, or NULL if that
+/// file failed. If `out_results` is non-null, `out_results[i]` receives the
+/// status of `paths[i]`. A null `ctx` loads with a temporary context using
+/// all available cores.
+///
+/// Returns `SpzResult_Success` if every file loaded, otherwise the status of
+/// the first failed file, whose message is available from `spz_last_error()`.
+/// The caller must free every non-null splat with `spz_gaussian_splat_free`.
+///
+/// # Safety
+///
+/// `ctx` must be null or a valid live context handle returned by this library.
+/// `paths` must point to `n` pointers, each null or a NUL-terminated string
+/// valid for the duration of this call. `out_splats` must point to `n`
+/// writable handles, and `out_results`, if non-null, to `n` writable results.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_gaussian_splat_load_batch(
+	ctx: *const SpzContext,
+	paths: *const *const c_char,
+	n: usize,
+	coord_sys: SpzCoordinateSystem,
+	out_splats: *mut *mut SpzGaussianSplat,
+	out_results: *mut SpzResult,
+) -> SpzResult {
+	clear_last_error();
+
+	if n == 0 {
+		return SpzResult::Success;
+	}
+	if paths.is_null() || out_splats.is_null() {
+		set_last_error("paths or out_splats is null".to_string());
+		return SpzResult::NullPointer;
+	}
+
+	// SAFETY: `paths` was checked for null above and the FFI contract
+	// requires it to point to `n` readable pointers for this call.
+	let paths = unsafe { slice::from_raw_parts(paths, n) };
+	// SAFETY: `out_splats` was checked for null above and the FFI contract
+	// requires it to point to `n` writable handles, not aliased by `paths`.
+	let out_splats = unsafe { slice::from_raw_parts_mut(out_splats, n) };
+	let mut out_results = if out_results.is_null() {
+		None
+	} else {
+		// SAFETY: `out_results` is non-null and the FFI contract requires it
+		// to point to `n` writable results, not aliased by the other arguments.
+		Some(unsafe { slice::from_raw_parts_mut(out_results, n) })
+	};
+
+	let temporary;
+	let loader = match context_ref(ctx) {
+		Some(ctx) => ctx.loader.as_ref(),
+		None => {
+			temporary = BatchLoader::new(0);
+			&temporary
+		},
+	};
+	let args: Vec<_> = paths
+		.iter()
+		.enumerate()
+		.map(|(i, &path)| cstr_arg(path, &format!("paths[{i}]")))
+		.collect();
+	let valid: Vec<&str> = args
+		.iter()
+		.filter_map(|arg| arg.as_ref().ok().copied())
+		.collect();
+
+	let opts = LoadOptions {
+		coord_sys: coord_sys.into(),
+		..Default::default()
+	};
+	let mut loaded = loader.load(&valid, &opts).into_iter();
+	let mut first_failure = None;
+
+	for (i, arg) in args.into_iter().enumerate() {
+		let (splat, result, message) = match arg {
+			Err(message) => (ptr::null_mut(), SpzResult::InvalidArgument, message),
+			Ok(path) => match loaded.next() {
+				Some(Ok(gs)) => (
+					Box::into_raw(Box::new(SpzGaussianSplat { inner: gs })),
+					SpzResult::Success,
+					String::new(),
+				),
+				Some(Err(e)) => (
+					ptr::null_mut(),
+					SpzResult::of_error(&e),
+					format!("failed to load SPZ file: {e}"),
+				),
+				None => (
+					ptr::null_mut(),
+					SpzResult::IoError,
+					format!("failed to load SPZ file {path}"),
+				),
+			},
+		};
+		out_splats[i] = splat;
+
+		if let Some(out_results) = out_results.as_deref_mut() {
+			out_results[i] = result;
+		}
+		if result != SpzResult::Success && first_failure.is_none() {
+			first_failure = Some((result, message));
+		}
+	}
+	match first_failure {
+		Some((result, message)) => {
+			set_last_error(message);
+			result
+		},
+		None => SpzResult::Success,
+	}
+}
+
+// ---------------------------------------------------------------------------
+// GaussianSplat — decoding into caller-provided buffers
+// ---------------------------------------------------------------------------
+
+/// Caller-owned output buffers for `spz_decode_into`.
+///
+/// Each array has the same layout as the matching `spz_gaussian_splat_*`
+/// accessor, and each `*_len` field is the capacity of its array in floats.
+/// An array may be NULL only if its capacity is 0 and no data is expected
+/// for it (e.g. `spherical_harmonics` for SH degree 0).
+///
+/// Use `spz_attribute_buffers_required` to get the capacities needed.
+#[repr(C)]
+#[derive(Clone, Copy, Debug)]
+pub struct SpzAttributeBuffers {
+	pub positions: *mut f32,
+	pub positions_len: usize,
+	pub scales: *mut f32,
+	pub scales_len: usize,
+	pub rotations: *mut f32,
+	pub rotations_len: usize,
+	pub alphas: *mut f32,
+	pub alphas_len: usize,
+	pub colors: *mut f32,
+	pub colors_len: usize,
+	pub spherical_harmonics: *mut f32,
+	pub spherical_harmonics_len: usize,
+}
+
+/// Writes the number of floats each attribute described by `header` needs
+/// into the `*_len` fields of `out`. The array pointers are left untouched.
+///
+/// Pair with `spz_header_from_bytes` to size the buffers for
+/// `spz_decode_into` without decoding the data.
+///
+/// # Safety
+///
+/// `header` must be null or a valid live header handle returned by this
+/// library, and `out` must be null or a valid writable pointer for this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_attribute_buffers_required(
+	header: *const SpzHeader,
+	out: *mut SpzAttributeBuffers,
+) -> SpzResult {
+	let opts = spz_load_options_default();
+
+	// SAFETY: the caller upholds the contract of
+	// `spz_attribute_buffers_required`, which is that of
+	// `spz_attribute_buffers_required_with`, and `opts` is a local.
+	unsafe { spz_attribute_buffers_required_with(header, &opts, out) }
+}
+
+/// Like `spz_attribute_buffers_required`, for the data decoded with `opts`:
+/// the attributes it leaves out need 0 floats and the spherical harmonics
+/// are cut to its `max_sh_degree`.
+///
+/// # Safety
+///
+/// `header` must be null or a valid live header handle returned by this
+/// library, `opts` null or a valid pointer to `SpzLoadOptions`, and `out`
+/// null or a valid writable pointer for this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_attribute_buffers_required_with(
+	header: *const SpzHeader,
+	opts: *const SpzLoadOptions,
+	out: *mut SpzAttributeBuffers,
+) -> SpzResult {
+	clear_last_error();
+
+	let Some(header) = header_ref(header) else {
+		set_last_error("header handle is null".to_string());
+		return SpzResult::NullPointer;
+	};
+	let opts = match load_options_arg(opts) {
+		Ok(opts) => opts,
+		Err(message) => {
+			set_last_error(message);
+			return SpzResult::NullPointer;
+		},
+	};
+	if out.is_null() {
+		set_last_error("out is null".to_string());
+		return SpzResult::NullPointer;
+	}
+	let lens = AttributeLens::decoded(&header.inner, &opts);
+
+	// SAFETY: `out` was checked for null above and the FFI contract requires
+	// it to be a valid writable pointer for this call.
+	let out = unsafe { &mut *out };
+
+	out.positions_len = lens.positions;
+	out.scales_len = lens.scales;
+	out.rotations_len = lens.rotations;
+	out.alphas_len = lens.alphas;
+	out.colors_len = lens.colors;
+	out.spherical_harmonics_len = lens.spherical_harmonics;
+
+	SpzResult::Success
+}
+
+/// Decodes SPZ data straight into caller-owned float arrays.
+///
+/// No splat handle is created and no float arrays are allocated by the
+/// library; the decoded attributes are written to the arrays in `out`,
+/// converted to `coord_sys`. Arrays larger than needed are only partially
+/// written.
+///
+/// Returns `SpzResult_BufferTooSmall` if any array is smaller than required,
+/// see `spz_attribute_buffers_required`. Call `spz_last_error()` on failure.
+///
+/// # Safety
+///
+/// `data` must be a valid, non-null pointer to `len` readable bytes for the
+/// duration of this call. `out` must be a valid pointer whose arrays are
+/// writable for their `*_len` floats and do not overlap each other or `data`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_decode_into(
+	data: *const u8,
+	len: usize,
+	coord_sys: SpzCoordinateSystem,
+	out: *const SpzAttributeBuffers,
+) -> SpzResult {
+	let opts = SpzLoadOptions {
+		coord_sys,
+		..spz_load_options_default()
+	};
+
+	// SAFETY: the caller upholds the contract of `spz_decode_into`, which is
+	// that of `spz_decode_into_with`, and `opts` is a local.
+	unsafe { spz_decode_into_with(data, len, &opts, out) }
+}
+
+/// Like `spz_decode_into`, decoding with `opts`.
+///
+/// Only the attributes selected by `opts` are written, size the arrays with
+/// `spz_attribute_buffers_required_with`. The sections of the data after
+/// the last selected attribute are not inflated when the data allows it.
+///
+/// # Safety
+///
+/// `data` must be a valid, non-null pointer to `len` readable bytes and
+/// `opts` a valid pointer to `SpzLoadOptions` for the duration of this call.
+/// `out` must be a valid pointer whose arrays are writable for their
+/// `*_len` floats and do not overlap each other or `data`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_decode_into_with(
+	data: *const u8,
+	len: usize,
+	opts: *const SpzLoadOptions,
+	out: *const SpzAttributeBuffers,
+) -> SpzResult {
+	clear_last_error();
+
+	let bytes = match byte_slice_arg(data, len) {
+		Ok(bytes) => bytes,
+		Err(message) => {
+			set_last_error(message);
+			return SpzResult::NullPointer;
+		},
+	};
+	let opts = match load_options_arg(opts) {
+		Ok(opts) => opts,
+		Err(message) => {
+			set_last_error(message);
+			return SpzResult::NullPointer;
+		},
+	};
+	if out.is_null() {
+		set_last_error("out is null".to_string());
+		return SpzResult::NullPointer;
+	}
+
+	// SAFETY: `out` was checked for null above and the FFI contract requires
+	// it to be a valid readable pointer for this call.
+	let out = unsafe { *out };
+
+	let buffers = match attribute_buffers_arg(&out) {
+		Ok(buffers) => buffers,
+		Err(message) => {
+			set_last_error(message);
+			return SpzResult::NullPointer;
+		},
+	};
+	let mut decoder = RustDecoder::new();
+	let packed = match decoder.decompress_with(bytes, &opts) {
+		Ok(packed) => packed,
+		Err(e) => {
+			set_last_error(format!("failed to decompress SPZ data: {e}"));
+			return SpzResult::of_error(&e);
+		},
+	};
+
+	decode_view_into(&packed, &opts, &out, buffers)
+}
+
+/// Checks the capacities of `out` and decodes `packed` into `buffers`, the
+/// slices of `out`.
+fn decode_view_into(
+	packed: &PackedGaussianSplatView<'_>,
+	opts: &LoadOptions,
+	out: &SpzAttributeBuffers,
+	buffers: AttributeBuffersMut<'_>,
+) -> SpzResult {
+	let required = AttributeLens::decoded(&packed.to_header(), opts);
+
+	if out.positions_len < required.positions
+		|| out.scales_len < required.scales
+		|| out.rotations_len < required.rotations
+		|| out.alphas_len < required.alphas
+		|| out.colors_len < required.colors
+		|| out.spherical_harmonics_len < required.spherical_harmonics
+	{
+		set_last_error(format!("output buffers too small, required: {required:?}"));
+		return SpzResult::BufferTooSmall;
+	}
+
+	match RustGaussianSplat::decode_into(packed, opts, buffers) {
+		Ok(_) => SpzResult::Success,
+		Err(e) => {
+			set_last_error(format!("failed to unpack SPZ data: {e}"));
+			SpzResult::of_error(&e)
+		},
+	}
+}
+
+// ---------------------------------------------------------------------------
+// GaussianSplat — scalar accessors
+// ---------------------------------------------------------------------------
+
+/// Returns the number of points (gaussians) in the splat.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live splat handle returned by this library.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_gaussian_splat_num_points(splat: *const SpzGaussianSplat) -> i32 {
+	splat_ref(splat)
+		.map(|splat| splat.inner.header.num_points)
+		.unwrap_or(0)
+}
+
+/// Returns the spherical harmonics degree (0-3).
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live splat handle returned by this library.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_gaussian_splat_sh_degree(splat: *const SpzGaussianSplat) -> u8 {
+	splat_ref(splat)
+		.map(|splat| splat.inner.header.spherical_harmonics_degree)
+		.unwrap_or(0)
+}
+
+/// Returns the SPZ format version of the splat.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live splat handle returned by this library.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_gaussian_splat_version(splat: *const SpzGaussianSplat) -> SpzVersion {
+	splat_ref(splat)
+		.map(|splat| splat.inner.header.version.into())
+		.unwrap_or(SpzVersion::V3)
+}
+
+/// Returns the number of fractional bits used in position encoding.
+///
+/// Standard value is 12, giving ~0.25 mm resolution.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live splat handle returned by this library.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_gaussian_splat_fractional_bits(splat: *const SpzGaussianSplat) -> u8 {
 	splat_ref(splat)
 		.map(|splat| splat.inner.header.fractional_bits)
 		.unwrap_or(0)
@@ -991,12 +2071,1518 @@ pub unsafe extern "C" fn spz_gaussian_splat_pretty_fmt(
 	}
 }
 
+// ---------------------------------------------------------------------------
+// Lazy GaussianSplat
+// ---------------------------------------------------------------------------
+
+/// Attribute mask bit selecting the positions.
+pub const SPZ_ATTRIBUTE_POSITIONS: u32 = 1 << 0;
+/// Attribute mask bit selecting the scales.
+pub const SPZ_ATTRIBUTE_SCALES: u32 = 1 << 1;
+/// Attribute mask bit selecting the rotations.
+pub const SPZ_ATTRIBUTE_ROTATIONS: u32 = 1 << 2;
+/// Attribute mask bit selecting the alphas.
+pub const SPZ_ATTRIBUTE_ALPHAS: u32 = 1 << 3;
+/// Attribute mask bit selecting the colors.
+pub const SPZ_ATTRIBUTE_COLORS: u32 = 1 << 4;
+/// Attribute mask bit selecting the spherical harmonics.
+pub const SPZ_ATTRIBUTE_SPHERICAL_HARMONICS: u32 = 1 << 5;
+/// Attribute mask selecting every attribute.
+pub const SPZ_ATTRIBUTE_ALL: u32 = (1 << 6) - 1;
+
+/// Opaque handle to a splat that decodes each attribute the first time its
+/// accessor is called.
+///
+/// It keeps the decompressed, packed data alive. Attributes outside of the
+/// load mask are never decoded and report a length of 0.
+///
+/// Must be freed with `spz_lazy_gaussian_splat_free`.
+pub struct SpzLazyGaussianSplat {
+	inner: RustLazyGaussianSplat,
+}
+
+/// Loads a lazy GaussianSplat from an SPZ file, decompressing it without
+/// decoding any attribute.
+///
+/// `mask` is a combination of `SPZ_ATTRIBUTE_*` bits, unknown bits are ignored.
+///
+/// Returns NULL on failure. Call `spz_last_error()` for error details.
+/// The caller must free the returned handle with `spz_lazy_gaussian_splat_free`.
+///
+/// # Safety
+///
+/// `filepath` must be a valid, non-null pointer to a NUL-terminated string
+/// for the duration of this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_lazy_gaussian_splat_load(
+	filepath: *const c_char,
+	coord_sys: SpzCoordinateSystem,
+	mask: u32,
+) -> *mut SpzLazyGaussianSplat {
+	clear_last_error();
+
+	let path = match cstr_arg(filepath, "filepath") {
+		Ok(path) => path,
+		Err(message) => {
+			set_last_error(message);
+			return ptr::null_mut();
+		},
+	};
+
+	let opts = LoadOptions {
+		coord_sys: coord_sys.into(),
+		..Default::default()
+	};
+
+	match RustLazyGaussianSplat::load(path, &opts, AttributeMask::from_bits_truncate(mask)) {
+		Ok(inner) => Box::into_raw(Box::new(SpzLazyGaussianSplat { inner })),
+		Err(e) => {
+			set_last_error(format!("failed to load SPZ file: {e}"));
+			ptr::null_mut()
+		},
+	}
+}
+
+/// Loads a lazy GaussianSplat from a byte buffer containing SPZ data.
+///
+/// The bytes are decompressed into the handle, `data` can be released once
+/// this returns.
+///
+/// Returns NULL on failure. Call `spz_last_error()` for error details.
+/// The caller must free the returned handle with `spz_lazy_gaussian_splat_free`.
+///
+/// # Safety
+///
+/// `data` must be a valid, non-null pointer to `len` readable bytes for the
+/// duration of this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_lazy_gaussian_splat_load_from_bytes(
+	data: *const u8,
+	len: usize,
+	coord_sys: SpzCoordinateSystem,
+	mask: u32,
+) -> *mut SpzLazyGaussianSplat {
+	clear_last_error();
+
+	let bytes = match byte_slice_arg(data, len) {
+		Ok(bytes) => bytes,
+		Err(message) => {
+			set_last_error(message);
+			return ptr::null_mut();
+		},
+	};
+
+	let opts = LoadOptions {
+		coord_sys: coord_sys.into(),
+		..Default::default()
+	};
+
+	match RustLazyGaussianSplat::from_bytes(
+		bytes,
+		&opts,
+		AttributeMask::from_bits_truncate(mask),
+	) {
+		Ok(inner) => Box::into_raw(Box::new(SpzLazyGaussianSplat { inner })),
+		Err(e) => {
+			set_last_error(format!("failed to load SPZ data: {e}"));
+			ptr::null_mut()
+		},
+	}
+}
+
+/// # Safety
+///
+/// `splat` must be null or a pointer previously returned by this library and
+/// not already freed.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_lazy_gaussian_splat_free(splat: *mut SpzLazyGaussianSplat) {
+	free_box_handle(splat);
+}
+
+/// Returns the number of points, or 0 if the handle is null.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live lazy splat handle returned by this library.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_lazy_gaussian_splat_num_points(
+	splat: *const SpzLazyGaussianSplat,
+) -> i32 {
+	lazy_ref(splat)
+		.map(|splat| splat.inner.header().num_points)
+		.unwrap_or(0)
+}
+
+/// Returns the spherical harmonics degree, or 0 if the handle is null.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live lazy splat handle returned by this library.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_lazy_gaussian_splat_sh_degree(
+	splat: *const SpzLazyGaussianSplat,
+) -> u8 {
+	lazy_ref(splat)
+		.map(|splat| splat.inner.header().spherical_harmonics_degree)
+		.unwrap_or(0)
+}
+
+/// Returns the attribute mask the splat was loaded with, or 0 if the handle
+/// is null.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live lazy splat handle returned by this library.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_lazy_gaussian_splat_mask(splat: *const SpzLazyGaussianSplat) -> u32 {
+	lazy_ref(splat)
+		.map(|splat| splat.inner.mask().bits())
+		.unwrap_or(0)
+}
+
+/// Returns the bounding box of the positions, read from the quantized data
+/// without decoding them, also when they are masked out.
+///
+/// Returns a zeroed bounding box if the handle is null.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live lazy splat handle returned by this library.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_lazy_gaussian_splat_bbox(
+	splat: *const SpzLazyGaussianSplat,
+) -> SpzBoundingBox {
+	let Some(splat) = lazy_ref(splat) else {
+		return SpzBoundingBox {
+			min_x: 0.0,
+			max_x: 0.0,
+			min_y: 0.0,
+			max_y: 0.0,
+			min_z: 0.0,
+			max_z: 0.0,
+		};
+	};
+	splat.inner.bbox().into()
+}
+
+/// Returns the median ellipsoid volume of the gaussians, read from the
+/// quantized scales without decoding them.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live lazy splat handle returned by this library.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_lazy_gaussian_splat_median_volume(
+	splat: *const SpzLazyGaussianSplat,
+) -> f32 {
+	lazy_ref(splat)
+		.map(|splat| splat.inner.statistics().median_volume)
+		.unwrap_or(0.0)
+}
+
+/// Returns a heap-allocated summary like `spz_gaussian_splat_pretty_fmt`,
+/// without decoding any attribute.
+///
+/// The caller must free the returned string with `spz_free_string`.
+/// Returns NULL if the handle is null.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live lazy splat handle returned by this library.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_lazy_gaussian_splat_pretty_fmt(
+	splat: *const SpzLazyGaussianSplat,
+) -> *mut c_char {
+	let Some(splat) = lazy_ref(splat) else {
+		return ptr::null_mut();
+	};
+	match std::ffi::CString::new(splat.inner.pretty_fmt()) {
+		Ok(cs) => cs.into_raw(),
+		Err(_) => ptr::null_mut(),
+	}
+}
+
+fn lazy_attribute(
+	splat: *const SpzLazyGaussianSplat,
+	out_len: *mut usize,
+	attribute: fn(&RustLazyGaussianSplat) -> &[f32],
+) -> *const f32 {
+	let Some(splat) = lazy_ref(splat) else {
+		write_out_len(out_len, 0);
+		return ptr::null();
+	};
+	let values = attribute(&splat.inner);
+
+	write_out_len(out_len, values.len());
+	values.as_ptr()
+}
+
+/// Returns a pointer to the positions array, decoding it on the first call.
+///
+/// The layout matches `spz_gaussian_splat_positions`. The pointer is valid
+/// until the lazy splat is freed.
+///
+/// If `out_len` is non-null it receives the total number of floats.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live lazy splat handle returned by this library.
+/// If `out_len` is non-null it must be a valid writable pointer for this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_lazy_gaussian_splat_positions(
+	splat: *const SpzLazyGaussianSplat,
+	out_len: *mut usize,
+) -> *const f32 {
+	lazy_attribute(splat, out_len, RustLazyGaussianSplat::positions)
+}
+
+/// Returns a pointer to the scales array, decoding it on the first call.
+///
+/// The layout matches `spz_gaussian_splat_scales`. The pointer is valid until
+/// the lazy splat is freed.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live lazy splat handle returned by this library.
+/// If `out_len` is non-null it must be a valid writable pointer for this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_lazy_gaussian_splat_scales(
+	splat: *const SpzLazyGaussianSplat,
+	out_len: *mut usize,
+) -> *const f32 {
+	lazy_attribute(splat, out_len, RustLazyGaussianSplat::scales)
+}
+
+/// Returns a pointer to the rotations array, decoding it on the first call.
+///
+/// The layout matches `spz_gaussian_splat_rotations`. The pointer is valid
+/// until the lazy splat is freed.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live lazy splat handle returned by this library.
+/// If `out_len` is non-null it must be a valid writable pointer for this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_lazy_gaussian_splat_rotations(
+	splat: *const SpzLazyGaussianSplat,
+	out_len: *mut usize,
+) -> *const f32 {
+	lazy_attribute(splat, out_len, RustLazyGaussianSplat::rotations)
+}
+
+/// Returns a pointer to the alphas array, decoding it on the first call.
+///
+/// The layout matches `spz_gaussian_splat_alphas`. The pointer is valid until
+/// the lazy splat is freed.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live lazy splat handle returned by this library.
+/// If `out_len` is non-null it must be a valid writable pointer for this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_lazy_gaussian_splat_alphas(
+	splat: *const SpzLazyGaussianSplat,
+	out_len: *mut usize,
+) -> *const f32 {
+	lazy_attribute(splat, out_len, RustLazyGaussianSplat::alphas)
+}
+
+/// Returns a pointer to the colors array, decoding it on the first call.
+///
+/// The layout matches `spz_gaussian_splat_colors`. The pointer is valid until
+/// the lazy splat is freed.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live lazy splat handle returned by this library.
+/// If `out_len` is non-null it must be a valid writable pointer for this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_lazy_gaussian_splat_colors(
+	splat: *const SpzLazyGaussianSplat,
+	out_len: *mut usize,
+) -> *const f32 {
+	lazy_attribute(splat, out_len, RustLazyGaussianSplat::colors)
+}
+
+/// Returns a pointer to the spherical harmonics array, decoding it on the
+/// first call.
+///
+/// The layout matches `spz_gaussian_splat_spherical_harmonics`. The pointer
+/// is valid until the lazy splat is freed. Loading without
+/// `SPZ_ATTRIBUTE_SPHERICAL_HARMONICS` skips them entirely.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live lazy splat handle returned by this library.
+/// If `out_len` is non-null it must be a valid writable pointer for this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_lazy_gaussian_splat_spherical_harmonics(
+	splat: *const SpzLazyGaussianSplat,
+	out_len: *mut usize,
+) -> *const f32 {
+	lazy_attribute(splat, out_len, RustLazyGaussianSplat::spherical_harmonics)
+}
+
+/// Decodes the remaining attributes into a new, independent GaussianSplat.
+///
+/// Attributes outside of the load mask are left empty.
+///
+/// Returns NULL if the handle is null.
+/// The caller must free the returned handle with `spz_gaussian_splat_free`.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live lazy splat handle returned by this library.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_lazy_gaussian_splat_to_splat(
+	splat: *const SpzLazyGaussianSplat,
+) -> *mut SpzGaussianSplat {
+	let Some(splat) = lazy_ref(splat) else {
+		return ptr::null_mut();
+	};
+	Box::into_raw(Box::new(SpzGaussianSplat {
+		inner: splat.inner.to_gaussian_splat(),
+	}))
+}
+
+// ---------------------------------------------------------------------------
+// Cached GaussianSplat — memory-mapped, decoded cache files
+// ---------------------------------------------------------------------------
+
+/// Opaque handle to a memory-mapped cache file, see `spz_cache_build`.
+///
+/// The attribute arrays point into the mapping, opening a cache decodes
+/// nothing. The file must not be modified while the handle is alive.
+///
+/// Must be freed with `spz_cached_gaussian_splat_free`.
+pub struct SpzCachedGaussianSplat {
+	inner: RustCachedGaussianSplat,
+}
+
+/// Loads an SPZ file and writes its decoded attributes to a cache file, in
+/// `coord_sys`.
+///
+/// If `output` is NULL the cache is written next to `source`, at
+/// `<source>.cache`, where `spz_cached_gaussian_splat_open_for` looks for it.
+///
+/// Returns `SpzResult_Success` on success. Call `spz_last_error()` on failure.
+///
+/// # Safety
+///
+/// `source` must be a valid, non-null pointer to a NUL-terminated string for
+/// this call. `output` must be null or such a pointer.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_cache_build(
+	source: *const c_char,
+	output: *const c_char,
+	coord_sys: SpzCoordinateSystem,
+) -> SpzResult {
+	clear_last_error();
+
+	let source = match cstr_arg(source, "source") {
+		Ok(source) => source,
+		Err(message) => {
+			set_last_error(message);
+			return SpzResult::InvalidArgument;
+		},
+	};
+	let output = if output.is_null() {
+		cache::cache_path(source)
+	} else {
+		match cstr_arg(output, "output") {
+			Ok(output) => output.into(),
+			Err(message) => {
+				set_last_error(message);
+				return SpzResult::InvalidArgument;
+			},
+		}
+	};
+	let opts = LoadOptions {
+		coord_sys: coord_sys.into(),
+		..Default::default()
+	};
+
+	match cache::build(source, output, &opts) {
+		Ok(()) => SpzResult::Success,
+		Err(e) => {
+			set_last_error(format!("failed to build cache file: {e}"));
+			SpzResult::of_error(&e)
+		},
+	}
+}
+
+/// Maps a cache file into memory, checking its header and section sizes.
+///
+/// Returns NULL on failure. Call `spz_last_error()` for error details.
+/// The caller must free the returned handle with `spz_cached_gaussian_splat_free`.
+///
+/// # Safety
+///
+/// `filepath` must be a valid, non-null pointer to a NUL-terminated string
+/// for the duration of this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_cached_gaussian_splat_open(
+	filepath: *const c_char,
+) -> *mut SpzCachedGaussianSplat {
+	clear_last_error();
+
+	let path = match cstr_arg(filepath, "filepath") {
+		Ok(path) => path,
+		Err(message) => {
+			set_last_error(message);
+			return ptr::null_mut();
+		},
+	};
+
+	match RustCachedGaussianSplat::open(path) {
+		Ok(inner) => Box::into_raw(Box::new(SpzCachedGaussianSplat { inner })),
+		Err(e) => {
+			set_last_error(format!("failed to open cache file: {e}"));
+			ptr::null_mut()
+		},
+	}
+}
+
+/// Maps the cache file of the SPZ file `source` into memory, if it exists
+/// and was built from the file as it is now.
+///
+/// Returns NULL with an empty `spz_last_error()` if there is no such cache,
+/// e.g. to fall back to `spz_gaussian_splat_load`, and NULL with an error
+/// message if opening it failed.
+/// The caller must free the returned handle with `spz_cached_gaussian_splat_free`.
+///
+/// # Safety
+///
+/// `source` must be a valid, non-null pointer to a NUL-terminated string for
+/// the duration of this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_cached_gaussian_splat_open_for(
+	source: *const c_char,
+) -> *mut SpzCachedGaussianSplat {
+	clear_last_error();
+
+	let source = match cstr_arg(source, "source") {
+		Ok(source) => source,
+		Err(message) => {
+			set_last_error(message);
+			return ptr::null_mut();
+		},
+	};
+
+	match RustCachedGaussianSplat::open_for(source) {
+		Ok(Some(inner)) => Box::into_raw(Box::new(SpzCachedGaussianSplat { inner })),
+		Ok(None) => ptr::null_mut(),
+		Err(e) => {
+			set_last_error(format!("failed to open cache file: {e}"));
+			ptr::null_mut()
+		},
+	}
+}
+
+/// # Safety
+///
+/// `splat` must be null or a pointer previously returned by this library and
+/// not already freed.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_cached_gaussian_splat_free(splat: *mut SpzCachedGaussianSplat) {
+	free_box_handle(splat);
+}
+
+/// Checks the CRC-32 of every section, reading the whole file.
+///
+/// Returns `SpzResult_Success` if the data is intact. Call `spz_last_error()`
+/// on failure.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live cached splat handle returned by this library.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_cached_gaussian_splat_verify(
+	splat: *const SpzCachedGaussianSplat,
+) -> SpzResult {
+	clear_last_error();
+
+	let Some(splat) = cached_ref(splat) else {
+		set_last_error("cached splat handle is null".to_string());
+		return SpzResult::NullPointer;
+	};
+
+	match splat.inner.verify() {
+		Ok(()) => SpzResult::Success,
+		Err(e) => {
+			set_last_error(format!("corrupt cache file: {e}"));
+			SpzResult::of_error(&e)
+		},
+	}
+}
+
+/// Returns the number of points, or 0 if the handle is null.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live cached splat handle returned by this library.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_cached_gaussian_splat_num_points(
+	splat: *const SpzCachedGaussianSplat,
+) -> i32 {
+	cached_ref(splat)
+		.map(|splat| splat.inner.header().num_points)
+		.unwrap_or(0)
+}
+
+/// Returns the spherical harmonics degree, or 0 if the handle is null.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live cached splat handle returned by this library.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_cached_gaussian_splat_sh_degree(
+	splat: *const SpzCachedGaussianSplat,
+) -> u8 {
+	cached_ref(splat)
+		.map(|splat| splat.inner.header().spherical_harmonics_degree)
+		.unwrap_or(0)
+}
+
+/// Returns the coordinate system the cache was built in, or
+/// `SpzCoordinateSystem_Unspecified` if the handle is null.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live cached splat handle returned by this library.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_cached_gaussian_splat_coord_sys(
+	splat: *const SpzCachedGaussianSplat,
+) -> SpzCoordinateSystem {
+	cached_ref(splat)
+		.map(|splat| splat.inner.coord_sys().into())
+		.unwrap_or(SpzCoordinateSystem::Unspecified)
+}
+
+fn cached_attribute(
+	splat: *const SpzCachedGaussianSplat,
+	out_len: *mut usize,
+	attribute: fn(&RustCachedGaussianSplat) -> &[f32],
+) -> *const f32 {
+	let Some(splat) = cached_ref(splat) else {
+		write_out_len(out_len, 0);
+		return ptr::null();
+	};
+	let values = attribute(&splat.inner);
+
+	write_out_len(out_len, values.len());
+	values.as_ptr()
+}
+
+/// Returns a pointer into the mapping at the positions array.
+///
+/// The layout matches `spz_gaussian_splat_positions`. The pointer is valid
+/// until the cached splat is freed.
+///
+/// If `out_len` is non-null it receives the total number of floats.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live cached splat handle returned by this library.
+/// If `out_len` is non-null it must be a valid writable pointer for this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_cached_gaussian_splat_positions(
+	splat: *const SpzCachedGaussianSplat,
+	out_len: *mut usize,
+) -> *const f32 {
+	cached_attribute(splat, out_len, RustCachedGaussianSplat::positions)
+}
+
+/// Returns a pointer into the mapping at the scales array.
+///
+/// The layout matches `spz_gaussian_splat_scales`. The pointer is valid until
+/// the cached splat is freed.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live cached splat handle returned by this library.
+/// If `out_len` is non-null it must be a valid writable pointer for this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_cached_gaussian_splat_scales(
+	splat: *const SpzCachedGaussianSplat,
+	out_len: *mut usize,
+) -> *const f32 {
+	cached_attribute(splat, out_len, RustCachedGaussianSplat::scales)
+}
+
+/// Returns a pointer into the mapping at the rotations array.
+///
+/// The layout matches `spz_gaussian_splat_rotations`. The pointer is valid
+/// until the cached splat is freed.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live cached splat handle returned by this library.
+/// If `out_len` is non-null it must be a valid writable pointer for this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_cached_gaussian_splat_rotations(
+	splat: *const SpzCachedGaussianSplat,
+	out_len: *mut usize,
+) -> *const f32 {
+	cached_attribute(splat, out_len, RustCachedGaussianSplat::rotations)
+}
+
+/// Returns a pointer into the mapping at the alphas array.
+///
+/// The layout matches `spz_gaussian_splat_alphas`. The pointer is valid until
+/// the cached splat is freed.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live cached splat handle returned by this library.
+/// If `out_len` is non-null it must be a valid writable pointer for this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_cached_gaussian_splat_alphas(
+	splat: *const SpzCachedGaussianSplat,
+	out_len: *mut usize,
+) -> *const f32 {
+	cached_attribute(splat, out_len, RustCachedGaussianSplat::alphas)
+}
+
+/// Returns a pointer into the mapping at the colors array.
+///
+/// The layout matches `spz_gaussian_splat_colors`. The pointer is valid until
+/// the cached splat is freed.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live cached splat handle returned by this library.
+/// If `out_len` is non-null it must be a valid writable pointer for this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_cached_gaussian_splat_colors(
+	splat: *const SpzCachedGaussianSplat,
+	out_len: *mut usize,
+) -> *const f32 {
+	cached_attribute(splat, out_len, RustCachedGaussianSplat::colors)
+}
+
+/// Returns a pointer into the mapping at the spherical harmonics array.
+///
+/// The layout matches `spz_gaussian_splat_spherical_harmonics`. The pointer
+/// is valid until the cached splat is freed.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live cached splat handle returned by this library.
+/// If `out_len` is non-null it must be a valid writable pointer for this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_cached_gaussian_splat_spherical_harmonics(
+	splat: *const SpzCachedGaussianSplat,
+	out_len: *mut usize,
+) -> *const f32 {
+	cached_attribute(splat, out_len, RustCachedGaussianSplat::spherical_harmonics)
+}
+
+/// Copies the attributes into a new, independent GaussianSplat.
+///
+/// Returns NULL if the handle is null.
+/// The caller must free the returned handle with `spz_gaussian_splat_free`.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live cached splat handle returned by this library.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_cached_gaussian_splat_to_splat(
+	splat: *const SpzCachedGaussianSplat,
+) -> *mut SpzGaussianSplat {
+	let Some(splat) = cached_ref(splat) else {
+		return ptr::null_mut();
+	};
+	Box::into_raw(Box::new(SpzGaussianSplat {
+		inner: splat.inner.to_gaussian_splat(),
+	}))
+}
+
+// ---------------------------------------------------------------------------
+// Decode context — loading without allocations
+// ---------------------------------------------------------------------------
+
+/// Opaque handle to a decode context.
+///
+/// It keeps its decompression buffer and inflate state between loads, and
+/// decodes into existing splats, reusing their float arrays. Once these have
+/// grown to fit, loading similarly sized data doesn't allocate. A context
+/// must be used by one thread at a time.
+///
+/// Must be freed with `spz_decode_context_free`.
+pub struct SpzDecodeContext {
+	inner: RustDecoder,
+}
+
+/// Creates a decode context, its buffers grow on first use.
+///
+/// The caller must free the returned handle with `spz_decode_context_free`.
+#[unsafe(no_mangle)]
+pub extern "C" fn spz_decode_context_new() -> *mut SpzDecodeContext {
+	clear_last_error();
+	Box::into_raw(Box::new(SpzDecodeContext {
+		inner: RustDecoder::new(),
+	}))
+}
+
+/// # Safety
+///
+/// `ctx` must be null or a pointer previously returned by this library and
+/// not already freed.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_decode_context_free(ctx: *mut SpzDecodeContext) {
+	free_box_handle(ctx);
+}
+
+/// Returns the bytes of scratch memory `ctx` keeps between loads, or 0 if the
+/// handle is null.
+///
+/// # Safety
+///
+/// `ctx` must be null or a valid live decode context handle returned by this
+/// library.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_decode_context_retained_bytes(ctx: *const SpzDecodeContext) -> usize {
+	if ctx.is_null() {
+		return 0;
+	}
+
+	// SAFETY: `ctx` was checked for null above and the FFI contract requires it
+	// to be a live handle returned by this library.
+	unsafe { &*ctx }.inner.retained_bytes()
+}
+
+/// Loads an SPZ file into an existing splat, replacing its contents and
+/// reusing its float arrays.
+///
+/// On failure the contents of `splat` are unspecified but it stays a valid
+/// handle. Call `spz_last_error()` for error details.
+///
+/// # Safety
+///
+/// `ctx` and `splat` must be valid live handles returned by this library.
+/// `filepath` must be a valid, non-null pointer to a NUL-terminated string
+/// for the duration of this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_decode_context_load(
+	ctx: *mut SpzDecodeContext,
+	filepath: *const c_char,
+	coord_sys: SpzCoordinateSystem,
+	splat: *mut SpzGaussianSplat,
+) -> SpzResult {
+	clear_last_error();
+
+	let Some(ctx) = decode_context_mut(ctx) else {
+		set_last_error("ctx is null".to_string());
+		return SpzResult::NullPointer;
+	};
+	let Some(splat) = splat_mut(splat) else {
+		set_last_error("splat handle is null".to_string());
+		return SpzResult::NullPointer;
+	};
+	let path = match cstr_arg(filepath, "filepath") {
+		Ok(path) => path,
+		Err(message) => {
+			set_last_error(message);
+			return SpzResult::NullPointer;
+		},
+	};
+
+	let opts = LoadOptions {
+		coord_sys: coord_sys.into(),
+		..Default::default()
+	};
+
+	match ctx.inner.load_into(path, &opts, &mut splat.inner) {
+		Ok(()) => SpzResult::Success,
+		Err(e) => {
+			set_last_error(format!("failed to load SPZ file: {e}"));
+			SpzResult::of_error(&e)
+		},
+	}
+}
+
+/// Loads SPZ data from a byte buffer into an existing splat, replacing its
+/// contents and reusing its float arrays.
+///
+/// On failure the contents of `splat` are unspecified but it stays a valid
+/// handle. Call `spz_last_error()` for error details.
+///
+/// # Safety
+///
+/// `ctx` and `splat` must be valid live handles returned by this library.
+/// `data` must be a valid, non-null pointer to `len` readable bytes for the
+/// duration of this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_decode_context_load_from_bytes(
+	ctx: *mut SpzDecodeContext,
+	data: *const u8,
+	len: usize,
+	coord_sys: SpzCoordinateSystem,
+	splat: *mut SpzGaussianSplat,
+) -> SpzResult {
+	clear_last_error();
+
+	let Some(ctx) = decode_context_mut(ctx) else {
+		set_last_error("ctx is null".to_string());
+		return SpzResult::NullPointer;
+	};
+	let Some(splat) = splat_mut(splat) else {
+		set_last_error("splat handle is null".to_string());
+		return SpzResult::NullPointer;
+	};
+	let bytes = match byte_slice_arg(data, len) {
+		Ok(bytes) => bytes,
+		Err(message) => {
+			set_last_error(message);
+			return SpzResult::NullPointer;
+		},
+	};
+
+	let opts = LoadOptions {
+		coord_sys: coord_sys.into(),
+		..Default::default()
+	};
+
+	match ctx.inner.decode_into(bytes, &opts, &mut splat.inner) {
+		Ok(()) => SpzResult::Success,
+		Err(e) => {
+			set_last_error(format!("failed to load SPZ data: {e}"));
+			SpzResult::of_error(&e)
+		},
+	}
+}
+
+/// Like `spz_decode_into`, decompressing into the scratch buffer of `ctx`
+/// instead of a temporary one.
+///
+/// # Safety
+///
+/// `ctx` must be a valid live decode context handle returned by this library.
+/// `data` must be a valid, non-null pointer to `len` readable bytes for the
+/// duration of this call. `out` must be a valid pointer whose arrays are
+/// writable for their `*_len` floats and do not overlap each other or `data`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_decode_context_decode_into(
+	ctx: *mut SpzDecodeContext,
+	data: *const u8,
+	len: usize,
+	coord_sys: SpzCoordinateSystem,
+	out: *const SpzAttributeBuffers,
+) -> SpzResult {
+	clear_last_error();
+
+	let Some(ctx) = decode_context_mut(ctx) else {
+		set_last_error("ctx is null".to_string());
+		return SpzResult::NullPointer;
+	};
+	let bytes = match byte_slice_arg(data, len) {
+		Ok(bytes) => bytes,
+		Err(message) => {
+			set_last_error(message);
+			return SpzResult::NullPointer;
+		},
+	};
+	if out.is_null() {
+		set_last_error("out is null".to_string());
+		return SpzResult::NullPointer;
+	}
+
+	// SAFETY: `out` was checked for null above and the FFI contract requires
+	// it to be a valid readable pointer for this call.
+	let out = unsafe { *out };
+
+	let buffers = match attribute_buffers_arg(&out) {
+		Ok(buffers) => buffers,
+		Err(message) => {
+			set_last_error(message);
+			return SpzResult::NullPointer;
+		},
+	};
+	let opts = LoadOptions {
+		coord_sys: coord_sys.into(),
+		..Default::default()
+	};
+	let packed = match ctx.inner.decompress(bytes) {
+		Ok(packed) => packed,
+		Err(e) => {
+			set_last_error(format!("failed to decompress SPZ data: {e}"));
+			return SpzResult::of_error(&e);
+		},
+	};
+
+	decode_view_into(&packed, &opts, &out, buffers)
+}
+
+// ---------------------------------------------------------------------------
+// Point records — interleaved layouts for GPU upload
+// ---------------------------------------------------------------------------
+
+/// Memory layout of decoded point records, the README lists the fields of
+/// each record.
+#[repr(C)]
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum SpzLayout {
+	/// One float array per attribute, as in a splat; has no records.
+	Columns = 0,
+	/// 64 byte records of floats: position, scale, rotation (xyzw) and RGBA,
+	/// each 16 byte aligned.
+	InterleavedF32 = 1,
+	/// 32 byte records of the same as IEEE 754 halves.
+	InterleavedF16 = 2,
+	/// 32 byte records: float position, unorm8 RGBA, half scales and snorm16
+	/// rotation.
+	Quantized32 = 3,
+}
+
+impl From<SpzLayout> for Layout {
+	fn from(layout: SpzLayout) -> Self {
+		match layout {
+			SpzLayout::Columns => Layout::Columns,
+			SpzLayout::InterleavedF32 => Layout::InterleavedF32,
+			SpzLayout::InterleavedF16 => Layout::InterleavedF16,
+			SpzLayout::Quantized32 => Layout::Quantized32,
+		}
+	}
+}
+
+/// Transform applied to the values of point records.
+#[repr(C)]
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum SpzActivation {
+	/// The values a splat holds: log scales, alphas before the sigmoid and
+	/// degree 0 spherical harmonics coefficients as colors.
+	Raw = 0,
+	/// `exp` of the scales, sigmoid of the alphas and RGB colors.
+	Activated = 1,
+	/// Like `SpzActivation_Activated`, with RGB multiplied by alpha.
+	Premultiplied = 2,
+}
+
+impl From<SpzActivation> for Activation {
+	fn from(activation: SpzActivation) -> Self {
+		match activation {
+			SpzActivation::Raw => Activation::Raw,
+			SpzActivation::Activated => Activation::Activated,
+			SpzActivation::Premultiplied => Activation::Premultiplied,
+		}
+	}
+}
+
+/// Returns the bytes per point record of `layout`, 0 for
+/// `SpzLayout_Columns`.
+#[unsafe(no_mangle)]
+pub extern "C" fn spz_layout_record_size(layout: SpzLayout) -> usize {
+	Layout::from(layout).record_size()
+}
+
+/// Decodes SPZ data straight into caller-owned point records of `layout`,
+/// in one pass over the packed data, decompressing into the scratch buffer
+/// of `ctx`. Records hold no spherical harmonics.
+///
+/// `out_len` receives the number of bytes the records take,
+/// `num_points * spz_layout_record_size(layout)`. If that exceeds `capacity`
+/// nothing is written to `out` and `SpzResult_BufferTooSmall` is returned.
+/// `out` needn't be aligned. Call `spz_last_error()` on failure.
+///
+/// # Safety
+///
+/// `ctx` must be a valid live decode context handle returned by this library.
+/// `data` must be a valid, non-null pointer to `len` readable bytes for the
+/// duration of this call. `out` must be writable for `capacity` bytes and
+/// not overlap `data`. `out_len` must be a valid, non-null pointer.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_decode_context_decode_records(
+	ctx: *mut SpzDecodeContext,
+	data: *const u8,
+	len: usize,
+	coord_sys: SpzCoordinateSystem,
+	layout: SpzLayout,
+	activation: SpzActivation,
+	out: *mut c_void,
+	capacity: usize,
+	out_len: *mut usize,
+) -> SpzResult {
+	clear_last_error();
+
+	let Some(ctx) = decode_context_mut(ctx) else {
+		set_last_error("ctx is null".to_string());
+		return SpzResult::NullPointer;
+	};
+	let bytes = match byte_slice_arg(data, len) {
+		Ok(bytes) => bytes,
+		Err(message) => {
+			set_last_error(message);
+			return SpzResult::NullPointer;
+		},
+	};
+	if out_len.is_null() {
+		set_last_error("out_len is null".to_string());
+		return SpzResult::NullPointer;
+	}
+	if layout == SpzLayout::Columns {
+		set_last_error("the columns layout has no point records".to_string());
+		return SpzResult::InvalidArgument;
+	}
+	let packed = match ctx.inner.decompress(bytes) {
+		Ok(packed) => packed,
+		Err(e) => {
+			set_last_error(format!("failed to decompress SPZ data: {e}"));
+			return SpzResult::of_error(&e);
+		},
+	};
+	let opts = LoadOptions::builder()
+		.coord_sys(coord_sys.into())
+		.layout(layout.into())
+		.activation(activation.into())
+		.build();
+	let required = packed.num_points().max(0) as usize * opts.layout.record_size();
+
+	write_out_len(out_len, required);
+
+	if required > capacity {
+		set_last_error(format!(
+			"output buffer too small, required: {required} bytes"
+		));
+		return SpzResult::BufferTooSmall;
+	}
+	if required == 0 {
+		return SpzResult::Success;
+	}
+	if out.is_null() {
+		set_last_error("out is null".to_string());
+		return SpzResult::NullPointer;
+	}
+
+	// SAFETY: `out` is non-null and the FFI contract requires it to be
+	// writable for `capacity` bytes, which `required` doesn't exceed.
+	let out = unsafe { slice::from_raw_parts_mut(out.cast::<u8>(), required) };
+
+	match layout::decode_records(&packed, &opts, out) {
+		Ok(_) => SpzResult::Success,
+		Err(e) => {
+			set_last_error(format!("failed to decode SPZ data: {e}"));
+			SpzResult::of_error(&e)
+		},
+	}
+}
+
+// ---------------------------------------------------------------------------
+// Spatial index — box and frustum queries
+// ---------------------------------------------------------------------------
+
+/// Opaque handle to a spatial index over the points of a splat.
+///
+/// The points are sorted along a Morton curve under a bounding volume
+/// hierarchy, each bounded by a sphere of 3 times its largest scale. The
+/// index doesn't reference the splat, it stays valid for as long as the
+/// positions and scales it was built from don't change.
+///
+/// Must be freed with `spz_spatial_index_free`.
+pub struct SpzSpatialIndex {
+	inner: RustSpatialIndex,
+}
+
+/// Builds a spatial index over the positions and scales of `splat`.
+///
+/// `leaf_size` is the maximum number of points per leaf, 0 uses the default.
+///
+/// Returns NULL on failure. Call `spz_last_error()` for error details.
+/// The caller must free the returned handle with `spz_spatial_index_free`.
+///
+/// # Safety
+///
+/// `splat` must be null or a valid live splat handle returned by this library.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_spatial_index_build(
+	splat: *const SpzGaussianSplat,
+	leaf_size: usize,
+) -> *mut SpzSpatialIndex {
+	clear_last_error();
+
+	let Some(splat) = splat_ref(splat) else {
+		set_last_error("splat is null".to_string());
+		return ptr::null_mut();
+	};
+	let leaf_size = if leaf_size == 0 {
+		DEFAULT_LEAF_SIZE
+	} else {
+		leaf_size
+	};
+	let inner = RustSpatialIndex::build_with(
+		&splat.inner.positions,
+		&splat.inner.scales,
+		leaf_size,
+	);
+	Box::into_raw(Box::new(SpzSpatialIndex { inner }))
+}
+
+/// # Safety
+///
+/// `index` must be null or a pointer previously returned by this library and
+/// not already freed.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_spatial_index_free(index: *mut SpzSpatialIndex) {
+	free_box_handle(index);
+}
+
+/// Returns a pointer to the point indices sorted along the Morton curve.
+///
+/// The pointer is valid until the index is freed. If `out_len` is non-null
+/// it receives the number of indices.
+///
+/// # Safety
+///
+/// `index` must be null or a valid live spatial index handle returned by this
+/// library. If `out_len` is non-null it must be a valid writable pointer for
+/// this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_spatial_index_order(
+	index: *const SpzSpatialIndex,
+	out_len: *mut usize,
+) -> *const u32 {
+	let Some(index) = spatial_index_ref(index) else {
+		write_out_len(out_len, 0);
+		return ptr::null();
+	};
+	let order = index.inner.order();
+
+	write_out_len(out_len, order.len());
+	order.as_ptr()
+}
+
+/// Writes the indices of the points whose bounding sphere intersects `bbox`
+/// into `out`.
+///
+/// `out_len` receives the number of matching points. If it exceeds
+/// `capacity` nothing is written to `out` and `SpzResult_BufferTooSmall` is
+/// returned, so calling with a `capacity` of 0 queries the size.
+///
+/// # Safety
+///
+/// `index` must be a valid live spatial index handle returned by this library.
+/// `bbox` and `out_len` must be valid pointers for this call, `out` must be
+/// writable for `capacity` indices or null if `capacity` is 0.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_spatial_index_query_box(
+	index: *const SpzSpatialIndex,
+	bbox: *const SpzBoundingBox,
+	out: *mut u32,
+	capacity: usize,
+	out_len: *mut usize,
+) -> SpzResult {
+	clear_last_error();
+
+	let Some(index) = spatial_index_ref(index) else {
+		set_last_error("index is null".to_string());
+		return SpzResult::NullPointer;
+	};
+	if bbox.is_null() {
+		set_last_error("bbox is null".to_string());
+		return SpzResult::NullPointer;
+	}
+
+	// SAFETY: `bbox` was checked for null above and the FFI contract requires
+	// it to be a valid readable pointer for this call.
+	let bbox = RustBoundingBox::from(unsafe { *bbox });
+
+	write_indices(&index.inner.query_box(&bbox), out, capacity, out_len)
+}
+
+/// Writes the indices of the points whose bounding sphere is at least partly
+/// inside the view frustum of `view_projection` into `out`.
+///
+/// `view_projection` is a column-major 4x4 matrix mapping the splat's
+/// coordinates to clip space with `-w <= x, y, z <= w`. For a `0 <= z <= w`
+/// depth range the near plane is conservative. `out`, `capacity` and
+/// `out_len` behave as in `spz_spatial_index_query_box`.
+///
+/// # Safety
+///
+/// `index` must be a valid live spatial index handle returned by this library.
+/// `view_projection` must be readable for 16 floats and `out_len` a valid
+/// writable pointer for this call, `out` must be writable for `capacity`
+/// indices or null if `capacity` is 0.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_spatial_index_query_frustum(
+	index: *const SpzSpatialIndex,
+	view_projection: *const f32,
+	out: *mut u32,
+	capacity: usize,
+	out_len: *mut usize,
+) -> SpzResult {
+	clear_last_error();
+
+	let Some(index) = spatial_index_ref(index) else {
+		set_last_error("index is null".to_string());
+		return SpzResult::NullPointer;
+	};
+	if view_projection.is_null() {
+		set_last_error("view_projection is null".to_string());
+		return SpzResult::NullPointer;
+	}
+
+	// SAFETY: `view_projection` was checked for null above and the FFI
+	// contract requires it to be readable for 16 floats.
+	let m = unsafe { *(view_projection as *const [f32; 16]) };
+	let frustum = Frustum::from_view_projection(&m);
+
+	write_indices(&index.inner.query_frustum(&frustum), out, capacity, out_len)
+}
+
+/// Copies query results into the caller's array, see
+/// `spz_spatial_index_query_box`.
+fn write_indices(
+	indices: &[u32],
+	out: *mut u32,
+	capacity: usize,
+	out_len: *mut usize,
+) -> SpzResult {
+	if out_len.is_null() {
+		set_last_error("out_len is null".to_string());
+		return SpzResult::NullPointer;
+	}
+	write_out_len(out_len, indices.len());
+
+	if indices.len() > capacity {
+		set_last_error(format!(
+			"output buffer too small, required: {} indices",
+			indices.len()
+		));
+		return SpzResult::BufferTooSmall;
+	}
+	if indices.is_empty() {
+		return SpzResult::Success;
+	}
+	if out.is_null() {
+		set_last_error("out is null".to_string());
+		return SpzResult::NullPointer;
+	}
+
+	// SAFETY: `out` is non-null and the FFI contract requires it to be
+	// writable for `capacity` indices, which `indices` doesn't exceed.
+	unsafe { ptr::copy_nonoverlapping(indices.as_ptr(), out, indices.len()) };
+
+	SpzResult::Success
+}
+
+// ---------------------------------------------------------------------------
+// Transcoding
+// ---------------------------------------------------------------------------
+
+/// Converts compressed SPZ data between coordinate systems without decoding
+/// it, flipping the signs of the quantized values. The result keeps the
+/// codec of the input, at the default compression level.
+///
+/// Returns `SpzResult_Success` on success. Call `spz_last_error()` on failure.
+/// The caller must free the returned buffer with `spz_free_bytes`.
+///
+/// # Safety
+///
+/// `data` must be a valid, non-null pointer to `len` readable bytes, and
+/// `out_data` and `out_len` valid writable pointers for this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_transcode_coordinates(
+	data: *const u8,
+	len: usize,
+	from: SpzCoordinateSystem,
+	to: SpzCoordinateSystem,
+	out_data: *mut *mut u8,
+	out_len: *mut usize,
+) -> SpzResult {
+	clear_last_error();
+
+	let bytes = match byte_slice_arg(data, len) {
+		Ok(bytes) => bytes,
+		Err(message) => {
+			set_last_error(message);
+			return SpzResult::NullPointer;
+		},
+	};
+	if out_data.is_null() || out_len.is_null() {
+		set_last_error("null pointer argument".to_string());
+		return SpzResult::NullPointer;
+	}
+	match transcode::convert_coordinates(
+		bytes,
+		from.into(),
+		to.into(),
+		CompressionLevel::Default,
+	) {
+		Ok(converted) => {
+			let len = converted.len();
+			let ptr = Box::into_raw(converted.into_boxed_slice()) as *mut u8;
+
+			// SAFETY: `out_data` and `out_len` were checked for null above and the
+			// FFI contract requires them to be valid writable pointers for this call.
+			unsafe {
+				*out_data = ptr;
+				*out_len = len;
+			}
+			SpzResult::Success
+		},
+		Err(e) => {
+			set_last_error(format!("failed to transcode SPZ data: {e}"));
+			SpzResult::of_error(&e)
+		},
+	}
+}
+
+/// Converts an SPZ file between coordinate systems without decoding it, see
+/// `spz_transcode_coordinates`. `output` may be `input`.
+///
+/// Returns `SpzResult_Success` on success. Call `spz_last_error()` on failure.
+///
+/// # Safety
+///
+/// `input` and `output` must be valid, non-null pointers to NUL-terminated
+/// strings for this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_transcode_coordinates_file(
+	input: *const c_char,
+	output: *const c_char,
+	from: SpzCoordinateSystem,
+	to: SpzCoordinateSystem,
+) -> SpzResult {
+	clear_last_error();
+
+	let (input, output) = match (cstr_arg(input, "input"), cstr_arg(output, "output")) {
+		(Ok(input), Ok(output)) => (input, output),
+		(Err(message), _) | (_, Err(message)) => {
+			set_last_error(message);
+			return SpzResult::InvalidArgument;
+		},
+	};
+	match transcode::convert_file(
+		input,
+		output,
+		from.into(),
+		to.into(),
+		CompressionLevel::Default,
+	) {
+		Ok(()) => SpzResult::Success,
+		Err(e) => {
+			set_last_error(format!("failed to transcode SPZ file: {e}"));
+			SpzResult::of_error(&e)
+		},
+	}
+}
+
+// ---------------------------------------------------------------------------
+// Instrumentation — per-stage load and save statistics
+// ---------------------------------------------------------------------------
+
+/// What one stage of loading or saving did, summed over the times it ran.
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default)]
+pub struct SpzStageStats {
+	/// Number of times the stage ran.
+	pub calls: u32,
+	/// Most threads the stage ran on at once.
+	pub threads: u32,
+	pub wall_ns: u64,
+	pub bytes_in: u64,
+	pub bytes_out: u64,
+	/// Bytes of the buffers the stage allocated for its output.
+	pub allocated: u64,
+}
+
+impl From<&StageStats> for SpzStageStats {
+	fn from(stats: &StageStats) -> Self {
+		SpzStageStats {
+			calls: stats.calls,
+			threads: stats.threads,
+			wall_ns: stats.wall.as_nanos().min(u64::MAX as u128) as u64,
+			bytes_in: stats.bytes_in,
+			bytes_out: stats.bytes_out,
+			allocated: stats.allocated,
+		}
+	}
+}
+
+/// Per-stage statistics recorded between `spz_load_stats_begin` and
+/// `spz_load_stats_end`.
+///
+/// Stages fused into one pass are reported as one: decoding in memory
+/// converts coordinates while dequantizing.
+#[repr(C)]
+#[derive(Clone, Copy, Debug, Default)]
+pub struct SpzLoadStats {
+	/// Reading or mapping the file.
+	pub read: SpzStageStats,
+	/// Decompressing.
+	pub inflate: SpzStageStats,
+	/// Reading the header and sections of decompressed data.
+	pub parse: SpzStageStats,
+	pub dequantize: SpzStageStats,
+	/// Axis flips applied as a pass of their own.
+	pub convert_coordinates: SpzStageStats,
+	pub quantize: SpzStageStats,
+	/// Compressing.
+	pub deflate: SpzStageStats,
+	/// Writing the file.
+	pub write: SpzStageStats,
+}
+
+impl From<&LoadStats> for SpzLoadStats {
+	fn from(stats: &LoadStats) -> Self {
+		SpzLoadStats {
+			read: stats.stage(Stage::Read).into(),
+			inflate: stats.stage(Stage::Inflate).into(),
+			parse: stats.stage(Stage::Parse).into(),
+			dequantize: stats.stage(Stage::Dequantize).into(),
+			convert_coordinates: stats.stage(Stage::ConvertCoordinates).into(),
+			quantize: stats.stage(Stage::Quantize).into(),
+			deflate: stats.stage(Stage::Deflate).into(),
+			write: stats.stage(Stage::Write).into(),
+		}
+	}
+}
+
+/// Starts recording the stages of the loads and saves made on the calling
+/// thread, dropping the ones recorded so far.
+///
+/// Work handed to other threads, e.g. by a `SpzContext`, isn't recorded.
+#[unsafe(no_mangle)]
+pub extern "C" fn spz_load_stats_begin() {
+	instrument::start();
+}
+
+/// Stops recording and writes the stages recorded on the calling thread
+/// since `spz_load_stats_begin` to `out_stats`.
+///
+/// Returns `SpzResult_InvalidArgument` if recording wasn't started.
+///
+/// # Safety
+///
+/// `out_stats` must be a valid, non-null, writable pointer for this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn spz_load_stats_end(out_stats: *mut SpzLoadStats) -> SpzResult {
+	clear_last_error();
+
+	if out_stats.is_null() {
+		set_last_error("out_stats is null".to_string());
+		return SpzResult::NullPointer;
+	}
+	let Some(stats) = instrument::finish() else {
+		set_last_error("spz_load_stats_begin wasn't called".to_string());
+		return SpzResult::InvalidArgument;
+	};
+
+	// SAFETY: `out_stats` was checked for null above and the FFI contract
+	// requires it to be a valid writable pointer for this call.
+	unsafe {
+		*out_stats = (&stats).into();
+	}
+	SpzResult::Success
+}
+
 // ---------------------------------------------------------------------------
 // Free helpers
 // ---------------------------------------------------------------------------
 
-/// Frees a string previously returned by `spz_gaussian_splat_pretty_fmt`
-/// or `spz_header_pretty_fmt`.
+/// Frees a string previously returned by `spz_gaussian_splat_pretty_fmt`,
+/// `spz_lazy_gaussian_splat_pretty_fmt` or `spz_header_pretty_fmt`.
 ///
 /// # Safety
 ///
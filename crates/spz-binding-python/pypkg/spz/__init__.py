@@ -19,6 +19,7 @@ from ._spz import (
     Header,
     Version,
     load,
+    load_many,
     read_header,
 )
 
@@ -29,6 +30,7 @@ __all__ = [
     "Header",
     "Version",
     "load",
+    "load_many",
     "read_header",
     # Context managers
     "SplatReader",
@@ -113,7 +113,9 @@ class GaussianSplat:
     rotation, scale, color, alpha (opacity), and spherical harmonics
     coefficients for view-dependent appearance.
 
-    All array data is returned as numpy arrays for efficient processing.
+    All array data is returned as read-only numpy arrays that borrow the
+    splat's buffers without copying. They keep the splat alive and see
+    ``convert_coordinates``; call ``.copy()`` for arrays of your own.
 
     Example:
         Load from file::
@@ -165,7 +167,10 @@ class GaussianSplat:
 
     @staticmethod
     def load(
-        path: str, coordinate_system=CoordinateSystem.UNSPECIFIED
+        path: str,
+        coordinate_system=CoordinateSystem.UNSPECIFIED,
+        max_sh_degree: int = 3,
+        attributes: list[str] | None = None,
     ) -> GaussianSplat:
         """Load a GaussianSplat from an SPZ file.
 
@@ -174,12 +179,19 @@ class GaussianSplat:
             coordinate_system: Target coordinate system to convert to when
                 loading the data.
                 Defaults to UNSPECIFIED (no conversion).
+            max_sh_degree: Highest degree of spherical harmonics to decode.
+                Defaults to 3, every degree.
+            attributes: Names of the attributes to decode, among
+                "positions", "scales", "rotations", "alphas", "colors" and
+                "spherical_harmonics". The others are left empty.
+                Defaults to None, every attribute.
 
         Returns:
             The loaded Gaussian splat.
 
         Raises:
-            ValueError: If the file cannot be read or is invalid.
+            ValueError: If the file cannot be read or is invalid, or an
+                attribute name is unknown.
         """
         ...
 
@@ -187,6 +199,8 @@ class GaussianSplat:
     def from_bytes(
         data: bytes,
         coordinate_system=CoordinateSystem.UNSPECIFIED,
+        max_sh_degree: int = 3,
+        attributes: list[str] | None = None,
     ) -> GaussianSplat:
         """Load a GaussianSplat from bytes.
 
@@ -195,6 +209,12 @@ class GaussianSplat:
             coordinate_system: The coordinate system to convert to when loading
                 the data.
                 Defaults to UNSPECIFIED (no conversion).
+            max_sh_degree: Highest degree of spherical harmonics to decode.
+                Defaults to 3, every degree.
+            attributes: Names of the attributes to decode, among
+                "positions", "scales", "rotations", "alphas", "colors" and
+                "spherical_harmonics". The others are left empty.
+                Defaults to None, every attribute.
 
         Returns:
             The loaded Gaussian splat.
@@ -314,6 +334,8 @@ class GaussianSplat:
 def load(
     path: str,
     coordinate_system=CoordinateSystem.UNSPECIFIED,
+    max_sh_degree: int = 3,
+    attributes: list[str] | None = None,
 ) -> GaussianSplat:
     """Loads a GaussianSplat from an SPZ file.
 
@@ -324,6 +346,12 @@ def load(
         coordinate_system: The coordinate system to convert to when loading
             the data.
             Defaults to UNSPECIFIED (no conversion).
+        max_sh_degree: Highest degree of spherical harmonics to decode.
+            Defaults to 3, every degree.
+        attributes: Names of the attributes to decode, among
+            "positions", "scales", "rotations", "alphas", "colors" and
+            "spherical_harmonics". The others are left empty.
+            Defaults to None, every attribute.
 
     Returns:
         The loaded Gaussian splat.
@@ -334,3 +362,36 @@ def load(
         >>> print(f"Loaded {len(splat)} gaussians")
     """
     ...
+
+def load_many(
+    paths: list[str],
+    coordinate_system=CoordinateSystem.UNSPECIFIED,
+    threads: int = 0,
+    max_sh_degree: int = 3,
+    attributes: list[str] | None = None,
+) -> list[GaussianSplat]:
+    """Loads many SPZ files in parallel, without holding the GIL.
+
+    Each file is decoded on one of ``threads`` workers, which reuse their
+    scratch memory from file to file.
+
+    Args:
+        paths: Paths to the SPZ files.
+        coordinate_system: The coordinate system to convert to when loading
+            the data.
+            Defaults to UNSPECIFIED (no conversion).
+        threads: Number of worker threads, 0 uses all available cores.
+        max_sh_degree: Highest degree of spherical harmonics to decode.
+            Defaults to 3, every degree.
+        attributes: Names of the attributes to decode, among
+            "positions", "scales", "rotations", "alphas", "colors" and
+            "spherical_harmonics". The others are left empty.
+            Defaults to None, every attribute.
+
+    Returns:
+        The loaded Gaussian splats, in the order of ``paths``.
+
+    Raises:
+        ValueError: Naming the first file that cannot be loaded.
+    """
+    ...
@@ -297,6 +297,45 @@ class TestGaussianSplatSerialization:
 
             assert restored.num_points == original.num_points
 
+    def test_load_many(self):
+        """spz.load_many() should load every file, in order."""
+        with TemporaryDirectory() as tmpdir:
+            paths = []
+            for i, num_points in enumerate([10, 20, 30]):
+                filepath = Path(tmpdir) / f"test{i}.spz"
+                util.create_test_splat(num_points).save(str(filepath))
+                paths.append(str(filepath))
+
+            splats = spz.load_many(paths, threads=2)
+
+            assert [s.num_points for s in splats] == [10, 20, 30]
+
+            with pytest.raises(ValueError):
+                spz.load_many([*paths, str(Path(tmpdir) / "missing.spz")])
+
+    def test_load_with_attributes(self):
+        """Loading should decode only the selected attributes and SH degrees."""
+        original = util.create_test_splat(20, sh_degree=3)
+
+        with TemporaryDirectory() as tmpdir:
+            filepath = Path(tmpdir) / "test.spz"
+            original.save(str(filepath))
+
+            restored = spz.load(
+                str(filepath),
+                max_sh_degree=1,
+                attributes=["positions", "spherical_harmonics"],
+            )
+
+            assert restored.num_points == 20
+            assert restored.sh_degree == 1
+            assert restored.positions.shape == (20, 3)
+            assert restored.spherical_harmonics.shape == (20, 9)
+            assert restored.colors.shape == (0, 3)
+
+            with pytest.raises(ValueError):
+                spz.load(str(filepath), attributes=["normals"])
+
     def test_save_with_coordinate_system(self):
         """Saving with a coordinate system should work."""
         splat = util.create_test_splat(20)
@@ -756,6 +795,20 @@ class TestEdgeCases:
         assert splat.colors.dtype == np.float32
         assert splat.spherical_harmonics.dtype == np.float32
 
+    def test_arrays_borrow_splat_buffers(self):
+        """Array properties should be read-only views of the splat."""
+        splat = util.create_test_splat(10)
+        positions = splat.positions
+
+        assert np.shares_memory(positions, splat.positions)
+        assert not positions.flags.writeable
+        with pytest.raises(ValueError):
+            positions[0, 0] = 1.0
+
+        expected = positions.copy()
+        del splat
+        np.testing.assert_array_equal(positions, expected)
+
     def test_coordinate_system_identity_conversion(self):
         """Converting to same coordinate system should be identity."""
         splat = util.create_test_splat(10)
@@ -5,9 +5,11 @@
 //! This crate provides Python bindings using PyO3 and numpy for efficient
 //! array handling.
 
+use numpy::ndarray::{ArrayView1, ArrayView2, Dimension};
+use numpy::npyffi::NPY_ARRAY_WRITEABLE;
 use numpy::{
-	PyArray1, PyArray2, PyArrayMethods, PyReadonlyArray1, PyReadonlyArray2,
-	PyUntypedArrayMethods,
+	PyArray, PyArray1, PyArray2, PyArrayMethods, PyReadonlyArray1, PyReadonlyArray2,
+	PyUntypedArray, PyUntypedArrayMethods,
 };
 use pyo3::exceptions::PyValueError;
 use pyo3::prelude::*;
@@ -447,7 +449,9 @@ impl BoundingBox {
 /// rotation, scale, color, alpha (opacity), and spherical harmonics
 /// coefficients for view-dependent appearance.
 ///
-/// All array data is returned as numpy arrays for efficient processing.
+/// All array data is returned as read-only numpy arrays that borrow the
+/// splat's buffers, without copying; they keep the splat alive and see
+/// `convert_coordinates`. Call `.copy()` on them for arrays of your own.
 ///
 /// # Examples
 ///
@@ -562,6 +566,10 @@ impl GaussianSplat {
 	/// * `coordinate_system` - The coordinate system to convert the data to
 	/// 	from the one it is stored.
 	/// 	Defaults to `UNSPECIFIED` (no conversion).
+	/// * `max_sh_degree` - Highest degree of spherical harmonics to decode.
+	/// 	Defaults to 3, every degree.
+	/// * `attributes` - Names of the attributes to decode, the others are
+	/// 	left empty. Defaults to `None`, every attribute.
 	///
 	/// # Returns
 	///
@@ -569,17 +577,30 @@ impl GaussianSplat {
 	///
 	/// # Errors
 	///
-	/// Returns `ValueError` if the file cannot be read or is invalid.
+	/// Returns `ValueError` if the file cannot be read or is invalid, or an
+	/// attribute name is unknown.
 	#[staticmethod]
-	#[pyo3(signature = (path, coordinate_system=CoordinateSystem::UNSPECIFIED()))]
+	#[pyo3(signature = (
+		path,
+		coordinate_system=CoordinateSystem::UNSPECIFIED(),
+		max_sh_degree=3,
+		attributes=None,
+	))]
 	#[inline]
-	pub fn load(path: &str, coordinate_system: CoordinateSystem) -> PyResult<Self> {
-		let opts = spz_rs::gaussian_splat::LoadOptions {
-			coord_sys: coordinate_system.inner,
-		};
-		let inner = spz_rs::gaussian_splat::GaussianSplat::load_with(path, &opts).map_err(
-			|e| PyValueError::new_err(format!("Failed to load SPZ file: {}", e)),
-		)?;
+	pub fn load(
+		py: Python<'_>,
+		path: &str,
+		coordinate_system: CoordinateSystem,
+		max_sh_degree: u8,
+		attributes: Option<Vec<String>>,
+	) -> PyResult<Self> {
+		let opts = load_options(coordinate_system, max_sh_degree, attributes)?;
+		let inner = py
+			.detach(|| spz_rs::gaussian_splat::GaussianSplat::load_with(path, &opts))
+			.map_err(|e| {
+				PyValueError::new_err(format!("Failed to load SPZ file: {}", e))
+			})?;
+
 		Ok(Self { inner })
 	}
 
@@ -591,25 +612,37 @@ impl GaussianSplat {
 	/// * `coordinate_system` - The coordinate system to convert the data to
 	/// 	from the one it is stored.
 	/// 	Defaults to `UNSPECIFIED` (no conversion).
+	/// * `max_sh_degree` - Highest degree of spherical harmonics to decode.
+	/// 	Defaults to 3, every degree.
+	/// * `attributes` - Names of the attributes to decode, the others are
+	/// 	left empty. Defaults to `None`, every attribute.
 	///
 	/// # Returns
 	///
 	/// The loaded Gaussian splat.
 	#[staticmethod]
-	#[pyo3(signature = (data, coordinate_system=CoordinateSystem::UNSPECIFIED()))]
+	#[pyo3(signature = (
+		data,
+		coordinate_system=CoordinateSystem::UNSPECIFIED(),
+		max_sh_degree=3,
+		attributes=None,
+	))]
 	#[inline]
-	pub fn from_bytes(data: &[u8], coordinate_system: CoordinateSystem) -> PyResult<Self> {
-		let opts = spz_rs::gaussian_splat::LoadOptions {
-			coord_sys: coordinate_system.inner,
-		};
-		let packed =
-			spz_rs::packed::PackedGaussianSplat::from_bytes(data).map_err(|e| {
-				PyValueError::new_err(format!("Failed to parse SPZ data: {}", e))
-			})?;
-		let inner = spz_rs::gaussian_splat::GaussianSplat::new_from_packed_gaussians(
-			&packed, &opts,
-		)
-		.map_err(|e| PyValueError::new_err(format!("Failed to unpack SPZ data: {}", e)))?;
+	pub fn from_bytes(
+		py: Python<'_>,
+		data: &[u8],
+		coordinate_system: CoordinateSystem,
+		max_sh_degree: u8,
+		attributes: Option<Vec<String>>,
+	) -> PyResult<Self> {
+		let opts = load_options(coordinate_system, max_sh_degree, attributes)?;
+		let inner = py.detach(|| {
+			spz_rs::decoder::Decoder::new()
+				.decode(data, &opts)
+				.map_err(|e| {
+					PyValueError::new_err(format!("Failed to load SPZ data: {}", e))
+				})
+		})?;
 
 		Ok(Self { inner })
 	}
@@ -623,13 +656,20 @@ impl GaussianSplat {
 	///   Defaults to `UNSPECIFIED` (no conversion).
 	#[pyo3(signature = (path, coordinate_system=CoordinateSystem::UNSPECIFIED()))]
 	#[inline]
-	pub fn save(&self, path: &str, coordinate_system: CoordinateSystem) -> PyResult<()> {
+	pub fn save(
+		&self,
+		py: Python<'_>,
+		path: &str,
+		coordinate_system: CoordinateSystem,
+	) -> PyResult<()> {
 		let pack_opts = spz_rs::gaussian_splat::SaveOptions {
 			coord_sys: coordinate_system.inner,
+			..Default::default()
 		};
-		self.inner.save(path, &pack_opts).map_err(|e| {
-			PyValueError::new_err(format!("Failed to save SPZ file: {}", e))
-		})
+		py.detach(|| self.inner.save(path, &pack_opts))
+			.map_err(|e| {
+				PyValueError::new_err(format!("Failed to save SPZ file: {}", e))
+			})
 	}
 
 	/// Serializes the `GaussianSplat` to bytes.
@@ -651,10 +691,10 @@ impl GaussianSplat {
 	) -> PyResult<Bound<'py, PyBytes>> {
 		let pack_opts = spz_rs::gaussian_splat::SaveOptions {
 			coord_sys: coordinate_system.inner,
+			..Default::default()
 		};
-		let bytes = self
-			.inner
-			.serialize_to_packed_bytes(&pack_opts)
+		let bytes = py
+			.detach(|| self.inner.serialize_to_packed_bytes(&pack_opts))
 			.map_err(|e| {
 				PyValueError::new_err(format!("Failed to serialize SPZ: {}", e))
 			})?;
@@ -697,52 +737,52 @@ impl GaussianSplat {
 	/// Returns an `(N, 3)` array of `(x, y, z)` positions.
 	#[inline]
 	#[getter]
-	pub fn positions<'py>(&self, py: Python<'py>) -> PyResult<Bound<'py, PyArray2<f32>>> {
-		let n = self.inner.header.num_points as usize;
-		let arr = PyArray1::from_slice(py, &self.inner.positions);
-		let reshaped = arr.reshape([n, 3])?;
+	pub fn positions<'py>(slf: &Bound<'py, Self>) -> PyResult<Bound<'py, PyArray2<f32>>> {
+		let this = slf.borrow();
 
-		Ok(reshaped)
+		borrowed_array2(slf, &this.inner.positions, 3)
 	}
 
 	/// Returns an `(N, 3)` array of `(x, y, z)` log-scale values.
 	#[inline]
 	#[getter]
-	pub fn scales<'py>(&self, py: Python<'py>) -> PyResult<Bound<'py, PyArray2<f32>>> {
-		let n = self.inner.header.num_points as usize;
-		let arr = PyArray1::from_slice(py, &self.inner.scales);
-		let reshaped = arr.reshape([n, 3])?;
+	pub fn scales<'py>(slf: &Bound<'py, Self>) -> PyResult<Bound<'py, PyArray2<f32>>> {
+		let this = slf.borrow();
 
-		Ok(reshaped)
+		borrowed_array2(slf, &this.inner.scales, 3)
 	}
 
 	/// Returns an `(N, 4)` array of `(w, x, y, z)` quaternion rotations.
 	#[inline]
 	#[getter]
-	pub fn rotations<'py>(&self, py: Python<'py>) -> PyResult<Bound<'py, PyArray2<f32>>> {
-		let n = self.inner.header.num_points as usize;
-		let arr = PyArray1::from_slice(py, &self.inner.rotations);
-		let reshaped = arr.reshape([n, 4])?;
+	pub fn rotations<'py>(slf: &Bound<'py, Self>) -> PyResult<Bound<'py, PyArray2<f32>>> {
+		let this = slf.borrow();
 
-		Ok(reshaped)
+		borrowed_array2(slf, &this.inner.rotations, 4)
 	}
 
 	/// Returns an `(N,)` array of inverse-sigmoid opacity values.
 	#[inline]
 	#[getter]
-	pub fn alphas<'py>(&self, py: Python<'py>) -> Bound<'py, PyArray1<f32>> {
-		PyArray1::from_slice(py, &self.inner.alphas)
+	pub fn alphas<'py>(slf: &Bound<'py, Self>) -> Bound<'py, PyArray1<f32>> {
+		let this = slf.borrow();
+		let view = ArrayView1::from(this.inner.alphas.as_slice());
+
+		// SAFETY: the array keeps `slf` alive as its base, and the splat's
+		// buffers are only ever modified in place, never reallocated, so the
+		// slice stays valid for as long as the array.
+		let arr = unsafe { PyArray1::borrow_from_array(&view, slf.clone().into_any()) };
+
+		read_only(arr)
 	}
 
 	/// Returns an `(N, 3)` array of `(r, g, b)` SH0 color values.
 	#[inline]
 	#[getter]
-	pub fn colors<'py>(&self, py: Python<'py>) -> PyResult<Bound<'py, PyArray2<f32>>> {
-		let n = self.inner.header.num_points as usize;
-		let arr = PyArray1::from_slice(py, &self.inner.colors);
-		let reshaped = arr.reshape([n, 3])?;
+	pub fn colors<'py>(slf: &Bound<'py, Self>) -> PyResult<Bound<'py, PyArray2<f32>>> {
+		let this = slf.borrow();
 
-		Ok(reshaped)
+		borrowed_array2(slf, &this.inner.colors, 3)
 	}
 
 	/// Returns an `(N, sh_dim * 3)` array of spherical harmonics coefficients.
@@ -753,26 +793,14 @@ impl GaussianSplat {
 	#[inline]
 	#[getter]
 	pub fn spherical_harmonics<'py>(
-		&self,
-		py: Python<'py>,
+		slf: &Bound<'py, Self>,
 	) -> PyResult<Bound<'py, PyArray2<f32>>> {
-		let n = self.inner.header.num_points as usize;
+		let this = slf.borrow();
 		let sh_dim =
-			spz_rs::math::dim_for_degree(self.inner.header.spherical_harmonics_degree);
+			spz_rs::math::dim_for_degree(this.inner.header.spherical_harmonics_degree);
 
-		if sh_dim == 0 {
-			// Return empty (N, 0) array
-			let arr = PyArray1::<f32>::from_slice(py, &[]);
-			let reshaped = arr.reshape([n, 0])?;
-
-			Ok(reshaped)
-		} else {
-			let arr = PyArray1::from_slice(py, &self.inner.spherical_harmonics);
-			// Return as (N, sh_dim * 3) for simplicity
-			let reshaped = arr.reshape([n, sh_dim as usize * 3])?;
-
-			Ok(reshaped)
-		}
+		// Return as (N, sh_dim * 3) for simplicity
+		borrowed_array2(slf, &this.inner.spherical_harmonics, sh_dim as usize * 3)
 	}
 
 	/// Returns the bounding box of the splat.
@@ -869,15 +897,80 @@ impl GaussianSplat {
 ///
 /// * `path` - Path to the SPZ file.
 /// * `coordinate_system` - Target coordinate system for the loaded data.
+/// * `max_sh_degree` - Highest degree of spherical harmonics to decode.
+/// * `attributes` - Names of the attributes to decode, `None` for all.
 ///
 /// # Returns
 ///
 /// The loaded Gaussian Splat.
 #[inline]
 #[pyfunction]
-#[pyo3(signature = (path, coordinate_system=CoordinateSystem::UNSPECIFIED()))]
-pub fn load(path: &str, coordinate_system: CoordinateSystem) -> PyResult<GaussianSplat> {
-	GaussianSplat::load(path, coordinate_system)
+#[pyo3(signature = (
+	path,
+	coordinate_system=CoordinateSystem::UNSPECIFIED(),
+	max_sh_degree=3,
+	attributes=None,
+))]
+pub fn load(
+	py: Python<'_>,
+	path: &str,
+	coordinate_system: CoordinateSystem,
+	max_sh_degree: u8,
+	attributes: Option<Vec<String>>,
+) -> PyResult<GaussianSplat> {
+	GaussianSplat::load(py, path, coordinate_system, max_sh_degree, attributes)
+}
+
+/// Loads many SPZ files in parallel, without holding the GIL.
+///
+/// Each file is decoded on one of `threads` workers, which reuse their
+/// scratch memory from file to file.
+///
+/// # Args
+///
+/// * `paths` - Paths to the SPZ files.
+/// * `coordinate_system` - Target coordinate system for the loaded data.
+/// * `threads` - Number of worker threads, `0` uses all available cores.
+/// * `max_sh_degree` - Highest degree of spherical harmonics to decode.
+/// * `attributes` - Names of the attributes to decode, `None` for all.
+///
+/// # Returns
+///
+/// The loaded Gaussian Splats, in the order of `paths`.
+///
+/// # Errors
+///
+/// Returns `ValueError` naming the first file that cannot be loaded.
+#[pyfunction]
+#[pyo3(signature = (
+	paths,
+	coordinate_system=CoordinateSystem::UNSPECIFIED(),
+	threads=0,
+	max_sh_degree=3,
+	attributes=None,
+))]
+pub fn load_many(
+	py: Python<'_>,
+	paths: Vec<String>,
+	coordinate_system: CoordinateSystem,
+	threads: usize,
+	max_sh_degree: u8,
+	attributes: Option<Vec<String>>,
+) -> PyResult<Vec<GaussianSplat>> {
+	let opts = load_options(coordinate_system, max_sh_degree, attributes)?;
+	let results = py.detach(|| spz_rs::batch::BatchLoader::new(threads).load(&paths, &opts));
+
+	paths.iter()
+		.zip(results)
+		.map(|(path, result)| {
+			result.map(|inner| GaussianSplat { inner }).map_err(|e| {
+				PyValueError::new_err(format!(
+					"Failed to load SPZ file {}: {}",
+					path, e
+				))
+			})
+		})
+		.collect()
 }
 
 /// Reads only the header from an SPZ file without loading the full data.
@@ -897,6 +990,92 @@ pub fn read_header(path: &str) -> PyResult<Header> {
 	Header::from_file(path)
 }
 
+/// Names of the attributes the `attributes` arguments of the load functions
+/// take, those of the `GaussianSplat` properties.
+const ATTRIBUTE_NAMES: [(&str, spz_rs::gaussian_splat::AttributeMask); 6] = [
+	(
+		"positions",
+		spz_rs::gaussian_splat::AttributeMask::POSITIONS,
+	),
+	("scales", spz_rs::gaussian_splat::AttributeMask::SCALES),
+	(
+		"rotations",
+		spz_rs::gaussian_splat::AttributeMask::ROTATIONS,
+	),
+	("alphas", spz_rs::gaussian_splat::AttributeMask::ALPHAS),
+	("colors", spz_rs::gaussian_splat::AttributeMask::COLORS),
+	(
+		"spherical_harmonics",
+		spz_rs::gaussian_splat::AttributeMask::SPHERICAL_HARMONICS,
+	),
+];
+
+/// Builds the load options of the arguments of the load functions.
+fn load_options(
+	coordinate_system: CoordinateSystem,
+	max_sh_degree: u8,
+	attributes: Option<Vec<String>>,
+) -> PyResult<spz_rs::gaussian_splat::LoadOptions> {
+	let mut mask = spz_rs::gaussian_splat::AttributeMask::all();
+
+	if let Some(attributes) = attributes {
+		mask = spz_rs::gaussian_splat::AttributeMask::empty();
+
+		for name in &attributes {
+			let Some((_, attribute)) = ATTRIBUTE_NAMES.iter().find(|(n, _)| n == name)
+			else {
+				return Err(PyValueError::new_err(format!(
+					"Unknown attribute: {}",
+					name
+				)));
+			};
+			mask |= *attribute;
+		}
+	}
+	Ok(spz_rs::gaussian_splat::LoadOptions::builder()
+		.coord_sys(coordinate_system.inner)
+		.max_sh_degree(max_sh_degree)
+		.attributes(mask)
+		.build())
+}
+
+/// Wraps `data` in a read-only `(N, cols)` array borrowing the buffer of
+/// `owner`, no copy is made. Attributes left out when loading give `(0,
+/// cols)` arrays.
+fn borrowed_array2<'py>(
+	owner: &Bound<'py, GaussianSplat>,
+	data: &[f32],
+	cols: usize,
+) -> PyResult<Bound<'py, PyArray2<f32>>> {
+	let rows = if data.is_empty() && cols > 0 {
+		0
+	} else {
+		owner.borrow().inner.header.num_points.max(0) as usize
+	};
+	let view = ArrayView2::from_shape((rows, cols), data)
+		.map_err(|e| PyValueError::new_err(format!("Inconsistent array sizes: {}", e)))?;
+
+	// SAFETY: the array keeps `owner` alive as its base, and the splat's
+	// buffers are only ever modified in place, never reallocated, so `data`
+	// stays valid for as long as the array.
+	let arr = unsafe { PyArray2::borrow_from_array(&view, owner.clone().into_any()) };
+
+	Ok(read_only(arr))
+}
+
+/// Clears the writeable flag of a freshly created array.
+fn read_only<'py, D>(arr: Bound<'py, PyArray<f32, D>>) -> Bound<'py, PyArray<f32, D>>
+where
+	D: Dimension,
+{
+	let untyped: &Bound<'py, PyUntypedArray> = arr.as_untyped();
+
+	// SAFETY: `untyped` is a valid array object, nothing else holds it yet.
+	unsafe { (*untyped.as_array_ptr()).flags &= !NPY_ARRAY_WRITEABLE };
+
+	arr
+}
+
 /// SPZ - Gaussian Splat file format library.
 ///
 /// A fast, efficient library for reading and writing SPZ files,
@@ -910,6 +1089,7 @@ pub fn read_header(path: &str) -> PyResult<Header> {
 /// * [`CoordinateSystem`] - Enumeration of coordinate systems (RUB, RDF, etc.).
 /// * [`BoundingBox`] - Axis-aligned bounding box.
 /// * [`load`] - Load a GaussianSplat from an SPZ file.
+/// * [`load_many`] - Load many SPZ files in parallel.
 ///
 /// # Examples
 ///
@@ -932,6 +1112,7 @@ pub fn spz(m: &Bound<'_, PyModule>) -> PyResult<()> {
 	m.add_class::<Header>()?;
 	m.add_class::<Version>()?;
 	m.add_function(wrap_pyfunction!(load, m)?)?;
+	m.add_function(wrap_pyfunction!(load_many, m)?)?;
 	m.add_function(wrap_pyfunction!(read_header, m)?)?;
 
 	Ok(())
@@ -0,0 +1,425 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+//! `spz convert`: re-encodes many SPZ files through a pipeline of stages.
+//!
+//! Every file goes through the stages
+//!
+//! ```text
+//! read -> inflate -> decode -> convert -> encode -> deflate -> write
+//! ```
+//!
+//! each running on its own threads and connected to the next one by a
+//! bounded queue, so one file is read while others are inflated, decoded,
+//! converted or compressed. The compute stages share [`Cores`], which lets
+//! no more threads run than there are cores, and a full queue blocks the
+//! stage feeding it, so at most [`ConvertOptions::queue_depth`] files wait
+//! between two stages and memory stays capped however many files are given.
+
+use std::collections::HashSet;
+use std::path::{Path, PathBuf};
+use std::sync::mpsc::{self, Receiver, SyncSender};
+use std::sync::{Arc, Condvar, Mutex};
+use std::thread::{self, Scope};
+
+use anyhow::{Context, Error, Result, bail};
+
+use spz::prelude::*;
+use spz::{chunked, compression, lod, packed::PackedGaussianSplatView, parallel};
+
+/// Options of a conversion, applied to every file.
+#[derive(Clone, Debug)]
+pub struct ConvertOptions {
+	/// Coordinate system the stored data is in.
+	pub from: CoordinateSystem,
+	/// Coordinate system to store the data in.
+	pub to: CoordinateSystem,
+	/// Highest spherical harmonics degree to keep, `None` keeps all.
+	pub sh_degree: Option<u8>,
+	/// Codec, level and point order of the written files. Encoding and
+	/// compression of a single file stay on one thread.
+	pub save: SaveOptions,
+	/// Number of threads per compute stage, and of threads computing at
+	/// once, `0` uses all available cores.
+	pub threads: usize,
+	/// Files each queue between two stages holds.
+	pub queue_depth: usize,
+}
+
+impl Default for ConvertOptions {
+	#[inline]
+	fn default() -> Self {
+		Self {
+			from: CoordinateSystem::Unspecified,
+			to: CoordinateSystem::Unspecified,
+			sh_degree: None,
+			save: SaveOptions::default(),
+			threads: 0,
+			queue_depth: 2,
+		}
+	}
+}
+
+/// Outcome of a conversion.
+#[derive(Debug, Default)]
+pub struct Summary {
+	/// Number of files written.
+	pub converted: usize,
+	/// Files that failed, with the error, in no particular order.
+	pub failed: Vec<(PathBuf, Error)>,
+}
+
+/// Pairs every input with its output: the file of the same name in
+/// `out_dir`.
+///
+/// # Args
+///
+/// `inputs` - the files to convert.
+/// `out_dir` - directory to write the converted files to.
+pub fn plan(inputs: &[PathBuf], out_dir: &Path) -> Result<Vec<(PathBuf, PathBuf)>> {
+	let mut outputs = HashSet::with_capacity(inputs.len());
+
+	inputs.iter()
+		.map(|input| {
+			let Some(name) = input.file_name() else {
+				bail!("not a file: {}", input.display());
+			};
+			let output = out_dir.join(name);
+
+			if !outputs.insert(output.clone()) {
+				bail!("more than one input is written to {}", output.display());
+			}
+			Ok((input.clone(), output))
+		})
+		.collect()
+}
+
+/// Converts every `(input, output)` pair of `jobs`.
+///
+/// A file that fails doesn't stop the others, it is reported in
+/// [`Summary::failed`].
+///
+/// # Args
+///
+/// `jobs` - the files to read and the files to write them to.
+/// `opts` - options of the conversion.
+pub fn convert(jobs: Vec<(PathBuf, PathBuf)>, opts: &ConvertOptions) -> Summary {
+	let workers = parallel::available_threads(opts.threads);
+	let depth = opts.queue_depth.max(1);
+	let cores = Cores::new(workers);
+	let failed = Mutex::new(Vec::new());
+	let load = LoadOptions::default();
+	let save = SaveOptions {
+		threads: 1,
+		parallel_compression: false,
+		..opts.save.clone()
+	};
+	let pipeline = Pipeline {
+		cores: &cores,
+		failed: &failed,
+		depth,
+	};
+	let converted = thread::scope(|s| {
+		let (jobs_tx, jobs_rx) = mpsc::sync_channel(depth);
+
+		s.spawn(move || {
+			for (input, output) in jobs {
+				if jobs_tx.send((Job { input, output }, ())).is_err() {
+					break;
+				}
+			}
+		});
+		let read = pipeline.stage(s, 1, false, jobs_rx, |job, ()| {
+			std::fs::read(&job.input).with_context(|| "unable to read file")
+		});
+		let inflated =
+			pipeline.stage(s, workers, true, read, |_, compressed| inflate(compressed));
+		let decoded = pipeline.stage(s, workers, true, inflated, |_, inflated| {
+			decode(&inflated, &load)
+		});
+		let converted = pipeline.stage(s, workers, true, decoded, |_, mut splat| {
+			convert_splat(&mut splat, opts);
+
+			Ok(splat)
+		});
+		let encoded = pipeline.stage(s, workers, true, converted, |_, splat| {
+			splat.to_packed_gaussians(&save)?.to_bytes_vec()
+		});
+		let deflated = pipeline.stage(s, workers, true, encoded, |_, uncompressed| {
+			let mut compressed = Vec::new();
+
+			compression::compress(
+				&uncompressed,
+				&mut compressed,
+				save.codec,
+				save.level,
+			)
+			.with_context(|| "unable to compress")?;
+
+			Ok(compressed)
+		});
+		let written = pipeline.stage(s, 1, false, deflated, |job, compressed| {
+			write(&job.output, &compressed)
+		});
+		written.iter().count()
+	});
+	Summary {
+		converted,
+		failed: failed.into_inner().unwrap_or_else(|e| e.into_inner()),
+	}
+}
+
+/// The paths of a file moving through the pipeline.
+struct Job {
+	input: PathBuf,
+	output: PathBuf,
+}
+
+/// Queue between two stages, of files with the output of the earlier one.
+type Queue<T> = Receiver<(Job, T)>;
+
+type Failures = Mutex<Vec<(PathBuf, Error)>>;
+
+/// Inflated file, or a container decoded as a whole.
+enum Inflated {
+	Packed(Vec<u8>),
+	Container(Vec<u8>),
+}
+
+/// What the stages share.
+struct Pipeline<'a> {
+	cores: &'a Cores,
+	failed: &'a Failures,
+	depth: usize,
+}
+
+impl<'a> Pipeline<'a> {
+	/// Spawns `workers` threads taking files from `input`, running `f` on
+	/// each and queueing the results to the returned queue.
+	///
+	/// The returned queue is closed once `input` is and all its files were
+	/// handled. Failed files are recorded and dropped.
+	///
+	/// # Args
+	///
+	/// `s` - scope the threads run in.
+	/// `workers` - number of threads.
+	/// `compute` - whether `f` needs a core, I/O stages don't wait for one.
+	/// `input` - queue of the previous stage.
+	/// `f` - the work on one file.
+	fn stage<'scope, I, O, F>(
+		&self,
+		s: &'scope Scope<'scope, '_>,
+		workers: usize,
+		compute: bool,
+		input: Queue<I>,
+		f: F,
+	) -> Queue<O>
+	where
+		'a: 'scope,
+		I: Send + 'scope,
+		O: Send + 'scope,
+		F: Fn(&Job, I) -> Result<O> + Send + Sync + 'scope,
+	{
+		let (tx, rx) = mpsc::sync_channel(self.depth);
+		let stage = Arc::new(Stage {
+			input: Mutex::new(input),
+			f,
+			cores: compute.then_some(self.cores),
+			failed: self.failed,
+		});
+		for _ in 0..workers.max(1) {
+			let stage = Arc::clone(&stage);
+			let tx = tx.clone();
+
+			s.spawn(move || stage.run(&tx));
+		}
+		rx
+	}
+}
+
+struct Stage<'a, I, F> {
+	/// Shared by the workers, which take turns waiting for the next file.
+	input: Mutex<Queue<I>>,
+	f: F,
+	cores: Option<&'a Cores>,
+	failed: &'a Failures,
+}
+
+impl<I, F> Stage<'_, I, F> {
+	fn run<O>(&self, output: &SyncSender<(Job, O)>)
+	where
+		F: Fn(&Job, I) -> Result<O>,
+	{
+		loop {
+			let next = self.input.lock().unwrap_or_else(|e| e.into_inner()).recv();
+			let Ok((job, data)) = next else {
+				return;
+			};
+			let result = {
+				let _core = self.cores.map(Cores::acquire);
+
+				(self.f)(&job, data)
+			};
+			match result {
+				Ok(data) => {
+					if output.send((job, data)).is_err() {
+						return;
+					}
+				},
+				Err(e) => self
+					.failed
+					.lock()
+					.unwrap_or_else(|e| e.into_inner())
+					.push((job.input, e)),
+			}
+		}
+	}
+}
+
+/// Counts the cores free for compute stages.
+struct Cores {
+	free: Mutex<usize>,
+	changed: Condvar,
+}
+
+/// A core taken with [`Cores::acquire`], freed on drop.
+struct Core<'a>(&'a Cores);
+
+impl Cores {
+	fn new(cores: usize) -> Self {
+		Self {
+			free: Mutex::new(cores.max(1)),
+			changed: Condvar::new(),
+		}
+	}
+
+	/// Waits for a free core and takes it.
+	fn acquire(&self) -> Core<'_> {
+		let mut free = self.free.lock().unwrap_or_else(|e| e.into_inner());
+
+		while *free == 0 {
+			free = self.changed.wait(free).unwrap_or_else(|e| e.into_inner());
+		}
+		*free -= 1;
+
+		Core(self)
+	}
+}
+
+impl Drop for Core<'_> {
+	fn drop(&mut self) {
+		*self.0.free.lock().unwrap_or_else(|e| e.into_inner()) += 1;
+		self.0.changed.notify_one();
+	}
+}
+
+fn inflate(compressed: Vec<u8>) -> Result<Inflated> {
+	if chunked::is_chunked(&compressed) || lod::is_progressive(&compressed) {
+		return Ok(Inflated::Container(compressed));
+	}
+	let mut decompressed = Vec::new();
+
+	compression::decompress(&compressed, &mut decompressed, 1)
+		.with_context(|| "unable to decompress data")?;
+
+	Ok(Inflated::Packed(decompressed))
+}
+
+fn decode(inflated: &Inflated, opts: &LoadOptions) -> Result<GaussianSplat> {
+	match inflated {
+		Inflated::Packed(decompressed) => {
+			let packed = PackedGaussianSplatView::try_from(decompressed.as_slice())?;
+
+			GaussianSplat::new_from_packed_gaussians(&packed, opts)
+		},
+		Inflated::Container(compressed) => GaussianSplat::read_from_bytes(compressed, opts),
+	}
+	.with_context(|| "unable to parse splat")
+}
+
+fn convert_splat(splat: &mut GaussianSplat, opts: &ConvertOptions) {
+	if let Some(degree) = opts.sh_degree {
+		splat.truncate_spherical_harmonics(degree);
+	}
+	splat.convert_coordinates(opts.from, opts.to);
+}
+
+fn write(path: &Path, compressed: &[u8]) -> Result<()> {
+	if let Some(dir) = path.parent().filter(|dir| !dir.as_os_str().is_empty()) {
+		std::fs::create_dir_all(dir)?;
+	}
+	std::fs::write(path, compressed).with_context(|| "unable to write to file")
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+	use spz::test_util::splat;
+
+	#[test]
+	fn test_convert_pipeline() {
+		let root = std::env::temp_dir().join(format!("spz-convert-{}", std::process::id()));
+		let out_dir = root.join("out");
+		let mut inputs = Vec::new();
+
+		std::fs::create_dir_all(&root).unwrap();
+
+		for i in 0..6 {
+			let input = root.join(format!("{i}.spz"));
+
+			splat(100 + i, 2)
+				.save(&input, &SaveOptions::default())
+				.unwrap();
+			inputs.push(input);
+		}
+		let broken = root.join("broken.spz");
+
+		std::fs::write(&broken, b"not gzip").unwrap();
+		inputs.push(broken.clone());
+
+		let opts = ConvertOptions {
+			from: CoordinateSystem::RightUpBack,
+			to: CoordinateSystem::RightDownFront,
+			sh_degree: Some(1),
+			threads: 3,
+			queue_depth: 1,
+			..Default::default()
+		};
+		let summary = convert(plan(&inputs, &out_dir).unwrap(), &opts);
+
+		assert_eq!(summary.converted, 6);
+		assert_eq!(summary.failed.len(), 1);
+		assert_eq!(summary.failed[0].0, broken);
+
+		for (i, input) in inputs.iter().take(6).enumerate() {
+			let original = GaussianSplat::load(input).unwrap();
+			let converted =
+				GaussianSplat::load(out_dir.join(format!("{i}.spz"))).unwrap();
+
+			assert_eq!(converted.header.num_points, 100 + i as i32);
+			assert_eq!(converted.header.spherical_harmonics_degree, 1);
+
+			for (a, b) in original
+				.positions
+				.chunks_exact(3)
+				.zip(converted.positions.chunks_exact(3))
+			{
+				assert!((a[0] - b[0]).abs() < 1e-3);
+				assert!((a[1] + b[1]).abs() < 1e-3);
+				assert!((a[2] + b[2]).abs() < 1e-3);
+			}
+		}
+		std::fs::remove_dir_all(&root).unwrap();
+	}
+
+	#[test]
+	fn test_plan_rejects_clashing_outputs() {
+		let inputs = [PathBuf::from("a/x.spz"), PathBuf::from("b/x.spz")];
+
+		assert!(plan(&inputs, Path::new("out")).is_err());
+		assert_eq!(
+			plan(&inputs[..1], Path::new("out")).unwrap(),
+			[(inputs[0].clone(), PathBuf::from("out/x.spz"))]
+		);
+	}
+}
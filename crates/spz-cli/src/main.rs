@@ -3,11 +3,14 @@
 use std::path::{Path, PathBuf};
 use std::process::ExitCode;
 
-use anyhow::{Context, Result};
+use anyhow::{Context, Result, bail};
 use clap::{Parser, Subcommand};
 
 use spz::prelude::*;
 
+mod convert;
+mod scan;
+
 /// CLI for SPZ (Gaussian Splat) files.
 #[derive(Parser, Debug)]
 #[command(name = "spz")]
@@ -24,7 +27,8 @@ enum Commands {
 	///
 	/// Provides efficient access to metadata without loading the entire
 	/// file, useful for quick inspection.
-	/// Parses/Loads only the 1st 512 bytes of the file.
+	/// Parses/Loads only the 1st 512 bytes of the file, chunked and
+	/// progressive files are read whole for their index.
 	Metainfo {
 		/// Path to the SPZ file.
 		spz_path: PathBuf,
@@ -34,6 +38,129 @@ enum Commands {
 		/// Path to the SPZ file.
 		spz_path: PathBuf,
 	},
+	/// Read the header of every SPZ file in some directories, in parallel.
+	///
+	/// Walks the directories recursively and prints one line per `.spz`
+	/// file: size, validity, version, points, SH degree, fractional bits and
+	/// flags. Only the first 512 bytes of each file are mapped.
+	Scan {
+		/// Directories to walk, or files to read.
+		#[arg(required = true)]
+		paths: Vec<PathBuf>,
+		/// Output format: `json` lines or `csv`.
+		#[arg(long, default_value = "json")]
+		format: scan::Format,
+		/// Number of threads, `0` uses all available cores. Each has at most
+		/// one file or directory open.
+		#[arg(long, default_value_t = 0)]
+		threads: usize,
+	},
+	/// Recompress an SPZ file with another codec or compression level.
+	///
+	/// The gaussian data is decoded and encoded again unchanged, apart from the
+	/// point order when asked for.
+	Recompress {
+		/// Path to the SPZ file to read.
+		input: PathBuf,
+		/// Path to the SPZ file to write.
+		output: PathBuf,
+		/// Compression format: `gzip`, or `zstd` for caches only readable
+		/// by this library.
+		#[arg(long, default_value = "gzip")]
+		codec: Codec,
+		/// Compression level: `fast`, `default`, `best` or a codec specific
+		/// number.
+		#[arg(long, default_value = "default")]
+		level: CompressionLevel,
+		/// Number of threads, `0` uses all available cores.
+		#[arg(long, default_value_t = 0)]
+		threads: usize,
+		/// Compress into a multi-member gzip stream on several threads, which
+		/// this library also inflates in parallel.
+		#[arg(long)]
+		parallel: bool,
+		/// Point order: `original`, or `morton` / `hilbert` to sort the points
+		/// along a space filling curve for smaller files.
+		#[arg(long, default_value = "original")]
+		order: PointOrder,
+	},
+	/// Convert an SPZ file between coordinate systems without decoding it.
+	///
+	/// Flips the signs of the quantized values directly, so nothing is
+	/// quantized twice. The codec of the input is kept.
+	Transcode {
+		/// Path to the SPZ file to read.
+		input: PathBuf,
+		/// Path to the SPZ file to write, may be the input.
+		output: PathBuf,
+		/// Coordinate system the stored data is in.
+		#[arg(long, value_parser = parse_coord_sys)]
+		from: CoordinateSystem,
+		/// Coordinate system to store the data in.
+		#[arg(long, value_parser = parse_coord_sys)]
+		to: CoordinateSystem,
+		/// Compression level: `fast`, `default`, `best` or a codec specific
+		/// number.
+		#[arg(long, default_value = "default")]
+		level: CompressionLevel,
+	},
+	/// Convert many SPZ files into a directory, in a pipeline.
+	///
+	/// Reading, inflating, decoding, converting, encoding, compressing and
+	/// writing run as stages on their own threads, so several files are in
+	/// flight at once.
+	Convert {
+		/// Paths of the SPZ files to read.
+		#[arg(required = true)]
+		inputs: Vec<PathBuf>,
+		/// Directory to write the converted files to, under the same names.
+		#[arg(long, short)]
+		out_dir: PathBuf,
+		/// Coordinate system the stored data is in.
+		#[arg(long, default_value = "unspecified", value_parser = parse_coord_sys)]
+		from: CoordinateSystem,
+		/// Coordinate system to store the data in, axes are flipped from
+		/// `--from` to it.
+		#[arg(long, default_value = "unspecified", value_parser = parse_coord_sys)]
+		to: CoordinateSystem,
+		/// Highest spherical harmonics degree to keep, `0`-`3`.
+		#[arg(long, value_parser = clap::value_parser!(u8).range(0..=3))]
+		sh_degree: Option<u8>,
+		/// Compression format: `gzip`, or `zstd` for caches only readable
+		/// by this library.
+		#[arg(long, default_value = "gzip")]
+		codec: Codec,
+		/// Compression level: `fast`, `default`, `best` or a codec specific
+		/// number.
+		#[arg(long, default_value = "default")]
+		level: CompressionLevel,
+		/// Point order: `original`, `morton` or `hilbert`.
+		#[arg(long, default_value = "original")]
+		order: PointOrder,
+		/// Number of threads per stage, and of files processed at once, `0`
+		/// uses all available cores.
+		#[arg(long, default_value_t = 0)]
+		threads: usize,
+		/// Number of files queued between two stages, caps memory use.
+		#[arg(long, default_value_t = 2)]
+		queue_depth: usize,
+	},
+	/// Write a memory-mapped cache file next to each SPZ file.
+	///
+	/// The cache of `scene.spz` is `scene.spz.cache`, holding the decoded
+	/// attributes, for loading without decompressing or decoding. Caches that
+	/// are up to date are left alone.
+	Cache {
+		/// Paths of the SPZ files to cache.
+		#[arg(required = true)]
+		inputs: Vec<PathBuf>,
+		/// Coordinate system to store the decoded data in.
+		#[arg(long, default_value = "unspecified", value_parser = parse_coord_sys)]
+		coord_sys: CoordinateSystem,
+		/// Rebuild caches that are up to date.
+		#[arg(long)]
+		force: bool,
+	},
 }
 
 fn main() -> Result<ExitCode> {
@@ -53,6 +180,70 @@ fn run() -> Result<()> {
 	match cli.command {
 		Commands::Metainfo { spz_path: file } => cmd_metainfo(&file),
 		Commands::Info { spz_path: file } => cmd_info(&file),
+		Commands::Scan {
+			paths,
+			format,
+			threads,
+		} => cmd_scan(&paths, format, threads),
+		Commands::Transcode {
+			input,
+			output,
+			from,
+			to,
+			level,
+		} => spz::transcode::convert_file(&input, &output, from, to, level)
+			.with_context(|| format!("failed to transcode SPZ file: {input:?}")),
+		Commands::Convert {
+			inputs,
+			out_dir,
+			from,
+			to,
+			sh_degree,
+			codec,
+			level,
+			order,
+			threads,
+			queue_depth,
+		} => cmd_convert(
+			&inputs,
+			&out_dir,
+			&convert::ConvertOptions {
+				from,
+				to,
+				sh_degree,
+				save: SaveOptions::builder()
+					.codec(codec)
+					.level(level)
+					.order(order)
+					.build(),
+				threads,
+				queue_depth,
+			},
+		),
+		Commands::Recompress {
+			input,
+			output,
+			codec,
+			level,
+			threads,
+			parallel,
+			order,
+		} => cmd_recompress(
+			&input,
+			&output,
+			&SaveOptions::builder()
+				.codec(codec)
+				.level(level)
+				.threads(threads)
+				.parallel_compression(parallel)
+				.order(order)
+				.build(),
+		),
+		Commands::Cache {
+			inputs,
+			coord_sys,
+			force,
+		} => cmd_cache(&inputs, coord_sys, force),
 	}
 }
 
@@ -60,14 +251,94 @@ fn cmd_info<P>(spz_path: P) -> Result<()>
 where
 	P: AsRef<Path>,
 {
-	let gs = GaussianSplat::load(spz_path.as_ref())
+	let info = info(spz_path.as_ref())
 		.with_context(|| format!("failed to load SPZ file: {:?}", spz_path.as_ref()))?;
 
-	print!("{}", gs.pretty_fmt());
+	print!("{info}");
 
 	Ok(())
 }
 
+/// The report of `spz info` for the file at `spz_path`.
+fn info(spz_path: &Path) -> Result<String> {
+	let bytes = spz::mmap::read_or_map(spz_path)?;
+	let opts = LoadOptions::default();
+
+	// a chunked file has no single packed stream for the lazy statistics,
+	// its chunks are decoded instead
+	if spz::chunked::is_chunked(&bytes) {
+		return Ok(ChunkedSpz::from_bytes(&*bytes)?
+			.load_all(&opts)?
+			.pretty_fmt());
+	}
+	// the statistics are read from the quantized data, nothing is decoded
+	let lazy = LazyGaussianSplat::from_bytes(&bytes, &opts, AttributeMask::empty())?;
+
+	Ok(lazy.pretty_fmt())
+}
+
+fn cmd_recompress<P>(input: P, output: P, opts: &SaveOptions) -> Result<()>
+where
+	P: AsRef<Path>,
+{
+	let gs = GaussianSplat::load(input.as_ref())
+		.with_context(|| format!("failed to load SPZ file: {:?}", input.as_ref()))?;
+
+	gs.save(output.as_ref(), opts)
+		.with_context(|| format!("failed to save SPZ file: {:?}", output.as_ref()))
+}
+
+fn cmd_convert(inputs: &[PathBuf], out_dir: &Path, opts: &convert::ConvertOptions) -> Result<()> {
+	let jobs = convert::plan(inputs, out_dir)?;
+	let summary = convert::convert(jobs, opts);
+
+	for (input, err) in &summary.failed {
+		eprintln!("error: {}: {err:#}", input.display());
+	}
+	eprintln!(
+		"converted {} files, {} failed",
+		summary.converted,
+		summary.failed.len()
+	);
+	if !summary.failed.is_empty() {
+		bail!("{} files failed to convert", summary.failed.len());
+	}
+	Ok(())
+}
+
+fn cmd_cache(inputs: &[PathBuf], coord_sys: CoordinateSystem, force: bool) -> Result<()> {
+	let opts = LoadOptions::builder().coord_sys(coord_sys).build();
+	let mut built = 0;
+
+	for input in inputs {
+		let fresh = !force
+			&& spz::cache::CachedGaussianSplat::open_for(input)
+				.ok()
+				.flatten()
+				.is_some_and(|cached| cached.coord_sys() == coord_sys);
+
+		if fresh {
+			continue;
+		}
+		spz::cache::build(input, spz::cache::cache_path(input), &opts)
+			.with_context(|| format!("failed to cache SPZ file: {input:?}"))?;
+		built += 1;
+	}
+	eprintln!("built {built} caches, {} up to date", inputs.len() - built);
+	Ok(())
+}
+
+fn cmd_scan(paths: &[PathBuf], format: scan::Format, threads: usize) -> Result<()> {
+	let out = std::io::BufWriter::new(std::io::stdout());
+	let summary = scan::scan(paths, format, threads, out)?;
+
+	eprintln!(
+		"scanned {} files, {} invalid",
+		summary.files, summary.invalid
+	);
+	Ok(())
+}
+
 fn cmd_metainfo<P>(spz_path: P) -> Result<()>
 where
 	P: AsRef<Path>,
@@ -79,3 +350,41 @@ where
 
 	Ok(())
 }
+
+fn parse_coord_sys(s: &str) -> Result<CoordinateSystem> {
+	let coord_sys = CoordinateSystem::from(s);
+
+	if coord_sys == CoordinateSystem::Unspecified && !s.eq_ignore_ascii_case("unspecified") {
+		bail!("invalid coordinate system: {s}");
+	}
+	Ok(coord_sys)
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+	use spz::test_util::splat;
+
+	#[test]
+	fn test_info_reads_chunked_files() {
+		let dir = std::env::temp_dir();
+		let plain = dir.join(format!("spz-info-{}.spz", std::process::id()));
+		let chunked = dir.join(format!("spz-info-chunked-{}.spz", std::process::id()));
+		let gs = splat(2000, 1);
+
+		gs.save(&plain, &SaveOptions::default()).unwrap();
+		spz::chunked::save_chunked(&gs, &chunked, &SaveOptions::default(), 500).unwrap();
+
+		let plain_info = info(&plain).unwrap();
+		let chunked_info = info(&chunked).unwrap();
+
+		let _ = std::fs::remove_file(&plain);
+		let _ = std::fs::remove_file(&chunked);
+
+		let lines =
+			|info: &str| info.lines().take(4).map(str::to_owned).collect::<Vec<_>>();
+
+		assert!(chunked_info.contains("Number of points:\t\t2000\n"));
+		assert_eq!(lines(&chunked_info), lines(&plain_info));
+	}
+}
@@ -0,0 +1,472 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+//! `spz scan`: reads only the headers of every SPZ file below some
+//! directories, in parallel.
+//!
+//! Workers share a stack of directories to walk. Each lists one directory
+//! at a time, closing it before reading the headers of its files, and maps
+//! at most [`COMPRESSED_BLOCK_READ_SIZE`] bytes of one file at a time, so
+//! open file descriptors stay bounded by the number of workers. The header
+//! is inflated with a [`Inflater`] reused across files.
+
+use std::fmt::Write as _;
+use std::io::Write;
+use std::path::{Path, PathBuf};
+use std::str::FromStr;
+use std::sync::{Condvar, Mutex};
+
+use anyhow::{Error, Result, anyhow, bail};
+
+use spz::compression::gzip::Inflater;
+use spz::header::{COMPRESSED_BLOCK_READ_SIZE, Header};
+use spz::{container, mmap, parallel};
+
+/// Records buffered per worker before they are written out.
+const FLUSH_SIZE: usize = 64 * 1024;
+
+/// Output format of the scan, one line per file.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub enum Format {
+	/// JSON lines.
+	#[default]
+	Json,
+	/// CSV, with a header row.
+	Csv,
+}
+
+impl FromStr for Format {
+	type Err = Error;
+
+	#[inline]
+	fn from_str(s: &str) -> Result<Self, Self::Err> {
+		match s.to_lowercase().as_ref() {
+			"json" | "jsonl" | "ndjson" => Ok(Format::Json),
+			"csv" => Ok(Format::Csv),
+			_ => Err(anyhow!("invalid output format: {}", s)),
+		}
+	}
+}
+
+/// Totals of a scan.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct Summary {
+	pub files: usize,
+	/// Files whose header couldn't be read or failed validation.
+	pub invalid: usize,
+}
+
+/// Scans `roots`, directories walked recursively for `.spz` files or files
+/// read as given, and writes a record per file to `out`.
+///
+/// Records are written in no particular order.
+///
+/// # Args
+///
+/// `roots` - directories and files to scan.
+/// `format` - output format.
+/// `threads` - number of workers, `0` uses all available cores.
+/// `out` - destination of the records.
+pub fn scan<W>(roots: &[PathBuf], format: Format, threads: usize, out: W) -> Result<Summary>
+where
+	W: Write + Send,
+{
+	let out = Mutex::new(out);
+	let queue = Queue::default();
+	let mut files = Vec::new();
+
+	for root in roots {
+		if root.is_dir() {
+			queue.push(vec![root.clone()]);
+		} else if root.exists() {
+			files.push(root.clone());
+		} else {
+			bail!("no such file or directory: {}", root.display());
+		}
+	}
+	if format == Format::Csv {
+		writeln!(
+			out.lock().unwrap_or_else(|e| e.into_inner()),
+			"path,size,valid,version,num_points,sh_degree,fractional_bits,flags,error"
+		)?;
+	}
+	let workers = parallel::available_threads(threads);
+	let jobs = (0..workers)
+		.map(|worker| Worker {
+			queue: &queue,
+			out: &out,
+			format,
+			inflater: Inflater::new(),
+			records: String::new(),
+			summary: Summary::default(),
+			files: if worker == 0 {
+				std::mem::take(&mut files)
+			} else {
+				Vec::new()
+			},
+		})
+		.collect();
+	let summary = Mutex::new(Summary::default());
+
+	parallel::try_run(jobs, |mut worker: Worker<'_, W>| {
+		let result = worker.run();
+		let mut summary = summary.lock().unwrap_or_else(|e| e.into_inner());
+
+		summary.files += worker.summary.files;
+		summary.invalid += worker.summary.invalid;
+
+		result
+	})?;
+	out.into_inner()
+		.unwrap_or_else(|e| e.into_inner())
+		.flush()?;
+
+	Ok(summary.into_inner().unwrap_or_else(|e| e.into_inner()))
+}
+
+/// Directories left to walk, shared by the workers.
+#[derive(Default)]
+struct Queue {
+	state: Mutex<QueueState>,
+	changed: Condvar,
+}
+
+#[derive(Default)]
+struct QueueState {
+	dirs: Vec<PathBuf>,
+	/// Workers walking a directory, which may push more.
+	busy: usize,
+}
+
+impl Queue {
+	fn push(&self, dirs: Vec<PathBuf>) {
+		if dirs.is_empty() {
+			return;
+		}
+		let mut state = self.state.lock().unwrap_or_else(|e| e.into_inner());
+
+		state.dirs.extend(dirs);
+		self.changed.notify_all();
+	}
+
+	/// Takes a directory to walk, `None` once every directory was walked.
+	fn pop(&self) -> Option<PathBuf> {
+		let mut state = self.state.lock().unwrap_or_else(|e| e.into_inner());
+
+		loop {
+			if let Some(dir) = state.dirs.pop() {
+				state.busy += 1;
+
+				return Some(dir);
+			}
+			if state.busy == 0 {
+				return None;
+			}
+			state = self.changed.wait(state).unwrap_or_else(|e| e.into_inner());
+		}
+	}
+
+	/// Marks a directory taken with [`Queue::pop`] as walked.
+	fn done(&self) {
+		let mut state = self.state.lock().unwrap_or_else(|e| e.into_inner());
+
+		state.busy -= 1;
+
+		if state.busy == 0 && state.dirs.is_empty() {
+			self.changed.notify_all();
+		}
+	}
+}
+
+struct Worker<'a, W> {
+	queue: &'a Queue,
+	out: &'a Mutex<W>,
+	format: Format,
+	inflater: Inflater,
+	/// Formatted records not yet written to `out`.
+	records: String,
+	summary: Summary,
+	/// Files to scan before walking directories.
+	files: Vec<PathBuf>,
+}
+
+impl<W> Worker<'_, W>
+where
+	W: Write,
+{
+	fn run(&mut self) -> Result<()> {
+		for file in std::mem::take(&mut self.files) {
+			self.scan_file(&file)?;
+		}
+		while let Some(dir) = self.queue.pop() {
+			let result = self.walk(&dir);
+
+			self.queue.done();
+			result?;
+		}
+		self.flush()
+	}
+
+	fn walk(&mut self, dir: &Path) -> Result<()> {
+		let mut dirs = Vec::new();
+		let mut files = Vec::new();
+
+		// list the whole directory first, closing it before opening files
+		match std::fs::read_dir(dir) {
+			Ok(entries) => {
+				for entry in entries.flatten() {
+					let Ok(file_type) = entry.file_type() else {
+						continue;
+					};
+					let path = entry.path();
+
+					if file_type.is_dir() {
+						dirs.push(path);
+					} else if file_type.is_file() && is_spz(&path) {
+						files.push(path);
+					}
+				}
+			},
+			Err(e) => eprintln!("warning: unable to read {}: {e}", dir.display()),
+		}
+		self.queue.push(dirs);
+
+		for file in files {
+			self.scan_file(&file)?;
+		}
+		Ok(())
+	}
+
+	fn scan_file(&mut self, path: &Path) -> Result<()> {
+		let record = read_header(path, &mut self.inflater);
+
+		self.summary.files += 1;
+
+		if !matches!(record, Ok((_, header)) if header.is_valid()) {
+			self.summary.invalid += 1;
+		}
+		match self.format {
+			Format::Json => json_record(&mut self.records, path, &record),
+			Format::Csv => csv_record(&mut self.records, path, &record),
+		}
+		if self.records.len() >= FLUSH_SIZE {
+			self.flush()?;
+		}
+		Ok(())
+	}
+
+	fn flush(&mut self) -> Result<()> {
+		if !self.records.is_empty() {
+			self.out.lock()
+				.unwrap_or_else(|e| e.into_inner())
+				.write_all(self.records.as_bytes())?;
+			self.records.clear();
+		}
+		Ok(())
+	}
+}
+
+#[inline]
+fn is_spz(path: &Path) -> bool {
+	path.extension()
+		.is_some_and(|extension| extension.eq_ignore_ascii_case("spz"))
+}
+
+/// Reads the size and header of the file at `path`, mapping only its first
+/// block, or the whole file for a chunked or progressive one.
+fn read_header(path: &Path, inflater: &mut Inflater) -> Result<(u64, Header)> {
+	let size = std::fs::metadata(path)?.len();
+
+	if size == 0 {
+		bail!("file is empty");
+	}
+	// never map past the end of the file, touching those pages faults
+	let len = size.min(u64::from(COMPRESSED_BLOCK_READ_SIZE)) as usize;
+	let mut block = mmap::read_or_map_range(path, 0, len)?;
+
+	if container::is_container(&block) {
+		block = mmap::read_or_map(path)?;
+	}
+	Ok((
+		size,
+		Header::from_compressed_bytes_unchecked_with(&block, inflater)?,
+	))
+}
+
+fn json_record(out: &mut String, path: &Path, record: &Result<(u64, Header)>) {
+	out.push_str("{\"path\":");
+	json_string(out, &path.to_string_lossy());
+
+	match record {
+		Ok((size, header)) => {
+			let _ = write!(
+				out,
+				",\"size\":{size},\"valid\":{},\"version\":{},\"num_points\":{},\"sh_degree\":{},\"fractional_bits\":{},\"flags\":{}",
+				header.is_valid(),
+				header.version as i32,
+				header.num_points,
+				header.spherical_harmonics_degree,
+				header.fractional_bits,
+				header.flags.0,
+			);
+		},
+		Err(e) => {
+			out.push_str(",\"valid\":false,\"error\":");
+			json_string(out, &format!("{e:#}"));
+		},
+	}
+	out.push_str("}\n");
+}
+
+fn json_string(out: &mut String, s: &str) {
+	out.push('"');
+
+	for c in s.chars() {
+		match c {
+			'"' => out.push_str("\\\""),
+			'\\' => out.push_str("\\\\"),
+			'\n' => out.push_str("\\n"),
+			'\r' => out.push_str("\\r"),
+			'\t' => out.push_str("\\t"),
+			c if c < ' ' => {
+				let _ = write!(out, "\\u{:04x}", c as u32);
+			},
+			c => out.push(c),
+		}
+	}
+	out.push('"');
+}
+
+fn csv_record(out: &mut String, path: &Path, record: &Result<(u64, Header)>) {
+	csv_field(out, &path.to_string_lossy());
+
+	match record {
+		Ok((size, header)) => {
+			let _ = writeln!(
+				out,
+				",{size},{},{},{},{},{},{},",
+				header.is_valid(),
+				header.version as i32,
+				header.num_points,
+				header.spherical_harmonics_degree,
+				header.fractional_bits,
+				header.flags.0,
+			);
+		},
+		Err(e) => {
+			out.push_str(",,false,,,,,,");
+			csv_field(out, &format!("{e:#}"));
+			out.push('\n');
+		},
+	}
+}
+
+fn csv_field(out: &mut String, s: &str) {
+	if s.contains([',', '"', '\n', '\r']) {
+		out.push('"');
+		out.push_str(&s.replace('"', "\"\""));
+		out.push('"');
+	} else {
+		out.push_str(s);
+	}
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+	use spz::prelude::*;
+	use spz::test_util::splat;
+
+	fn write_splat(path: &Path, num_points: usize) {
+		splat(num_points, 0)
+			.save(path, &SaveOptions::default())
+			.unwrap();
+	}
+
+	#[test]
+	fn test_scan_walks_directories() {
+		let root = std::env::temp_dir().join(format!("spz-scan-{}", std::process::id()));
+		let nested = root.join("a").join("b");
+
+		std::fs::create_dir_all(&nested).unwrap();
+		write_splat(&root.join("one.spz"), 10);
+		write_splat(&nested.join("two.SPZ"), 2000);
+		std::fs::write(nested.join("broken.spz"), b"not gzip").unwrap();
+		std::fs::write(nested.join("empty.spz"), b"").unwrap();
+		std::fs::write(root.join("skipped.txt"), b"not an spz file").unwrap();
+
+		for format in [Format::Json, Format::Csv] {
+			let mut out = Vec::new();
+			let summary =
+				scan(std::slice::from_ref(&root), format, 3, &mut out).unwrap();
+			let out = String::from_utf8(out).unwrap();
+
+			assert_eq!(
+				summary,
+				Summary {
+					files: 4,
+					invalid: 2
+				}
+			);
+			assert_eq!(out.lines().count(), 4 + usize::from(format == Format::Csv));
+			if format == Format::Json {
+				assert!(out.contains("\"num_points\":2000,"));
+				assert!(out.contains("\"valid\":false,\"error\":\"file is empty\""));
+			} else {
+				assert!(out.contains(",true,3,10,0,12,0,\n"));
+			}
+		}
+		std::fs::remove_dir_all(&root).unwrap();
+	}
+
+	#[test]
+	fn test_scan_reads_container_headers() {
+		let root = std::env::temp_dir()
+			.join(format!("spz-scan-containers-{}", std::process::id()));
+		let gs = splat(2000, 1);
+
+		std::fs::create_dir_all(&root).unwrap();
+		spz::chunked::save_chunked(
+			&gs,
+			root.join("chunked.spz"),
+			&SaveOptions::default(),
+			500,
+		)
+		.unwrap();
+		std::fs::write(
+			root.join("progressive.spz"),
+			spz::lod::serialize_progressive(
+				&gs,
+				&SaveOptions::default(),
+				&spz::lod::LodOptions::default(),
+			)
+			.unwrap(),
+		)
+		.unwrap();
+
+		let mut out = Vec::new();
+		let summary = scan(std::slice::from_ref(&root), Format::Json, 2, &mut out).unwrap();
+		let out = String::from_utf8(out).unwrap();
+
+		assert_eq!(
+			summary,
+			Summary {
+				files: 2,
+				invalid: 0
+			}
+		);
+		assert_eq!(out.matches("\"num_points\":2000,").count(), 2, "{out}");
+		std::fs::remove_dir_all(&root).unwrap();
+	}
+
+	#[test]
+	fn test_record_escaping() {
+		let mut out = String::new();
+
+		json_string(&mut out, "a\"b\\c\n\u{1}");
+		assert_eq!(out, r#""a\"b\\c\n\u0001""#);
+
+		out.clear();
+		csv_field(&mut out, "a,\"b\"");
+		assert_eq!(out, r#""a,""b""""#);
+	}
+}
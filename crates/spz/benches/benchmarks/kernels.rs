@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+use std::hint::black_box;
+
+use codspeed_criterion_compat::{Criterion, Throughput};
+use spz::kernels::{self, scalar};
+
+use crate::benchmarks::util;
+
+const NUM_POINTS: usize = 1_000_000;
+
+type Kernel = fn(&[u8], &mut [f32]);
+
+pub fn bench_decode_kernels(c: &mut Criterion) {
+	let packed = util::create_splat(NUM_POINTS as i32)
+		.to_packed_gaussians(&Default::default())
+		.unwrap();
+
+	let mut group = c.benchmark_group("decode_kernels");
+
+	group.throughput(Throughput::Elements(NUM_POINTS as u64));
+
+	let mut positions = vec![0.0_f32; NUM_POINTS * 3];
+
+	group.bench_function("positions", |b| {
+		b.iter(|| {
+			kernels::decode_positions(black_box(&packed.positions), &mut positions, 12)
+		});
+	});
+	group.bench_function("positions_scalar", |b| {
+		b.iter(|| {
+			scalar::decode_positions(black_box(&packed.positions), &mut positions, 12)
+		});
+	});
+	let mut rotations = vec![0.0_f32; NUM_POINTS * 4];
+
+	group.bench_function("rotations", |b| {
+		b.iter(|| {
+			kernels::decode_rotations(
+				black_box(&packed.rotations),
+				&mut rotations,
+				true,
+			)
+		});
+	});
+	let byte_kernels: [(&str, &[u8], Kernel, Kernel); 4] = [
+		(
+			"scales",
+			&packed.scales,
+			kernels::decode_scales,
+			scalar::decode_scales,
+		),
+		(
+			"alphas",
+			&packed.alphas,
+			kernels::decode_alphas,
+			scalar::decode_alphas,
+		),
+		(
+			"colors",
+			&packed.colors,
+			kernels::decode_colors,
+			scalar::decode_colors,
+		),
+		(
+			"spherical_harmonics",
+			&packed.spherical_harmonics,
+			kernels::decode_spherical_harmonics,
+			scalar::decode_spherical_harmonics,
+		),
+	];
+	for (name, src, kernel, reference) in byte_kernels {
+		let mut dst = vec![0.0_f32; src.len()];
+
+		group.bench_function(name, |b| b.iter(|| kernel(black_box(src), &mut dst)));
+		group.bench_function(format!("{name}_scalar"), |b| {
+			b.iter(|| reference(black_box(src), &mut dst))
+		});
+	}
+	group.finish();
+}
@@ -1,6 +1,8 @@
 // SPDX-License-Identifier: Apache-2.0 OR MIT
 
+pub mod kernels;
 pub mod load;
+pub mod pipeline;
 pub mod print_info;
 pub mod save;
 mod util;
@@ -0,0 +1,156 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+//! Per stage benchmarks of the load and save pipelines.
+//!
+//! Every stage is measured on its own over a matrix of point counts and
+//! spherical harmonics degrees, so a regression points at either the codec or
+//! the math. Codec stages (inflate, parse, deflate) report MB/s of packed
+//! data, the math stages points/s. The peak RSS of one run of every stage is
+//! printed to stderr.
+//!
+//! The point counts default to [`DEFAULT_POINTS`] and can be overridden with
+//! a comma separated `SPZ_BENCH_POINTS`, e.g. `10000,10000000`.
+
+use std::hint::black_box;
+
+use codspeed_criterion_compat::{Criterion, Throughput};
+use spz::{
+	compression,
+	coord::CoordinateSystem,
+	gaussian_splat::{GaussianSplat, LoadOptions, SaveOptions},
+	packed::PackedGaussianSplatView,
+};
+
+use crate::benchmarks::util;
+
+const DEFAULT_POINTS: [usize; 3] = [10_000, 100_000, 1_000_000];
+
+/// One input of the matrix: a splat with its packed and compressed forms.
+struct Case {
+	name: String,
+	splat: GaussianSplat,
+	packed: Vec<u8>,
+	compressed: Vec<u8>,
+}
+
+impl Case {
+	fn new(name: String, splat: GaussianSplat) -> Self {
+		let packed = splat
+			.to_packed_gaussians(&SaveOptions::default())
+			.unwrap()
+			.to_bytes_vec()
+			.unwrap();
+		let mut compressed = Vec::new();
+
+		compression::gzip::compress_bytes(&packed, &mut compressed).unwrap();
+
+		Self {
+			name,
+			splat,
+			packed,
+			compressed,
+		}
+	}
+}
+
+fn point_counts() -> Vec<usize> {
+	std::env::var("SPZ_BENCH_POINTS")
+		.ok()
+		.map(|v| {
+			v.split(',')
+				.filter_map(|n| n.trim().replace('_', "").parse().ok())
+				.collect::<Vec<usize>>()
+		})
+		.filter(|points| !points.is_empty())
+		.unwrap_or_else(|| DEFAULT_POINTS.to_vec())
+}
+
+/// Runs `stage` once to record its peak RSS, then benchmarks it.
+fn bench_stage<F, R>(
+	c: &mut Criterion,
+	stage_name: &str,
+	case: &Case,
+	throughput: Throughput,
+	mut stage: F,
+) where
+	F: FnMut() -> R,
+{
+	let baseline = util::current_rss();
+
+	util::reset_peak_rss();
+	black_box(stage());
+
+	if let (Some(peak), Some(baseline)) = (util::peak_rss(), baseline) {
+		eprintln!(
+			"pipeline/{stage_name}/{}: peak RSS {:.1} MiB (+{:.1} MiB)",
+			case.name,
+			util::mib(peak),
+			util::mib(peak.saturating_sub(baseline)),
+		);
+	}
+	let mut group = c.benchmark_group(format!("pipeline/{stage_name}"));
+
+	group.sample_size(10);
+	group.throughput(throughput);
+	group.bench_function(&case.name, |b| b.iter(&mut stage));
+	group.finish();
+}
+
+fn bench_case(c: &mut Criterion, case: &Case) {
+	let num_points = Throughput::Elements(case.splat.header.num_points as u64);
+	let packed_bytes = Throughput::Bytes(case.packed.len() as u64);
+	let opts = LoadOptions::default();
+
+	let mut decompressed = Vec::with_capacity(case.packed.len());
+
+	bench_stage(c, "inflate", case, packed_bytes.clone(), || {
+		decompressed.clear();
+		compression::decompress(black_box(&case.compressed), &mut decompressed, 1).unwrap();
+	});
+	bench_stage(c, "parse", case, packed_bytes.clone(), || {
+		PackedGaussianSplatView::try_from(black_box(case.packed.as_slice())).unwrap()
+	});
+	let view = PackedGaussianSplatView::try_from(case.packed.as_slice()).unwrap();
+
+	bench_stage(c, "dequantize", case, num_points.clone(), || {
+		GaussianSplat::new_from_packed_gaussians(black_box(&view), &opts).unwrap()
+	});
+	let mut splat = case.splat.clone();
+
+	bench_stage(c, "convert_coordinates", case, num_points.clone(), || {
+		splat.convert_coordinates(
+			CoordinateSystem::RightUpBack,
+			CoordinateSystem::LeftUpFront,
+		);
+	});
+	bench_stage(c, "quantize", case, num_points, || {
+		black_box(&case.splat)
+			.to_packed_gaussians(&SaveOptions::default())
+			.unwrap()
+	});
+	let mut compressed = Vec::with_capacity(case.compressed.len());
+
+	bench_stage(c, "deflate", case, packed_bytes, || {
+		compression::gzip::compress_bytes(black_box(&case.packed), &mut compressed)
+			.unwrap();
+	});
+}
+
+pub fn bench_pipeline(c: &mut Criterion) {
+	if let Ok(splat) = util::load_packed_from_file() {
+		let name = format!("racoonfamily_sh{}", splat.header.spherical_harmonics_degree);
+
+		bench_case(c, &Case::new(name, splat));
+	}
+	// one case at a time, so the peak RSS of a stage isn't hidden by the
+	// inputs of the others
+	for num_points in point_counts() {
+		for sh_degree in 0..=3 {
+			let case = Case::new(
+				format!("{num_points}_pts_sh{sh_degree}"),
+				util::create_scene(num_points, sh_degree),
+			);
+			bench_case(c, &case);
+		}
+	}
+}
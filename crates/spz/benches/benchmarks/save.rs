@@ -17,3 +17,18 @@ pub fn bench_cloud_save_n(c: &mut Criterion) {
 	});
 	let _ = std::fs::remove_file(&spz_path);
 }
+
+pub fn bench_to_packed_gaussians(c: &mut Criterion) {
+	let gs = util::create_splat(1_000_000);
+
+	for threads in [1, 0] {
+		let opts = SaveOptions::builder().threads(threads).build();
+
+		c.bench_function(
+			&format!("splat_to_packed_1_000_000_pts_threads_{threads}"),
+			|b| {
+				b.iter(|| gs.to_packed_gaussians(&opts).unwrap());
+			},
+		);
+	}
+}
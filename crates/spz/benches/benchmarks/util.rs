@@ -46,6 +46,78 @@ pub fn create_splat(num_points: i32) -> GaussianSplat {
 	}
 }
 
+/// Creates a scene-like splat: gaussians on noisy, nested shells with
+/// log-normal scales, mostly opaque alphas, colors that vary smoothly with
+/// position and spherical harmonics that fall off with the band, stored in
+/// spatial order. Unlike uniform noise it compresses like captured data.
+pub fn create_scene(num_points: usize, sh_degree: u8) -> GaussianSplat {
+	let sh_dim = math::dim_for_degree(sh_degree) as usize;
+
+	let mut rng = StdRng::seed_from_u64(42);
+
+	let mut positions = Vec::with_capacity(num_points * 3);
+	let mut scales = Vec::with_capacity(num_points * 3);
+	let mut rotations = Vec::with_capacity(num_points * 4);
+	let mut alphas = Vec::with_capacity(num_points);
+	let mut colors = Vec::with_capacity(num_points * 3);
+	let mut spherical_harmonics = Vec::with_capacity(num_points * sh_dim * 3);
+
+	for i in 0..num_points {
+		// golden angle spiral, so that neighbouring points are close by
+		let t = (i as f32 + 0.5) / num_points as f32;
+		let theta = i as f32 * 2.399_963;
+		let phi = (1.0 - 2.0 * t).acos();
+		let radius = 4.0 + (i % 3) as f32 + (rng.random::<f32>() - 0.5) * 0.05;
+		let (x, y, z) = (
+			radius * phi.sin() * theta.cos(),
+			radius * phi.cos(),
+			radius * phi.sin() * theta.sin(),
+		);
+		positions.extend_from_slice(&[x, y, z]);
+
+		let base = -4.5 + (rng.random::<f32>() - 0.5);
+
+		scales.extend((0..3).map(|_| base + (rng.random::<f32>() - 0.5) * 0.5));
+
+		let q = [
+			rng.random::<f32>() - 0.5,
+			rng.random::<f32>() - 0.5,
+			rng.random::<f32>() - 0.5,
+			1.0,
+		];
+		let norm = q.iter().map(|v| v * v).sum::<f32>().sqrt();
+
+		rotations.extend(q.map(|v| v / norm));
+		alphas.push(2.0 + rng.random::<f32>() * 2.0);
+		colors.extend_from_slice(&[x.sin() * 0.5, y.cos() * 0.5, (x + z).sin() * 0.25]);
+
+		for coeff in 0..sh_dim {
+			let falloff = if coeff < 3 {
+				0.2
+			} else if coeff < 8 {
+				0.1
+			} else {
+				0.05
+			};
+			spherical_harmonics
+				.extend((0..3).map(|_| (rng.random::<f32>() - 0.5) * falloff));
+		}
+	}
+	GaussianSplat {
+		header: Header {
+			num_points: num_points as i32,
+			spherical_harmonics_degree: sh_degree,
+			..Default::default()
+		},
+		positions,
+		scales,
+		rotations,
+		alphas,
+		colors,
+		spherical_harmonics,
+	}
+}
+
 pub fn load_packed_from_file() -> Result<GaussianSplat> {
 	GaussianSplat::builder()
 		.packed(true)?
@@ -71,3 +143,40 @@ pub fn tmpdir() -> Result<PathBuf> {
 
 	Ok(temp_dir)
 }
+
+/// Resets the peak resident set size of the process, where supported.
+pub fn reset_peak_rss() {
+	#[cfg(target_os = "linux")]
+	let _ = std::fs::write("/proc/self/clear_refs", "5");
+}
+
+/// Peak resident set size of the process in bytes, where supported.
+pub fn peak_rss() -> Option<u64> {
+	proc_status_bytes("VmHWM:")
+}
+
+/// Current resident set size of the process in bytes, where supported.
+pub fn current_rss() -> Option<u64> {
+	proc_status_bytes("VmRSS:")
+}
+
+pub fn mib(bytes: u64) -> f64 {
+	bytes as f64 / (1024.0 * 1024.0)
+}
+
+fn proc_status_bytes(key: &str) -> Option<u64> {
+	if !cfg!(target_os = "linux") {
+		return None;
+	}
+	let status = std::fs::read_to_string("/proc/self/status").ok()?;
+	let kib: u64 = status
+		.lines()
+		.find_map(|line| line.strip_prefix(key))?
+		.trim()
+		.trim_end_matches("kB")
+		.trim()
+		.parse()
+		.ok()?;
+
+	Some(kib * 1024)
+}
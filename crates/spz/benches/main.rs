@@ -8,7 +8,10 @@ criterion_group! {
 	benches,
 	benchmarks::load::bench_load_packed_from_file,
 	benchmarks::load::bench_cloud_load_n,
+	benchmarks::kernels::bench_decode_kernels,
+	benchmarks::pipeline::bench_pipeline,
 	benchmarks::save::bench_cloud_save_n,
+	benchmarks::save::bench_to_packed_gaussians,
 	benchmarks::print_info::bench_print_info,
 }
 criterion_main!(benches);
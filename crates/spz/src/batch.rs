@@ -0,0 +1,379 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+//! Loading many SPZ files at once.
+//!
+//! A [`BatchLoader`] decodes files concurrently, each file on one worker,
+//! and keeps the [`Decoder`]s of finished files to reuse their buffers and
+//! inflate state for the next ones, in this batch and in later ones. A
+//! [`LoadPool`] runs loads in the background on a fixed set of threads and
+//! reports each one to a completion callback.
+
+use std::panic::{self, AssertUnwindSafe};
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::{Arc, Mutex, OnceLock, PoisonError, mpsc};
+use std::thread::{self, JoinHandle};
+
+use anyhow::{Context, Result, anyhow, bail};
+
+use crate::{
+	decoder::Decoder,
+	gaussian_splat::{GaussianSplat, LoadOptions},
+	parallel,
+};
+
+/// Loads batches of SPZ files on a number of worker threads, recycling
+/// scratch memory across files and calls.
+///
+/// It can be shared between threads, concurrent batches share the scratch
+/// buffers.
+#[derive(Debug, Default)]
+pub struct BatchLoader {
+	threads: usize,
+	decoders: Mutex<Vec<Decoder>>,
+}
+
+impl BatchLoader {
+	/// Creates a loader running up to `threads` files at once, `0` uses all
+	/// available cores.
+	#[inline]
+	pub fn new(threads: usize) -> Self {
+		Self {
+			threads,
+			decoders: Mutex::new(Vec::new()),
+		}
+	}
+
+	/// Number of files decoded at once.
+	#[inline]
+	pub fn threads(&self) -> usize {
+		parallel::available_threads(self.threads)
+	}
+
+	/// Number of decoders currently kept for reuse.
+	#[inline]
+	pub fn scratch_buffers(&self) -> usize {
+		self.decoders
+			.lock()
+			.unwrap_or_else(PoisonError::into_inner)
+			.len()
+	}
+
+	/// Loads every file of `paths`.
+	///
+	/// Workers take the next file as soon as they are done with the previous
+	/// one, so a few large files don't hold up the small ones.
+	///
+	/// # Args
+	///
+	/// `paths` - gzip or zstd compressed, packed gaussian data files.
+	/// `opts` - options for loading each splat, `opts.threads` applies within
+	/// a file.
+	///
+	/// # Returns
+	///
+	/// One result per path, in the order of `paths`.
+	pub fn load<P>(&self, paths: &[P], opts: &LoadOptions) -> Vec<Result<GaussianSplat>>
+	where
+		P: AsRef<Path> + Sync,
+	{
+		let results: Vec<OnceLock<Result<GaussianSplat>>> =
+			paths.iter().map(|_| OnceLock::new()).collect();
+		let next = AtomicUsize::new(0);
+		let workers = self.threads().min(paths.len());
+
+		parallel::run((0..workers).collect(), |_worker: usize| {
+			loop {
+				let i = next.fetch_add(1, Ordering::Relaxed);
+				let Some(path) = paths.get(i) else {
+					break;
+				};
+				let _ = results[i].set(self.load_one(path.as_ref(), opts));
+			}
+		});
+		results.into_iter()
+			.map(|result| {
+				result.into_inner()
+					.unwrap_or_else(|| Err(anyhow!("file was not loaded")))
+			})
+			.collect()
+	}
+
+	/// Loads a single file on the calling thread, with a recycled decoder.
+	///
+	/// # Args
+	///
+	/// `filepath` - gzip or zstd compressed, packed gaussian data file.
+	/// `opts` - options for loading the splat.
+	pub fn load_one<F>(&self, filepath: F, opts: &LoadOptions) -> Result<GaussianSplat>
+	where
+		F: AsRef<Path>,
+	{
+		let mut decoder = self.take_decoder();
+
+		let result = decoder.load(filepath, opts);
+
+		self.recycle_decoder(decoder);
+
+		result
+	}
+
+	fn take_decoder(&self) -> Decoder {
+		self.decoders
+			.lock()
+			.unwrap_or_else(PoisonError::into_inner)
+			.pop()
+			.unwrap_or_default()
+	}
+
+	/// Keeps `decoder` for the next file, up to one per worker.
+	fn recycle_decoder(&self, decoder: Decoder) {
+		let mut pool = self.decoders.lock().unwrap_or_else(PoisonError::into_inner);
+
+		if pool.len() < self.threads() {
+			pool.push(decoder);
+		}
+	}
+}
+
+type Job = Box<dyn FnOnce(&BatchLoader) + Send>;
+
+/// Background loading on a fixed set of worker threads.
+///
+/// Any number of loads can be submitted, at most one per worker decodes at a
+/// time, so many loads in flight don't oversubscribe the cores. Dropping the
+/// pool waits for the submitted loads to complete.
+#[derive(Debug)]
+pub struct LoadPool {
+	loader: Arc<BatchLoader>,
+	queue: Option<mpsc::Sender<Job>>,
+	workers: Vec<JoinHandle<()>>,
+}
+
+impl LoadPool {
+	/// Starts a pool of `threads` workers, `0` uses all available cores.
+	#[inline]
+	pub fn new(threads: usize) -> Result<Self> {
+		Self::with_loader(Arc::new(BatchLoader::new(threads)))
+	}
+
+	/// Starts a pool with one worker per thread of `loader`, sharing its
+	/// scratch buffers.
+	pub fn with_loader(loader: Arc<BatchLoader>) -> Result<Self> {
+		let (queue, jobs) = mpsc::channel::<Job>();
+		let jobs = Arc::new(Mutex::new(jobs));
+
+		let workers = (0..loader.threads())
+			.map(|i| {
+				let jobs = Arc::clone(&jobs);
+				let loader = Arc::clone(&loader);
+
+				thread::Builder::new()
+					.name(format!("spz-load-{i}"))
+					.spawn(move || {
+						loop {
+							let job = jobs
+								.lock()
+								.unwrap_or_else(
+									PoisonError::into_inner,
+								)
+								.recv();
+							let Ok(job) = job else {
+								break;
+							};
+							// a panicking completion must not take the worker down
+							let _ = panic::catch_unwind(
+								AssertUnwindSafe(|| job(&loader)),
+							);
+						}
+					})
+					.with_context(|| "unable to spawn load worker")
+			})
+			.collect::<Result<_>>()?;
+
+		Ok(Self {
+			loader,
+			queue: Some(queue),
+			workers,
+		})
+	}
+
+	/// The loader the workers decode with.
+	#[inline]
+	pub fn loader(&self) -> &Arc<BatchLoader> {
+		&self.loader
+	}
+
+	/// Queues a load of `filepath`, `done` is called with its result on a
+	/// worker thread.
+	///
+	/// # Args
+	///
+	/// `filepath` - gzip or zstd compressed, packed gaussian data file.
+	/// `opts` - options for loading the splat.
+	/// `done` - completion, called exactly once unless this returns an error,
+	/// with an error if the load panics.
+	pub fn submit<P, F>(&self, filepath: P, opts: LoadOptions, done: F) -> Result<()>
+	where
+		P: Into<PathBuf>,
+		F: FnOnce(Result<GaussianSplat>) + Send + 'static,
+	{
+		let filepath = filepath.into();
+		// a panicking load still completes, callers waiting on `done` don't hang
+		let job: Job = Box::new(move |loader| {
+			done(unwind_to_error(|| loader.load_one(&filepath, &opts)))
+		});
+
+		let Some(queue) = &self.queue else {
+			bail!("load pool is shut down");
+		};
+		queue.send(job)
+			.map_err(|_| anyhow!("load pool is shut down"))
+	}
+}
+
+/// Runs `f`, turning a panic into an error.
+fn unwind_to_error<T, F>(f: F) -> Result<T>
+where
+	F: FnOnce() -> Result<T>,
+{
+	panic::catch_unwind(AssertUnwindSafe(f)).unwrap_or_else(|payload| {
+		let message = payload
+			.downcast_ref::<&str>()
+			.copied()
+			.or_else(|| payload.downcast_ref::<String>().map(String::as_str))
+			.unwrap_or("unknown panic");
+
+		Err(anyhow!("load panicked: {message}"))
+	})
+}
+
+impl Drop for LoadPool {
+	fn drop(&mut self) {
+		// workers drain the queue, then see it closed
+		drop(self.queue.take());
+
+		for worker in self.workers.drain(..) {
+			let _ = worker.join();
+		}
+	}
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+	use crate::{coord::CoordinateSystem, gaussian_splat::SaveOptions, test_util::splat};
+
+	#[test]
+	fn test_batch_load_matches_load() {
+		let dir = std::env::temp_dir().join(format!("spz_batch_{}", std::process::id()));
+
+		std::fs::create_dir_all(&dir).unwrap();
+
+		let mut paths: Vec<_> = (0..6)
+			.map(|i| {
+				let path = dir.join(format!("{i}.spz"));
+
+				splat(100 * (i + 1), 1)
+					.save(&path, &SaveOptions::default())
+					.unwrap();
+				path
+			})
+			.collect();
+		paths.insert(3, dir.join("missing.spz"));
+
+		// containers load like they do on their own
+		let chunked = dir.join("chunked.spz");
+		let progressive = dir.join("progressive.spz");
+
+		crate::chunked::save_chunked(
+			&splat(300, 1),
+			&chunked,
+			&SaveOptions::default(),
+			100,
+		)
+		.unwrap();
+		crate::lod::save_progressive(
+			&splat(300, 1),
+			&progressive,
+			&SaveOptions::default(),
+			&Default::default(),
+		)
+		.unwrap();
+		paths.extend([chunked, progressive]);
+
+		let opts = LoadOptions::builder()
+			.coord_sys(CoordinateSystem::LeftUpFront)
+			.build();
+		let loader = BatchLoader::new(3);
+
+		for _ in 0..2 {
+			let results = loader.load(&paths, &opts);
+
+			assert_eq!(results.len(), paths.len());
+
+			for (path, result) in paths.iter().zip(results) {
+				match GaussianSplat::load_with(path, &opts) {
+					Ok(expected) => assert_eq!(result.unwrap(), expected),
+					Err(_) => assert!(result.is_err()),
+				}
+			}
+			assert!(loader.scratch_buffers() <= loader.threads());
+		}
+		let _ = std::fs::remove_dir_all(&dir);
+	}
+
+	#[test]
+	fn test_load_pool_completes_every_load() {
+		let dir = std::env::temp_dir().join(format!("spz_pool_{}", std::process::id()));
+
+		std::fs::create_dir_all(&dir).unwrap();
+
+		let path = dir.join("splat.spz");
+		let expected = splat(500, 1);
+
+		expected.save(&path, &SaveOptions::default()).unwrap();
+
+		let (tx, rx) = mpsc::channel();
+		let pool = LoadPool::new(2).unwrap();
+
+		for i in 0..8 {
+			let tx = tx.clone();
+			let filepath = if i % 4 == 3 {
+				dir.join("missing.spz")
+			} else {
+				path.clone()
+			};
+			pool.submit(filepath, LoadOptions::default(), move |result| {
+				let _ = tx.send((i, result));
+			})
+			.unwrap();
+		}
+		drop(pool);
+		drop(tx);
+
+		let mut results: Vec<_> = rx.iter().collect();
+
+		results.sort_by_key(|(i, _)| *i);
+
+		assert_eq!(results.len(), 8);
+
+		for (i, result) in results {
+			if i % 4 == 3 {
+				assert!(result.is_err());
+			} else {
+				assert_eq!(result.unwrap().positions.len(), 1500);
+			}
+		}
+		let _ = std::fs::remove_dir_all(&dir);
+	}
+
+	#[test]
+	fn test_panicking_load_completes_with_error() {
+		assert_eq!(unwind_to_error(|| Ok(1)).unwrap(), 1);
+
+		let err = unwind_to_error::<(), _>(|| panic!("corrupt {}", "state")).unwrap_err();
+
+		assert!(err.to_string().contains("corrupt state"));
+	}
+}
@@ -0,0 +1,563 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+//! Uncompressed, memory-mapped cache files of decoded splats.
+//!
+//! A cache file holds the float arrays of a [`GaussianSplat`] as they are in
+//! memory, each on a page boundary, so opening one is a `mmap` and the
+//! accessors of [`CachedGaussianSplat`] return slices into the mapping, with
+//! nothing inflated or dequantized. They are several times larger than the
+//! SPZ file they are built from, and meant to sit next to it on local disk.
+//!
+//! Layout, little-endian:
+//!
+//! | Bytes            | Content                                             |
+//! |------------------|-----------------------------------------------------|
+//! | 200              | [`MAGIC`], version, coordinate system, SPZ header,  |
+//! |                  | source stamp, per section offset, length and CRC-32 |
+//! | to [`PAGE_SIZE`] | zero padding                                        |
+//! | each section     | `f32` attribute array, padded to [`PAGE_SIZE`]      |
+//!
+//! Sections are in [`GaussianSplat`] field order: positions, scales,
+//! rotations, alphas, colors and spherical harmonics. The source stamp, the
+//! length, modification time and last 8 bytes of the SPZ file, tells whether
+//! a cache is stale without reading the source. For gzip streams the last
+//! bytes are the CRC-32 and size trailer, for other files just data, so a
+//! rewrite of the same length within the resolution of the file system's
+//! timestamps can go unnoticed there.
+//!
+//! [`build`] writes a new file and renames it over the cache, so mappings of
+//! the old cache stay valid while it is rebuilt.
+
+use std::fs::File;
+use std::io::{BufWriter, Read, Seek, SeekFrom, Write};
+use std::ops::Range;
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::time::UNIX_EPOCH;
+
+use anyhow::{Context, Result, bail};
+use likely_stable::unlikely;
+use memmap2::Mmap;
+use strum::IntoEnumIterator;
+use zerocopy::{FromBytes, Immutable, IntoBytes, KnownLayout, TryFromBytes};
+
+use crate::{
+	coord::CoordinateSystem,
+	gaussian_splat::{AttributeLens, GaussianSplat, LoadOptions},
+	header::{HEADER_SIZE, Header},
+	mmap,
+};
+
+/// Magic bytes starting a cache file.
+pub const MAGIC: [u8; 8] = *b"SPZCACHE";
+
+/// The cache file version written by this crate.
+pub const VERSION: u32 = 1;
+
+/// Alignment of the sections within the file.
+pub const PAGE_SIZE: usize = 4096;
+
+/// Extension appended to the source file name by [`cache_path`].
+pub const EXTENSION: &str = "cache";
+
+static_assertions::const_assert_eq!(200, size_of::<RawHeader>());
+static_assertions::const_assert_eq!(HEADER_SIZE, 16);
+
+#[derive(Clone, Copy, Debug, FromBytes, IntoBytes, Immutable, KnownLayout)]
+#[repr(C)]
+struct RawHeader {
+	magic: [u8; 8],
+	version: u32,
+	coord_sys: u32,
+	header: [u8; HEADER_SIZE],
+	source_len: u64,
+	source_tail: [u8; 8],
+	source_mtime_ns: u64,
+	sections: [RawSection; 6],
+}
+
+#[derive(Clone, Copy, Debug, Default, FromBytes, IntoBytes, Immutable, KnownLayout)]
+#[repr(C)]
+struct RawSection {
+	offset: u64,
+	len: u64,
+	crc32: u32,
+	reserved: u32,
+}
+
+/// What a cache was built from: the length, modification time and last 8
+/// bytes of the SPZ file.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct SourceStamp {
+	pub len: u64,
+	pub tail: [u8; 8],
+	/// Nanoseconds since the Unix epoch, `0` where the file system keeps
+	/// no modification times.
+	pub mtime_ns: u64,
+}
+
+impl SourceStamp {
+	/// Reads the stamp of an SPZ file, 8 bytes of it.
+	pub fn of_file<F>(filepath: F) -> Result<Self>
+	where
+		F: AsRef<Path>,
+	{
+		let mut infile = File::open(filepath)?;
+		let metadata = infile.metadata()?;
+		let len = metadata.len();
+		let mtime_ns = metadata
+			.modified()
+			.ok()
+			.and_then(|mtime| mtime.duration_since(UNIX_EPOCH).ok())
+			.map_or(0, |since| since.as_nanos() as u64);
+		let mut tail = [0; 8];
+		let tail_len = len.min(8) as usize;
+
+		infile.seek(SeekFrom::End(-(tail_len as i64)))?;
+		infile.read_exact(&mut tail[..tail_len])?;
+
+		Ok(Self {
+			len,
+			tail,
+			mtime_ns,
+		})
+	}
+}
+
+/// The cache file path of an SPZ file, `scene.spz` becomes
+/// `scene.spz.cache`.
+pub fn cache_path<F>(source: F) -> PathBuf
+where
+	F: AsRef<Path>,
+{
+	let mut path = source.as_ref().as_os_str().to_owned();
+
+	path.push(".");
+	path.push(EXTENSION);
+	path.into()
+}
+
+/// Writes `splat` as a cache file.
+///
+/// # Args
+///
+/// `splat` - the splat to write, in `coord_sys`.
+/// `coord_sys` - the coordinate system of `splat`, recorded in the file.
+/// `source` - stamp of the SPZ file the splat was loaded from, if any.
+/// `stream` - destination.
+pub fn write_cache<W>(
+	splat: &GaussianSplat,
+	coord_sys: CoordinateSystem,
+	source: SourceStamp,
+	stream: &mut W,
+) -> Result<()>
+where
+	W: Write,
+{
+	if unlikely(!splat.check_sizes()) {
+		bail!("inconsistent sizes");
+	}
+	let arrays = attributes(splat);
+	let mut raw = RawHeader {
+		magic: MAGIC,
+		version: VERSION,
+		coord_sys: coord_sys as u32,
+		header: [0; HEADER_SIZE],
+		source_len: source.len,
+		source_tail: source.tail,
+		source_mtime_ns: source.mtime_ns,
+		sections: [RawSection::default(); 6],
+	};
+	raw.header.copy_from_slice(splat.header.as_bytes());
+
+	let mut offset = PAGE_SIZE;
+
+	for (section, array) in raw.sections.iter_mut().zip(arrays) {
+		let bytes = array.as_bytes();
+		let mut crc = flate2::Crc::new();
+
+		crc.update(bytes);
+		*section = RawSection {
+			offset: offset as u64,
+			len: bytes.len() as u64,
+			crc32: crc.sum(),
+			reserved: 0,
+		};
+		offset += bytes.len().next_multiple_of(PAGE_SIZE);
+	}
+	let padding = [0; PAGE_SIZE];
+
+	stream.write_all(raw.as_bytes())?;
+	stream.write_all(&padding[size_of::<RawHeader>()..])?;
+
+	for array in arrays {
+		let bytes = array.as_bytes();
+
+		stream.write_all(bytes)?;
+		stream.write_all(
+			&padding[..bytes.len().next_multiple_of(PAGE_SIZE) - bytes.len()],
+		)?;
+	}
+	Ok(())
+}
+
+/// Loads an SPZ file and writes its cache file.
+///
+/// The cache is written to a temporary file next to `output`, then renamed
+/// over it, so processes that have the old cache open keep reading it.
+///
+/// # Args
+///
+/// `source` - gzip or zstd compressed, packed gaussian data file.
+/// `output` - the cache file to write, e.g. [`cache_path`] of `source`.
+/// `opts` - options for loading the splat, its coordinate system is the
+/// one of the cache.
+pub fn build<S, O>(source: S, output: O, opts: &LoadOptions) -> Result<()>
+where
+	S: AsRef<Path>,
+	O: AsRef<Path>,
+{
+	let source = source.as_ref();
+	let stamp = SourceStamp::of_file(source)?;
+	let splat = GaussianSplat::load_with(source, opts)?;
+	let output = output.as_ref();
+	let temp = temp_path(output);
+
+	let written = File::create(&temp)
+		.with_context(|| "unable to create file")
+		.and_then(|outfile| {
+			let mut stream = BufWriter::new(outfile);
+
+			write_cache(&splat, opts.coord_sys, stamp, &mut stream)?;
+
+			stream.into_inner()
+				.map_err(|e| e.into_error())
+				.and_then(|outfile| outfile.sync_all())
+				.with_context(|| "unable to write to file")
+		})
+		.and_then(|()| {
+			std::fs::rename(&temp, output)
+				.with_context(|| "unable to replace the cache")
+		});
+
+	if written.is_err() {
+		let _ = std::fs::remove_file(&temp);
+	}
+	written
+}
+
+/// A path next to `output` that no other build writes to at the same time.
+fn temp_path(output: &Path) -> PathBuf {
+	static BUILDS: AtomicUsize = AtomicUsize::new(0);
+
+	let mut name = output.file_name().unwrap_or_default().to_owned();
+
+	name.push(format!(
+		".{}.{}.tmp",
+		std::process::id(),
+		BUILDS.fetch_add(1, Ordering::Relaxed)
+	));
+	output.with_file_name(name)
+}
+
+/// A cache file mapped into memory.
+///
+/// The attribute slices point into the mapping and have the layout of the
+/// fields of [`GaussianSplat`]. The file must not be modified while it is
+/// open.
+#[derive(Debug)]
+pub struct CachedGaussianSplat {
+	mmap: Mmap,
+	header: Header,
+	coord_sys: CoordinateSystem,
+	source: SourceStamp,
+	sections: [Range<usize>; 6],
+	crc32s: [u32; 6],
+}
+
+impl CachedGaussianSplat {
+	/// Maps a cache file and validates its layout, without reading the
+	/// sections; see [`CachedGaussianSplat::verify`].
+	///
+	/// # Args
+	///
+	/// `filepath` - the cache file.
+	pub fn open<F>(filepath: F) -> Result<Self>
+	where
+		F: AsRef<Path>,
+	{
+		if cfg!(target_endian = "big") {
+			bail!("cache files are little-endian only");
+		}
+		// unlike for compressed files, mapping is the point here, so macos
+		// maps too
+		let mmap = mmap::mmap(filepath.as_ref()).with_context(|| {
+			format!("unable to open {}", filepath.as_ref().display())
+		})?;
+
+		Self::from_mmap(mmap)
+	}
+
+	fn from_mmap(mmap: Mmap) -> Result<Self> {
+		let Ok((raw, _)) = RawHeader::read_from_prefix(&mmap) else {
+			bail!("cache file too small");
+		};
+		if unlikely(raw.magic != MAGIC) {
+			bail!("not a cache file");
+		}
+		if unlikely(raw.version != VERSION) {
+			bail!("unsupported cache file version: {}", raw.version);
+		}
+		let Ok(header) = Header::try_read_from_bytes(&raw.header) else {
+			bail!("invalid header");
+		};
+		let Some(coord_sys) = CoordinateSystem::iter().find(|c| *c as u32 == raw.coord_sys)
+		else {
+			bail!("invalid coordinate system: {}", raw.coord_sys);
+		};
+		if unlikely(header.num_points < 0 || header.spherical_harmonics_degree > 3) {
+			bail!("invalid header");
+		}
+		let lens = AttributeLens::from_header(&header);
+		let expected = [
+			lens.positions,
+			lens.scales,
+			lens.rotations,
+			lens.alphas,
+			lens.colors,
+			lens.spherical_harmonics,
+		];
+		let mut sections: [Range<usize>; 6] = Default::default();
+
+		for ((range, section), floats) in
+			sections.iter_mut().zip(&raw.sections).zip(expected)
+		{
+			let offset = section.offset as usize;
+			let len = section.len as usize;
+
+			if unlikely(
+				len != floats * size_of::<f32>()
+					|| !offset.is_multiple_of(PAGE_SIZE)
+					|| offset
+						.checked_add(len)
+						.is_none_or(|end| end > mmap.len()),
+			) {
+				bail!("invalid section: offset {offset}, length {len}");
+			}
+			*range = offset..offset + len;
+		}
+		Ok(Self {
+			header,
+			coord_sys,
+			source: SourceStamp {
+				len: raw.source_len,
+				tail: raw.source_tail,
+				mtime_ns: raw.source_mtime_ns,
+			},
+			sections,
+			crc32s: raw.sections.map(|section| section.crc32),
+			mmap,
+		})
+	}
+
+	/// Opens the cache of `source` at [`cache_path`], if it exists and was
+	/// built from the file as it is now.
+	///
+	/// # Args
+	///
+	/// `source` - the SPZ file.
+	pub fn open_for<F>(source: F) -> Result<Option<Self>>
+	where
+		F: AsRef<Path>,
+	{
+		let path = cache_path(source.as_ref());
+
+		if !path.exists() {
+			return Ok(None);
+		}
+		let cached = Self::open(path)?;
+
+		Ok((cached.source == SourceStamp::of_file(source)?).then_some(cached))
+	}
+
+	/// Checks the CRC-32 of every section, reading the whole file.
+	pub fn verify(&self) -> Result<()> {
+		for (range, expected) in self.sections.iter().zip(self.crc32s) {
+			let mut crc = flate2::Crc::new();
+
+			crc.update(&self.mmap[range.clone()]);
+
+			if unlikely(crc.sum() != expected) {
+				bail!("checksum mismatch in section at offset {}", range.start);
+			}
+		}
+		Ok(())
+	}
+
+	#[inline]
+	pub fn header(&self) -> &Header {
+		&self.header
+	}
+
+	/// The coordinate system the attributes are in.
+	#[inline]
+	pub fn coord_sys(&self) -> CoordinateSystem {
+		self.coord_sys
+	}
+
+	/// Stamp of the SPZ file the cache was built from.
+	#[inline]
+	pub fn source(&self) -> SourceStamp {
+		self.source
+	}
+
+	#[inline]
+	pub fn num_points(&self) -> usize {
+		self.header.num_points as usize
+	}
+
+	#[inline]
+	pub fn positions(&self) -> &[f32] {
+		self.section(0)
+	}
+
+	#[inline]
+	pub fn scales(&self) -> &[f32] {
+		self.section(1)
+	}
+
+	#[inline]
+	pub fn rotations(&self) -> &[f32] {
+		self.section(2)
+	}
+
+	#[inline]
+	pub fn alphas(&self) -> &[f32] {
+		self.section(3)
+	}
+
+	#[inline]
+	pub fn colors(&self) -> &[f32] {
+		self.section(4)
+	}
+
+	#[inline]
+	pub fn spherical_harmonics(&self) -> &[f32] {
+		self.section(5)
+	}
+
+	/// Copies the attributes into a new [`GaussianSplat`].
+	pub fn to_gaussian_splat(&self) -> GaussianSplat {
+		GaussianSplat {
+			header: self.header,
+			positions: self.positions().to_vec(),
+			scales: self.scales().to_vec(),
+			rotations: self.rotations().to_vec(),
+			alphas: self.alphas().to_vec(),
+			colors: self.colors().to_vec(),
+			spherical_harmonics: self.spherical_harmonics().to_vec(),
+		}
+	}
+
+	#[inline]
+	fn section(&self, i: usize) -> &[f32] {
+		// mappings are page aligned and so are the sections, whose lengths
+		// were checked on open
+		<[f32]>::ref_from_bytes(&self.mmap[self.sections[i].clone()]).unwrap_or_default()
+	}
+}
+
+fn attributes(splat: &GaussianSplat) -> [&[f32]; 6] {
+	[
+		&splat.positions,
+		&splat.scales,
+		&splat.rotations,
+		&splat.alphas,
+		&splat.colors,
+		&splat.spherical_harmonics,
+	]
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+	use crate::{gaussian_splat::SaveOptions, test_util::splat};
+
+	#[test]
+	fn test_cache_round_trip() {
+		let dir = std::env::temp_dir().join(format!("spz-cache-{}", std::process::id()));
+		let source = dir.join("scene.spz");
+
+		std::fs::create_dir_all(&dir).unwrap();
+		splat(1000, 2)
+			.save(&source, &SaveOptions::default())
+			.unwrap();
+
+		assert!(CachedGaussianSplat::open_for(&source).unwrap().is_none());
+
+		let opts = LoadOptions::builder()
+			.coord_sys(CoordinateSystem::RightDownFront)
+			.build();
+
+		build(&source, cache_path(&source), &opts).unwrap();
+
+		let cached = CachedGaussianSplat::open_for(&source).unwrap().unwrap();
+		let loaded = GaussianSplat::load_with(&source, &opts).unwrap();
+
+		cached.verify().unwrap();
+		assert_eq!(cached.coord_sys(), CoordinateSystem::RightDownFront);
+		assert_eq!(cached.to_gaussian_splat(), loaded);
+		assert_eq!(
+			cached.positions().as_ptr() as usize % PAGE_SIZE,
+			0,
+			"sections are page aligned"
+		);
+
+		// a rewritten source makes the cache stale
+		splat(999, 2)
+			.save(&source, &SaveOptions::default())
+			.unwrap();
+		assert!(CachedGaussianSplat::open_for(&source).unwrap().is_none());
+
+		// rebuilding leaves the open cache intact
+		build(&source, cache_path(&source), &opts).unwrap();
+
+		assert_eq!(cached.to_gaussian_splat(), loaded);
+		assert_eq!(
+			CachedGaussianSplat::open_for(&source)
+				.unwrap()
+				.unwrap()
+				.num_points(),
+			999
+		);
+		assert_eq!(std::fs::read_dir(&dir).unwrap().count(), 2);
+
+		std::fs::remove_dir_all(&dir).unwrap();
+	}
+
+	#[test]
+	fn test_cache_rejects_corruption() {
+		let mut bytes = Vec::new();
+
+		write_cache(
+			&splat(100, 2),
+			CoordinateSystem::Unspecified,
+			SourceStamp::default(),
+			&mut bytes,
+		)
+		.unwrap();
+		assert_eq!(bytes.len() % PAGE_SIZE, 0);
+
+		let path = std::env::temp_dir()
+			.join(format!("spz-cache-{}.cache", std::process::id()));
+
+		bytes[PAGE_SIZE + 5] ^= 1;
+		std::fs::write(&path, &bytes).unwrap();
+		assert!(CachedGaussianSplat::open(&path).unwrap().verify().is_err());
+
+		std::fs::write(&path, &bytes[..PAGE_SIZE * 2]).unwrap();
+		assert!(CachedGaussianSplat::open(&path).is_err());
+
+		std::fs::remove_file(&path).unwrap();
+	}
+}
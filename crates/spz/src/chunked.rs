@@ -0,0 +1,839 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+//! Chunked SPZ container, for out-of-core scenes.
+//!
+//! A chunked file splits a splat into spatially coherent chunks, each one a
+//! complete, independently compressed SPZ stream, behind an index of byte
+//! ranges and bounding boxes. Readers map the file and inflate only the
+//! chunks they need, in parallel.
+//!
+//! Layout, little-endian:
+//!
+//! | Bytes     | Content                                              |
+//! |-----------|------------------------------------------------------|
+//! | 24        | [`MAGIC`], version, points, chunks, SH degree, flags |
+//! | 56 each   | index entry: offset, length, points, origin, bbox    |
+//! | remaining | the compressed chunks                                |
+//!
+//! Chunk positions are stored relative to the chunk origin, so the 24 bit
+//! fixed point positions of SPZ keep their precision far from the scene
+//! origin. Origins and bounding boxes are in the SPZ coordinate system
+//! (RightUpBack).
+
+use std::ops::Range;
+use std::path::Path;
+
+use anyhow::{Context, Result, bail};
+use likely_stable::unlikely;
+use zerocopy::{FromBytes, Immutable, IntoBytes, KnownLayout};
+
+use crate::{
+	compression,
+	coord::{AxisFlips, CoordinateSystem},
+	decoder::Decoder,
+	gaussian_splat::{
+		AttributeBuffersMut, AttributeLens, BoundingBox, GaussianSplat, LoadOptions,
+		SaveOptions,
+	},
+	header::{Flags, Header},
+	math::dim_for_degree,
+	mmap, parallel,
+};
+
+/// Magic bytes starting a chunked SPZ file.
+pub const MAGIC: [u8; 4] = *b"SPZC";
+
+/// The container version written by this crate.
+pub const VERSION: u32 = 1;
+
+/// Default maximum number of points per chunk.
+pub const DEFAULT_CHUNK_POINTS: usize = 64 * 1024;
+
+static_assertions::const_assert_eq!(24, size_of::<RawHeader>());
+static_assertions::const_assert_eq!(56, size_of::<RawEntry>());
+
+#[derive(Clone, Copy, Debug, FromBytes, IntoBytes, Immutable, KnownLayout)]
+#[repr(C)]
+struct RawHeader {
+	magic: [u8; 4],
+	version: u32,
+	num_points: u64,
+	num_chunks: u32,
+	sh_degree: u8,
+	flags: u8,
+	reserved: [u8; 2],
+}
+
+#[derive(Clone, Copy, Debug, Default, FromBytes, IntoBytes, Immutable, KnownLayout)]
+#[repr(C)]
+struct RawEntry {
+	offset: u64,
+	len: u64,
+	num_points: u32,
+	origin: [f32; 3],
+	/// min x, max x, min y, max y, min z, max z.
+	bbox: [f32; 6],
+}
+
+/// One chunk of a chunked file.
+#[derive(Clone, Debug, PartialEq)]
+pub struct ChunkInfo {
+	/// Byte range of the compressed chunk in the file.
+	pub range: Range<usize>,
+	pub num_points: usize,
+	/// Offset added to the decoded positions, RightUpBack.
+	pub origin: [f32; 3],
+	/// Bounds of the positions, RightUpBack.
+	pub bbox: BoundingBox,
+}
+
+/// Whether `bytes` start like a chunked SPZ file.
+#[inline]
+pub fn is_chunked(bytes: &[u8]) -> bool {
+	bytes.starts_with(&MAGIC)
+}
+
+/// Splits `splat` into chunks of at most `max_chunk_points` points and
+/// serializes them into a chunked file.
+///
+/// The chunks are compressed on [`SaveOptions::threads`] threads, one chunk
+/// per thread at a time, with the codec and level of `opts`.
+///
+/// # Args
+///
+/// `splat` - the splat to write.
+/// `opts` - options for saving each chunk.
+/// `max_chunk_points` - upper bound of points per chunk, e.g.
+/// [`DEFAULT_CHUNK_POINTS`].
+pub fn serialize_chunked(
+	splat: &GaussianSplat,
+	opts: &SaveOptions,
+	max_chunk_points: usize,
+) -> Result<Vec<u8>> {
+	if unlikely(!splat.check_sizes()) {
+		bail!("inconsistent sizes");
+	}
+	if unlikely(max_chunk_points == 0 || max_chunk_points > u32::MAX as usize) {
+		bail!("invalid number of points per chunk: {max_chunk_points}");
+	}
+	let num_points = splat.header.num_points as usize;
+	let mut order: Vec<u32> = (0..num_points as u32).collect();
+	let mut ranges = Vec::with_capacity(num_points.div_ceil(max_chunk_points));
+
+	split_spatially(
+		&splat.positions,
+		&mut order,
+		0,
+		max_chunk_points,
+		&mut ranges,
+	);
+
+	let to_spz = opts.coord_sys.axis_flips_to(CoordinateSystem::RightUpBack);
+	let chunk_opts = SaveOptions {
+		threads: 1,
+		parallel_compression: false,
+		..opts.clone()
+	};
+	let mut chunks: Vec<(Vec<u8>, RawEntry)> = ranges
+		.iter()
+		.map(|_| (Vec::new(), RawEntry::default()))
+		.collect();
+	let jobs = parallel::deal(
+		ranges.iter().zip(chunks.iter_mut()).collect(),
+		parallel::available_threads(opts.threads),
+	);
+	parallel::try_run(jobs, |jobs| {
+		for (range, (bytes, entry)) in jobs {
+			let (chunk, origin, bbox) = gather(splat, &order[range.clone()]);
+			let bbox = bbox.flipped(&to_spz);
+
+			*bytes = chunk.serialize_to_packed_bytes(&chunk_opts)?;
+			*entry = RawEntry {
+				offset: 0,
+				len: bytes.len() as u64,
+				num_points: range.len() as u32,
+				origin: [0, 1, 2].map(|i| origin[i] * to_spz.position[i]),
+				bbox: [
+					bbox.min_x, bbox.max_x, bbox.min_y, bbox.max_y, bbox.min_z,
+					bbox.max_z,
+				],
+			};
+		}
+		Ok(())
+	})?;
+
+	let index_len = chunks.len() * size_of::<RawEntry>();
+	let data_len = chunks.iter().map(|(bytes, _)| bytes.len()).sum::<usize>();
+	let mut out = Vec::with_capacity(size_of::<RawHeader>() + index_len + data_len);
+
+	out.extend_from_slice(
+		RawHeader {
+			magic: MAGIC,
+			version: VERSION,
+			num_points: num_points as u64,
+			num_chunks: chunks.len() as u32,
+			sh_degree: splat.header.spherical_harmonics_degree,
+			flags: splat.header.flags.0,
+			reserved: [0; 2],
+		}
+		.as_bytes(),
+	);
+	let mut offset = (size_of::<RawHeader>() + index_len) as u64;
+
+	for (bytes, entry) in &mut chunks {
+		entry.offset = offset;
+		offset += bytes.len() as u64;
+
+		out.extend_from_slice(entry.as_bytes());
+	}
+	for (bytes, _) in &chunks {
+		out.extend_from_slice(bytes);
+	}
+	Ok(out)
+}
+
+/// Writes `splat` to a chunked file, see [`serialize_chunked`].
+///
+/// # Args
+///
+/// `splat` - the splat to write.
+/// `filepath` - file path to save the chunked file to.
+/// `opts` - options for saving each chunk.
+/// `max_chunk_points` - upper bound of points per chunk.
+pub fn save_chunked<F>(
+	splat: &GaussianSplat,
+	filepath: F,
+	opts: &SaveOptions,
+	max_chunk_points: usize,
+) -> Result<()>
+where
+	F: AsRef<Path>,
+{
+	let bytes = serialize_chunked(splat, opts, max_chunk_points)?;
+
+	std::fs::write(filepath, bytes).with_context(|| "unable to write to file")
+}
+
+/// Random access reader of a chunked file, over its mapped or read bytes.
+#[derive(Debug)]
+pub struct ChunkedSpz<B> {
+	data: B,
+	num_points: usize,
+	sh_degree: u8,
+	flags: Flags,
+	chunks: Vec<ChunkInfo>,
+}
+
+impl ChunkedSpz<memmap2::Mmap> {
+	/// Maps a chunked file and reads its index, without inflating anything.
+	///
+	/// # Args
+	///
+	/// `filepath` - chunked SPZ file.
+	pub fn open<F>(filepath: F) -> Result<Self>
+	where
+		F: AsRef<Path>,
+	{
+		let filepath = filepath.as_ref();
+
+		Self::from_bytes(mmap::mmap(filepath)?)
+			.with_context(|| format!("unable to open {}", filepath.display()))
+	}
+}
+
+impl<B> ChunkedSpz<B>
+where
+	B: AsRef<[u8]> + Sync,
+{
+	/// Reads the index of a chunked file held in `data`.
+	///
+	/// # Args
+	///
+	/// `data` - the whole chunked file.
+	pub fn from_bytes(data: B) -> Result<Self> {
+		let bytes = data.as_ref();
+		let (header, rest) = RawHeader::read_from_prefix(bytes)
+			.map_err(|_| anyhow::anyhow!("chunked header is truncated"))?;
+
+		if unlikely(header.magic != MAGIC) {
+			bail!("not a chunked SPZ file");
+		}
+		if unlikely(header.version != VERSION) {
+			bail!("unsupported chunked SPZ version: {}", header.version);
+		}
+		if unlikely(header.sh_degree > 3) {
+			bail!("invalid spherical harmonics degree: {}", header.sh_degree);
+		}
+		let num_chunks = header.num_chunks as usize;
+
+		if unlikely(rest.len() / size_of::<RawEntry>() < num_chunks) {
+			bail!("chunk index is truncated");
+		}
+		let mut num_points = 0_usize;
+		let chunks = rest
+			.chunks_exact(size_of::<RawEntry>())
+			.take(num_chunks)
+			.map(|entry| {
+				let entry = RawEntry::read_from_bytes(entry).map_err(|_| {
+					anyhow::anyhow!("invalid chunk index entry")
+				})?;
+				let range = usize::try_from(entry.offset)
+					.ok()
+					.zip(usize::try_from(entry.len).ok())
+					.and_then(|(start, len)| {
+						Some(start..start.checked_add(len)?)
+					})
+					.filter(|range| range.end <= bytes.len());
+
+				let Some(range) = range else {
+					bail!("chunk is out of bounds");
+				};
+				let [min_x, max_x, min_y, max_y, min_z, max_z] = entry.bbox;
+
+				num_points += entry.num_points as usize;
+
+				Ok(ChunkInfo {
+					range,
+					num_points: entry.num_points as usize,
+					origin: entry.origin,
+					bbox: BoundingBox {
+						min_x,
+						max_x,
+						min_y,
+						max_y,
+						min_z,
+						max_z,
+					},
+				})
+			})
+			.collect::<Result<Vec<_>>>()?;
+
+		if unlikely(num_points as u64 != header.num_points) {
+			bail!(
+				"chunks hold {num_points} points, the header {}",
+				header.num_points
+			);
+		}
+		Ok(Self {
+			data,
+			num_points,
+			sh_degree: header.sh_degree,
+			flags: Flags(header.flags),
+			chunks,
+		})
+	}
+
+	#[inline]
+	pub fn num_points(&self) -> usize {
+		self.num_points
+	}
+
+	#[inline]
+	pub fn sh_degree(&self) -> u8 {
+		self.sh_degree
+	}
+
+	/// A header for the whole file: the total points, SH degree and flags of
+	/// the index, with the version and fractional bits of the first chunk.
+	///
+	/// Not validated, like [`Header::from_compressed_bytes_unchecked`].
+	pub fn header(&self) -> Result<Header> {
+		if unlikely(self.num_points > i32::MAX as usize) {
+			bail!("too many points: {}", self.num_points);
+		}
+		let first = match self.chunk_bytes(0) {
+			Some(chunk) => Header::from_stream_unchecked(chunk)?,
+			None => Header::default(),
+		};
+		Ok(Header {
+			num_points: self.num_points as i32,
+			spherical_harmonics_degree: self.sh_degree,
+			flags: self.flags,
+			..first
+		})
+	}
+
+	#[inline]
+	pub fn chunks(&self) -> &[ChunkInfo] {
+		&self.chunks
+	}
+
+	/// The compressed SPZ stream of chunk `i`, positions relative to its
+	/// origin.
+	#[inline]
+	pub fn chunk_bytes(&self, i: usize) -> Option<&[u8]> {
+		let chunk = self.chunks.get(i)?;
+
+		self.data.as_ref().get(chunk.range.clone())
+	}
+
+	/// Indices of the chunks whose bounds intersect `bbox`.
+	///
+	/// # Args
+	///
+	/// `bbox` - region of interest, in `coord_sys`.
+	/// `coord_sys` - coordinate system of `bbox`.
+	pub fn chunks_intersecting(
+		&self,
+		bbox: &BoundingBox,
+		coord_sys: CoordinateSystem,
+	) -> Vec<usize> {
+		let bbox = bbox.flipped(&coord_sys.axis_flips_to(CoordinateSystem::RightUpBack));
+
+		self.chunks
+			.iter()
+			.enumerate()
+			.filter(|(_, chunk)| chunk.bbox.intersects(&bbox))
+			.map(|(i, _)| i)
+			.collect()
+	}
+
+	/// Loads the chunks intersecting `bbox` into one splat, see
+	/// [`ChunkedSpz::load_chunks`].
+	///
+	/// # Args
+	///
+	/// `bbox` - region of interest, in `opts.coord_sys`.
+	/// `opts` - options for loading the splat.
+	#[inline]
+	pub fn load_region(&self, bbox: &BoundingBox, opts: &LoadOptions) -> Result<GaussianSplat> {
+		self.load_chunks(&self.chunks_intersecting(bbox, opts.coord_sys), opts)
+	}
+
+	/// Loads every chunk into one splat, in chunk order.
+	#[inline]
+	pub fn load_all(&self, opts: &LoadOptions) -> Result<GaussianSplat> {
+		self.load_chunks(&(0..self.chunks.len()).collect::<Vec<_>>(), opts)
+	}
+
+	/// Loads the given chunks into one splat, their points in the order of
+	/// `indices`.
+	///
+	/// The chunks are inflated and decoded on [`LoadOptions::threads`]
+	/// threads, one chunk per thread at a time, straight into the buffers of
+	/// the result.
+	///
+	/// # Args
+	///
+	/// `indices` - chunks to load.
+	/// `opts` - options for loading the splat.
+	pub fn load_chunks(&self, indices: &[usize], opts: &LoadOptions) -> Result<GaussianSplat> {
+		if let Some(i) = indices.iter().find(|&&i| i >= self.chunks.len()) {
+			bail!("chunk {i} out of range, the file has {}", self.chunks.len());
+		}
+		let num_points = indices
+			.iter()
+			.map(|&i| self.chunks[i].num_points)
+			.sum::<usize>();
+
+		if unlikely(num_points > i32::MAX as usize) {
+			bail!("too many points: {num_points}");
+		}
+		let header = |num_points: usize| Header {
+			num_points: num_points as i32,
+			spherical_harmonics_degree: self.sh_degree,
+			..Default::default()
+		};
+		opts.check_limits(&header(num_points))?;
+
+		// every chunk must be able to inflate to the points of the index
+		// before they get allocated
+		for &i in indices {
+			let n = self.chunks[i].num_points;
+			let len = opts.check_limits(&header(n))?;
+
+			if unlikely(
+				len > compression::max_decompressed_len(
+					self.chunk_bytes(i).unwrap_or_default(),
+				),
+			) {
+				bail!("chunk {i} is too short for its {n} points");
+			}
+		}
+		let lens = AttributeLens::decoded(&header(num_points), opts);
+		let mut splat = GaussianSplat {
+			header: Header {
+				num_points: num_points as i32,
+				spherical_harmonics_degree: opts.decoded_sh_degree(self.sh_degree),
+				flags: self.flags,
+				..Default::default()
+			},
+			positions: vec![0.0; lens.positions],
+			scales: vec![0.0; lens.scales],
+			rotations: vec![0.0; lens.rotations],
+			alphas: vec![0.0; lens.alphas],
+			colors: vec![0.0; lens.colors],
+			spherical_harmonics: vec![0.0; lens.spherical_harmonics],
+		};
+		let mut outs = Vec::with_capacity(indices.len());
+		let mut rest = AttributeBuffersMut {
+			positions: &mut splat.positions,
+			scales: &mut splat.scales,
+			rotations: &mut splat.rotations,
+			alphas: &mut splat.alphas,
+			colors: &mut splat.colors,
+			spherical_harmonics: &mut splat.spherical_harmonics,
+		};
+		for &i in indices {
+			let n = self.chunks[i].num_points;
+			let (head, tail) =
+				split_buffers(rest, AttributeLens::decoded(&header(n), opts));
+
+			outs.push((i, head));
+			rest = tail;
+		}
+		let chunk_opts = LoadOptions {
+			threads: 1,
+			..opts.clone()
+		};
+		let to_target = CoordinateSystem::RightUpBack.axis_flips_to(opts.coord_sys);
+		let jobs = parallel::deal(outs, parallel::available_threads(opts.threads));
+
+		parallel::try_run(jobs, |jobs| {
+			let mut decoder = Decoder::new();
+
+			for (i, out) in jobs {
+				self.decode_chunk(&mut decoder, i, &chunk_opts, &to_target, out)
+					.with_context(|| format!("unable to load chunk {i}"))?;
+			}
+			Ok(())
+		})?;
+
+		Ok(splat)
+	}
+
+	fn decode_chunk(
+		&self,
+		decoder: &mut Decoder,
+		i: usize,
+		opts: &LoadOptions,
+		to_target: &AxisFlips,
+		out: AttributeBuffersMut<'_>,
+	) -> Result<()> {
+		let chunk = &self.chunks[i];
+		let packed = decoder
+			.decompress_stream_with(self.chunk_bytes(i).unwrap_or_default(), opts)?;
+
+		if unlikely(
+			packed.num_points as usize != chunk.num_points
+				|| packed.sh_degree != self.sh_degree as i32,
+		) {
+			bail!("chunk doesn't match the index");
+		}
+		let positions = out.positions;
+
+		GaussianSplat::decode_into(
+			&packed,
+			opts,
+			AttributeBuffersMut {
+				positions: &mut *positions,
+				..out
+			},
+		)?;
+		let origin = [0, 1, 2].map(|i| chunk.origin[i] * to_target.position[i]);
+
+		for p in positions.chunks_exact_mut(3) {
+			p[0] += origin[0];
+			p[1] += origin[1];
+			p[2] += origin[2];
+		}
+		Ok(())
+	}
+}
+
+/// Splits `buffers` after the first `lens` floats of each attribute.
+fn split_buffers(
+	buffers: AttributeBuffersMut<'_>,
+	lens: AttributeLens,
+) -> (AttributeBuffersMut<'_>, AttributeBuffersMut<'_>) {
+	let AttributeBuffersMut {
+		positions,
+		scales,
+		rotations,
+		alphas,
+		colors,
+		spherical_harmonics,
+	} = buffers;
+	let (positions, positions_tail) = positions.split_at_mut(lens.positions);
+	let (scales, scales_tail) = scales.split_at_mut(lens.scales);
+	let (rotations, rotations_tail) = rotations.split_at_mut(lens.rotations);
+	let (alphas, alphas_tail) = alphas.split_at_mut(lens.alphas);
+	let (colors, colors_tail) = colors.split_at_mut(lens.colors);
+	let (spherical_harmonics, spherical_harmonics_tail) =
+		spherical_harmonics.split_at_mut(lens.spherical_harmonics);
+
+	(
+		AttributeBuffersMut {
+			positions,
+			scales,
+			rotations,
+			alphas,
+			colors,
+			spherical_harmonics,
+		},
+		AttributeBuffersMut {
+			positions: positions_tail,
+			scales: scales_tail,
+			rotations: rotations_tail,
+			alphas: alphas_tail,
+			colors: colors_tail,
+			spherical_harmonics: spherical_harmonics_tail,
+		},
+	)
+}
+
+/// Reorders `order` into runs of at most `max_points` points that are close
+/// to each other, splitting at the median of the longest axis, and appends
+/// the runs, offset by `start`, to `ranges`.
+fn split_spatially(
+	positions: &[f32],
+	order: &mut [u32],
+	start: usize,
+	max_points: usize,
+	ranges: &mut Vec<Range<usize>>,
+) {
+	if order.len() <= max_points {
+		if !order.is_empty() {
+			ranges.push(start..start + order.len());
+		}
+		return;
+	}
+	let bbox = bounds_of(positions, order);
+	let (x, y, z) = bbox.size();
+	let axis = if x >= y && x >= z {
+		0
+	} else if y >= z {
+		1
+	} else {
+		2
+	};
+	let mid = order.len() / 2;
+
+	order.select_nth_unstable_by(mid, |&a, &b| {
+		positions[a as usize * 3 + axis].total_cmp(&positions[b as usize * 3 + axis])
+	});
+	let (head, tail) = order.split_at_mut(mid);
+
+	split_spatially(positions, head, start, max_points, ranges);
+	split_spatially(positions, tail, start + mid, max_points, ranges);
+}
+
+/// Bounds of the points `order` of `positions`.
+fn bounds_of(positions: &[f32], order: &[u32]) -> BoundingBox {
+	let mut bbox = BoundingBox {
+		min_x: f32::INFINITY,
+		max_x: f32::NEG_INFINITY,
+		min_y: f32::INFINITY,
+		max_y: f32::NEG_INFINITY,
+		min_z: f32::INFINITY,
+		max_z: f32::NEG_INFINITY,
+	};
+	for &i in order {
+		let p = &positions[i as usize * 3..i as usize * 3 + 3];
+
+		bbox.min_x = bbox.min_x.min(p[0]);
+		bbox.max_x = bbox.max_x.max(p[0]);
+		bbox.min_y = bbox.min_y.min(p[1]);
+		bbox.max_y = bbox.max_y.max(p[1]);
+		bbox.min_z = bbox.min_z.min(p[2]);
+		bbox.max_z = bbox.max_z.max(p[2]);
+	}
+	bbox
+}
+
+/// Copies the points `order` of `splat` into a new splat, with positions
+/// relative to the center of their bounds.
+///
+/// # Returns
+///
+/// The new splat, the center and the bounds.
+fn gather(splat: &GaussianSplat, order: &[u32]) -> (GaussianSplat, [f32; 3], BoundingBox) {
+	let sh_dim = dim_for_degree(splat.header.spherical_harmonics_degree) as usize * 3;
+	let attribute = |src: &[f32], stride: usize| -> Vec<f32> {
+		order.iter()
+			.flat_map(|&i| &src[i as usize * stride..(i as usize + 1) * stride])
+			.copied()
+			.collect()
+	};
+	let mut positions = attribute(&splat.positions, 3);
+	let bbox = BoundingBox::from_positions(&positions);
+	let (x, y, z) = bbox.center();
+
+	for p in positions.chunks_exact_mut(3) {
+		p[0] -= x;
+		p[1] -= y;
+		p[2] -= z;
+	}
+	let chunk = GaussianSplat {
+		header: Header {
+			num_points: order.len() as i32,
+			..splat.header
+		},
+		positions,
+		scales: attribute(&splat.scales, 3),
+		rotations: attribute(&splat.rotations, 4),
+		alphas: attribute(&splat.alphas, 1),
+		colors: attribute(&splat.colors, 3),
+		spherical_harmonics: attribute(&splat.spherical_harmonics, sh_dim),
+	};
+	(chunk, [x, y, z], bbox)
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+	use crate::{gaussian_splat::AttributeMask, test_util};
+
+	/// A line of points along x, far from the origin, `0.5` apart.
+	fn splat(num_points: usize) -> GaussianSplat {
+		let mut splat = test_util::splat(num_points, 1);
+
+		for (i, p) in splat.positions.chunks_exact_mut(3).enumerate() {
+			p[0] = 10_000.0 + i as f32 * 0.5;
+			p[2] -= 5_000.0;
+		}
+		splat
+	}
+
+	/// Points sorted along x, as `(x, y, z, alpha)`.
+	fn sorted_points(splat: &GaussianSplat) -> Vec<[f32; 4]> {
+		let mut points: Vec<_> = splat
+			.positions
+			.chunks_exact(3)
+			.zip(&splat.alphas)
+			.map(|(p, &a)| [p[0], p[1], p[2], a])
+			.collect();
+
+		points.sort_by(|a, b| a[0].total_cmp(&b[0]));
+		points
+	}
+
+	#[test]
+	fn test_chunked_roundtrip_keeps_far_positions() {
+		let expected = splat(5000);
+		let bytes = serialize_chunked(&expected, &SaveOptions::default(), 1000).unwrap();
+		let file = ChunkedSpz::from_bytes(bytes.as_slice()).unwrap();
+
+		assert_eq!(file.num_points(), 5000);
+		assert!(file.chunks().len() >= 5);
+		assert!(file.chunks().iter().all(|c| c.num_points <= 1000));
+
+		let opts = LoadOptions::builder().threads(3).build();
+		let loaded = file.load_all(&opts).unwrap();
+
+		assert!(loaded.check_sizes());
+		assert_eq!(
+			loaded,
+			GaussianSplat::read_from_bytes(&bytes, &opts).unwrap()
+		);
+
+		for (a, b) in sorted_points(&loaded).iter().zip(sorted_points(&expected)) {
+			for k in 0..3 {
+				assert!((a[k] - b[k]).abs() < 0.01, "{a:?} != {b:?}");
+			}
+			assert!((a[3] - b[3]).abs() < 0.1);
+		}
+	}
+
+	#[test]
+	fn test_chunked_region_loads_only_intersecting_chunks() {
+		let expected = splat(4000);
+		let bytes = serialize_chunked(&expected, &SaveOptions::default(), 500).unwrap();
+		let file = ChunkedSpz::from_bytes(bytes.as_slice()).unwrap();
+
+		let region = BoundingBox {
+			min_x: 10_000.0,
+			max_x: 10_100.0,
+			min_y: -10.0,
+			max_y: 10.0,
+			min_z: -6_000.0,
+			max_z: -4_000.0,
+		};
+		let chunks = file.chunks_intersecting(&region, CoordinateSystem::RightUpBack);
+
+		assert!(!chunks.is_empty() && chunks.len() < file.chunks().len());
+
+		let loaded = file.load_region(&region, &LoadOptions::default()).unwrap();
+		let inside = |p: &[f32]| p[0] <= region.max_x + 0.01;
+
+		assert_eq!(
+			loaded.positions
+				.chunks_exact(3)
+				.filter(|p| inside(p))
+				.count(),
+			expected.positions
+				.chunks_exact(3)
+				.filter(|p| inside(p))
+				.count(),
+		);
+
+		// the same region, given in another coordinate system
+		let luf = CoordinateSystem::LeftUpFront;
+		let flipped = region.flipped(&CoordinateSystem::RightUpBack.axis_flips_to(luf));
+
+		assert_eq!(file.chunks_intersecting(&flipped, luf), chunks);
+
+		let loaded_luf = file
+			.load_chunks(&chunks, &LoadOptions::builder().coord_sys(luf).build())
+			.unwrap();
+
+		for (a, b) in loaded_luf
+			.positions
+			.chunks_exact(3)
+			.zip(loaded.positions.chunks_exact(3))
+		{
+			assert_eq!([a[0], a[1], a[2]], [-b[0], b[1], -b[2]]);
+		}
+	}
+
+	#[test]
+	fn test_chunked_selective_load_matches_full_load() {
+		let bytes = serialize_chunked(&splat(3000), &SaveOptions::default(), 1000).unwrap();
+		let file = ChunkedSpz::from_bytes(bytes.as_slice()).unwrap();
+		let full = file
+			.load_all(&LoadOptions::builder().threads(2).build())
+			.unwrap();
+
+		let opts = LoadOptions::builder()
+			.threads(2)
+			.max_sh_degree(0)
+			.attributes(AttributeMask::POSITIONS | AttributeMask::ALPHAS)
+			.build();
+		let loaded = file.load_all(&opts).unwrap();
+
+		assert_eq!(loaded.header.spherical_harmonics_degree, 0);
+		assert_eq!(loaded.positions, full.positions);
+		assert_eq!(loaded.alphas, full.alphas);
+		assert!(loaded.scales.is_empty() && loaded.colors.is_empty());
+		assert!(loaded.rotations.is_empty() && loaded.spherical_harmonics.is_empty());
+	}
+
+	#[test]
+	fn test_chunked_invalid_files_fail() {
+		let bytes = serialize_chunked(&splat(100), &SaveOptions::default(), 30).unwrap();
+
+		assert!(ChunkedSpz::from_bytes(&bytes[..40]).is_err());
+		assert!(ChunkedSpz::from_bytes(&bytes[..bytes.len() - 1]).is_err());
+		assert!(serialize_chunked(&splat(10), &SaveOptions::default(), 0).is_err());
+
+		let file = ChunkedSpz::from_bytes(bytes.as_slice()).unwrap();
+
+		assert!(file
+			.load_chunks(&[file.chunks().len()], &LoadOptions::default())
+			.is_err());
+
+		let empty =
+			serialize_chunked(&GaussianSplat::default(), &SaveOptions::default(), 30)
+				.unwrap();
+		let empty = ChunkedSpz::from_bytes(empty.as_slice()).unwrap();
+
+		assert!(empty.chunks().is_empty());
+		assert_eq!(
+			empty.load_all(&LoadOptions::default())
+				.unwrap()
+				.header
+				.num_points,
+			0
+		);
+	}
+}
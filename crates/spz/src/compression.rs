@@ -1,24 +1,437 @@
 // SPDX-License-Identifier: Apache-2.0 OR MIT
 
-pub mod gzip {
-	use std::io::{BufRead, BufReader, Read};
+//! Compression of SPZ data.
+//!
+//! SPZ files are gzip streams, see [`gzip`]. The gzip backend is `flate2`
+//! with its default miniz_oxide backend, or zlib-ng with the `zlib-ng`
+//! feature. The `libdeflate` feature additionally routes whole-buffer
+//! deflate and inflate through libdeflate.
+//!
+//! With the `zstd` feature the data can instead be stored as a zstd frame,
+//! see [`zstd`]. That is not an SPZ file other readers understand, and is
+//! meant for internal caches. Readers in this crate detect the codec from the
+//! leading magic bytes.
+
+use std::io::Read;
+use std::str::FromStr;
+
+use anyhow::{Error, Result, anyhow};
+use arbitrary::Arbitrary;
+use serde::{Deserialize, Serialize};
+
+use crate::instrument::{self, Stage};
+
+/// Compression format of packed gaussian data.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq, Hash, Serialize, Deserialize, Arbitrary)]
+pub enum Codec {
+	/// gzip, the SPZ file format.
+	#[default]
+	Gzip,
+	/// A zstd frame, not readable by other SPZ readers. Needs the `zstd`
+	/// feature.
+	Zstd,
+}
+
+impl Codec {
+	/// Detects the codec of compressed data from its magic bytes, anything
+	/// not zstd is taken for gzip.
+	#[inline]
+	pub fn detect(compressed: &[u8]) -> Self {
+		if compressed.starts_with(&zstd::MAGIC) {
+			Codec::Zstd
+		} else {
+			Codec::Gzip
+		}
+	}
+
+	#[inline]
+	pub const fn as_str(&self) -> &'static str {
+		match self {
+			Codec::Gzip => "gzip",
+			Codec::Zstd => "zstd",
+		}
+	}
+}
+
+impl FromStr for Codec {
+	type Err = Error;
+
+	#[inline]
+	fn from_str(s: &str) -> Result<Self, Self::Err> {
+		match s.to_lowercase().as_ref() {
+			"gzip" | "gz" => Ok(Codec::Gzip),
+			"zstd" | "zst" => Ok(Codec::Zstd),
+			_ => Err(anyhow!("invalid codec: {}", s)),
+		}
+	}
+}
+
+/// Speed/ratio tradeoff of compression, as a preset or a codec specific
+/// level.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq, Hash, Serialize, Deserialize, Arbitrary)]
+pub enum CompressionLevel {
+	/// Fastest compression.
+	Fast,
+	/// The codec's default tradeoff.
+	#[default]
+	Default,
+	/// Smallest output.
+	Best,
+	/// A codec specific level, clamped to the range of the codec: `0..=9`
+	/// for gzip (`0..=12` with libdeflate), `1..=22` for zstd.
+	Level(u32),
+}
+
+impl CompressionLevel {
+	/// Highest gzip level of the backend in use.
+	pub const MAX_GZIP_LEVEL: u32 = if cfg!(feature = "libdeflate") { 12 } else { 9 };
+
+	/// The gzip level of the backend in use.
+	#[inline]
+	pub fn gzip(self) -> u32 {
+		match self {
+			CompressionLevel::Fast => 1,
+			CompressionLevel::Default => 6,
+			CompressionLevel::Best => Self::MAX_GZIP_LEVEL,
+			CompressionLevel::Level(level) => level.min(Self::MAX_GZIP_LEVEL),
+		}
+	}
+
+	/// The zstd level.
+	#[inline]
+	pub fn zstd(self) -> i32 {
+		match self {
+			CompressionLevel::Fast => 1,
+			CompressionLevel::Default => 3,
+			CompressionLevel::Best => 19,
+			CompressionLevel::Level(level) => level.clamp(1, 22) as i32,
+		}
+	}
+}
+
+impl FromStr for CompressionLevel {
+	type Err = Error;
+
+	/// Parses `fast`, `default`, `best` or a numeric level.
+	#[inline]
+	fn from_str(s: &str) -> Result<Self, Self::Err> {
+		match s.to_lowercase().as_ref() {
+			"fast" | "fastest" => Ok(CompressionLevel::Fast),
+			"default" => Ok(CompressionLevel::Default),
+			"best" | "small" | "smallest" => Ok(CompressionLevel::Best),
+			level => level
+				.parse()
+				.map(CompressionLevel::Level)
+				.map_err(|_| anyhow!("invalid compression level: {}", s)),
+		}
+	}
+}
+
+/// Compresses data into a single gzip member or a zstd frame.
+///
+/// # Args
+///
+/// `decompressed` - data to compress.
+/// `compressed` - output buffer, its contents are replaced.
+/// `codec` - compression format.
+/// `level` - speed/ratio tradeoff.
+#[inline]
+pub fn compress(
+	decompressed: &[u8],
+	compressed: &mut Vec<u8>,
+	codec: Codec,
+	level: CompressionLevel,
+) -> Result<()> {
+	let mut stage = instrument::enter(Stage::Deflate, decompressed.len());
+	let (len, capacity) = (compressed.len(), compressed.capacity());
+
+	match codec {
+		Codec::Gzip => gzip::compress_bytes_with_level(decompressed, compressed, level)?,
+		Codec::Zstd => zstd::compress_bytes(decompressed, compressed, level)?,
+	}
+	stage.bytes_out(compressed.len().saturating_sub(len));
+	stage.allocated(compressed.capacity().saturating_sub(capacity));
+
+	Ok(())
+}
+
+/// Decompresses gzip or zstd compressed data, detecting the codec, into the
+/// given buffer.
+///
+/// # Args
+///
+/// `compressed` - compressed data.
+/// `decompressed` - output buffer, the data is appended to it.
+/// `threads` - number of threads for indexed multi-member gzip streams,
+/// `0` uses all available cores.
+#[inline]
+pub fn decompress(compressed: &[u8], decompressed: &mut Vec<u8>, threads: usize) -> Result<()> {
+	let mut stage = instrument::enter(Stage::Inflate, compressed.len());
+	let (len, capacity) = (decompressed.len(), decompressed.capacity());
+
+	match Codec::detect(compressed) {
+		Codec::Gzip => gzip::decompress_parallel(compressed, decompressed, threads)?,
+		Codec::Zstd => zstd::decompress_end(compressed, decompressed)?,
+	}
+	stage.bytes_out(decompressed.len().saturating_sub(len));
+	stage.allocated(decompressed.capacity().saturating_sub(capacity));
+
+	Ok(())
+}
+
+/// Like [`decompress`], decompressing only the first `len` bytes, or a
+/// little more, of the data. Indexed multi-member gzip streams only inflate
+/// the members holding them, other streams stop inflating after them.
+///
+/// # Args
+///
+/// `compressed` - compressed data.
+/// `decompressed` - output buffer, at least `len` bytes, or all of the data
+/// if it is shorter, are appended to it.
+/// `threads` - number of threads for indexed multi-member gzip streams,
+/// `0` uses all available cores.
+/// `len` - number of bytes of the data needed.
+pub fn decompress_prefix(
+	compressed: &[u8],
+	decompressed: &mut Vec<u8>,
+	threads: usize,
+	len: usize,
+) -> Result<()> {
+	let mut stage = instrument::enter(Stage::Inflate, compressed.len());
+	let (start, capacity) = (decompressed.len(), decompressed.capacity());
+
+	if Codec::detect(compressed) == Codec::Gzip && gzip::is_indexed_multi_member(compressed) {
+		gzip::decompress_parallel_prefix(compressed, decompressed, threads, len)?;
+	} else {
+		decoder(compressed)?
+			.take(len as u64)
+			.read_to_end(decompressed)
+			.inspect_err(|_| decompressed.truncate(start))?;
+	}
+	stage.bytes_out(decompressed.len().saturating_sub(start));
+	stage.allocated(decompressed.capacity().saturating_sub(capacity));
+
+	Ok(())
+}
+
+/// Upper bound of the length of the data `compressed` decompresses to, to
+/// reject headers claiming more before allocating for them. Zstd data isn't
+/// bounded.
+#[inline]
+pub fn max_decompressed_len(compressed: &[u8]) -> usize {
+	match Codec::detect(compressed) {
+		Codec::Gzip => compressed.len().saturating_mul(gzip::MAX_DEFLATE_RATIO),
+		Codec::Zstd => usize::MAX,
+	}
+}
+
+/// Wraps a reader of gzip or zstd compressed data, detecting the codec, into
+/// a reader of the decompressed data.
+pub fn decoder<'a, R>(compressed: R) -> Result<Box<dyn Read + 'a>>
+where
+	R: Read + 'a,
+{
+	let mut compressed = compressed;
+	let mut magic = Vec::with_capacity(zstd::MAGIC.len());
+
+	(&mut compressed)
+		.take(zstd::MAGIC.len() as u64)
+		.read_to_end(&mut magic)?;
+
+	let compressed = std::io::Cursor::new(magic).chain(compressed);
+
+	if Codec::detect(compressed.get_ref().0.get_ref()) == Codec::Zstd {
+		zstd::decoder(compressed)
+	} else {
+		Ok(Box::new(flate2::read::MultiGzDecoder::new(compressed)))
+	}
+}
 
+pub mod zstd {
+	//! zstd compression, for caches only: the output is not an SPZ file.
+
+	#[cfg(feature = "zstd")]
 	use anyhow::Context;
 	use anyhow::Result;
+	#[cfg(not(feature = "zstd"))]
+	use anyhow::bail;
+	use std::io::Read;
+
+	use super::CompressionLevel;
+
+	/// Magic bytes starting a zstd frame.
+	pub const MAGIC: [u8; 4] = [0x28, 0xb5, 0x2f, 0xfd];
+
+	/// Compress data into a zstd frame.
+	#[cfg(feature = "zstd")]
+	#[inline]
+	pub fn compress_bytes(
+		decompressed: &[u8],
+		compressed: &mut Vec<u8>,
+		level: CompressionLevel,
+	) -> Result<()> {
+		*compressed = ::zstd::bulk::compress(decompressed, level.zstd())
+			.with_context(|| "unable to compress")?;
+
+		Ok(())
+	}
+
+	/// Decompress zstd compressed data into the given buffer.
+	#[cfg(feature = "zstd")]
+	#[inline]
+	pub fn decompress_end(compressed: &[u8], decompressed: &mut Vec<u8>) -> Result<()> {
+		::zstd::stream::read::Decoder::new(compressed)
+			.and_then(|mut decoder| decoder.read_to_end(decompressed))
+			.with_context(|| "unable to decompress to end")?;
+
+		Ok(())
+	}
+
+	/// Wraps a reader of zstd compressed data.
+	#[cfg(feature = "zstd")]
+	pub(super) fn decoder<'a, R>(compressed: R) -> Result<Box<dyn Read + 'a>>
+	where
+		R: Read + 'a,
+	{
+		Ok(Box::new(
+			::zstd::stream::read::Decoder::new(compressed)
+				.with_context(|| "unable to create zstd decoder")?,
+		))
+	}
+
+	#[cfg(not(feature = "zstd"))]
+	#[inline]
+	pub fn compress_bytes(
+		_decompressed: &[u8],
+		_compressed: &mut Vec<u8>,
+		_level: CompressionLevel,
+	) -> Result<()> {
+		bail!("zstd support is not enabled, build with the `zstd` feature")
+	}
+
+	#[cfg(not(feature = "zstd"))]
+	#[inline]
+	pub fn decompress_end(_compressed: &[u8], _decompressed: &mut Vec<u8>) -> Result<()> {
+		bail!("zstd support is not enabled, build with the `zstd` feature")
+	}
+
+	#[cfg(not(feature = "zstd"))]
+	pub(super) fn decoder<'a, R>(_compressed: R) -> Result<Box<dyn Read + 'a>>
+	where
+		R: Read + 'a,
+	{
+		bail!("zstd support is not enabled, build with the `zstd` feature")
+	}
+}
+
+pub mod gzip {
+	//! gzip compression of SPZ data.
+	//!
+	//! Besides plain single member streams, data can be compressed in
+	//! independent blocks on several threads, see [`compress_parallel`]. Each
+	//! block becomes its own gzip member, and each member carries its total
+	//! size in an `SP` extra field subfield (like BGZF does), so
+	//! [`decompress_parallel`] can find the members without inflating and
+	//! inflate them concurrently. Any gzip reader that handles multiple
+	//! members reads such streams as is.
+	//!
+	//! With the `libdeflate` feature, whole buffers and members are deflated
+	//! and inflated by libdeflate.
+
+	use std::io::{BufRead, Read};
+	#[cfg(not(feature = "libdeflate"))]
+	use std::io::{BufReader, Write};
+
+	use anyhow::Context;
+	use anyhow::{Result, bail};
+	#[cfg(not(feature = "libdeflate"))]
+	use flate2::write::DeflateEncoder;
 	use flate2::{
-		Compression,
-		bufread::{GzDecoder, GzEncoder},
+		Compression, Crc, Decompress, FlushDecompress, Status,
+		bufread::{GzEncoder, MultiGzDecoder},
 	};
+	use likely_stable::unlikely;
+
+	use super::CompressionLevel;
+	use crate::parallel;
+
+	/// Smallest block of input compressed into one member by
+	/// [`compress_parallel`], smaller blocks cost ratio for little speedup.
+	pub const MIN_MEMBER_INPUT_SIZE: usize = 1024 * 1024;
+
+	/// Largest block of input compressed into one member by
+	/// [`compress_parallel`], keeping member sizes within 32 bits.
+	pub const MAX_MEMBER_INPUT_SIZE: usize = 1024 * 1024 * 1024;
+
+	/// gzip member header with the `FEXTRA` flag and a single `SP` subfield,
+	/// whose 4 byte little endian payload (zero here) is the member size.
+	const MEMBER_HEADER: [u8; 20] = [
+		0x1f, 0x8b, // magic
+		8,    // CM: deflate
+		0x04, // FLG: FEXTRA
+		0, 0, 0, 0,    // MTIME
+		0,    // XFL
+		0xff, // OS: unknown
+		8, 0, // XLEN
+		b'S', b'P', 4, 0, // subfield id and length
+		0, 0, 0, 0, // member size
+	];
+
+	/// Offset of the member size in [`MEMBER_HEADER`].
+	const MEMBER_SIZE_OFFSET: usize = 16;
+
+	/// CRC32 and ISIZE.
+	pub(crate) const MEMBER_TRAILER_SIZE: usize = 8;
+
+	/// Upper bound of the deflate compression ratio, used to reject member
+	/// trailers claiming impossible sizes before allocating for them.
+	pub(super) const MAX_DEFLATE_RATIO: usize = 1032;
 
 	/// Compress data using gzip compression.
 	#[inline]
 	pub fn compress_bytes(decompressed: &[u8], compressed: &mut Vec<u8>) -> Result<()> {
+		compress_bytes_with_level(decompressed, compressed, CompressionLevel::Default)
+	}
+
+	/// Compress data using gzip compression at the given level.
+	#[cfg(not(feature = "libdeflate"))]
+	#[inline]
+	pub fn compress_bytes_with_level(
+		decompressed: &[u8],
+		compressed: &mut Vec<u8>,
+		level: CompressionLevel,
+	) -> Result<()> {
 		compressed.clear();
 		compressed.reserve(decompressed.len() / 4);
 
 		let reader = BufReader::new(decompressed);
+		let mut encoder = GzEncoder::new(reader, Compression::new(level.gzip()));
 
-		compress(reader, compressed)
+		encoder.read_to_end(compressed)
+			.with_context(|| "unable to compress")?;
+
+		Ok(())
+	}
+
+	/// Compress data using gzip compression at the given level.
+	#[cfg(feature = "libdeflate")]
+	pub fn compress_bytes_with_level(
+		decompressed: &[u8],
+		compressed: &mut Vec<u8>,
+		level: CompressionLevel,
+	) -> Result<()> {
+		let mut compressor = libdeflate::compressor(level)?;
+
+		compressed.clear();
+		compressed.resize(compressor.gzip_compress_bound(decompressed.len()), 0);
+
+		let len = compressor
+			.gzip_compress(decompressed, compressed)
+			.map_err(|e| anyhow::anyhow!("unable to compress: {e:?}"))?;
+
+		compressed.truncate(len);
+
+		Ok(())
 	}
 
 	/// Compress data using gzip compression.
@@ -42,7 +455,11 @@ pub mod gzip {
 		C: AsRef<[u8]>,
 		D: AsMut<Vec<u8>>,
 	{
-		let mut gz_decoder = GzDecoder::new(compressed.as_ref());
+		#[cfg(feature = "libdeflate")]
+		if libdeflate::inflate_single_member(compressed.as_ref(), decompressed.as_mut()) {
+			return Ok(());
+		}
+		let mut gz_decoder = MultiGzDecoder::new(compressed.as_ref());
 
 		gz_decoder
 			.read_to_end(decompressed.as_mut())
@@ -51,6 +468,713 @@ pub mod gzip {
 		Ok(())
 	}
 
+	/// Reusable gzip inflate state.
+	///
+	/// Unlike [`decompress_end`], which sets up a new decoder per call, an
+	/// `Inflater` resets and reuses its state, and inflates into the spare
+	/// capacity of the output. Inflating streams into a buffer of sufficient
+	/// capacity doesn't allocate.
+	pub struct Inflater {
+		inflater: Decompress,
+		#[cfg(feature = "libdeflate")]
+		decompressor: libdeflater::Decompressor,
+	}
+
+	impl Default for Inflater {
+		#[inline]
+		fn default() -> Self {
+			Self::new()
+		}
+	}
+
+	impl std::fmt::Debug for Inflater {
+		fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+			f.debug_struct("Inflater").finish_non_exhaustive()
+		}
+	}
+
+	impl Inflater {
+		#[inline]
+		pub fn new() -> Self {
+			Self {
+				inflater: Decompress::new(false),
+				#[cfg(feature = "libdeflate")]
+				decompressor: libdeflater::Decompressor::new(),
+			}
+		}
+
+		/// Inflates every member of a gzip stream.
+		///
+		/// # Args
+		///
+		/// `compressed` - gzip compressed data, one or more members.
+		/// `decompressed` - output buffer, the data is appended to it.
+		pub fn inflate_to_end(
+			&mut self,
+			compressed: &[u8],
+			decompressed: &mut Vec<u8>,
+		) -> Result<()> {
+			#[cfg(feature = "libdeflate")]
+			if libdeflate::inflate_single_member_with(
+				&mut self.decompressor,
+				compressed,
+				decompressed,
+			) {
+				return Ok(());
+			}
+			let start = decompressed.len();
+
+			self.inflate_members(compressed, decompressed)
+				.inspect_err(|_| decompressed.truncate(start))
+		}
+
+		/// Inflates the start of the first member of a gzip stream into
+		/// `out`, as far as `compressed` or `out` reach. Truncated streams,
+		/// like the first block of a file, are fine.
+		///
+		/// # Args
+		///
+		/// `compressed` - the start of gzip compressed data.
+		/// `out` - output buffer, filled from its start.
+		///
+		/// # Returns
+		///
+		/// The number of bytes written to `out`.
+		pub fn inflate_prefix(
+			&mut self,
+			compressed: &[u8],
+			out: &mut [u8],
+		) -> Result<usize> {
+			let deflate = &compressed[member_header_len(compressed)?..];
+
+			self.inflater.reset(false);
+
+			loop {
+				let consumed = self.inflater.total_in() as usize;
+				let produced = self.inflater.total_out() as usize;
+
+				let status = self
+					.inflater
+					.decompress(
+						&deflate[consumed..],
+						&mut out[produced..],
+						FlushDecompress::None,
+					)
+					.with_context(|| "unable to inflate gzip member")?;
+				let written = self.inflater.total_out() as usize;
+
+				if status == Status::StreamEnd
+					|| written == out.len() || (self.inflater.total_in() as usize
+					== consumed && written == produced)
+				{
+					return Ok(written);
+				}
+			}
+		}
+
+		fn inflate_members(&mut self, compressed: &[u8], out: &mut Vec<u8>) -> Result<()> {
+			let mut rest = compressed;
+
+			if unlikely(rest.is_empty()) {
+				bail!("gzip stream is empty");
+			}
+			while !rest.is_empty() {
+				let deflate = &rest[member_header_len(rest)?..];
+
+				// the trailer of the last member holds its size, exact for
+				// single member streams
+				if let Some(isize) = trailing_isize(rest, compressed.len()) {
+					out.reserve(isize);
+				}
+				let start = out.len();
+				let consumed = self.inflate_member_data(deflate, out)?;
+
+				let Some(trailer) =
+					deflate.get(consumed..consumed + MEMBER_TRAILER_SIZE)
+				else {
+					bail!("gzip member trailer is missing");
+				};
+				let mut crc = Crc::new();
+
+				crc.update(&out[start..]);
+
+				if unlikely(crc.sum() != le_u32(&trailer[..4])) {
+					bail!("gzip member crc mismatch");
+				}
+				if unlikely((out.len() - start) as u32 != le_u32(&trailer[4..])) {
+					bail!("gzip member size mismatch");
+				}
+				rest = &deflate[consumed + MEMBER_TRAILER_SIZE..];
+			}
+			Ok(())
+		}
+
+		/// Inflates one raw deflate stream into the spare capacity of `out`,
+		/// growing it only when full.
+		///
+		/// # Returns
+		///
+		/// The number of bytes of `deflate` consumed.
+		fn inflate_member_data(
+			&mut self,
+			deflate: &[u8],
+			out: &mut Vec<u8>,
+		) -> Result<usize> {
+			self.inflater.reset(false);
+
+			loop {
+				if out.len() == out.capacity() {
+					out.reserve(out.capacity().max(32 * 1024));
+				}
+				let consumed = self.inflater.total_in() as usize;
+				let produced = self.inflater.total_out();
+
+				// not Finish: it inflates in one shot on the first call and
+				// fails for good if `out` can't hold the whole member
+				let status = self
+					.inflater
+					.decompress_vec(
+						&deflate[consumed..],
+						out,
+						FlushDecompress::None,
+					)
+					.with_context(|| "unable to inflate gzip member")?;
+
+				if status == Status::StreamEnd {
+					return Ok(self.inflater.total_in() as usize);
+				}
+				if unlikely(
+					self.inflater.total_in() as usize == consumed
+						&& self.inflater.total_out() == produced && out.len()
+						< out.capacity(),
+				) {
+					bail!("gzip member is truncated");
+				}
+			}
+		}
+	}
+
+	/// Length of the gzip member header at the start of `b`, with its
+	/// optional fields.
+	fn member_header_len(b: &[u8]) -> Result<usize> {
+		const FHCRC: u8 = 0x02;
+		const FEXTRA: u8 = 0x04;
+		const FNAME: u8 = 0x08;
+		const FCOMMENT: u8 = 0x10;
+
+		if unlikely(b.len() < 10 || b[..3] != [0x1f, 0x8b, 8]) {
+			bail!("invalid gzip header");
+		}
+		let flags = b[3];
+		let mut len = 10;
+
+		if flags & FEXTRA != 0 {
+			let Some(xlen) = b.get(len..len + 2) else {
+				bail!("invalid gzip header");
+			};
+			len += 2 + u16::from_le_bytes([xlen[0], xlen[1]]) as usize;
+		}
+		for field in [FNAME, FCOMMENT] {
+			if flags & field != 0 {
+				let Some(end) =
+					b.get(len..).and_then(|b| b.iter().position(|&c| c == 0))
+				else {
+					bail!("invalid gzip header");
+				};
+				len += end + 1;
+			}
+		}
+		if flags & FHCRC != 0 {
+			len += 2;
+		}
+		if unlikely(len > b.len()) {
+			bail!("invalid gzip header");
+		}
+		Ok(len)
+	}
+
+	#[inline]
+	fn le_u32(b: &[u8]) -> u32 {
+		u32::from_le_bytes([b[0], b[1], b[2], b[3]])
+	}
+
+	/// The ISIZE of the last member of `rest`, if it is plausible for
+	/// `compressed_len` bytes of deflate data.
+	#[inline]
+	fn trailing_isize(rest: &[u8], compressed_len: usize) -> Option<usize> {
+		let isize = le_u32(rest.get(rest.len().checked_sub(4)?..)?) as usize;
+
+		(isize <= compressed_len.saturating_mul(MAX_DEFLATE_RATIO)).then_some(isize)
+	}
+
+	/// Compress data into a multi-member gzip stream, compressing blocks of
+	/// the input on up to `threads` threads.
+	///
+	/// # Args
+	///
+	/// `decompressed` - the data to compress.
+	/// `compressed` - output buffer, cleared first.
+	/// `level` - compression level of every member.
+	/// `threads` - number of threads, `0` uses all available cores.
+	pub fn compress_parallel(
+		decompressed: &[u8],
+		compressed: &mut Vec<u8>,
+		level: CompressionLevel,
+		threads: usize,
+	) -> Result<()> {
+		let threads = parallel::available_threads(threads);
+		let block_size = decompressed
+			.len()
+			.div_ceil(threads)
+			.clamp(MIN_MEMBER_INPUT_SIZE, MAX_MEMBER_INPUT_SIZE);
+
+		let blocks: Vec<&[u8]> = if decompressed.is_empty() {
+			vec![decompressed]
+		} else {
+			decompressed.chunks(block_size).collect()
+		};
+		let mut members = vec![Vec::new(); blocks.len()];
+		let jobs: Vec<_> = blocks.into_iter().zip(members.iter_mut()).collect();
+
+		parallel::try_run(jobs, |(block, member)| {
+			compress_member(block, level, member)
+		})?;
+
+		compressed.clear();
+		compressed.reserve(members.iter().map(Vec::len).sum());
+
+		for member in members {
+			compressed.extend_from_slice(&member);
+		}
+		Ok(())
+	}
+
+	/// Decompress gzip-compressed data into the given buffer, inflating the
+	/// members of streams written by [`compress_parallel`] on up to `threads`
+	/// threads.
+	///
+	/// Other streams, including multi-member streams without member sizes,
+	/// are inflated sequentially.
+	///
+	/// # Args
+	///
+	/// `compressed` - gzip compressed data.
+	/// `decompressed` - output buffer, the data is appended to it.
+	/// `threads` - number of threads, `0` uses all available cores.
+	#[inline]
+	pub fn decompress_parallel(
+		compressed: &[u8],
+		decompressed: &mut Vec<u8>,
+		threads: usize,
+	) -> Result<()> {
+		decompress_parallel_prefix(compressed, decompressed, threads, usize::MAX)
+	}
+
+	/// Like [`decompress_parallel`], inflating only the members of streams
+	/// written by [`compress_parallel`] that hold the first `len` bytes of
+	/// the data. Other streams are inflated whole.
+	///
+	/// # Args
+	///
+	/// `compressed` - gzip compressed data.
+	/// `decompressed` - output buffer, the data is appended to it.
+	/// `threads` - number of threads, `0` uses all available cores.
+	/// `len` - number of bytes of the data needed.
+	pub fn decompress_parallel_prefix(
+		compressed: &[u8],
+		decompressed: &mut Vec<u8>,
+		threads: usize,
+		len: usize,
+	) -> Result<()> {
+		let Some(mut members) = indexed_members(compressed) else {
+			return decompress_end(compressed, decompressed);
+		};
+		let mut covered = 0_usize;
+
+		members.retain(|member| {
+			let needed = covered < len;
+
+			covered = covered.saturating_add(member.isize);
+			needed
+		});
+		if members.is_empty() {
+			return Ok(());
+		}
+		let threads = parallel::available_threads(threads).min(members.len());
+
+		let total = members.iter().map(|m| m.isize).sum::<usize>();
+		let start = decompressed.len();
+
+		decompressed.resize(start + total, 0);
+
+		let mut jobs = Vec::with_capacity(threads);
+		let mut rest = &mut decompressed[start..];
+
+		for members in members.chunks(members.len().div_ceil(threads)) {
+			let len = members.iter().map(|m| m.isize).sum::<usize>();
+			let (head, tail) = std::mem::take(&mut rest).split_at_mut(len);
+
+			jobs.push((members, head));
+			rest = tail;
+		}
+		parallel::try_run(jobs, |(members, mut out)| {
+			for member in members {
+				let (head, tail) =
+					std::mem::take(&mut out).split_at_mut(member.isize);
+
+				inflate_member(member, head)?;
+				out = tail;
+			}
+			Ok(())
+		})
+		.inspect_err(|_| decompressed.truncate(start))
+	}
+
+	/// Whether `compressed` is a stream of gzip members with member sizes,
+	/// as written by [`compress_parallel`].
+	#[inline]
+	pub fn is_indexed_multi_member(compressed: &[u8]) -> bool {
+		indexed_members(compressed).is_some()
+	}
+
+	/// One member of an indexed multi-member gzip stream.
+	struct Member<'a> {
+		/// The raw deflate data.
+		deflate: &'a [u8],
+		crc: u32,
+		/// Size of the inflated data.
+		isize: usize,
+	}
+
+	/// Splits an indexed multi-member gzip stream into its members.
+	///
+	/// # Returns
+	///
+	/// `None` unless every member carries its size and the sizes cover the
+	/// whole stream.
+	fn indexed_members(compressed: &[u8]) -> Option<Vec<Member<'_>>> {
+		let mut members = Vec::new();
+		let mut rest = compressed;
+
+		while !rest.is_empty() {
+			let (member, tail) = indexed_member(rest)?;
+
+			members.push(member);
+			rest = tail;
+		}
+		(!members.is_empty()).then_some(members)
+	}
+
+	/// Size of the indexed gzip member `head` starts with, from its `SP`
+	/// subfield, and the offset of its deflate data.
+	///
+	/// # Args
+	///
+	/// `head` - at least the member header and its extra field.
+	pub(crate) fn member_size(head: &[u8]) -> Option<(usize, usize)> {
+		const FEXTRA: u8 = 0x04;
+
+		let header = head.get(..12)?;
+
+		// Only FEXTRA may be set, other optional fields would precede the
+		// deflate data.
+		if header[..4] != [0x1f, 0x8b, 8, FEXTRA] {
+			return None;
+		}
+		let xlen = u16::from_le_bytes([header[10], header[11]]) as usize;
+		let mut extra = head.get(12..12 + xlen)?;
+		let mut size = None;
+
+		while extra.len() >= 4 {
+			let len = u16::from_le_bytes([extra[2], extra[3]]) as usize;
+			let data = extra.get(4..4 + len)?;
+
+			if extra[..2] == *b"SP" && len == 4 {
+				size = Some(u32::from_le_bytes(data.try_into().ok()?) as usize);
+			}
+			extra = &extra[4 + len..];
+		}
+		Some((size?, 12 + xlen))
+	}
+
+	/// Splits the first member off an indexed multi-member gzip stream.
+	fn indexed_member(compressed: &[u8]) -> Option<(Member<'_>, &[u8])> {
+		let (size, data_start) = member_size(compressed)?;
+
+		if size < data_start + MEMBER_TRAILER_SIZE || size > compressed.len() {
+			return None;
+		}
+		let (member, tail) = compressed.split_at(size);
+		let (deflate, trailer) = member[data_start..]
+			.split_at(member.len() - data_start - MEMBER_TRAILER_SIZE);
+		let crc = u32::from_le_bytes(trailer[..4].try_into().ok()?);
+		let isize = u32::from_le_bytes(trailer[4..].try_into().ok()?) as usize;
+
+		if isize > deflate.len().saturating_mul(MAX_DEFLATE_RATIO) {
+			return None;
+		}
+		Some((
+			Member {
+				deflate,
+				crc,
+				isize,
+			},
+			tail,
+		))
+	}
+
+	/// Compresses `block` into a complete gzip member with its size.
+	pub(crate) fn compress_member(
+		block: &[u8],
+		level: CompressionLevel,
+		member: &mut Vec<u8>,
+	) -> Result<()> {
+		member.clear();
+		member.reserve(MEMBER_HEADER.len() + block.len() / 4 + MEMBER_TRAILER_SIZE);
+		member.extend_from_slice(&MEMBER_HEADER);
+
+		deflate_into(block, level, member)?;
+
+		finish_member(block, member)
+	}
+
+	/// Stores `block` uncompressed into a complete gzip member with its size,
+	/// whose size only depends on the length of `block`.
+	pub(crate) fn store_member(block: &[u8], member: &mut Vec<u8>) -> Result<()> {
+		let Ok(len) = u16::try_from(block.len()) else {
+			bail!("block too large to store ({} bytes)", block.len());
+		};
+		member.clear();
+		member.extend_from_slice(&MEMBER_HEADER);
+		// a single final stored deflate block: BFINAL, LEN and NLEN
+		member.push(0x01);
+		member.extend_from_slice(&len.to_le_bytes());
+		member.extend_from_slice(&(!len).to_le_bytes());
+		member.extend_from_slice(block);
+
+		finish_member(block, member)
+	}
+
+	/// Grows a member written by [`compress_member`] to exactly `size` bytes
+	/// with a padding subfield in its extra field, which readers skip.
+	///
+	/// # Returns
+	///
+	/// Whether it fit: the padding takes at least 4 bytes, and the extra
+	/// field at most 65535.
+	pub(crate) fn pad_member(member: &mut Vec<u8>, size: usize) -> bool {
+		const XLEN_OFFSET: usize = 10;
+
+		let Some(padding) = size.checked_sub(member.len() + 4) else {
+			return false;
+		};
+		let xlen = u16::from_le_bytes([member[XLEN_OFFSET], member[XLEN_OFFSET + 1]]);
+		let (Ok(len), Some(xlen)) = (
+			u16::try_from(padding),
+			u16::try_from(padding + 4)
+				.ok()
+				.and_then(|grown| xlen.checked_add(grown)),
+		) else {
+			return false;
+		};
+		let Ok(size) = u32::try_from(size) else {
+			return false;
+		};
+		let end = MEMBER_HEADER.len();
+
+		member.splice(
+			end..end,
+			[b'P', b'D']
+				.into_iter()
+				.chain(len.to_le_bytes())
+				.chain(std::iter::repeat_n(0, padding)),
+		);
+		member[XLEN_OFFSET..XLEN_OFFSET + 2].copy_from_slice(&xlen.to_le_bytes());
+		member[MEMBER_SIZE_OFFSET..MEMBER_SIZE_OFFSET + 4]
+			.copy_from_slice(&size.to_le_bytes());
+
+		true
+	}
+
+	/// Appends the trailer of `block` to `member` and records its size.
+	fn finish_member(block: &[u8], member: &mut Vec<u8>) -> Result<()> {
+		let mut crc = Crc::new();
+
+		crc.update(block);
+
+		member.extend_from_slice(&crc.sum().to_le_bytes());
+		member.extend_from_slice(&(block.len() as u32).to_le_bytes());
+
+		let Ok(size) = u32::try_from(member.len()) else {
+			bail!("gzip member too large ({} bytes)", member.len());
+		};
+		member[MEMBER_SIZE_OFFSET..MEMBER_SIZE_OFFSET + 4]
+			.copy_from_slice(&size.to_le_bytes());
+
+		Ok(())
+	}
+
+	/// Inflates `member` into `out`, which is exactly its inflated size.
+	fn inflate_member(member: &Member<'_>, out: &mut [u8]) -> Result<()> {
+		inflate_into(member.deflate, out)?;
+
+		let mut crc = Crc::new();
+
+		crc.update(out);
+
+		if unlikely(crc.sum() != member.crc) {
+			bail!("gzip member crc mismatch");
+		}
+		Ok(())
+	}
+
+	/// Appends the raw deflate stream of `block` to `out`.
+	#[cfg(not(feature = "libdeflate"))]
+	fn deflate_into(block: &[u8], level: CompressionLevel, out: &mut Vec<u8>) -> Result<()> {
+		let mut encoder = DeflateEncoder::new(out, Compression::new(level.gzip()));
+
+		encoder.write_all(block)
+			.with_context(|| "unable to compress block")?;
+		encoder.finish()
+			.with_context(|| "unable to compress block")?;
+
+		Ok(())
+	}
+
+	/// Appends the raw deflate stream of `block` to `out`.
+	#[cfg(feature = "libdeflate")]
+	fn deflate_into(block: &[u8], level: CompressionLevel, out: &mut Vec<u8>) -> Result<()> {
+		let mut compressor = libdeflate::compressor(level)?;
+		let start = out.len();
+
+		out.resize(start + compressor.deflate_compress_bound(block.len()), 0);
+
+		let len = compressor
+			.deflate_compress(block, &mut out[start..])
+			.map_err(|e| anyhow::anyhow!("unable to compress block: {e:?}"))?;
+
+		out.truncate(start + len);
+
+		Ok(())
+	}
+
+	/// Inflates the raw deflate stream `deflate` into `out`, which must be
+	/// exactly its inflated size.
+	#[cfg(not(feature = "libdeflate"))]
+	fn inflate_into(deflate: &[u8], out: &mut [u8]) -> Result<()> {
+		let mut inflater = Decompress::new(false);
+
+		let status = inflater
+			.decompress(deflate, out, FlushDecompress::Finish)
+			.with_context(|| "unable to inflate gzip member")?;
+
+		if unlikely(
+			status != Status::StreamEnd || inflater.total_out() as usize != out.len(),
+		) {
+			bail!("gzip member size mismatch");
+		}
+		Ok(())
+	}
+
+	/// Inflates the raw deflate stream `deflate` into `out`, which must be
+	/// exactly its inflated size.
+	#[cfg(feature = "libdeflate")]
+	fn inflate_into(deflate: &[u8], out: &mut [u8]) -> Result<()> {
+		let len = libdeflater::Decompressor::new()
+			.deflate_decompress(deflate, out)
+			.map_err(|e| anyhow::anyhow!("unable to inflate gzip member: {e:?}"))?;
+
+		if unlikely(len != out.len()) {
+			bail!("gzip member size mismatch");
+		}
+		Ok(())
+	}
+
+	#[cfg(feature = "libdeflate")]
+	mod libdeflate {
+		use anyhow::{Result, anyhow};
+		use flate2::Crc;
+		use libdeflater::{CompressionLvl, Compressor, Decompressor};
+
+		use super::{CompressionLevel, MAX_DEFLATE_RATIO, MEMBER_TRAILER_SIZE, le_u32};
+
+		#[inline]
+		pub(super) fn compressor(level: CompressionLevel) -> Result<Compressor> {
+			let level = CompressionLvl::new(level.gzip() as i32)
+				.map_err(|e| anyhow!("invalid compression level: {e:?}"))?;
+
+			Ok(Compressor::new(level))
+		}
+
+		/// Inflates a single member gzip stream into `decompressed`, sized
+		/// from its trailer.
+		///
+		/// libdeflate inflates only the first member and doesn't report
+		/// where it ended, so the output must also match the checksum of
+		/// the trailer ending the stream. The first member of a
+		/// multi-member stream that has the size of the last one is then
+		/// left to the multi-member fallback, unless the last member
+		/// repeats its data exactly.
+		///
+		/// # Returns
+		///
+		/// Whether it succeeded; on failure, such as for multi-member
+		/// streams, `decompressed` is left as it was.
+		#[inline]
+		pub(super) fn inflate_single_member(
+			compressed: &[u8],
+			decompressed: &mut Vec<u8>,
+		) -> bool {
+			inflate_single_member_with(
+				&mut Decompressor::new(),
+				compressed,
+				decompressed,
+			)
+		}
+
+		/// Like [`inflate_single_member`], reusing `decompressor`.
+		pub(super) fn inflate_single_member_with(
+			decompressor: &mut Decompressor,
+			compressed: &[u8],
+			decompressed: &mut Vec<u8>,
+		) -> bool {
+			let Some(isize) = compressed
+				.len()
+				.checked_sub(4)
+				.and_then(|i| compressed.get(i..))
+				.and_then(|b| b.try_into().ok())
+				.map(|b| u32::from_le_bytes(b) as usize)
+			else {
+				return false;
+			};
+			if compressed.len() < MEMBER_TRAILER_SIZE
+				|| isize > compressed.len().saturating_mul(MAX_DEFLATE_RATIO)
+			{
+				return false;
+			}
+			let start = decompressed.len();
+
+			decompressed.resize(start + isize, 0);
+
+			let trailer_crc =
+				le_u32(&compressed[compressed.len() - MEMBER_TRAILER_SIZE..]);
+			let inflated = matches!(
+				decompressor.gzip_decompress(compressed, &mut decompressed[start..]),
+				Ok(len) if len == isize
+			) && {
+				let mut crc = Crc::new();
+
+				crc.update(&decompressed[start..]);
+				crc.sum() == trailer_crc
+			};
+
+			if !inflated {
+				decompressed.truncate(start);
+			}
+			inflated
+		}
+	}
+
 	/// Decompress gzip-compressed data into the given buffer.
 	#[inline]
 	pub fn decompress<C, D>(compressed: C, mut decompressed: D) -> Result<()>
@@ -58,7 +1182,7 @@ pub mod gzip {
 		C: AsRef<[u8]>,
 		D: AsMut<[u8]>,
 	{
-		let mut gz_decoder = GzDecoder::new(compressed.as_ref());
+		let mut gz_decoder = MultiGzDecoder::new(compressed.as_ref());
 
 		gz_decoder
 			.read(decompressed.as_mut())
@@ -70,7 +1194,8 @@ pub mod gzip {
 
 #[cfg(test)]
 mod tests {
-	use super::gzip;
+	use super::*;
+	use rstest::rstest;
 
 	#[test]
 	fn test_compress_decompress_roundtrip() {
@@ -163,4 +1288,252 @@ mod tests {
 		assert_eq!(compressed[0], 0x1F);
 		assert_eq!(compressed[1], 0x8B);
 	}
+
+	#[test]
+	fn test_compress_parallel_roundtrip() {
+		let original: Vec<u8> = (0..gzip::MIN_MEMBER_INPUT_SIZE * 3 + 12345)
+			.map(|i| (i.wrapping_mul(2654435761) >> 13) as u8 % 17)
+			.collect();
+
+		for threads in [1, 4] {
+			let mut compressed = Vec::new();
+
+			gzip::compress_parallel(
+				&original,
+				&mut compressed,
+				CompressionLevel::Default,
+				threads,
+			)
+			.expect("compression failed");
+
+			assert!(gzip::is_indexed_multi_member(&compressed));
+
+			for read_threads in [1, 3] {
+				let mut decompressed = Vec::new();
+
+				gzip::decompress_parallel(
+					&compressed,
+					&mut decompressed,
+					read_threads,
+				)
+				.expect("decompression failed");
+
+				assert_eq!(decompressed, original);
+			}
+			// Plain multi-member readers see the same data.
+			let mut decompressed = Vec::new();
+
+			gzip::decompress_end(&compressed, &mut decompressed)
+				.expect("decompression failed");
+
+			assert_eq!(decompressed, original);
+		}
+	}
+
+	#[test]
+	fn test_compress_parallel_empty_data() {
+		let mut compressed = Vec::new();
+		let mut decompressed = Vec::new();
+
+		gzip::compress_parallel(&[], &mut compressed, CompressionLevel::Default, 4)
+			.expect("compression failed");
+		gzip::decompress_parallel(&compressed, &mut decompressed, 4)
+			.expect("decompression failed");
+
+		assert!(decompressed.is_empty());
+	}
+
+	#[test]
+	fn test_decompress_parallel_plain_stream() {
+		let original = b"a plain single member stream";
+		let mut compressed = Vec::new();
+
+		gzip::compress_bytes(original.as_slice(), &mut compressed)
+			.expect("compression failed");
+
+		assert!(!gzip::is_indexed_multi_member(&compressed));
+
+		let mut decompressed = Vec::new();
+
+		gzip::decompress_parallel(&compressed, &mut decompressed, 4)
+			.expect("decompression failed");
+
+		assert_eq!(decompressed.as_slice(), original.as_slice());
+	}
+
+	#[test]
+	fn test_decompress_parallel_corrupt_member_fails() {
+		let original = vec![7_u8; 4096];
+		let mut compressed = Vec::new();
+
+		gzip::compress_parallel(&original, &mut compressed, CompressionLevel::Fast, 1)
+			.expect("compression failed");
+
+		let crc_offset = compressed.len() - 8;
+
+		compressed[crc_offset] ^= 0xff;
+
+		let mut decompressed = Vec::new();
+
+		assert!(gzip::decompress_parallel(&compressed, &mut decompressed, 1).is_err());
+		assert!(decompressed.is_empty());
+	}
+
+	#[test]
+	fn test_decompress_multi_member_of_equal_sizes() {
+		// plain members, the size of the first matches the last trailer
+		let first = vec![1_u8; 4096];
+		let last = vec![2_u8; 4096];
+		let mut compressed = Vec::new();
+		let mut member = Vec::new();
+
+		for data in [&first, &last] {
+			gzip::compress_bytes(data, &mut member).expect("compression failed");
+			compressed.extend_from_slice(&member);
+		}
+		assert!(!gzip::is_indexed_multi_member(&compressed));
+
+		let expected = [first, last].concat();
+		let mut decompressed = Vec::new();
+
+		gzip::decompress_end(&compressed, &mut decompressed).expect("decompression failed");
+
+		assert_eq!(decompressed, expected);
+
+		decompressed.clear();
+		gzip::Inflater::new()
+			.inflate_to_end(&compressed, &mut decompressed)
+			.expect("decompression failed");
+
+		assert_eq!(decompressed, expected);
+	}
+
+	#[rstest]
+	#[case(CompressionLevel::Fast)]
+	#[case(CompressionLevel::Default)]
+	#[case(CompressionLevel::Best)]
+	#[case(CompressionLevel::Level(0))]
+	#[case(CompressionLevel::Level(100))]
+	fn test_compress_with_level_roundtrip(#[case] level: CompressionLevel) {
+		let original: Vec<u8> = (0..100_000).map(|i| (i % 251) as u8).collect();
+		let mut compressed = Vec::new();
+		let mut decompressed = Vec::new();
+
+		gzip::compress_bytes_with_level(&original, &mut compressed, level)
+			.expect("compression failed");
+		decompress(&compressed, &mut decompressed, 1).expect("decompression failed");
+
+		assert_eq!(decompressed, original);
+	}
+
+	#[rstest]
+	#[case("fast", CompressionLevel::Fast)]
+	#[case("Default", CompressionLevel::Default)]
+	#[case("best", CompressionLevel::Best)]
+	#[case("7", CompressionLevel::Level(7))]
+	fn test_compression_level_from_str(#[case] s: &str, #[case] expected: CompressionLevel) {
+		assert_eq!(s.parse::<CompressionLevel>().unwrap(), expected);
+	}
+
+	#[test]
+	fn test_inflater_reuses_capacity() {
+		let data: Vec<u8> = (0..200_000).map(|i| (i % 251) as u8).collect();
+		let mut single = Vec::new();
+		let mut multi = Vec::new();
+
+		gzip::compress_bytes(&data, &mut single).unwrap();
+		gzip::compress_parallel(&data[..150_000], &mut multi, CompressionLevel::Fast, 4)
+			.unwrap();
+
+		let mut inflater = gzip::Inflater::new();
+		let mut out = Vec::new();
+
+		inflater.inflate_to_end(&single, &mut out).unwrap();
+		assert_eq!(out, data);
+
+		let capacity = out.capacity();
+
+		for _ in 0..3 {
+			out.clear();
+			inflater.inflate_to_end(&single, &mut out).unwrap();
+			assert_eq!(out, data);
+			assert_eq!(out.capacity(), capacity);
+		}
+		out.clear();
+		inflater.inflate_to_end(&multi, &mut out).unwrap();
+		assert_eq!(out, &data[..150_000]);
+	}
+
+	#[test]
+	fn test_inflater_header_fields_and_errors() {
+		let mut named = flate2::GzBuilder::new()
+			.filename("splat.spz")
+			.comment("comment")
+			.extra(vec![1, 2, 3])
+			.read(&b"hello gaussians"[..], flate2::Compression::default());
+		let mut compressed = Vec::new();
+
+		named.read_to_end(&mut compressed).unwrap();
+
+		let mut inflater = gzip::Inflater::new();
+		let mut out = vec![b'>'];
+
+		inflater.inflate_to_end(&compressed, &mut out).unwrap();
+		assert_eq!(out, b">hello gaussians");
+
+		assert!(inflater
+			.inflate_to_end(&compressed[..compressed.len() - 3], &mut out)
+			.is_err());
+		assert!(inflater
+			.inflate_to_end(&compressed[..12], &mut out)
+			.is_err());
+		assert!(inflater.inflate_to_end(b"not gzip", &mut out).is_err());
+		assert_eq!(out, b">hello gaussians");
+	}
+
+	#[test]
+	fn test_codec_detect() {
+		let mut compressed = Vec::new();
+
+		gzip::compress_bytes(b"data", &mut compressed).expect("compression failed");
+
+		assert_eq!(Codec::detect(&compressed), Codec::Gzip);
+		assert_eq!(Codec::detect(&zstd::MAGIC), Codec::Zstd);
+		assert!("lz4".parse::<Codec>().is_err());
+	}
+
+	#[test]
+	fn test_decoder_reads_gzip() {
+		let original = b"streamed through the detecting decoder";
+		let mut compressed = Vec::new();
+
+		gzip::compress_bytes(original.as_slice(), &mut compressed)
+			.expect("compression failed");
+
+		let mut decompressed = Vec::new();
+
+		decoder(compressed.as_slice())
+			.unwrap()
+			.read_to_end(&mut decompressed)
+			.unwrap();
+
+		assert_eq!(decompressed.as_slice(), original.as_slice());
+	}
+
+	#[cfg(feature = "zstd")]
+	#[test]
+	fn test_zstd_roundtrip() {
+		let original: Vec<u8> = (0..100_000).map(|i| (i % 251) as u8).collect();
+		let mut compressed = Vec::new();
+		let mut decompressed = Vec::new();
+
+		zstd::compress_bytes(&original, &mut compressed, CompressionLevel::Default)
+			.expect("compression failed");
+
+		assert_eq!(Codec::detect(&compressed), Codec::Zstd);
+
+		decompress(&compressed, &mut decompressed, 1).expect("decompression failed");
+
+		assert_eq!(decompressed, original);
+	}
 }
@@ -13,6 +13,10 @@ use strum::EnumIter;
 /// smaller value.
 pub const COLOR_SCALE: f32 = 0.15;
 
+/// Degree 0 spherical harmonics basis constant, turning a DC color
+/// coefficient `c` into the color `0.5 + SH_C0 * c`.
+pub const SH_C0: f32 = 0.282_094_8;
+
 /// Standard file extensions for SPZ files.
 #[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, EnumIter)]
 pub enum Extensions {
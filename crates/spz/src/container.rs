@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+//! Dispatch of SPZ data to the container holding it.
+//!
+//! Besides a plain gzip or zstd compressed packed stream, SPZ data can be a
+//! [chunked](crate::chunked) or a [progressive](crate::lod) file. The loaders
+//! taking SPZ data in memory, [`GaussianSplat::read_from_bytes`],
+//! [`LazyGaussianSplat`] and the [`Header`] readers, go through
+//! [`Container::parse`], so they accept the same files.
+//! [`GaussianSplat::read_from`] buffers a container it reads before parsing
+//! it. Containers don't nest: chunks and levels are decoded as plain
+//! streams, whatever their leading bytes.
+//!
+//! [`GaussianSplat::read_from_bytes`]: crate::gaussian_splat::GaussianSplat::read_from_bytes
+//! [`GaussianSplat::read_from`]: crate::gaussian_splat::GaussianSplat::read_from
+//! [`LazyGaussianSplat`]: crate::lazy::LazyGaussianSplat
+
+use anyhow::{Result, bail};
+
+use crate::{chunked, chunked::ChunkedSpz, header::Header, lod};
+
+/// SPZ data, resolved to what has to be decoded.
+#[derive(Debug)]
+pub enum Container<'a> {
+	/// A plain compressed stream, or the finest level of a progressive file.
+	Stream(&'a [u8]),
+	/// A chunked file, its index already read.
+	Chunked(ChunkedSpz<&'a [u8]>),
+}
+
+impl<'a> Container<'a> {
+	/// Detects the container of `bytes` and validates its index.
+	///
+	/// # Args
+	///
+	/// `bytes` - a compressed SPZ stream, a chunked or a progressive file.
+	pub fn parse(bytes: &'a [u8]) -> Result<Self> {
+		if chunked::is_chunked(bytes) {
+			return Ok(Self::Chunked(ChunkedSpz::from_bytes(bytes)?));
+		}
+		if lod::is_progressive(bytes) {
+			return Ok(Self::Stream(lod::finest_level(bytes)?));
+		}
+		Ok(Self::Stream(bytes))
+	}
+
+	/// The header describing all of the data, see
+	/// [`ChunkedSpz::header`] for a chunked file.
+	///
+	/// Not validated, like [`Header::from_compressed_bytes_unchecked`].
+	pub fn header(&self) -> Result<Header> {
+		match self {
+			Self::Stream(stream) => Header::from_stream_unchecked(stream),
+			Self::Chunked(chunked) => chunked.header(),
+		}
+	}
+
+	/// The single compressed stream, for the entry points that hand out
+	/// packed data.
+	///
+	/// # Returns
+	///
+	/// An error for a chunked file, its chunks are separate streams that
+	/// only [`ChunkedSpz`] loads.
+	pub fn stream(self) -> Result<&'a [u8]> {
+		match self {
+			Self::Stream(stream) => Ok(stream),
+			Self::Chunked(_) => {
+				bail!(
+					"chunked container has no single packed stream, load it with ChunkedSpz"
+				)
+			},
+		}
+	}
+}
+
+/// Whether `bytes` start like a chunked or a progressive file rather than
+/// a plain stream.
+#[inline]
+pub fn is_container(bytes: &[u8]) -> bool {
+	chunked::is_chunked(bytes) || lod::is_progressive(bytes)
+}
+
+/// Resolves `bytes` to its single compressed stream, see
+/// [`Container::stream`].
+#[inline]
+pub fn stream(bytes: &[u8]) -> Result<&[u8]> {
+	Container::parse(bytes)?.stream()
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+	use crate::{
+		compression::gzip::Inflater,
+		gaussian_splat::{GaussianSplat, LoadOptions, SaveOptions},
+		lod::LodOptions,
+		test_util::splat,
+	};
+
+	#[test]
+	fn test_parse_resolves_containers() {
+		let gs = splat(300, 1);
+		let plain = gs
+			.serialize_to_packed_bytes(&SaveOptions::default())
+			.unwrap();
+		let chunked =
+			chunked::serialize_chunked(&gs, &SaveOptions::default(), 100).unwrap();
+		let progressive = lod::serialize_progressive(
+			&gs,
+			&SaveOptions::default(),
+			&LodOptions::default(),
+		)
+		.unwrap();
+
+		assert_eq!(stream(&plain).unwrap(), plain.as_slice());
+		assert_eq!(
+			stream(&progressive).unwrap(),
+			lod::finest_level(&progressive).unwrap()
+		);
+		assert!(matches!(
+			Container::parse(&chunked).unwrap(),
+			Container::Chunked(_)
+		));
+		assert!(stream(&chunked).is_err());
+		assert!(Container::parse(&chunked[..20]).is_err());
+		assert!(Container::parse(&progressive[..20]).is_err());
+	}
+
+	#[test]
+	fn test_entry_points_resolve_containers() {
+		let gs = splat(300, 1);
+		let chunked =
+			chunked::serialize_chunked(&gs, &SaveOptions::default(), 100).unwrap();
+		let progressive = lod::serialize_progressive(
+			&gs,
+			&SaveOptions::default(),
+			&LodOptions::default(),
+		)
+		.unwrap();
+		let finest =
+			Header::from_compressed_bytes(lod::finest_level(&progressive).unwrap())
+				.unwrap();
+		let mut inflater = Inflater::new();
+
+		for (name, bytes, expected) in [
+			("chunked", &chunked, 300),
+			("progressive", &progressive, finest.num_points),
+		] {
+			let path = std::env::temp_dir()
+				.join(format!("spz-container-{name}-{}.spz", std::process::id()));
+			std::fs::write(&path, bytes).unwrap();
+
+			let headers = [
+				Header::from_compressed_bytes(bytes).unwrap(),
+				Header::from_compressed_bytes_unchecked_with(bytes, &mut inflater)
+					.unwrap(),
+				Header::from_file(&path).unwrap(),
+			];
+			let _ = std::fs::remove_file(&path);
+
+			for header in headers {
+				assert_eq!(header.num_points, expected, "{name}");
+				assert_eq!(header.spherical_harmonics_degree, 1, "{name}");
+				assert!(header.is_valid(), "{name}");
+			}
+			let opts = LoadOptions::default();
+			let read = GaussianSplat::read_from(bytes.as_slice(), &opts).unwrap();
+			let expected = GaussianSplat::read_from_bytes(bytes, &opts).unwrap();
+
+			assert_eq!(read.header, expected.header, "{name}");
+			assert_eq!(read.positions, expected.positions, "{name}");
+			assert!(
+				Header::from_compressed_bytes(&bytes[..64]).is_err(),
+				"{name}"
+			);
+		}
+	}
+}
@@ -0,0 +1,460 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+//! Reusable decoding of SPZ data.
+//!
+//! A [`Decoder`] keeps its decompression buffer and inflate state between
+//! loads, and decodes into the buffers of an existing [`GaussianSplat`].
+//! Once the buffers have grown to fit, loading similarly sized data with
+//! [`LoadOptions::threads`] of 1 doesn't allocate, which keeps long-running
+//! processes from fragmenting the heap.
+//!
+//! Every method takes the containers of [`Container::parse`]: progressive
+//! files decode their finest level, chunked files load through
+//! [`ChunkedSpz`](crate::chunked::ChunkedSpz) and are rejected by the methods
+//! handing out packed data.
+
+use std::path::Path;
+
+use anyhow::{Context, Result, bail};
+use likely_stable::unlikely;
+
+use crate::{
+	compression::{
+		self, Codec,
+		gzip::{self, Inflater},
+	},
+	container::{self, Container},
+	gaussian_splat::{AttributeBuffersMut, AttributeLens, GaussianSplat, LoadOptions},
+	header::Header,
+	layout,
+	mmap::{self, FileBytes},
+	packed::{self, PackedGaussianSplatView, PackedGaussians},
+};
+
+/// Decoding state and scratch memory kept across loads.
+#[derive(Debug, Default)]
+pub struct Decoder {
+	decompressed: Vec<u8>,
+	compressed: Vec<u8>,
+	inflater: Inflater,
+}
+
+impl Decoder {
+	#[inline]
+	pub fn new() -> Self {
+		Self::default()
+	}
+
+	/// Bytes of scratch memory kept for the next load.
+	#[inline]
+	pub fn retained_bytes(&self) -> usize {
+		self.decompressed.capacity() + self.compressed.capacity()
+	}
+
+	/// Decompresses `compressed` into the scratch buffer and validates it.
+	///
+	/// The view borrows the decoder until it is dropped.
+	///
+	/// # Args
+	///
+	/// `compressed` - gzip or zstd compressed, packed gaussian data, or a
+	/// progressive file.
+	pub fn decompress(&mut self, compressed: &[u8]) -> Result<PackedGaussianSplatView<'_>> {
+		self.decompress_stream(container::stream(compressed)?)
+	}
+
+	/// [`Decoder::decompress`] of a plain stream, without container
+	/// dispatch.
+	pub(crate) fn decompress_stream(
+		&mut self,
+		compressed: &[u8],
+	) -> Result<PackedGaussianSplatView<'_>> {
+		if unlikely(compressed.is_empty()) {
+			bail!("data is empty");
+		}
+		self.decompressed.clear();
+
+		match Codec::detect(compressed) {
+			Codec::Gzip => self
+				.inflater
+				.inflate_to_end(compressed, &mut self.decompressed),
+			Codec::Zstd => compression::zstd::decompress_end(
+				compressed,
+				&mut self.decompressed,
+			),
+		}
+		.with_context(|| "unable to decompress data")?;
+
+		PackedGaussianSplatView::try_from(self.decompressed.as_slice())
+			.with_context(|| "unable to parse packed gaussian data")
+	}
+
+	/// Like [`Decoder::decompress`], inflating only the sections of the
+	/// attributes decoded with `opts`, see [`LoadOptions::attributes`]. The
+	/// sections after the last decoded one are left empty in the view.
+	///
+	/// The header is checked against the limits of `opts` first, see
+	/// [`LoadOptions::check_limits`].
+	///
+	/// # Args
+	///
+	/// `compressed` - gzip or zstd compressed, packed gaussian data, or a
+	/// progressive file.
+	/// `opts` - options the data will be decoded with.
+	pub fn decompress_with(
+		&mut self,
+		compressed: &[u8],
+		opts: &LoadOptions,
+	) -> Result<PackedGaussianSplatView<'_>> {
+		self.decompress_stream_with(container::stream(compressed)?, opts)
+	}
+
+	/// [`Decoder::decompress_with`] of a plain stream, without container
+	/// dispatch.
+	pub(crate) fn decompress_stream_with(
+		&mut self,
+		compressed: &[u8],
+		opts: &LoadOptions,
+	) -> Result<PackedGaussianSplatView<'_>> {
+		let (header, len) = self.read_header(compressed, opts)?;
+
+		if opts.inflates_everything(header.spherical_harmonics_degree) {
+			return self.decompress_stream(compressed);
+		}
+		let sections = packed::leading_sections(
+			opts.decoded_attributes(header.spherical_harmonics_degree),
+		);
+
+		self.decompressed.clear();
+
+		// single member gzip inflates with the kept state, other streams
+		// fall back to a reader
+		if Codec::detect(compressed) == Codec::Gzip
+			&& !gzip::is_indexed_multi_member(compressed)
+		{
+			// no bigger than the data can inflate to, whatever the header
+			// claims
+			self.decompressed
+				.resize(len.min(compression::max_decompressed_len(compressed)), 0);
+
+			let written = self
+				.inflater
+				.inflate_prefix(compressed, &mut self.decompressed)
+				.with_context(|| "unable to decompress data")?;
+
+			self.decompressed.truncate(written);
+		}
+		if self.decompressed.len() < len {
+			self.decompressed.clear();
+
+			compression::decompress_prefix(compressed, &mut self.decompressed, 1, len)
+				.with_context(|| "unable to decompress data")?;
+		}
+		PackedGaussianSplatView::from_prefix(&self.decompressed, sections)
+			.with_context(|| "unable to parse packed gaussian data")
+	}
+
+	/// Reads the header of `compressed` with the kept inflate state and
+	/// checks it against the limits of `opts`, see
+	/// [`LoadOptions::check_limits`].
+	fn read_header(
+		&mut self,
+		compressed: &[u8],
+		opts: &LoadOptions,
+	) -> Result<(Header, usize)> {
+		if unlikely(compressed.is_empty()) {
+			bail!("data is empty");
+		}
+		let header = Header::from_stream_unchecked_with(compressed, &mut self.inflater)?;
+		let len = opts.check_limits(&header)?;
+
+		Ok((header, len))
+	}
+
+	/// Decodes `compressed` into `splat`, reusing the capacity of its
+	/// attribute buffers.
+	///
+	/// The attribute buffers are resized to the decoded data, on error the
+	/// contents of `splat` are unspecified.
+	///
+	/// A chunked file is loaded into a new splat that replaces `splat`.
+	///
+	/// # Args
+	///
+	/// `compressed` - gzip or zstd compressed, packed gaussian data, or a
+	/// chunked or progressive file.
+	/// `opts` - options for loading the splat.
+	/// `splat` - destination, its previous contents are replaced.
+	pub fn decode_into(
+		&mut self,
+		compressed: &[u8],
+		opts: &LoadOptions,
+		splat: &mut GaussianSplat,
+	) -> Result<()> {
+		match Container::parse(compressed)? {
+			Container::Stream(stream) => self.decode_stream_into(stream, opts, splat),
+			Container::Chunked(chunked) => {
+				*splat = chunked.load_all(opts)?;
+
+				Ok(())
+			},
+		}
+	}
+
+	/// [`Decoder::decode_into`] of a plain stream, without container
+	/// dispatch.
+	pub(crate) fn decode_stream_into(
+		&mut self,
+		compressed: &[u8],
+		opts: &LoadOptions,
+		splat: &mut GaussianSplat,
+	) -> Result<()> {
+		let packed = self.decompress_stream_with(compressed, opts)?;
+		let lens = AttributeLens::decoded(&packed.to_header(), opts);
+
+		// the decoded prefix overwrites whatever the buffers held
+		splat.positions.resize(lens.positions, 0.0);
+		splat.scales.resize(lens.scales, 0.0);
+		splat.rotations.resize(lens.rotations, 0.0);
+		splat.alphas.resize(lens.alphas, 0.0);
+		splat.colors.resize(lens.colors, 0.0);
+		splat.spherical_harmonics
+			.resize(lens.spherical_harmonics, 0.0);
+
+		splat.header = GaussianSplat::decode_into(
+			&packed,
+			opts,
+			AttributeBuffersMut {
+				positions: &mut splat.positions,
+				scales: &mut splat.scales,
+				rotations: &mut splat.rotations,
+				alphas: &mut splat.alphas,
+				colors: &mut splat.colors,
+				spherical_harmonics: &mut splat.spherical_harmonics,
+			},
+		)?;
+		Ok(())
+	}
+
+	/// Decodes `compressed` into a new [`GaussianSplat`], reusing only the
+	/// decoder's scratch memory.
+	///
+	/// # Args
+	///
+	/// `compressed` - gzip or zstd compressed, packed gaussian data, or a
+	/// chunked or progressive file.
+	/// `opts` - options for loading the splat.
+	pub fn decode(&mut self, compressed: &[u8], opts: &LoadOptions) -> Result<GaussianSplat> {
+		let mut splat = GaussianSplat::default();
+
+		self.decode_into(compressed, opts, &mut splat)?;
+
+		Ok(splat)
+	}
+
+	/// Loads a file into `splat`, see [`Decoder::decode_into`].
+	///
+	/// # Args
+	///
+	/// `filepath` - gzip or zstd compressed, packed gaussian data file.
+	/// `opts` - options for loading the splat.
+	/// `splat` - destination, its previous contents are replaced.
+	pub fn load_into<F>(
+		&mut self,
+		filepath: F,
+		opts: &LoadOptions,
+		splat: &mut GaussianSplat,
+	) -> Result<()>
+	where
+		F: AsRef<Path>,
+	{
+		self.with_file(filepath.as_ref(), |decoder, compressed| {
+			decoder.decode_into(compressed, opts, splat)
+		})
+	}
+
+	/// Loads a file into a new [`GaussianSplat`].
+	///
+	/// # Args
+	///
+	/// `filepath` - gzip or zstd compressed, packed gaussian data file.
+	/// `opts` - options for loading the splat.
+	pub fn load<F>(&mut self, filepath: F, opts: &LoadOptions) -> Result<GaussianSplat>
+	where
+		F: AsRef<Path>,
+	{
+		let mut splat = GaussianSplat::default();
+
+		self.load_into(filepath, opts, &mut splat)?;
+
+		Ok(splat)
+	}
+
+	/// Decodes `compressed` into point records of [`LoadOptions::layout`],
+	/// see [`decode_records`](crate::layout::decode_records).
+	///
+	/// # Args
+	///
+	/// `compressed` - gzip or zstd compressed, packed gaussian data, or a
+	/// progressive file.
+	/// `opts` - options for loading, the layout must not be
+	/// [`Layout::Columns`](crate::layout::Layout::Columns).
+	/// `records` - destination, resized to the records and its previous
+	/// contents replaced.
+	pub fn decode_records_into(
+		&mut self,
+		compressed: &[u8],
+		opts: &LoadOptions,
+		records: &mut Vec<u8>,
+	) -> Result<Header> {
+		let compressed = container::stream(compressed)?;
+
+		self.read_header(compressed, opts)?;
+
+		let packed = self.decompress_stream(compressed)?;
+
+		records.resize(
+			packed.num_points().max(0) as usize * opts.layout.record_size(),
+			0,
+		);
+		layout::decode_records(&packed, opts, records)
+	}
+
+	/// Loads a file into point records, see
+	/// [`Decoder::decode_records_into`].
+	///
+	/// # Args
+	///
+	/// `filepath` - gzip or zstd compressed, packed gaussian data file.
+	/// `opts` - options for loading.
+	/// `records` - destination, its previous contents are replaced.
+	pub fn load_records_into<F>(
+		&mut self,
+		filepath: F,
+		opts: &LoadOptions,
+		records: &mut Vec<u8>,
+	) -> Result<Header>
+	where
+		F: AsRef<Path>,
+	{
+		self.with_file(filepath.as_ref(), |decoder, compressed| {
+			decoder.decode_records_into(compressed, opts, records)
+		})
+	}
+
+	fn with_file<T, F>(&mut self, filepath: &Path, f: F) -> Result<T>
+	where
+		F: FnOnce(&mut Self, &[u8]) -> Result<T>,
+	{
+		let result = mmap::read_or_map_into(filepath, std::mem::take(&mut self.compressed))
+			.and_then(|compressed| {
+				let result = f(self, &compressed);
+
+				if let FileBytes::Read(compressed) = compressed {
+					self.compressed = compressed;
+				}
+				result
+			});
+		result.with_context(|| format!("unable to load {}", filepath.display()))
+	}
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+	use crate::{coord::CoordinateSystem, gaussian_splat::SaveOptions, test_util::splat};
+
+	#[test]
+	fn test_decoder_matches_read_from_bytes() {
+		let opts = LoadOptions::builder()
+			.coord_sys(CoordinateSystem::LeftUpFront)
+			.build();
+		let mut decoder = Decoder::new();
+		let mut decoded = GaussianSplat::default();
+
+		// shrinking and growing between loads
+		for (num_points, sh_degree) in [(1000, 3), (10, 1), (500, 0), (1000, 2)] {
+			let bytes = splat(num_points, sh_degree)
+				.serialize_to_packed_bytes(&SaveOptions::default())
+				.unwrap();
+
+			decoder.decode_into(&bytes, &opts, &mut decoded).unwrap();
+
+			assert_eq!(
+				decoded,
+				GaussianSplat::read_from_bytes(&bytes, &opts).unwrap()
+			);
+			assert!(decoded.check_sizes());
+		}
+	}
+
+	#[test]
+	fn test_decoder_dispatches_containers() {
+		let gs = splat(300, 1);
+		let save = SaveOptions::default();
+		let progressive =
+			crate::lod::serialize_progressive(&gs, &save, &Default::default()).unwrap();
+		let chunked = crate::chunked::serialize_chunked(&gs, &save, 100).unwrap();
+		let opts = LoadOptions::default();
+		let mut decoder = Decoder::new();
+
+		for bytes in [&progressive, &chunked] {
+			assert_eq!(
+				decoder.decode(bytes, &opts).unwrap(),
+				GaussianSplat::read_from_bytes(bytes, &opts).unwrap()
+			);
+		}
+		assert_eq!(decoder.decompress(&progressive).unwrap().num_points(), 300);
+		assert!(decoder.decompress(&chunked).is_err());
+		assert!(decoder.decompress_with(&chunked, &opts).is_err());
+	}
+
+	#[test]
+	fn test_decoder_reuses_buffers() {
+		let bytes = splat(1000, 3)
+			.serialize_to_packed_bytes(&SaveOptions::default())
+			.unwrap();
+		let opts = LoadOptions::default();
+		let mut decoder = Decoder::new();
+		let mut decoded = GaussianSplat::default();
+
+		decoder.decode_into(&bytes, &opts, &mut decoded).unwrap();
+
+		let retained = decoder.retained_bytes();
+		let positions = decoded.positions.as_ptr();
+		let spherical_harmonics = decoded.spherical_harmonics.as_ptr();
+
+		for _ in 0..3 {
+			decoder.decode_into(&bytes, &opts, &mut decoded).unwrap();
+
+			assert_eq!(decoder.retained_bytes(), retained);
+			assert_eq!(decoded.positions.as_ptr(), positions);
+			assert_eq!(decoded.spherical_harmonics.as_ptr(), spherical_harmonics);
+		}
+	}
+
+	#[test]
+	fn test_decoder_errors_keep_it_usable() {
+		let bytes = splat(100, 1)
+			.serialize_to_packed_bytes(&SaveOptions::default())
+			.unwrap();
+		let mut decoder = Decoder::new();
+		let mut decoded = GaussianSplat::default();
+
+		assert!(decoder
+			.decode_into(&[], &LoadOptions::default(), &mut decoded)
+			.is_err());
+		assert!(decoder
+			.decode_into(
+				&bytes[..bytes.len() / 2],
+				&LoadOptions::default(),
+				&mut decoded
+			)
+			.is_err());
+
+		decoder.decode_into(&bytes, &LoadOptions::default(), &mut decoded)
+			.unwrap();
+
+		assert_eq!(decoded.header.num_points, 100);
+	}
+}
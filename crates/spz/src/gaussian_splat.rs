@@ -1,21 +1,29 @@
 // SPDX-License-Identifier: Apache-2.0 OR MIT
 
+use std::io::Read;
 use std::path::Path;
-use std::{fmt::Write, io::Read};
 
 use anyhow::{Context, Result, bail};
 use arbitrary::Arbitrary;
+use bitflags::bitflags;
 use likely_stable::unlikely;
 use serde::{Deserialize, Serialize};
 use tokio::io::AsyncReadExt;
 
 use crate::{
-	compression, consts,
+	compression::{self, Codec, CompressionLevel},
+	container::{self, Container},
 	coord::{AxisFlips, CoordinateSystem},
-	header::{Flags, Header},
+	header::{HEADER_SIZE, Header},
+	instrument::{self, Stage},
+	kernels,
+	layout::{Activation, Layout},
 	math::{self, dim_for_degree},
-	mmap,
-	packed::PackedGaussianSplat,
+	mmap::{self, FileBytes},
+	packed::{self, PackedGaussianSplat, PackedGaussianSplatView, PackedGaussians, PointOrder},
+	parallel,
+	stats::{self, Statistics},
+	stream,
 };
 
 /// A set of Gaussian Splats representing a 3D scene.
@@ -97,7 +105,7 @@ impl GaussianSplat {
 
 		infile.read_to_end(contents).await?;
 
-		Self::new_from_packed_gaussians(&PackedGaussianSplat::from_bytes(&contents)?, opts)
+		Self::read_from_bytes(contents.as_slice(), opts)
 	}
 
 	/// Loads a [`GaussianSplat`] from a file with the given options from
@@ -117,33 +125,87 @@ impl GaussianSplat {
 
 		from.read_to_end(&mut contents).await?;
 
-		let packed = PackedGaussianSplat::from_bytes(&contents)
-			.with_context(|| "unable to parse splat")?;
-
-		Self::new_from_packed_gaussians(&packed, opts)
+		Self::read_from_bytes(&contents, opts)
 	}
 
 	/// Loads a [`GaussianSplat`] from a file with the given options from
 	/// the reader.
 	///
+	/// The data is inflated and decoded in one streaming pass: each attribute
+	/// section is dequantized straight into its final buffer as it is
+	/// inflated, only a small fixed-size window of inflated bytes is kept
+	/// around, see [`stream`](crate::stream).
+	///
+	/// A chunked or progressive file is read to its end and loaded like
+	/// [`GaussianSplat::read_from_bytes`] does, its index comes first but
+	/// points around the file.
+	///
 	/// # Args
 	///
-	/// `from` - gzip compressed, packed gaussian data.
+	/// `from` - gzip compressed, packed gaussian data, or a chunked or
+	/// progressive file.
 	/// `opts` - options for loading the splat.
-	#[inline]
-	pub fn read_from<F, R>(mut from: R, opts: &LoadOptions) -> Result<Self>
+	pub fn read_from<R>(mut from: R, opts: &LoadOptions) -> Result<Self>
 	where
-		F: AsRef<Path>,
 		R: Read,
 	{
-		let mut contents = Vec::new();
+		let mut magic = Vec::with_capacity(4);
+
+		from.by_ref().take(4).read_to_end(&mut magic)?;
 
-		from.read_to_end(&mut contents)?;
+		if container::is_container(&magic) {
+			from.read_to_end(&mut magic)?;
+
+			return Self::read_from_bytes(&magic, opts);
+		}
+		stream::decode_from(Read::chain(magic.as_slice(), from), opts)
+			.with_context(|| "unable to parse splat")
+	}
+
+	/// Loads a [`GaussianSplat`] from gzip compressed, packed gaussian data
+	/// in memory.
+	///
+	/// Streams written with [`SaveOptions::parallel_compression`] have their
+	/// members inflated concurrently and zstd data is inflated in one go
+	/// before decoding, as is all data with the `libdeflate` feature or
+	/// [`LoadOptions::threads`] other than 1, and decoded on that many
+	/// threads. Other streams are decoded like [`GaussianSplat::read_from`]
+	/// does.
+	///
+	/// A [chunked](crate::chunked) file loads all of its chunks, in chunk
+	/// order, and a [progressive](crate::lod) file its finest level, see
+	/// [`Container::parse`].
+	///
+	/// # Args
+	///
+	/// `bytes` - gzip or zstd compressed, packed gaussian data.
+	/// `opts` - options for loading the splat.
+	pub fn read_from_bytes(bytes: &[u8], opts: &LoadOptions) -> Result<Self> {
+		let bytes = match Container::parse(bytes)? {
+			Container::Stream(stream) => stream,
+			Container::Chunked(chunked) => return chunked.load_all(opts),
+		};
+		if !cfg!(feature = "libdeflate")
+			&& opts.threads == 1 && Codec::detect(bytes) == Codec::Gzip
+			&& !compression::gzip::is_indexed_multi_member(bytes)
+		{
+			return Self::read_from(bytes, opts);
+		}
+		let mut decompressed = Vec::new();
+		let sections = opts.decompress_decoded(bytes, &mut decompressed, 0)?;
 
-		let packed = PackedGaussianSplat::from_bytes(&contents)
-			.with_context(|| "unable to parse splat")?;
+		if opts.threads != 1 {
+			let packed = PackedGaussianSplatView::from_prefix(&decompressed, sections)
+				.with_context(|| "unable to parse packed gaussian data")?;
 
-		Self::new_from_packed_gaussians(&packed, opts)
+			return Self::new_from_packed_gaussians(&packed, opts);
+		}
+		stream::decode_decompressed_from(
+			&mut decompressed.as_slice(),
+			opts,
+			stream::DEFAULT_WINDOW_SIZE,
+		)
+		.with_context(|| "unable to parse splat")
 	}
 
 	/// Loads a [`GaussianSplat`] from a file with the given options, async.
@@ -173,20 +235,18 @@ impl GaussianSplat {
 	where
 		F: AsRef<Path>,
 	{
-		// mmap on macos isn't great according to ripgrep code
-		if cfg!(target_os = "macos") {
-			let infile = std::fs::read(filepath)?;
+		let mut stage = instrument::enter(Stage::Read, 0);
 
-			return Self::new_from_packed_gaussians(
-				&PackedGaussianSplat::from_bytes(&infile)?,
-				opts,
-			);
+		let compressed = mmap::read_or_map(filepath)?;
+
+		stage.bytes_out(compressed.len());
+		if let FileBytes::Read(read) = &compressed {
+			stage.allocated(read.len());
 		}
-		let mmap = mmap::mmap(filepath)?;
-		let packed = PackedGaussianSplat::from_bytes(mmap.as_ref())
-			.with_context(|| "unable to load packed file")?;
+		drop(stage);
 
-		Self::new_from_packed_gaussians(&packed, opts)
+		Self::read_from_bytes(&compressed, opts)
+			.with_context(|| "unable to load packed file")
 	}
 
 	/// Loads a [`GaussianSplat`] from a file.
@@ -267,118 +327,259 @@ impl GaussianSplat {
 		F: AsRef<Path>,
 	{
 		let compressed = self.serialize_to_packed_bytes(opts)?;
+		let mut stage = instrument::enter(Stage::Write, compressed.len());
 
 		std::fs::create_dir_all(
 			filepath.as_ref()
 				.parent()
 				.ok_or_else(|| anyhow::anyhow!("recursive mkdir failed"))?,
 		)?;
-		std::fs::write(filepath, compressed).with_context(|| "unable to write to file")
+		std::fs::write(filepath, &compressed).with_context(|| "unable to write to file")?;
+		stage.bytes_out(compressed.len());
+
+		Ok(())
 	}
 
 	pub fn serialize_to_packed_bytes(&self, opts: &SaveOptions) -> Result<Vec<u8>> {
+		let mut stage = instrument::enter(
+			Stage::Quantize,
+			AttributeLens::from_header(&self.header).total() * size_of::<f32>(),
+		);
 		let packed = self.to_packed_gaussians(opts)?;
 
 		let uncompressed = packed.to_bytes_vec()?;
+
+		stage.bytes_out(uncompressed.len());
+		// the packed sections, then the bytes they are copied into
+		stage.allocated(2 * uncompressed.len() - HEADER_SIZE);
+		stage.threads(parallel::thread_count(
+			opts.threads,
+			packed.num_points.max(0) as usize,
+		));
+		drop(stage);
+
 		let mut compressed = Vec::new();
 
-		compression::gzip::compress_bytes(uncompressed.as_ref(), &mut compressed)?;
+		match (opts.codec, opts.parallel_compression) {
+			(Codec::Gzip, true) => {
+				let mut stage =
+					instrument::enter(Stage::Deflate, uncompressed.len());
+
+				compression::gzip::compress_parallel(
+					&uncompressed,
+					&mut compressed,
+					opts.level,
+					opts.threads,
+				)?;
+				stage.bytes_out(compressed.len());
+				stage.allocated(compressed.capacity());
+				stage.threads(parallel::available_threads(opts.threads));
+			},
+			(codec, _) => compression::compress(
+				&uncompressed,
+				&mut compressed,
+				codec,
+				opts.level,
+			)?,
+		}
 
 		Ok(compressed)
 	}
 
-	pub fn new_from_packed_gaussians(
-		packed: &PackedGaussianSplat,
-		opts: &LoadOptions,
-	) -> Result<Self> {
-		let num_points = packed.num_points as usize;
-		let sh_dim = dim_for_degree(packed.sh_degree as u8);
+	/// Decodes packed gaussians, owned or borrowed, into a new splat.
+	///
+	/// # Args
+	///
+	/// `packed` - the packed gaussian data to decode, a
+	/// [`PackedGaussianSplat`] or a
+	/// [`PackedGaussianSplatView`](crate::packed::PackedGaussianSplatView).
+	/// `opts` - options for loading the splat.
+	pub fn new_from_packed_gaussians<P>(packed: &P, opts: &LoadOptions) -> Result<Self>
+	where
+		P: PackedGaussians + ?Sized,
+	{
+		let header = packed.to_header();
 
-		if unlikely(!packed.check_sizes(num_points, sh_dim)) {
-			bail!("inconsistent sizes");
-		}
+		// sizes claimed by the header are checked against the sections
+		// before allocating for them
+		opts.check_limits(&header)?;
+		packed_sections(packed, opts)?;
+
+		let lens = AttributeLens::decoded(&header, opts);
+
+		instrument::record(Stage::Dequantize, |stats| {
+			stats.allocated += (lens.total() * size_of::<f32>()) as u64;
+		});
 		let mut result = Self {
-			header: Header {
-				num_points: packed.num_points,
-				spherical_harmonics_degree: packed.sh_degree as u8,
-				fractional_bits: packed.fractional_bits as u8,
-				flags: if packed.antialiased {
-					Flags::ANTIALIASED
-				} else {
-					Flags::none()
-				},
-				..Default::default()
-			},
-			positions: vec![0_f32; num_points * 3],
-			scales: vec![0_f32; num_points * 3],
-			rotations: vec![0_f32; num_points * 4],
-			alphas: vec![0_f32; num_points],
-			colors: vec![0_f32; num_points * 3],
-			spherical_harmonics: vec![0_f32; num_points * sh_dim as usize * 3],
+			header: Header::default(),
+			positions: vec![0_f32; lens.positions],
+			scales: vec![0_f32; lens.scales],
+			rotations: vec![0_f32; lens.rotations],
+			alphas: vec![0_f32; lens.alphas],
+			colors: vec![0_f32; lens.colors],
+			spherical_harmonics: vec![0_f32; lens.spherical_harmonics],
 		};
-		// positions: decode 24-bit fixed point coordinates
-		let scale = 1.0_f32 / (1_u32 << (packed.fractional_bits as u32)) as f32;
+		result.header = Self::decode_into(
+			packed,
+			opts,
+			AttributeBuffersMut {
+				positions: &mut result.positions,
+				scales: &mut result.scales,
+				rotations: &mut result.rotations,
+				alphas: &mut result.alphas,
+				colors: &mut result.colors,
+				spherical_harmonics: &mut result.spherical_harmonics,
+			},
+		)?;
+		Ok(result)
+	}
 
-		for (dst, src) in result
-			.positions
-			.chunks_exact_mut(3)
-			.zip(packed.positions.chunks_exact(9))
-		{
-			for (i, value) in dst.iter_mut().enumerate().take(3) {
-				let base = i * 3;
-				let mut fixed32 = src[base] as i32
-					| ((src[base + 1] as i32) << 8) | ((src[base + 2]
-					as i32) << 16);
-
-				if (fixed32 & 0x800000) != 0 {
-					fixed32 |= 0xff000000_u32 as i32;
-				}
-				*value = fixed32 as f32 * scale;
-			}
-		}
-		// scales
-		for (dst, src) in result.scales.iter_mut().zip(packed.scales.iter()) {
-			*dst = *src as f32 / 16.0 - 10.0;
-		}
-		// rotations
-		if packed.uses_quaternion_smallest_three {
-			for (dst, src) in result
-				.rotations
-				.chunks_exact_mut(4)
-				.zip(packed.rotations.chunks_exact(4))
-			{
-				math::unpack_quaternion_smallest_three(dst, src);
-			}
+	/// Decodes packed gaussians straight into caller-owned float buffers,
+	/// without allocating.
+	///
+	/// Each buffer must hold at least as many floats as reported by
+	/// [`AttributeLens::decoded`] for the packed data; only that prefix of
+	/// each buffer is written, anything past it is left untouched. Only the
+	/// sections of the attributes selected by [`LoadOptions::attributes`]
+	/// are read, the others may be empty.
+	///
+	/// With [`LoadOptions::threads`] other than 1, the points are split into
+	/// ranges decoded in parallel; the output is the same either way.
+	///
+	/// # Args
+	///
+	/// `packed` - the packed gaussian data to decode.
+	/// `opts` - options for loading the splat.
+	/// `out` - destination buffers, one per attribute.
+	///
+	/// # Returns
+	///
+	/// The header describing the decoded data.
+	pub fn decode_into<P>(
+		packed: &P,
+		opts: &LoadOptions,
+		out: AttributeBuffersMut<'_>,
+	) -> Result<Header>
+	where
+		P: PackedGaussians + ?Sized,
+	{
+		let (src, strides) = packed_sections(packed, opts)?;
+		let num_points = packed.num_points() as usize;
+		let header = packed.to_header();
+		let sh_degree = opts.decoded_sh_degree(header.spherical_harmonics_degree);
+		let sh_dim = dim_for_degree(header.spherical_harmonics_degree) as usize;
+		let kept_sh_dim = dim_for_degree(sh_degree) as usize;
+		let uses_quaternion_smallest_three = packed.uses_quaternion_smallest_three();
+		let lens = AttributeLens::decoded(&header, opts);
+		let mut stage =
+			instrument::enter(Stage::Dequantize, src.iter().map(|s| s.len()).sum());
+		let AttributeBuffersMut {
+			positions,
+			scales,
+			rotations,
+			alphas,
+			colors,
+			spherical_harmonics,
+		} = out;
+
+		let positions = attribute_prefix(positions, lens.positions, "positions")?;
+		let scales = attribute_prefix(scales, lens.scales, "scales")?;
+		let rotations = attribute_prefix(rotations, lens.rotations, "rotations")?;
+		let alphas = attribute_prefix(alphas, lens.alphas, "alphas")?;
+		let colors = attribute_prefix(colors, lens.colors, "colors")?;
+		let spherical_harmonics = attribute_prefix(
+			spherical_harmonics,
+			lens.spherical_harmonics,
+			"spherical harmonics",
+		)?;
+
+		let fractional_bits = packed.fractional_bits();
+		let axis_flips = opts.coord_sys.axis_flips_to(CoordinateSystem::RightUpBack);
+		let threads = parallel::thread_count(opts.threads, num_points);
+
+		stage.bytes_out(lens.total() * size_of::<f32>());
+		stage.threads(threads);
+
+		let job = DecodeJob {
+			src,
+			dst: [
+				positions,
+				scales,
+				rotations,
+				alphas,
+				colors,
+				spherical_harmonics,
+			],
+		};
+		let decode = |job: DecodeJob<'_>| {
+			let AttributeJob {
+				src:
+					[
+						packed_positions,
+						packed_scales,
+						packed_rotations,
+						packed_alphas,
+						packed_colors,
+						packed_spherical_harmonics,
+					],
+				dst:
+					[
+						positions,
+						scales,
+						rotations,
+						alphas,
+						colors,
+						spherical_harmonics,
+					],
+			} = job;
+
+			kernels::decode_positions(packed_positions, positions, fractional_bits);
+			kernels::decode_scales(packed_scales, scales);
+			kernels::decode_rotations(
+				packed_rotations,
+				rotations,
+				uses_quaternion_smallest_three,
+			);
+			kernels::decode_alphas(packed_alphas, alphas);
+			kernels::decode_colors(packed_colors, colors);
+			kernels::decode_spherical_harmonics_truncated(
+				packed_spherical_harmonics,
+				spherical_harmonics,
+				sh_dim * 3,
+				kept_sh_dim * 3,
+			);
+			apply_axis_flips(
+				&axis_flips,
+				positions,
+				rotations,
+				spherical_harmonics,
+				kept_sh_dim,
+			);
+		};
+		if threads == 1 {
+			// no job list, decoding on one thread doesn't allocate
+			decode(job);
 		} else {
-			for (dst, src) in result
-				.rotations
-				.chunks_exact_mut(4)
-				.zip(packed.rotations.chunks_exact(3))
-			{
-				math::unpack_quaternion_first_three(dst, src);
-			}
-		}
-		// alphas
-		for (dst, src) in result.alphas.iter_mut().zip(packed.alphas.iter()) {
-			*dst = math::inv_sigmoid(*src as f32 / 255.0);
-		}
-		// colors
-		for (dst, src) in result.colors.iter_mut().zip(packed.colors.iter()) {
-			*dst = ((*src as f32 / 255.0) - 0.5) / consts::COLOR_SCALE;
-		}
-		// spherical harmonics
-		for (dst, src) in result
-			.spherical_harmonics
-			.iter_mut()
-			.zip(packed.spherical_harmonics.iter())
-		{
-			*dst = math::unquantize_sh(*src);
+			let jobs = DecodeJob::split(
+				job.src,
+				job.dst,
+				strides,
+				num_points,
+				num_points.div_ceil(threads),
+			);
+			parallel::run(jobs, decode);
 		}
-		result.convert_coordinates(opts.coord_sys, CoordinateSystem::RightUpBack);
-
-		Ok(result)
+		Ok(Header {
+			spherical_harmonics_degree: sh_degree,
+			..header
+		})
 	}
 
+	/// Quantizes the splat into packed gaussians.
+	///
+	/// With [`SaveOptions::threads`] other than 1, the points are split into
+	/// ranges encoded in parallel; the output is the same either way. The
+	/// points are sorted per [`SaveOptions::order`] once quantized.
 	pub fn to_packed_gaussians(&self, opts: &SaveOptions) -> Result<PackedGaussianSplat> {
 		if unlikely(!self.check_sizes()) {
 			bail!("inconsistent sizes");
@@ -387,7 +588,6 @@ impl GaussianSplat {
 		let sh_dim = math::dim_for_degree(self.header.spherical_harmonics_degree) as usize;
 		let axis_flips = opts.coord_sys.axis_flips_to(CoordinateSystem::RightUpBack);
 		let fractional_bits: i32 = 12;
-		let scale = (1_i32 << fractional_bits) as f32;
 
 		let mut packed = PackedGaussianSplat {
 			num_points: self.header.num_points,
@@ -402,112 +602,69 @@ impl GaussianSplat {
 			colors: vec![0_u8; num_points * 3],
 			spherical_harmonics: vec![0_u8; num_points * sh_dim * 3],
 		};
-		for i in 0..(num_points * 3) {
-			let axis = i % 3;
-			let fixed32 = (axis_flips.position[axis] * self.positions[i] * scale)
-				.round() as i32;
-
-			packed.positions[i * 3] = (fixed32 & 0xff) as u8;
-			packed.positions[i * 3 + 1] = ((fixed32 >> 8) & 0xff) as u8;
-			packed.positions[i * 3 + 2] = ((fixed32 >> 16) & 0xff) as u8;
-		}
-		// Pack scales
-		for i in 0..(num_points * 3) {
-			packed.scales[i] = math::to_u8((self.scales[i] + 10.0) * 16.0);
-		}
-		// Pack rotations using smallest-three encoding
-		for i in 0..num_points {
-			let rot_src: [f32; 4] = [
-				self.rotations[4 * i],
-				self.rotations[4 * i + 1],
-				self.rotations[4 * i + 2],
-				self.rotations[4 * i + 3],
-			];
-			let rot_dst = math::pack_quaternion_smallest_three(
-				&rot_src,
-				[
-					axis_flips.rotation[0],
-					axis_flips.rotation[1],
-					axis_flips.rotation[2],
-				],
+		let threads = parallel::thread_count(opts.threads, num_points);
+		let jobs = EncodeJob::split(
+			[
+				&self.positions,
+				&self.scales,
+				&self.rotations,
+				&self.alphas,
+				&self.colors,
+				&self.spherical_harmonics,
+			],
+			[
+				&mut packed.positions,
+				&mut packed.scales,
+				&mut packed.rotations,
+				&mut packed.alphas,
+				&mut packed.colors,
+				&mut packed.spherical_harmonics,
+			],
+			encode_strides(sh_dim),
+			num_points,
+			num_points.div_ceil(threads),
+		);
+		parallel::run(jobs, |job: EncodeJob<'_>| {
+			let AttributeJob {
+				src:
+					[
+						positions,
+						scales,
+						rotations,
+						alphas,
+						colors,
+						spherical_harmonics,
+					],
+				dst:
+					[
+						packed_positions,
+						packed_scales,
+						packed_rotations,
+						packed_alphas,
+						packed_colors,
+						packed_spherical_harmonics,
+					],
+			} = job;
+
+			kernels::encode_positions(
+				positions,
+				packed_positions,
+				axis_flips.position,
+				fractional_bits,
 			);
-			packed.rotations[4 * i..4 * i + 4].copy_from_slice(&rot_dst);
-		}
-		// Pack alphas with sigmoid activation
-		for i in 0..num_points {
-			packed.alphas[i] = math::to_u8(math::sigmoid(self.alphas[i]) * 255.0);
-		}
-		// Pack colors
-		for i in 0..(num_points * 3) {
-			packed.colors[i] = math::to_u8(
-				self.colors[i] * (consts::COLOR_SCALE * 255.0) + (0.5 * 255.0),
+			kernels::encode_scales(scales, packed_scales);
+			kernels::encode_rotations(rotations, packed_rotations, axis_flips.rotation);
+			kernels::encode_alphas(alphas, packed_alphas);
+			kernels::encode_colors(colors, packed_colors);
+			kernels::encode_spherical_harmonics(
+				spherical_harmonics,
+				packed_spherical_harmonics,
+				&axis_flips.spherical_harmonics,
+				sh_dim,
 			);
-		}
-		// Pack spherical harmonics
-		if self.header.spherical_harmonics_degree > 0 {
-			const SH1_BITS: i32 = 5;
-			const SH_REST_BITS: i32 = 4;
-
-			let sh_per_point = sh_dim * 3;
-
-			for point_idx in 0..num_points {
-				let base = point_idx * sh_per_point;
-
-				let mut j = 0_usize;
-				let mut k = 0_usize;
-
-				while j < 9 && j < sh_per_point {
-					let step = 1_i32 << (8 - SH1_BITS);
-
-					packed.spherical_harmonics[base + j] = math::quantize_sh(
-						axis_flips.spherical_harmonics[k]
-							* self.spherical_harmonics[base + j],
-						step,
-					);
-					packed.spherical_harmonics[base + j + 1] =
-						math::quantize_sh(
-							axis_flips.spherical_harmonics[k]
-								* self.spherical_harmonics
-									[base + j + 1],
-							step,
-						);
-					packed.spherical_harmonics[base + j + 2] =
-						math::quantize_sh(
-							axis_flips.spherical_harmonics[k]
-								* self.spherical_harmonics
-									[base + j + 2],
-							step,
-						);
-					j += 3;
-					k += 1;
-				}
-				while j < sh_per_point {
-					let step = 1_i32 << (8 - SH_REST_BITS);
-
-					packed.spherical_harmonics[base + j] = math::quantize_sh(
-						axis_flips.spherical_harmonics[k]
-							* self.spherical_harmonics[base + j],
-						step,
-					);
-					packed.spherical_harmonics[base + j + 1] =
-						math::quantize_sh(
-							axis_flips.spherical_harmonics[k]
-								* self.spherical_harmonics
-									[base + j + 1],
-							step,
-						);
-					packed.spherical_harmonics[base + j + 2] =
-						math::quantize_sh(
-							axis_flips.spherical_harmonics[k]
-								* self.spherical_harmonics
-									[base + j + 2],
-							step,
-						);
-					j += 3;
-					k += 1;
-				}
-			}
-		}
+		});
+		packed.reorder(opts.order)?;
+
 		Ok(packed)
 	}
 
@@ -515,113 +672,126 @@ impl GaussianSplat {
 		&mut self,
 		source_cs: crate::coord::CoordinateSystem,
 		target_cs: crate::coord::CoordinateSystem,
+	) {
+		self.convert_coordinates_with_threads(source_cs, target_cs, 1);
+	}
+
+	/// Converts the splat between coordinate systems, in place, splitting
+	/// the points into ranges converted on `threads` threads.
+	///
+	/// # Args
+	///
+	/// `source_cs` - the coordinate system the splat is in.
+	/// `target_cs` - the coordinate system to convert to.
+	/// `threads` - number of threads, `0` uses all available cores.
+	pub fn convert_coordinates_with_threads(
+		&mut self,
+		source_cs: crate::coord::CoordinateSystem,
+		target_cs: crate::coord::CoordinateSystem,
+		threads: usize,
 	) {
 		if unlikely(self.header.num_points == 0) {
 			return;
 		}
-		let (x_match, y_match, z_match) = source_cs.axes_align(target_cs);
-
-		let x = if x_match { 1.0_f32 } else { -1.0_f32 };
-		let y = if y_match { 1.0_f32 } else { -1.0_f32 };
-		let z = if z_match { 1.0_f32 } else { -1.0_f32 };
-
-		let flip = AxisFlips {
-			position: [x, y, z],
-			rotation: [y * z, x * z, x * y],
-			spherical_harmonics: [
-				y,         // 0
-				z,         // 1
-				x,         // 2
-				x * y,     // 3
-				y * z,     // 4
-				1.0_f32,   // 5
-				x * z,     // 6
-				1.0_f32,   // 7
-				y,         // 8
-				x * y * z, // 9
-				y,         // 10
-				z,         // 11
-				x,         // 12
-				z,         // 13
-				x,         // 14
-			],
-		};
-		for i in (0..self.positions.len()).step_by(3) {
-			self.positions[i] *= flip.position[0];
-			self.positions[i + 1] *= flip.position[1];
-			self.positions[i + 2] *= flip.position[2];
-		}
-		for i in (0..self.rotations.len()).step_by(4) {
-			self.rotations[i] *= flip.rotation[0];
-			self.rotations[i + 1] *= flip.rotation[1];
-			self.rotations[i + 2] *= flip.rotation[2];
-			// rotations[i + 3] (w) unchanged
-		}
-		let total_coeffs = if self.spherical_harmonics.len() >= 3 {
-			self.spherical_harmonics.len() / 3
+		let num_points = self.header.num_points.max(0) as usize;
+		let coeffs_per_point = if num_points > 0 {
+			self.spherical_harmonics.len() / 3 / num_points
 		} else {
 			0
 		};
-		let num_points = self.header.num_points.max(0) as usize;
-
-		if unlikely(num_points == 0 || total_coeffs == 0) {
+		let flip = source_cs.axis_flips_to(target_cs);
+		let threads = parallel::thread_count(threads, num_points);
+		let float_bytes = (self.positions.len()
+			+ self.rotations.len()
+			+ self.spherical_harmonics.len())
+			* size_of::<f32>();
+		let mut stage = instrument::enter(Stage::ConvertCoordinates, float_bytes);
+
+		stage.bytes_out(float_bytes);
+		stage.threads(threads);
+
+		if threads == 1 || unlikely(!self.check_sizes()) {
+			apply_axis_flips(
+				&flip,
+				&mut self.positions,
+				&mut self.rotations,
+				&mut self.spherical_harmonics,
+				coeffs_per_point,
+			);
 			return;
 		}
-		let coeffs_per_point = total_coeffs / num_points;
-		let mut idx = 0_usize;
-
-		for _pt in 0..num_points {
-			for j in 0..coeffs_per_point {
-				let f = flip.spherical_harmonics[j];
-
-				self.spherical_harmonics[idx] *= f;
-				self.spherical_harmonics[idx + 1] *= f;
-				self.spherical_harmonics[idx + 2] *= f;
+		let points_per_job = num_points.div_ceil(threads);
+
+		let mut jobs = Vec::with_capacity(threads);
+		let mut positions = self.positions.as_mut_slice();
+		let mut rotations = self.rotations.as_mut_slice();
+		let mut spherical_harmonics = self.spherical_harmonics.as_mut_slice();
+
+		while !positions.is_empty() {
+			let n = points_per_job.min(positions.len() / 3);
+			let (p, p_tail) = std::mem::take(&mut positions).split_at_mut(n * 3);
+			let (r, r_tail) = std::mem::take(&mut rotations).split_at_mut(n * 4);
+			let (sh, sh_tail) = std::mem::take(&mut spherical_harmonics)
+				.split_at_mut(n * coeffs_per_point * 3);
+
+			jobs.push((p, r, sh));
+			positions = p_tail;
+			rotations = r_tail;
+			spherical_harmonics = sh_tail;
+		}
+		parallel::run(jobs, |(positions, rotations, spherical_harmonics)| {
+			apply_axis_flips(
+				&flip,
+				positions,
+				rotations,
+				spherical_harmonics,
+				coeffs_per_point,
+			);
+		});
+	}
 
-				idx += 3;
+	/// Drops the spherical harmonics above `degree`, in place, keeping the
+	/// lower degree coefficients of every point. Does nothing if the splat is
+	/// already at `degree` or below.
+	///
+	/// # Args
+	///
+	/// `degree` - the highest spherical harmonics degree to keep, 0-3.
+	pub fn truncate_spherical_harmonics(&mut self, degree: u8) {
+		if self.header.spherical_harmonics_degree <= degree {
+			return;
+		}
+		let num_points = self.header.num_points.max(0) as usize;
+		let coeffs = dim_for_degree(degree) as usize * 3;
+		let stride = if num_points > 0 {
+			self.spherical_harmonics.len() / num_points
+		} else {
+			0
+		};
+		if stride > coeffs {
+			for i in 1..num_points {
+				self.spherical_harmonics
+					.copy_within(i * stride..i * stride + coeffs, i * coeffs);
 			}
 		}
+		self.spherical_harmonics.truncate(num_points * coeffs);
+		self.header.spherical_harmonics_degree = degree;
 	}
 
 	/// Compute median ellipsoid volume.
+	///
+	/// Exact and without allocating for scales decoded from SPZ data, see
+	/// [`stats`](crate::stats).
+	#[inline]
 	pub fn median_volume(&self) -> f32 {
-		if unlikely(self.scales.is_empty()) {
-			return 0.01;
-		}
-		// The volume of an ellipsoid is 4/3 * pi * x * y * z,
-		// where x, y, and z are the radii on each axis.
-		// Scales are stored on a log scale, and
-		// 	exp(x) * exp(y) * exp(z) = exp(x + y + z).
-		// So we can sort by value = (x + y + z) and compute
-		// 	volume = 4/3 * pi * exp(value) later.
-		let mut sums = self
-			.scales
-			.chunks_exact(3)
-			.filter_map(|c| {
-				let s = c[0] + c[1] + c[2];
-
-				if unlikely(!s.is_finite()) {
-					None
-				} else {
-					Some(s)
-				}
-			})
-			.collect::<Vec<_>>();
-
-		if unlikely(sums.is_empty()) {
-			return 0.01;
-		}
-		let n = sums.len() / 2;
-
-		sums.select_nth_unstable_by(n, |a, b| {
-			a.partial_cmp(b).unwrap_or(std::cmp::Ordering::Equal)
-		});
-		let median = sums[sums.len() / 2];
+		stats::median_volume(&self.scales)
+	}
 
-		if unlikely(!median.is_finite() || median <= f32::MIN_POSITIVE.ln()) {
-			return 0.01;
-		}
-		(std::f32::consts::PI * 4.0 / 3.0) * median.exp()
+	/// Bounding box and median ellipsoid volume, reading each position and
+	/// scale once.
+	#[inline]
+	pub fn statistics(&self) -> Statistics {
+		Statistics::from_splat(self)
 	}
 
 	/// Validates that all internal arrays have consistent sizes.
@@ -667,87 +837,31 @@ impl GaussianSplat {
 	}
 
 	pub fn bbox(&self) -> BoundingBox {
-		let mut min_x = self.positions[0];
-		let mut max_x = self.positions[0];
-		let mut min_y = self.positions[1];
-		let mut max_y = self.positions[1];
-		let mut min_z = self.positions[2];
-		let mut max_z = self.positions[2];
-
-		for i in (0..self.positions.len()).step_by(3) {
-			min_x = min_x.min(self.positions[i]);
-			max_x = max_x.max(self.positions[i]);
-			min_y = min_y.min(self.positions[i + 1]);
-			max_y = max_y.max(self.positions[i + 1]);
-			min_z = min_z.min(self.positions[i + 2]);
-			max_z = max_z.max(self.positions[i + 2]);
-		}
-		BoundingBox {
-			min_x,
-			max_x,
-			min_y,
-			max_y,
-			min_z,
-			max_z,
-		}
+		BoundingBox::from_positions(&self.positions)
 	}
 
 	pub fn pretty_fmt(&self) -> String {
-		let bbox = self.bbox();
-		let (size_x, size_y, size_z) = bbox.size();
-		let (center_x, center_y, center_z) = bbox.center();
-
-		let mut ret = String::new();
-
-		let _ = writeln!(ret, "GaussianSplat:");
-		let _ = writeln!(ret, "\tNumber of points:\t\t{}", self.header.num_points);
-		let _ = writeln!(
-			ret,
-			"\tSpherical harmonics degree:\t{}",
-			self.header.spherical_harmonics_degree
-		);
-		let _ = writeln!(
-			ret,
-			"\tAntialiased:\t\t\t{}",
-			self.header.flags.is_antialiased()
-		);
-		let _ = writeln!(ret, "\tMedian ellipsoid volume:\t{:}", self.median_volume());
-		let _ = writeln!(
-			ret,
-			"\tBounding box:\n\t\tx: {:} to {:} (size {:}, center {:})\n",
-			bbox.min_x, bbox.max_x, size_x, center_x
-		);
-		let _ = writeln!(
-			ret,
-			"\t\ty: {:} to {:} (size {:}, center {:})",
-			bbox.min_y, bbox.max_y, size_y, center_y
-		);
-		let _ = writeln!(
-			ret,
-			"\t\tz: {:} to {:} (size {:}, center {:})",
-			bbox.min_z, bbox.max_z, size_z, center_z
-		);
-		ret
+		stats::pretty_fmt(&self.header, &self.statistics())
 	}
 }
 
 impl std::fmt::Display for GaussianSplat {
 	#[inline]
 	fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
-		let _ = write!(
-			f,
-			"GaussianSplat={{{}, {}, ",
-			self.header,
-			self.median_volume()
-		);
-		let BoundingBox {
-			min_x,
-			max_x,
-			min_y,
-			max_y,
-			min_z,
-			max_z,
-		} = self.bbox();
+		let Statistics {
+			bbox:
+				BoundingBox {
+					min_x,
+					max_x,
+					min_y,
+					max_y,
+					min_z,
+					max_z,
+				},
+			median_volume,
+		} = self.statistics();
+
+		let _ = write!(f, "GaussianSplat={{{}, {}, ", self.header, median_volume);
 
 		write!(
 			f,
@@ -818,6 +932,13 @@ impl Default for GaussianSplatBuilder {
 #[derive(Clone, Debug, Arbitrary)]
 pub struct LoadOptionsBuilder {
 	coord_sys: CoordinateSystem,
+	threads: usize,
+	layout: Layout,
+	activation: Activation,
+	max_sh_degree: u8,
+	attributes: AttributeMask,
+	max_points: usize,
+	max_decompressed_len: usize,
 }
 
 impl LoadOptionsBuilder {
@@ -827,10 +948,66 @@ impl LoadOptionsBuilder {
 		self
 	}
 
+	/// Sets the number of decoding threads, `0` uses all available cores.
+	#[inline]
+	pub fn threads(mut self, threads: usize) -> Self {
+		self.threads = threads;
+		self
+	}
+
+	/// Sets the layout of decoded point records.
+	#[inline]
+	pub fn layout(mut self, layout: Layout) -> Self {
+		self.layout = layout;
+		self
+	}
+
+	/// Sets the activation of decoded point records.
+	#[inline]
+	pub fn activation(mut self, activation: Activation) -> Self {
+		self.activation = activation;
+		self
+	}
+
+	/// Sets the highest degree of spherical harmonics to decode.
+	#[inline]
+	pub fn max_sh_degree(mut self, max_sh_degree: u8) -> Self {
+		self.max_sh_degree = max_sh_degree;
+		self
+	}
+
+	/// Sets the attributes to decode.
+	#[inline]
+	pub fn attributes(mut self, attributes: AttributeMask) -> Self {
+		self.attributes = attributes;
+		self
+	}
+
+	/// Sets the largest number of points to decode.
+	#[inline]
+	pub fn max_points(mut self, max_points: usize) -> Self {
+		self.max_points = max_points;
+		self
+	}
+
+	/// Sets the largest number of bytes to decompress.
+	#[inline]
+	pub fn max_decompressed_len(mut self, max_decompressed_len: usize) -> Self {
+		self.max_decompressed_len = max_decompressed_len;
+		self
+	}
+
 	#[inline]
 	pub fn build(self) -> LoadOptions {
 		LoadOptions {
 			coord_sys: self.coord_sys,
+			threads: self.threads,
+			layout: self.layout,
+			activation: self.activation,
+			max_sh_degree: self.max_sh_degree,
+			attributes: self.attributes,
+			max_points: self.max_points,
+			max_decompressed_len: self.max_decompressed_len,
 		}
 	}
 }
@@ -840,17 +1017,72 @@ impl Default for LoadOptionsBuilder {
 	fn default() -> Self {
 		Self {
 			coord_sys: CoordinateSystem::Unspecified,
+			threads: 1,
+			layout: Layout::Columns,
+			activation: Activation::Raw,
+			max_sh_degree: 3,
+			attributes: AttributeMask::all(),
+			max_points: usize::MAX,
+			max_decompressed_len: usize::MAX,
 		}
 	}
 }
 
-#[derive(Clone, Debug, Default, PartialEq, Eq, Serialize, Deserialize, Arbitrary)]
+#[derive(Clone, Debug, PartialEq, Eq, Serialize, Deserialize, Arbitrary)]
 pub struct LoadOptions {
 	/// Specifies the coordinate system to convert to when loading from
 	/// the one the data is stored in the SPZ file.
 	///
 	/// For more information see [`CoordinateSystem`](crate::coord::CoordinateSystem).
 	pub coord_sys: CoordinateSystem,
+
+	/// Number of threads to decode the points with, `0` uses all available
+	/// cores. Defaults to 1, decoding on the calling thread.
+	///
+	/// Applies to decoding packed gaussians, see
+	/// [`GaussianSplat::decode_into`]; streamed decoding is sequential.
+	/// Small splats are never split below
+	/// [`MIN_POINTS_PER_THREAD`](crate::parallel::MIN_POINTS_PER_THREAD)
+	/// points per thread.
+	pub threads: usize,
+
+	/// Layout of decoded point records, see
+	/// [`decode_records`](crate::layout::decode_records). Loading into a
+	/// [`GaussianSplat`] always gives [`Layout::Columns`].
+	pub layout: Layout,
+
+	/// Transform applied to the values of decoded point records, see
+	/// [`Activation`].
+	pub activation: Activation,
+
+	/// Highest degree of spherical harmonics to decode, the coefficients of
+	/// higher degrees in the file are skipped. Defaults to 3, every degree.
+	///
+	/// The decoded splat reports the degree it was decoded with.
+	pub max_sh_degree: u8,
+
+	/// Attributes to decode. The others are neither dequantized nor
+	/// allocated and their buffers stay empty, which also leaves the splat
+	/// unfit for saving. Defaults to every attribute.
+	///
+	/// Sections of the file after the last selected one are not inflated
+	/// when the data allows reading a prefix: streamed gzip, indexed
+	/// multi-member gzip and the chunks of a
+	/// [`ChunkedSpz`](crate::chunked::ChunkedSpz).
+	pub attributes: AttributeMask,
+
+	/// Largest number of points to decode, data whose header claims more is
+	/// rejected before anything gets allocated for it. Defaults to no limit.
+	pub max_points: usize,
+
+	/// Largest number of bytes to decompress: the header and the packed
+	/// sections that get decoded, see [`LoadOptions::check_limits`].
+	/// Defaults to no limit.
+	///
+	/// Without limits, what gets allocated is still bounded by the data:
+	/// buffers grow as sections are inflated rather than as big as the
+	/// header claims.
+	pub max_decompressed_len: usize,
 }
 
 impl LoadOptions {
@@ -858,6 +1090,118 @@ impl LoadOptions {
 	pub fn builder() -> LoadOptionsBuilder {
 		LoadOptionsBuilder::default()
 	}
+
+	/// Degree of spherical harmonics decoded from data of degree
+	/// `sh_degree`, 0 when they aren't selected.
+	#[inline]
+	pub fn decoded_sh_degree(&self, sh_degree: u8) -> u8 {
+		if self.attributes.contains(AttributeMask::SPHERICAL_HARMONICS) {
+			sh_degree.min(self.max_sh_degree)
+		} else {
+			0
+		}
+	}
+
+	/// Attributes decoded from data with spherical harmonics of degree
+	/// `sh_degree`: [`LoadOptions::attributes`], without spherical
+	/// harmonics if none of their degrees get decoded.
+	#[inline]
+	pub fn decoded_attributes(&self, sh_degree: u8) -> AttributeMask {
+		if self.decoded_sh_degree(sh_degree) == 0 {
+			self.attributes - AttributeMask::SPHERICAL_HARMONICS
+		} else {
+			self.attributes
+		}
+	}
+
+	/// Checks data with `header` against [`LoadOptions::max_points`] and
+	/// [`LoadOptions::max_decompressed_len`].
+	///
+	/// # Returns
+	///
+	/// The length of the decompressed prefix holding the header and the
+	/// sections decoded with these options.
+	pub fn check_limits(&self, header: &Header) -> Result<usize> {
+		let num_points = header.num_points.max(0) as usize;
+
+		if unlikely(num_points > self.max_points) {
+			bail!(
+				"{num_points} points exceed the limit of {}",
+				self.max_points
+			);
+		}
+		let len = packed::prefix_len(
+			header,
+			packed::leading_sections(
+				self.decoded_attributes(header.spherical_harmonics_degree),
+			),
+		);
+
+		if unlikely(len > self.max_decompressed_len) {
+			bail!(
+				"{len} decompressed bytes exceed the limit of {}",
+				self.max_decompressed_len
+			);
+		}
+		Ok(len)
+	}
+
+	/// Checks the compressed stream `compressed` against the limits, see
+	/// [`LoadOptions::check_limits`], and decompresses into `decompressed`
+	/// the prefix holding the sections decoded with these options. The
+	/// sections after the last selected one aren't inflated when the data
+	/// allows reading a prefix.
+	///
+	/// # Args
+	///
+	/// `compressed` - gzip or zstd compressed, packed gaussian data, not a
+	/// container.
+	/// `decompressed` - buffer for the decompressed data, cleared first.
+	/// `threads` - threads to inflate indexed multi-member gzip with, `0`
+	/// uses all available cores.
+	///
+	/// # Returns
+	///
+	/// The number of leading sections decoded, in file order.
+	pub fn decompress_decoded(
+		&self,
+		compressed: &[u8],
+		decompressed: &mut Vec<u8>,
+		threads: usize,
+	) -> Result<usize> {
+		let header = Header::from_stream(compressed)?;
+		let len = self.check_limits(&header)?;
+
+		decompressed.clear();
+
+		if self.inflates_everything(header.spherical_harmonics_degree) {
+			compression::decompress(compressed, decompressed, threads)
+		} else {
+			compression::decompress_prefix(compressed, decompressed, threads, len)
+		}
+		.with_context(|| "unable to decompress data")?;
+
+		Ok(packed::leading_sections(
+			self.decoded_attributes(header.spherical_harmonics_degree),
+		))
+	}
+
+	/// Whether data with spherical harmonics of degree `sh_degree` gets
+	/// inflated whole: every attribute is decoded and no limit bounds the
+	/// decompressed length, so nothing past the sections has to be cut off.
+	#[inline]
+	pub(crate) fn inflates_everything(&self, sh_degree: u8) -> bool {
+		self.attributes.is_all()
+			&& self.max_sh_degree >= sh_degree
+			&& self.max_decompressed_len == usize::MAX
+	}
+}
+
+impl Default for LoadOptions {
+	#[inline]
+	fn default() -> Self {
+		LoadOptionsBuilder::default().build()
+	}
 }
 
 /// Options for saving the [`GaussianSplat`](crate::gaussian_splat::GaussianSplat) data.
@@ -866,11 +1210,42 @@ impl LoadOptions {
 /// compression to convert to the SPZ internal format (RightUpBack|RUB).
 ///
 /// For more information see [`CoordinateSystem`](crate::coord::CoordinateSystem).
-#[derive(Clone, Debug, Default, PartialEq, Eq, Serialize, Deserialize, Arbitrary)]
+#[derive(Clone, Debug, PartialEq, Eq, Serialize, Deserialize, Arbitrary)]
 pub struct SaveOptions {
 	/// Specifies the coordinate system to convert to when saving the
 	/// Gaussian Splat data into the SPZ file.
 	pub coord_sys: CoordinateSystem,
+
+	/// Number of threads to quantize the points with, `0` uses all available
+	/// cores. Defaults to 1, encoding on the calling thread.
+	///
+	/// Small splats are never split below
+	/// [`MIN_POINTS_PER_THREAD`](crate::parallel::MIN_POINTS_PER_THREAD)
+	/// points per thread.
+	pub threads: usize,
+
+	/// Compresses blocks of the data on [`SaveOptions::threads`] threads
+	/// into a multi-member gzip stream, which
+	/// [`GaussianSplat::read_from_bytes`] inflates in parallel again.
+	///
+	/// The stream is valid gzip and readable by any reader that handles
+	/// multiple members, but not by readers that stop after the first one.
+	/// Defaults to `false`.
+	pub parallel_compression: bool,
+
+	/// Compression format. Anything but [`Codec::Gzip`] is not an SPZ file
+	/// other readers understand. Defaults to [`Codec::Gzip`].
+	pub codec: Codec,
+
+	/// Speed/ratio tradeoff of compression. Defaults to
+	/// [`CompressionLevel::Default`].
+	pub level: CompressionLevel,
+
+	/// Order to write the points in, sorting them along a space filling curve
+	/// makes files smaller and traversal cache friendly. The loaded splat
+	/// then holds the points in that order too. Defaults to
+	/// [`PointOrder::Original`].
+	pub order: PointOrder,
 }
 
 impl SaveOptions {
@@ -881,10 +1256,22 @@ impl SaveOptions {
 	}
 }
 
+impl Default for SaveOptions {
+	#[inline]
+	fn default() -> Self {
+		SaveOptionsBuilder::default().build()
+	}
+}
+
 /// Builder for [`SaveOptions`].
 #[derive(Clone, Debug, Arbitrary)]
 pub struct SaveOptionsBuilder {
 	coord_sys: CoordinateSystem,
+	threads: usize,
+	parallel_compression: bool,
+	codec: Codec,
+	level: CompressionLevel,
+	order: PointOrder,
 }
 
 impl SaveOptionsBuilder {
@@ -895,11 +1282,52 @@ impl SaveOptionsBuilder {
 		self
 	}
 
+	/// Sets the number of encoding threads, `0` uses all available cores.
+	#[inline]
+	pub fn threads(mut self, threads: usize) -> Self {
+		self.threads = threads;
+		self
+	}
+
+	/// Enables compressing into a multi-member gzip stream on several
+	/// threads.
+	#[inline]
+	pub fn parallel_compression(mut self, parallel_compression: bool) -> Self {
+		self.parallel_compression = parallel_compression;
+		self
+	}
+
+	/// Sets the compression format.
+	#[inline]
+	pub fn codec(mut self, codec: Codec) -> Self {
+		self.codec = codec;
+		self
+	}
+
+	/// Sets the compression level.
+	#[inline]
+	pub fn level(mut self, level: CompressionLevel) -> Self {
+		self.level = level;
+		self
+	}
+
+	/// Sets the order to write the points in.
+	#[inline]
+	pub fn order(mut self, order: PointOrder) -> Self {
+		self.order = order;
+		self
+	}
+
 	/// Builds the [`SaveOptions`].
 	#[inline]
 	pub fn build(self) -> SaveOptions {
 		SaveOptions {
 			coord_sys: self.coord_sys,
+			threads: self.threads,
+			parallel_compression: self.parallel_compression,
+			codec: self.codec,
+			level: self.level,
+			order: self.order,
 		}
 	}
 }
@@ -909,8 +1337,285 @@ impl Default for SaveOptionsBuilder {
 	fn default() -> Self {
 		Self {
 			coord_sys: CoordinateSystem::Unspecified,
+			threads: 1,
+			parallel_compression: false,
+			codec: Codec::Gzip,
+			level: CompressionLevel::Default,
+			order: PointOrder::Original,
+		}
+	}
+}
+
+/// A range of whole points of every attribute, in the order positions,
+/// scales, rotations, alphas, colors and spherical harmonics: the source and
+/// destination of encoding (`f32` to `u8`) or decoding (`u8` to `f32`).
+struct AttributeJob<'a, S, D> {
+	src: [&'a [S]; 6],
+	dst: [&'a mut [D]; 6],
+}
+
+/// A range of whole points to encode.
+type EncodeJob<'a> = AttributeJob<'a, f32, u8>;
+
+/// A range of whole points to decode.
+type DecodeJob<'a> = AttributeJob<'a, u8, f32>;
+
+impl<'a, S, D> AttributeJob<'a, S, D> {
+	/// Splits the attributes of `num_points` points into jobs of
+	/// `points_per_job` points.
+	///
+	/// `strides` is the per-point (source, destination) length of every
+	/// attribute.
+	fn split(
+		src: [&'a [S]; 6],
+		dst: [&'a mut [D]; 6],
+		strides: [(usize, usize); 6],
+		num_points: usize,
+		points_per_job: usize,
+	) -> Vec<Self> {
+		let points_per_job = points_per_job.max(1);
+
+		let mut jobs = Vec::with_capacity(num_points.div_ceil(points_per_job));
+		let mut src = src;
+		let mut dst = dst;
+		let mut start = 0_usize;
+
+		while start < num_points {
+			let n = points_per_job.min(num_points - start);
+			let mut job_src: [&[S]; 6] = [&[]; 6];
+			let mut job_dst: [&mut [D]; 6] = Default::default();
+
+			for (a, (src_stride, dst_stride)) in strides.into_iter().enumerate() {
+				let (head, tail) = src[a].split_at(n * src_stride);
+
+				job_src[a] = head;
+				src[a] = tail;
+
+				let (head, tail) =
+					std::mem::take(&mut dst[a]).split_at_mut(n * dst_stride);
+
+				job_dst[a] = head;
+				dst[a] = tail;
+			}
+			jobs.push(Self {
+				src: job_src,
+				dst: job_dst,
+			});
+			start += n;
+		}
+		jobs
+	}
+}
+
+/// Per-point (source floats, destination bytes) of every attribute when
+/// encoding.
+#[inline]
+fn encode_strides(sh_dim: usize) -> [(usize, usize); 6] {
+	[
+		(3, 9),
+		(3, 3),
+		(4, 4),
+		(1, 1),
+		(3, 3),
+		(sh_dim * 3, sh_dim * 3),
+	]
+}
+
+/// Per-point (source bytes, destination floats) of every attribute when
+/// decoding `sh_dim` spherical harmonics coefficients into `kept_sh_dim`.
+#[inline]
+fn decode_strides(
+	sh_dim: usize,
+	kept_sh_dim: usize,
+	uses_quaternion_smallest_three: bool,
+) -> [(usize, usize); 6] {
+	[
+		(9, 3),
+		(3, 3),
+		(if uses_quaternion_smallest_three { 4 } else { 3 }, 4),
+		(1, 1),
+		(3, 3),
+		(sh_dim * 3, kept_sh_dim * 3),
+	]
+}
+
+/// Packed sections, in [`AttributeMask`] bit order, with their per-point
+/// (source bytes, destination floats).
+type Sections<'a> = ([&'a [u8]; 6], [(usize, usize); 6]);
+
+/// The sections of `packed` decoded with `opts`, with their
+/// [`decode_strides`], checked against the number of points. The sections
+/// of attributes that aren't decoded are empty, with strides of 0.
+fn packed_sections<'a, P>(packed: &'a P, opts: &LoadOptions) -> Result<Sections<'a>>
+where
+	P: PackedGaussians + ?Sized,
+{
+	if unlikely(packed.num_points() < 0) {
+		bail!("inconsistent sizes");
+	}
+	let num_points = packed.num_points() as usize;
+	let sh_degree = packed.to_header().spherical_harmonics_degree;
+	let attributes = opts.decoded_attributes(sh_degree);
+	let sh_dim = dim_for_degree(sh_degree) as usize;
+	let kept_sh_dim = dim_for_degree(opts.decoded_sh_degree(sh_degree)) as usize;
+
+	// the sections of attributes that aren't decoded are never read
+	let mut src = [
+		packed.positions(),
+		packed.scales(),
+		packed.rotations(),
+		packed.alphas(),
+		packed.colors(),
+		packed.spherical_harmonics(),
+	];
+	let mut strides =
+		decode_strides(sh_dim, kept_sh_dim, packed.uses_quaternion_smallest_three());
+
+	for (a, (src, strides)) in src.iter_mut().zip(&mut strides).enumerate() {
+		if !attributes.contains(AttributeMask::from_bits_retain(1 << a)) {
+			*src = &[];
+			*strides = (0, 0);
+		} else if unlikely(src.len() != num_points.saturating_mul(strides.0)) {
+			bail!("inconsistent sizes");
+		}
+	}
+	Ok((src, strides))
+}
+
+/// Number of floats each decoded attribute of a splat occupies.
+///
+/// Use it to size the buffers handed to
+/// [`GaussianSplat::decode_into`](crate::gaussian_splat::GaussianSplat::decode_into).
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq, Serialize, Deserialize, Arbitrary)]
+pub struct AttributeLens {
+	/// `num_points * 3`.
+	pub positions: usize,
+	/// `num_points * 3`.
+	pub scales: usize,
+	/// `num_points * 4`.
+	pub rotations: usize,
+	/// `num_points`.
+	pub alphas: usize,
+	/// `num_points * 3`.
+	pub colors: usize,
+	/// `num_points * sh_dim * 3`.
+	pub spherical_harmonics: usize,
+}
+
+impl AttributeLens {
+	/// Computes the attribute lengths for `num_points` gaussians with
+	/// spherical harmonics of degree `sh_degree`.
+	#[inline]
+	pub fn new(num_points: usize, sh_degree: u8) -> Self {
+		let sh_dim = dim_for_degree(sh_degree) as usize;
+
+		Self {
+			positions: num_points.saturating_mul(3),
+			scales: num_points.saturating_mul(3),
+			rotations: num_points.saturating_mul(4),
+			alphas: num_points,
+			colors: num_points.saturating_mul(3),
+			spherical_harmonics: num_points.saturating_mul(sh_dim).saturating_mul(3),
+		}
+	}
+
+	/// Computes the attribute lengths described by `header`.
+	#[inline]
+	pub fn from_header(header: &Header) -> Self {
+		Self::new(
+			header.num_points.max(0) as usize,
+			header.spherical_harmonics_degree,
+		)
+	}
+
+	/// Computes the attribute lengths of data described by `header` decoded
+	/// with `opts`: the attributes outside of [`LoadOptions::attributes`]
+	/// take no floats and spherical harmonics are cut to
+	/// [`LoadOptions::max_sh_degree`].
+	#[inline]
+	pub fn decoded(header: &Header, opts: &LoadOptions) -> Self {
+		let sh_degree = header.spherical_harmonics_degree;
+
+		Self::new(
+			header.num_points.max(0) as usize,
+			opts.decoded_sh_degree(sh_degree),
+		)
+		.masked(opts.decoded_attributes(sh_degree))
+	}
+
+	/// The lengths with the attributes outside of `attributes` set to 0.
+	#[inline]
+	pub fn masked(self, attributes: AttributeMask) -> Self {
+		let len = |attribute, len| {
+			if attributes.contains(attribute) {
+				len
+			} else {
+				0
+			}
+		};
+		Self {
+			positions: len(AttributeMask::POSITIONS, self.positions),
+			scales: len(AttributeMask::SCALES, self.scales),
+			rotations: len(AttributeMask::ROTATIONS, self.rotations),
+			alphas: len(AttributeMask::ALPHAS, self.alphas),
+			colors: len(AttributeMask::COLORS, self.colors),
+			spherical_harmonics: len(
+				AttributeMask::SPHERICAL_HARMONICS,
+				self.spherical_harmonics,
+			),
 		}
 	}
+
+	/// Number of floats of all attributes.
+	#[inline]
+	pub fn total(&self) -> usize {
+		self.positions
+			.saturating_add(self.scales)
+			.saturating_add(self.rotations)
+			.saturating_add(self.alphas)
+			.saturating_add(self.colors)
+			.saturating_add(self.spherical_harmonics)
+	}
+}
+
+/// A set of splat attributes, selects which attributes get decoded.
+///
+/// Attributes outside of the mask are never dequantized, their decoded
+/// buffers stay empty.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, Serialize, Deserialize, Arbitrary)]
+pub struct AttributeMask(pub u32);
+
+bitflags! {
+	impl AttributeMask: u32 {
+		const POSITIONS = 0x1;
+		const SCALES = 0x2;
+		const ROTATIONS = 0x4;
+		const ALPHAS = 0x8;
+		const COLORS = 0x10;
+		const SPHERICAL_HARMONICS = 0x20;
+	}
+}
+
+impl Default for AttributeMask {
+	/// Every attribute.
+	#[inline]
+	fn default() -> Self {
+		Self::all()
+	}
+}
+
+/// Caller-owned destination buffers to decode a splat into, one per attribute.
+///
+/// The layout of every buffer matches the corresponding field of
+/// [`GaussianSplat`](crate::gaussian_splat::GaussianSplat).
+#[derive(Debug)]
+pub struct AttributeBuffersMut<'a> {
+	pub positions: &'a mut [f32],
+	pub scales: &'a mut [f32],
+	pub rotations: &'a mut [f32],
+	pub alphas: &'a mut [f32],
+	pub colors: &'a mut [f32],
+	pub spherical_harmonics: &'a mut [f32],
 }
 
 #[derive(Clone, Debug, PartialEq, Serialize, Deserialize, Arbitrary)]
@@ -924,6 +1629,40 @@ pub struct BoundingBox {
 }
 
 impl BoundingBox {
+	/// Computes the bounding box of `(x, y, z)` positions, all zeros when
+	/// there are none.
+	pub fn from_positions(positions: &[f32]) -> Self {
+		let mut points = positions.chunks_exact(3);
+
+		let Some(first) = points.next() else {
+			return Self {
+				min_x: 0.0,
+				max_x: 0.0,
+				min_y: 0.0,
+				max_y: 0.0,
+				min_z: 0.0,
+				max_z: 0.0,
+			};
+		};
+		let mut bbox = Self {
+			min_x: first[0],
+			max_x: first[0],
+			min_y: first[1],
+			max_y: first[1],
+			min_z: first[2],
+			max_z: first[2],
+		};
+		for p in points {
+			bbox.min_x = bbox.min_x.min(p[0]);
+			bbox.max_x = bbox.max_x.max(p[0]);
+			bbox.min_y = bbox.min_y.min(p[1]);
+			bbox.max_y = bbox.max_y.max(p[1]);
+			bbox.min_z = bbox.min_z.min(p[2]);
+			bbox.max_z = bbox.max_z.max(p[2]);
+		}
+		bbox
+	}
+
 	#[inline]
 	pub fn size(&self) -> (f32, f32, f32) {
 		(
@@ -946,11 +1685,85 @@ impl BoundingBox {
 			(self.min_z + self.max_z) / 2.0,
 		)
 	}
+
+	/// Whether the two boxes overlap, touching counts.
+	#[inline]
+	pub fn intersects(&self, other: &BoundingBox) -> bool {
+		self.min_x <= other.max_x
+			&& other.min_x <= self.max_x
+			&& self.min_y <= other.max_y
+			&& other.min_y <= self.max_y
+			&& self.min_z <= other.max_z
+			&& other.min_z <= self.max_z
+	}
+
+	/// The box in another coordinate system, given the axis flips to it.
+	#[inline]
+	pub fn flipped(&self, flip: &AxisFlips) -> Self {
+		let axis = |min: f32, max: f32, sign: f32| {
+			if sign < 0.0 { (-max, -min) } else { (min, max) }
+		};
+		let (min_x, max_x) = axis(self.min_x, self.max_x, flip.position[0]);
+		let (min_y, max_y) = axis(self.min_y, self.max_y, flip.position[1]);
+		let (min_z, max_z) = axis(self.min_z, self.max_z, flip.position[2]);
+
+		Self {
+			min_x,
+			max_x,
+			min_y,
+			max_y,
+			min_z,
+			max_z,
+		}
+	}
+}
+
+/// Returns the first `len` floats of a caller provided attribute buffer.
+#[inline]
+fn attribute_prefix<'a>(buf: &'a mut [f32], len: usize, name: &str) -> Result<&'a mut [f32]> {
+	if unlikely(buf.len() < len) {
+		bail!("{name} buffer too small: {} < {len}", buf.len());
+	}
+	Ok(&mut buf[..len])
+}
+
+/// Multiplies positions, rotations and spherical harmonics by the given
+/// axis flips, in place.
+pub(crate) fn apply_axis_flips(
+	flip: &AxisFlips,
+	positions: &mut [f32],
+	rotations: &mut [f32],
+	spherical_harmonics: &mut [f32],
+	coeffs_per_point: usize,
+) {
+	for p in positions.chunks_exact_mut(3) {
+		p[0] *= flip.position[0];
+		p[1] *= flip.position[1];
+		p[2] *= flip.position[2];
+	}
+	for r in rotations.chunks_exact_mut(4) {
+		r[0] *= flip.rotation[0];
+		r[1] *= flip.rotation[1];
+		r[2] *= flip.rotation[2];
+		// r[3] (w) unchanged
+	}
+	if unlikely(coeffs_per_point == 0) {
+		return;
+	}
+	for point in spherical_harmonics.chunks_exact_mut(coeffs_per_point * 3) {
+		for (coeff, f) in point.chunks_exact_mut(3).zip(flip.spherical_harmonics) {
+			coeff[0] *= f;
+			coeff[1] *= f;
+			coeff[2] *= f;
+		}
+	}
 }
 
 #[cfg(test)]
 mod tests {
 	use super::*;
+	use crate::decoder::Decoder;
+	use crate::test_util::splat;
 	use approx::assert_relative_eq;
 	use rstest::rstest;
 
@@ -1157,6 +1970,39 @@ mod tests {
 		assert_eq!(gs.positions, original_pos);
 	}
 
+	#[test]
+	fn test_truncate_spherical_harmonics_keeps_lower_degrees() {
+		let num_points = 3;
+		let mut gs = GaussianSplat {
+			header: Header {
+				num_points: num_points as i32,
+				spherical_harmonics_degree: 2,
+				..Default::default()
+			},
+			positions: vec![0.0; num_points * 3],
+			scales: vec![0.0; num_points * 3],
+			rotations: vec![0.0; num_points * 4],
+			alphas: vec![0.0; num_points],
+			colors: vec![0.0; num_points * 3],
+			spherical_harmonics: (0..num_points * 24).map(|i| i as f32).collect(),
+		};
+		gs.truncate_spherical_harmonics(3);
+		assert_eq!(gs.header.spherical_harmonics_degree, 2);
+
+		gs.truncate_spherical_harmonics(1);
+		assert_eq!(gs.header.spherical_harmonics_degree, 1);
+		assert!(gs.check_sizes());
+
+		for (i, point) in gs.spherical_harmonics.chunks_exact(9).enumerate() {
+			let expected: Vec<f32> = (i * 24..i * 24 + 9).map(|c| c as f32).collect();
+
+			assert_eq!(point, expected.as_slice());
+		}
+		gs.truncate_spherical_harmonics(0);
+		assert!(gs.spherical_harmonics.is_empty());
+		assert!(gs.check_sizes());
+	}
+
 	#[test]
 	fn test_to_packed_gaussians_inconsistent_sizes_fails() {
 		let gs = GaussianSplat {
@@ -1169,4 +2015,561 @@ mod tests {
 		};
 		assert!(gs.to_packed_gaussians(&SaveOptions::default()).is_err());
 	}
+
+	#[rstest]
+	#[case(0)]
+	#[case(2)]
+	#[case(3)]
+	fn test_to_packed_gaussians_threads_match_single_thread(#[case] threads: usize) {
+		let num_points = crate::parallel::MIN_POINTS_PER_THREAD * 3 + 7;
+		let gs = splat(num_points, 3);
+		let opts = SaveOptions::builder().coord_sys(CoordinateSystem::LeftDownFront);
+
+		let expected = gs.to_packed_gaussians(&opts.clone().build()).unwrap();
+		let actual = gs
+			.to_packed_gaussians(&opts.threads(threads).build())
+			.unwrap();
+
+		assert_eq!(actual, expected);
+	}
+
+	#[rstest]
+	#[case(0, 3)]
+	#[case(2, 0)]
+	#[case(3, 2)]
+	fn test_decode_and_convert_threads_match_single_thread(
+		#[case] threads: usize,
+		#[case] sh_degree: u8,
+	) {
+		let num_points = crate::parallel::MIN_POINTS_PER_THREAD * 3 + 7;
+		let gs = splat(num_points, sh_degree);
+		let packed = gs.to_packed_gaussians(&SaveOptions::default()).unwrap();
+		let opts = LoadOptions::builder().coord_sys(CoordinateSystem::LeftDownFront);
+
+		let mut expected =
+			GaussianSplat::new_from_packed_gaussians(&packed, &opts.clone().build())
+				.unwrap();
+		let mut actual = GaussianSplat::new_from_packed_gaussians(
+			&packed,
+			&opts.threads(threads).build(),
+		)
+		.unwrap();
+
+		assert_eq!(actual, expected);
+
+		expected.convert_coordinates(
+			CoordinateSystem::RightUpBack,
+			CoordinateSystem::LeftUpFront,
+		);
+		actual.convert_coordinates_with_threads(
+			CoordinateSystem::RightUpBack,
+			CoordinateSystem::LeftUpFront,
+			threads,
+		);
+
+		assert_eq!(actual, expected);
+	}
+
+	#[rstest]
+	#[case(false, 3)]
+	#[case(true, 3)]
+	#[case(false, 1)]
+	fn test_threaded_load_matches_single_thread(
+		#[case] parallel_compression: bool,
+		#[case] max_sh_degree: u8,
+	) {
+		let num_points = crate::parallel::MIN_POINTS_PER_THREAD * 3 + 7;
+		let gs = splat(num_points, 2);
+		let bytes = gs
+			.serialize_to_packed_bytes(
+				&SaveOptions::builder()
+					.threads(4)
+					.parallel_compression(parallel_compression)
+					.build(),
+			)
+			.unwrap();
+		let opts = LoadOptions::builder()
+			.coord_sys(CoordinateSystem::LeftDownFront)
+			.max_sh_degree(max_sh_degree);
+
+		let expected =
+			GaussianSplat::read_from_bytes(&bytes, &opts.clone().build()).unwrap();
+
+		for threads in [0, 2] {
+			assert_eq!(
+				GaussianSplat::read_from_bytes(
+					&bytes,
+					&opts.clone().threads(threads).build()
+				)
+				.unwrap(),
+				expected
+			);
+		}
+	}
+
+	#[test]
+	fn test_parallel_compression_roundtrip() {
+		let num_points = 40_000;
+		let gs = splat(num_points, 1);
+		let plain = gs
+			.serialize_to_packed_bytes(&SaveOptions::default())
+			.unwrap();
+		let parallel = gs
+			.serialize_to_packed_bytes(
+				&SaveOptions::builder()
+					.threads(4)
+					.parallel_compression(true)
+					.build(),
+			)
+			.unwrap();
+
+		assert!(compression::gzip::is_indexed_multi_member(&parallel));
+
+		let expected =
+			GaussianSplat::read_from_bytes(&plain, &LoadOptions::default()).unwrap();
+
+		assert_eq!(
+			GaussianSplat::read_from_bytes(&parallel, &LoadOptions::default()).unwrap(),
+			expected
+		);
+		assert_eq!(
+			GaussianSplat::read_from(parallel.as_slice(), &LoadOptions::default())
+				.unwrap(),
+			expected
+		);
+		assert_eq!(
+			PackedGaussianSplat::from_bytes(&parallel).unwrap(),
+			PackedGaussianSplat::from_bytes(&plain).unwrap()
+		);
+	}
+
+	#[rstest]
+	#[case(CompressionLevel::Fast, false)]
+	#[case(CompressionLevel::Best, false)]
+	#[case(CompressionLevel::Level(3), true)]
+	fn test_compression_level_roundtrip(
+		#[case] level: CompressionLevel,
+		#[case] parallel_compression: bool,
+	) {
+		let num_points = 20_000;
+		let gs = splat(num_points, 1);
+		let expected = gs
+			.serialize_to_packed_bytes(&SaveOptions::default())
+			.unwrap();
+		let actual = gs
+			.serialize_to_packed_bytes(
+				&SaveOptions::builder()
+					.level(level)
+					.parallel_compression(parallel_compression)
+					.threads(2)
+					.build(),
+			)
+			.unwrap();
+
+		assert_eq!(
+			PackedGaussianSplat::from_bytes(&actual).unwrap(),
+			PackedGaussianSplat::from_bytes(&expected).unwrap()
+		);
+		assert_eq!(
+			GaussianSplat::read_from_bytes(&actual, &LoadOptions::default()).unwrap(),
+			GaussianSplat::read_from_bytes(&expected, &LoadOptions::default()).unwrap()
+		);
+	}
+
+	#[rstest]
+	#[case(PointOrder::Morton)]
+	#[case(PointOrder::Hilbert)]
+	fn test_point_order_permutes_and_shrinks(#[case] order: PointOrder) {
+		// points scattered at random, their colors smooth over space
+		let num_points = 20_000;
+		let hash = |i: usize| {
+			((i as u64).wrapping_mul(0x9e37_79b9_7f4a_7c15) >> 40) as f32 / 16_777_216.0
+		};
+		let positions: Vec<f32> =
+			(0..num_points * 3).map(|i| hash(i) * 20.0 - 10.0).collect();
+
+		let gs = GaussianSplat {
+			header: Header {
+				num_points: num_points as i32,
+				spherical_harmonics_degree: 1,
+				..Default::default()
+			},
+			scales: positions.iter().map(|p| p / 20.0 - 3.0).collect(),
+			rotations: (0..num_points).flat_map(|_| [0.0, 0.0, 0.0, 1.0]).collect(),
+			alphas: positions.iter().step_by(3).map(|p| p / 5.0).collect(),
+			colors: positions.iter().map(|p| p / 10.0).collect(),
+			spherical_harmonics: positions
+				.chunks_exact(3)
+				.flat_map(|p| [p[0], p[1], p[2]].repeat(3))
+				.map(|p| p / 40.0)
+				.collect(),
+			positions,
+		};
+		let original = gs.to_packed_gaussians(&SaveOptions::default()).unwrap();
+		let opts = SaveOptions::builder().order(order).build();
+		let sorted = gs.to_packed_gaussians(&opts).unwrap();
+		let permutation = original.clone().reorder(order).unwrap().unwrap();
+
+		for (i, &source) in permutation.iter().enumerate() {
+			assert_eq!(sorted.at(i).unwrap(), original.at(source as usize).unwrap());
+		}
+		let mut indices = permutation.clone();
+
+		indices.sort_unstable();
+		assert!(indices.iter().copied().eq(0..num_points as u32));
+
+		let original_len = gs
+			.serialize_to_packed_bytes(&SaveOptions::default())
+			.unwrap()
+			.len();
+		let sorted_len = gs.serialize_to_packed_bytes(&opts).unwrap().len();
+
+		assert!(sorted_len < original_len * 19 / 20);
+	}
+
+	fn one_point_sh1_packed() -> PackedGaussianSplat {
+		let gs = GaussianSplat {
+			header: Header {
+				num_points: 1,
+				spherical_harmonics_degree: 1,
+				..Default::default()
+			},
+			positions: vec![1.0, -2.0, 3.0],
+			scales: vec![-1.0, 0.0, 1.0],
+			rotations: vec![0.0, 0.0, 0.0, 1.0],
+			alphas: vec![0.5],
+			colors: vec![0.1, 0.2, 0.3],
+			spherical_harmonics: vec![0.25; 9],
+		};
+		gs.to_packed_gaussians(&SaveOptions::default()).unwrap()
+	}
+
+	#[test]
+	fn test_decode_into_matches_new_from_packed_gaussians() {
+		let packed = one_point_sh1_packed();
+		let opts = LoadOptions::builder()
+			.coord_sys(CoordinateSystem::RightDownFront)
+			.build();
+		let expected = GaussianSplat::new_from_packed_gaussians(&packed, &opts).unwrap();
+
+		// oversized buffers, only the prefix must be written
+		let mut positions = [f32::NAN; 4];
+		let mut scales = [0.0; 3];
+		let mut rotations = [0.0; 4];
+		let mut alphas = [0.0; 1];
+		let mut colors = [0.0; 3];
+		let mut sh = [0.0; 9];
+
+		let header = GaussianSplat::decode_into(
+			&packed,
+			&opts,
+			AttributeBuffersMut {
+				positions: &mut positions,
+				scales: &mut scales,
+				rotations: &mut rotations,
+				alphas: &mut alphas,
+				colors: &mut colors,
+				spherical_harmonics: &mut sh,
+			},
+		)
+		.unwrap();
+
+		assert_eq!(header, expected.header);
+		assert_eq!(&positions[..3], expected.positions.as_slice());
+		assert!(positions[3].is_nan());
+		assert_eq!(scales.as_slice(), expected.scales.as_slice());
+		assert_eq!(rotations.as_slice(), expected.rotations.as_slice());
+		assert_eq!(alphas.as_slice(), expected.alphas.as_slice());
+		assert_eq!(colors.as_slice(), expected.colors.as_slice());
+		assert_eq!(sh.as_slice(), expected.spherical_harmonics.as_slice());
+	}
+
+	#[test]
+	fn test_decode_into_buffer_too_small_fails() {
+		let packed = one_point_sh1_packed();
+		let mut positions = [0.0; 3];
+		let mut scales = [0.0; 3];
+		let mut rotations = [0.0; 4];
+		let mut alphas = [0.0; 1];
+		let mut colors = [0.0; 3];
+		let mut sh = [0.0; 8];
+
+		let res = GaussianSplat::decode_into(
+			&packed,
+			&LoadOptions::default(),
+			AttributeBuffersMut {
+				positions: &mut positions,
+				scales: &mut scales,
+				rotations: &mut rotations,
+				alphas: &mut alphas,
+				colors: &mut colors,
+				spherical_harmonics: &mut sh,
+			},
+		);
+		assert!(res.is_err());
+	}
+
+	/// `full` as decoded with `max_sh_degree` and `attributes`.
+	fn selected(
+		full: &GaussianSplat,
+		max_sh_degree: u8,
+		attributes: AttributeMask,
+	) -> GaussianSplat {
+		let mut expected = full.clone();
+		let keep = |attribute, buf: &mut Vec<f32>| {
+			if !attributes.contains(attribute) {
+				buf.clear();
+			}
+		};
+		keep(AttributeMask::POSITIONS, &mut expected.positions);
+		keep(AttributeMask::SCALES, &mut expected.scales);
+		keep(AttributeMask::ROTATIONS, &mut expected.rotations);
+		keep(AttributeMask::ALPHAS, &mut expected.alphas);
+		keep(AttributeMask::COLORS, &mut expected.colors);
+
+		if attributes.contains(AttributeMask::SPHERICAL_HARMONICS) {
+			expected.truncate_spherical_harmonics(max_sh_degree);
+		} else {
+			expected.truncate_spherical_harmonics(0);
+		}
+		expected
+	}
+
+	#[rstest]
+	#[case(3, AttributeMask::all(), 1)]
+	#[case(1, AttributeMask::all(), 1)]
+	#[case(0, AttributeMask::all(), 4)]
+	#[case(2, AttributeMask::POSITIONS | AttributeMask::SPHERICAL_HARMONICS, 4)]
+	#[case(3, AttributeMask::POSITIONS | AttributeMask::COLORS, 1)]
+	#[case(3, AttributeMask::SCALES | AttributeMask::ROTATIONS, 4)]
+	#[case(3, AttributeMask::empty(), 1)]
+	fn test_selective_decode_matches_full_decode(
+		#[case] max_sh_degree: u8,
+		#[case] attributes: AttributeMask,
+		#[case] threads: usize,
+	) {
+		let num_points = crate::parallel::MIN_POINTS_PER_THREAD * 3 + 7;
+		let gs = splat(num_points, 3);
+		let plain = gs
+			.serialize_to_packed_bytes(&SaveOptions::default())
+			.unwrap();
+		let parallel = gs
+			.serialize_to_packed_bytes(
+				&SaveOptions::builder()
+					.threads(4)
+					.parallel_compression(true)
+					.build(),
+			)
+			.unwrap();
+		let opts = LoadOptions::builder()
+			.coord_sys(CoordinateSystem::LeftDownFront)
+			.threads(threads);
+		let full = GaussianSplat::read_from_bytes(&plain, &opts.clone().build()).unwrap();
+		let expected = selected(&full, max_sh_degree, attributes);
+		let opts = opts
+			.max_sh_degree(max_sh_degree)
+			.attributes(attributes)
+			.build();
+
+		assert_eq!(
+			AttributeLens::decoded(&full.header, &opts),
+			AttributeLens {
+				positions: expected.positions.len(),
+				scales: expected.scales.len(),
+				rotations: expected.rotations.len(),
+				alphas: expected.alphas.len(),
+				colors: expected.colors.len(),
+				spherical_harmonics: expected.spherical_harmonics.len(),
+			}
+		);
+		assert_eq!(
+			GaussianSplat::new_from_packed_gaussians(
+				&PackedGaussianSplat::from_bytes(&plain).unwrap(),
+				&opts
+			)
+			.unwrap(),
+			expected
+		);
+		assert_eq!(
+			GaussianSplat::read_from_bytes(&plain, &opts).unwrap(),
+			expected
+		);
+		assert_eq!(
+			GaussianSplat::read_from_bytes(&parallel, &opts).unwrap(),
+			expected
+		);
+		assert_eq!(
+			GaussianSplat::read_from(plain.as_slice(), &opts).unwrap(),
+			expected
+		);
+		assert_eq!(Decoder::new().decode(&parallel, &opts).unwrap(), expected);
+		assert_eq!(Decoder::new().decode(&plain, &opts).unwrap(), expected);
+	}
+
+	#[test]
+	fn test_selective_decode_skips_trailing_sections() {
+		let gs = GaussianSplat {
+			header: Header {
+				num_points: 2,
+				spherical_harmonics_degree: 1,
+				..Default::default()
+			},
+			positions: vec![0.5; 6],
+			scales: vec![0.0; 6],
+			rotations: vec![0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0],
+			alphas: vec![0.0; 2],
+			colors: vec![0.0; 6],
+			spherical_harmonics: vec![0.0; 18],
+		};
+		let mut packed = gs
+			.to_packed_gaussians(&SaveOptions::default())
+			.unwrap()
+			.to_bytes_vec()
+			.unwrap();
+
+		// everything after the colors is cut off
+		packed.truncate(HEADER_SIZE + 2 * (9 + 1 + 3));
+
+		let mut gz = Vec::new();
+		compression::gzip::compress_bytes(&packed, &mut gz).unwrap();
+
+		let opts = LoadOptions::builder()
+			.attributes(AttributeMask::POSITIONS | AttributeMask::COLORS)
+			.build();
+
+		assert!(GaussianSplat::read_from_bytes(&gz, &LoadOptions::default()).is_err());
+		assert_eq!(
+			GaussianSplat::read_from_bytes(&gz, &opts)
+				.unwrap()
+				.positions,
+			gs.positions
+		);
+		assert_eq!(
+			GaussianSplat::read_from(gz.as_slice(), &opts)
+				.unwrap()
+				.colors
+				.len(),
+			6
+		);
+		assert_eq!(
+			Decoder::new().decode(&gz, &opts).unwrap().positions,
+			gs.positions
+		);
+	}
+
+	#[test]
+	fn test_load_limits() {
+		let num_points = 100;
+		let gs = GaussianSplat {
+			header: Header {
+				num_points: num_points as i32,
+				spherical_harmonics_degree: 1,
+				..Default::default()
+			},
+			positions: vec![0.5; num_points * 3],
+			scales: vec![0.0; num_points * 3],
+			rotations: (0..num_points).flat_map(|_| [0.0, 0.0, 0.0, 1.0]).collect(),
+			alphas: vec![0.0; num_points],
+			colors: vec![0.0; num_points * 3],
+			spherical_harmonics: vec![0.0; num_points * 9],
+		};
+		let plain = gs
+			.serialize_to_packed_bytes(&SaveOptions::default())
+			.unwrap();
+		let parallel = gs
+			.serialize_to_packed_bytes(
+				&SaveOptions::builder()
+					.threads(2)
+					.parallel_compression(true)
+					.build(),
+			)
+			.unwrap();
+		let len = packed::prefix_len(
+			&Header::from_compressed_bytes(&plain).unwrap(),
+			packed::SECTIONS.len(),
+		);
+		let cases = [
+			(
+				LoadOptions::builder()
+					.max_points(num_points)
+					.max_decompressed_len(len),
+				true,
+			),
+			(LoadOptions::builder().max_points(num_points - 1), false),
+			(LoadOptions::builder().max_decompressed_len(len - 1), false),
+			(
+				LoadOptions::builder()
+					.attributes(AttributeMask::POSITIONS)
+					.max_decompressed_len(HEADER_SIZE + num_points * 9),
+				true,
+			),
+		];
+		for (opts, ok) in cases {
+			let opts = opts.build();
+
+			for bytes in [&plain, &parallel] {
+				assert_eq!(
+					GaussianSplat::read_from_bytes(bytes, &opts).is_ok(),
+					ok
+				);
+				assert_eq!(
+					GaussianSplat::read_from(bytes.as_slice(), &opts).is_ok(),
+					ok
+				);
+				assert_eq!(Decoder::new().decode(bytes, &opts).is_ok(), ok);
+			}
+			assert_eq!(
+				GaussianSplat::new_from_packed_gaussians(
+					&PackedGaussianSplat::from_bytes(&plain).unwrap(),
+					&opts
+				)
+				.is_ok(),
+				ok
+			);
+		}
+	}
+
+	#[test]
+	fn test_oversized_header_fails_before_allocating() {
+		let header = Header {
+			num_points: i32::MAX,
+			spherical_harmonics_degree: 3,
+			..Default::default()
+		};
+		let mut packed = Vec::new();
+
+		header.serialize_to(&mut packed).unwrap();
+		packed.extend_from_slice(&[0; 1000]);
+
+		let mut gz = Vec::new();
+		compression::gzip::compress_bytes(&packed, &mut gz).unwrap();
+
+		// the limits are off, what gets allocated follows the data
+		let opts = LoadOptions::default();
+
+		assert!(GaussianSplat::read_from_bytes(&gz, &opts).is_err());
+		assert!(GaussianSplat::read_from(gz.as_slice(), &opts).is_err());
+		assert!(Decoder::new().decode(&gz, &opts).is_err());
+		assert!(GaussianSplat::new_from_packed_gaussians(
+			&PackedGaussianSplat {
+				num_points: i32::MAX,
+				sh_degree: 3,
+				..Default::default()
+			},
+			&opts
+		)
+		.is_err());
+	}
+
+	#[rstest]
+	#[case(0, 0, AttributeLens::default())]
+	#[case(2, 0, AttributeLens { positions: 6, scales: 6, rotations: 8, alphas: 2, colors: 6, spherical_harmonics: 0 })]
+	#[case(2, 3, AttributeLens { positions: 6, scales: 6, rotations: 8, alphas: 2, colors: 6, spherical_harmonics: 90 })]
+	fn test_attribute_lens(
+		#[case] num_points: usize,
+		#[case] sh_degree: u8,
+		#[case] expected: AttributeLens,
+	) {
+		assert_eq!(AttributeLens::new(num_points, sh_degree), expected);
+	}
 }
@@ -11,8 +11,9 @@ use serde::{Deserialize, Serialize};
 use strum::EnumIter;
 use zerocopy::{FromBytes, Immutable, IntoBytes, KnownLayout, TryFromBytes};
 
-use crate::compression;
-use crate::mmap::mmap_range;
+use crate::compression::{self, gzip::Inflater};
+use crate::container::{self, Container};
+use crate::mmap::{read_or_map, read_or_map_range};
 
 /// Header Magic Value. "NGSP" in little-endian (LE).
 /// Every SPZ file's 1st 4 bytes are this magic number.
@@ -109,7 +110,7 @@ impl Display for Version {
 }
 
 /// Enough bytes to decompress the first 16 bytes of the spz file, the header.
-const COMPRESSED_BLOCK_READ_SIZE: u16 = 512;
+pub const COMPRESSED_BLOCK_READ_SIZE: u16 = 512;
 
 // Asserts that the size of the `Header` struct is 16 bytes (by specification)
 // at compile time.
@@ -165,6 +166,11 @@ pub struct Header {
 impl Header {
 	/// Decompresses and reads a header from the given compressed bytes.
 	///
+	/// `compressed` is resolved through [`Container::parse`]: a chunked file
+	/// gives the total points, SH degree and flags of its index, a
+	/// progressive file the header of its finest level. Both need the whole
+	/// file.
+	///
 	/// Does NOT validate whether the read header is a valid SPZ header,
 	/// simply reads the bytes and interprets them as a header.
 	#[inline]
@@ -172,9 +178,21 @@ impl Header {
 	where
 		C: AsRef<[u8]>,
 	{
+		let compressed = compressed.as_ref();
+
+		if container::is_container(compressed) {
+			return Container::parse(compressed)?.header();
+		}
+		Self::from_stream_unchecked(compressed)
+	}
+
+	/// Reads the header of a single compressed stream, whatever its leading
+	/// bytes, for the chunks and levels of a container.
+	pub(crate) fn from_stream_unchecked(compressed: &[u8]) -> Result<Self> {
 		let mut decompressed = [0_u8; COMPRESSED_BLOCK_READ_SIZE as usize];
 
-		compression::gzip::decompress(compressed, &mut decompressed)
+		compression::decoder(compressed)
+			.and_then(|mut decoder| Ok(decoder.read(&mut decompressed)?))
 			.with_context(|| "unable to decompress header bytes")?;
 
 		decompressed[..HEADER_SIZE]
@@ -182,24 +200,78 @@ impl Header {
 			.with_context(|| "unable to read header")
 	}
 
-	/// Decompresses and reads a header from the given compressed bytes.
+	/// Like [`Header::from_compressed_bytes_unchecked`], inflating only the
+	/// header with a reused `inflater`, without allocating for gzip data.
+	///
+	/// # Args
+	///
+	/// `compressed` - the start of gzip or zstd compressed, packed gaussian
+	/// data, e.g. its first block, or a whole chunked or progressive file.
+	/// `inflater` - inflate state, reset before use.
+	pub fn from_compressed_bytes_unchecked_with(
+		compressed: &[u8],
+		inflater: &mut Inflater,
+	) -> Result<Self> {
+		match Container::parse(compressed)? {
+			Container::Stream(stream) => {
+				Self::from_stream_unchecked_with(stream, inflater)
+			},
+			chunked => chunked.header(),
+		}
+	}
+
+	/// Like [`Header::from_stream_unchecked`], with a reused `inflater`.
+	pub(crate) fn from_stream_unchecked_with(
+		compressed: &[u8],
+		inflater: &mut Inflater,
+	) -> Result<Self> {
+		if compression::Codec::detect(compressed) == compression::Codec::Zstd {
+			return Self::from_stream_unchecked(compressed);
+		}
+		let mut decompressed = [0_u8; HEADER_SIZE];
+
+		let len = inflater
+			.inflate_prefix(compressed, &mut decompressed)
+			.with_context(|| "unable to decompress header bytes")?;
+
+		if unlikely(len < HEADER_SIZE) {
+			bail!("header is truncated: {len} of {HEADER_SIZE} bytes");
+		}
+		decompressed
+			.as_slice()
+			.try_into()
+			.with_context(|| "unable to read header")
+	}
+
+	/// Decompresses and reads a header from the given compressed bytes, see
+	/// [`Header::from_compressed_bytes_unchecked`].
 	#[inline]
 	pub fn from_compressed_bytes<C>(compressed: C) -> Result<Self>
 	where
 		C: AsRef<[u8]>,
 	{
-		let header = Self::from_compressed_bytes_unchecked(compressed)?;
+		Self::from_compressed_bytes_unchecked(compressed)?.validated()
+	}
 
-		if unlikely(!header.is_valid()) {
+	/// Reads and validates the header of a single compressed stream.
+	pub(crate) fn from_stream(compressed: &[u8]) -> Result<Self> {
+		Self::from_stream_unchecked(compressed)?.validated()
+	}
+
+	#[inline]
+	fn validated(self) -> Result<Self> {
+		if unlikely(!self.is_valid()) {
 			bail!("header fails validation");
 		}
-		Ok(header)
+		Ok(self)
 	}
 
 	/// Reads a header directly from a file path using memory mapping.
 	///
 	/// Efficient for quickly inspecting SPZ file metadata without
-	/// reading the entire file.
+	/// reading the entire file. Only chunked and progressive files are
+	/// mapped whole, their index sits in front of the streams, see
+	/// [`Header::from_compressed_bytes_unchecked`].
 	///
 	/// Does NOT validate whether the read header is a valid SPZ header,
 	/// simply reads the bytes and interprets them as a header.
@@ -208,33 +280,31 @@ impl Header {
 	where
 		P: AsRef<Path>,
 	{
-		if cfg!(target_os = "macos") {
-			// mmap on macos isn't great according to ripgrep code
-			let mut input = std::fs::File::open(&spz_path)?;
-			let mut buf = [0_u8; COMPRESSED_BLOCK_READ_SIZE as usize];
-
-			input.read_exact(&mut buf)?;
-
-			Self::from_compressed_bytes_unchecked(buf)
-				.with_context(|| "unable to decompress and parse SPZ header")
-		} else {
-			let mmap = mmap_range(&spz_path, 0, COMPRESSED_BLOCK_READ_SIZE as usize)
-				.with_context(|| "unable to memory-map file header range")?;
-
-			if unlikely(mmap.as_ref().len() != COMPRESSED_BLOCK_READ_SIZE as usize) {
-				bail!(
-					"unable to mmap expected length, expected {} bytes, got {}",
-					COMPRESSED_BLOCK_READ_SIZE,
-					mmap.as_ref().len()
-				);
-			}
-			Self::from_compressed_bytes_unchecked(mmap.as_ref())
+		let block = read_or_map_range(&spz_path, 0, COMPRESSED_BLOCK_READ_SIZE as usize)
+			.with_context(|| "unable to read file header range")?;
+
+		if container::is_container(&block) {
+			let bytes =
+				read_or_map(&spz_path).with_context(|| "unable to read file")?;
+
+			return Self::from_compressed_bytes_unchecked(&*bytes)
+				.with_context(|| "unable to parse SPZ container header");
 		}
+		if unlikely(block.len() != COMPRESSED_BLOCK_READ_SIZE as usize) {
+			bail!(
+				"unable to read expected length, expected {} bytes, got {}",
+				COMPRESSED_BLOCK_READ_SIZE,
+				block.len()
+			);
+		}
+		Self::from_stream_unchecked(&block)
+			.with_context(|| "unable to decompress and parse SPZ header")
 	}
 
 	/// Reads a header directly from a file path using memory mapping.
 	///
-	/// Memory-maps the file and reads the 1st 16 bytes as a header.
+	/// Memory-maps the file and reads the 1st 16 bytes as a header, see
+	/// [`Header::from_file_unchecked`].
 	/// Efficient for quickly inspecting SPZ file metadata without
 	/// reading the entire file.
 	#[inline]
@@ -242,12 +312,7 @@ impl Header {
 	where
 		P: AsRef<Path>,
 	{
-		let ret = Self::from_file_unchecked(spz_path)?;
-
-		if unlikely(!ret.is_valid()) {
-			bail!("header fails validation");
-		}
-		Ok(ret)
+		Self::from_file_unchecked(spz_path)?.validated()
 	}
 
 	/// Reads a header from the given reader without validation.
@@ -685,4 +750,51 @@ mod tests {
 
 		assert!(result.is_err());
 	}
+
+	#[test]
+	fn test_from_compressed_bytes_unchecked_with_reuses_inflater() {
+		use crate::gaussian_splat::{GaussianSplat, SaveOptions};
+
+		let num_points = 2000;
+		let gs = GaussianSplat {
+			header: Header {
+				num_points,
+				spherical_harmonics_degree: 1,
+				..Default::default()
+			},
+			positions: (0..num_points as u64 * 3)
+				.map(|i| {
+					(i.wrapping_mul(0x9e37_79b9_7f4a_7c15) >> 48) as f32 / 100.0
+				})
+				.collect(),
+			scales: vec![-3.0; num_points as usize * 3],
+			rotations: vec![0.5; num_points as usize * 4],
+			alphas: vec![0.0; num_points as usize],
+			colors: vec![0.25; num_points as usize * 3],
+			spherical_harmonics: vec![0.0; num_points as usize * 9],
+		};
+		let bytes = gs
+			.serialize_to_packed_bytes(&SaveOptions::default())
+			.unwrap();
+		let block = &bytes[..COMPRESSED_BLOCK_READ_SIZE as usize];
+		let expected = Header::from_compressed_bytes(block).unwrap();
+		let mut inflater = Inflater::new();
+
+		for _ in 0..2 {
+			let header =
+				Header::from_compressed_bytes_unchecked_with(block, &mut inflater)
+					.unwrap();
+
+			assert_eq!(header, expected);
+			assert_eq!(header.num_points, num_points);
+		}
+		assert!(
+			Header::from_compressed_bytes_unchecked_with(&bytes[..12], &mut inflater)
+				.is_err()
+		);
+		assert!(
+			Header::from_compressed_bytes_unchecked_with(&[0; 64], &mut inflater)
+				.is_err()
+		);
+	}
 }
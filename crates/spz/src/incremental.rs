@@ -0,0 +1,967 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+//! Writing SPZ files a batch of points at a time, and editing the attributes
+//! of written files in place.
+//!
+//! [`SpzWriter`] quantizes each batch as it arrives and compresses every
+//! block of points of each attribute section into a gzip member of its own,
+//! an indexed multi-member stream (see [`gzip`]) any gzip reader handles:
+//!
+//! | Members     | Content                                                 |
+//! |-------------|---------------------------------------------------------|
+//! | 1           | the header, stored, rewritten by [`SpzWriter::finish`] |
+//! | 1 per block | positions, written to the output as the blocks fill    |
+//! | 1 per block | each of the other sections, spooled until `finish`     |
+//!
+//! SPZ stores each section for all points before the next one, so only the
+//! positions can be written before the last batch; the other sections wait,
+//! compressed, in a temporary file, and memory stays at the pending blocks
+//! whatever the number of points.
+//!
+//! [`SpzEditor`] re-encodes only the members an edit touches. The writer
+//! pads every member with some slack (see [`SpzWriter::slack_percent`]),
+//! a member that still fits is padded to its old size in place, one that
+//! grows past it moves the rest of the file, copying its bytes as they are.
+//! Any indexed multi-member stream can be edited, including the ones
+//! [`SaveOptions::parallel_compression`] writes, though their members are
+//! larger and have no slack.
+//!
+//! Edits are not crash-safe: members are overwritten in place, and an edit
+//! interrupted by a crash or an I/O error can leave the file corrupt. Edit a
+//! copy when the original must survive.
+
+use std::fs::{File, OpenOptions};
+use std::io::{BufWriter, Read, Seek, SeekFrom, Write};
+use std::ops::Range;
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicUsize, Ordering};
+
+use anyhow::{Context, Result, bail};
+use likely_stable::unlikely;
+
+use crate::{
+	compression::{Codec, CompressionLevel, gzip},
+	gaussian_splat::{AttributeMask, GaussianSplat, SaveOptions},
+	header::{Flags, HEADER_SIZE, Header},
+	instrument::{self, Stage},
+	kernels,
+	math::dim_for_degree,
+	packed::{PackedGaussianSplatView, PackedGaussians, PointOrder, SECTIONS, section_strides},
+	parallel,
+};
+
+/// Default number of points per gzip member of each section.
+pub const DEFAULT_BLOCK_POINTS: usize = 64 * 1024;
+
+/// Default padding of each written or grown member, in percent of its
+/// compressed size.
+pub const DEFAULT_SLACK_PERCENT: usize = 4;
+
+/// Writes an SPZ file from batches of points, see the [module](self) docs.
+///
+/// Points are written in the order they are appended.
+pub struct SpzWriter<W>
+where
+	W: Write + Seek,
+{
+	out: W,
+	/// Where the header member starts in `out`.
+	start: u64,
+	header: Header,
+	opts: SaveOptions,
+	block_points: usize,
+	slack_percent: usize,
+	/// Quantized points not compressed yet, per section in file order.
+	pending: [Vec<u8>; 6],
+	pending_points: usize,
+	/// Compressed members of the sections after the positions.
+	spool: Spool,
+}
+
+impl SpzWriter<BufWriter<File>> {
+	/// Creates the file at `filepath`, see [`SpzWriter::new`].
+	pub fn create<F>(
+		filepath: F,
+		sh_degree: u8,
+		antialiased: bool,
+		opts: &SaveOptions,
+	) -> Result<Self>
+	where
+		F: AsRef<Path>,
+	{
+		let file = File::create(filepath.as_ref()).with_context(|| {
+			format!("unable to create file: {}", filepath.as_ref().display())
+		})?;
+
+		Self::new(BufWriter::new(file), sh_degree, antialiased, opts)
+	}
+}
+
+impl<W> SpzWriter<W>
+where
+	W: Write + Seek,
+{
+	/// Starts an SPZ stream at the current position of `out`.
+	///
+	/// # Args
+	///
+	/// `out` - where to write the stream.
+	/// `sh_degree` - spherical harmonics degree of every batch.
+	/// `antialiased` - whether the splat was trained with antialiasing.
+	/// `opts` - the coordinate system of the batches, the compression level,
+	/// and the threads to quantize and compress on. The codec must be gzip,
+	/// points are never reordered.
+	pub fn new(
+		mut out: W,
+		sh_degree: u8,
+		antialiased: bool,
+		opts: &SaveOptions,
+	) -> Result<Self> {
+		if unlikely(sh_degree > 3) {
+			bail!("invalid spherical harmonics degree: {sh_degree}");
+		}
+		if unlikely(opts.codec != Codec::Gzip) {
+			bail!("incremental writing supports gzip only");
+		}
+		let start = out.stream_position()?;
+		let mut writer = Self {
+			out,
+			start,
+			header: Header {
+				spherical_harmonics_degree: sh_degree,
+				flags: if antialiased {
+					Flags::ANTIALIASED
+				} else {
+					Flags::none()
+				},
+				..Default::default()
+			},
+			opts: SaveOptions {
+				order: PointOrder::Original,
+				..opts.clone()
+			},
+			block_points: DEFAULT_BLOCK_POINTS,
+			slack_percent: DEFAULT_SLACK_PERCENT,
+			pending: Default::default(),
+			pending_points: 0,
+			spool: Spool::new()?,
+		};
+		writer.write_header()?;
+
+		Ok(writer)
+	}
+
+	/// Sets the number of points per gzip member of each section, the unit an
+	/// [`SpzEditor`] re-encodes. Defaults to [`DEFAULT_BLOCK_POINTS`].
+	#[inline]
+	pub fn block_points(mut self, block_points: usize) -> Self {
+		self.block_points = block_points.max(1);
+		self
+	}
+
+	/// Sets the padding of every member, in percent of its compressed size,
+	/// that lets [`SpzEditor`] re-encode it in place when it grows that
+	/// much. Defaults to [`DEFAULT_SLACK_PERCENT`], `0` writes no padding.
+	#[inline]
+	pub fn slack_percent(mut self, slack_percent: usize) -> Self {
+		self.slack_percent = slack_percent;
+		self
+	}
+
+	/// The header as it stands, with the points appended so far.
+	#[inline]
+	pub fn header(&self) -> &Header {
+		&self.header
+	}
+
+	/// Quantizes and appends the points of `batch`.
+	///
+	/// # Args
+	///
+	/// `batch` - points in the coordinate system of the save options, with
+	/// the spherical harmonics degree of the writer.
+	pub fn append(&mut self, batch: &GaussianSplat) -> Result<()> {
+		if unlikely(
+			batch.header.spherical_harmonics_degree
+				!= self.header.spherical_harmonics_degree,
+		) {
+			bail!(
+				"spherical harmonics degree mismatch: {} != {}",
+				batch.header.spherical_harmonics_degree,
+				self.header.spherical_harmonics_degree
+			);
+		}
+		let packed = batch.to_packed_gaussians(&self.opts)?;
+
+		self.append_packed(&packed.view())
+	}
+
+	/// Appends already quantized points, in the SPZ coordinate system
+	/// (RightUpBack).
+	pub fn append_packed(&mut self, packed: &PackedGaussianSplatView) -> Result<()> {
+		let header = packed.to_header();
+
+		if unlikely(
+			header.spherical_harmonics_degree != self.header.spherical_harmonics_degree
+				|| header.fractional_bits != self.header.fractional_bits
+				|| header.flags != self.header.flags
+				|| !packed.uses_quaternion_smallest_three,
+		) {
+			bail!("packed points don't match the header of the writer");
+		}
+		let num_points = packed.num_points.max(0) as usize;
+
+		if unlikely(!packed.check_sizes(
+			num_points,
+			dim_for_degree(header.spherical_harmonics_degree),
+		)) {
+			bail!("inconsistent sizes");
+		}
+		let total = self.header.num_points as usize + num_points;
+
+		if unlikely(total > i32::MAX as usize) {
+			bail!("too many points: {total}");
+		}
+		let sections = [
+			packed.positions,
+			packed.alphas,
+			packed.colors,
+			packed.scales,
+			packed.rotations,
+			packed.spherical_harmonics,
+		];
+		for (pending, section) in self.pending.iter_mut().zip(sections) {
+			pending.extend_from_slice(section);
+		}
+		self.pending_points += num_points;
+		self.header.num_points = total as i32;
+
+		if self.pending_points >= self.block_points {
+			self.flush(false)?;
+		}
+		Ok(())
+	}
+
+	/// Compresses the points still pending, writes the other sections after
+	/// the positions and rewrites the header with the number of points.
+	///
+	/// # Returns
+	///
+	/// The output, positioned at the end of the stream.
+	pub fn finish(mut self) -> Result<W> {
+		self.flush(true)?;
+		self.spool.copy_to(&mut self.out)?;
+
+		let end = self.out.stream_position()?;
+
+		self.out.seek(SeekFrom::Start(self.start))?;
+		self.write_header()?;
+		self.out.seek(SeekFrom::Start(end))?;
+		self.out.flush()?;
+
+		Ok(self.out)
+	}
+
+	/// Writes the header as one stored member, always of the same size.
+	fn write_header(&mut self) -> Result<()> {
+		let mut member = Vec::new();
+
+		gzip::store_member(&<[u8; HEADER_SIZE]>::from(self.header), &mut member)?;
+
+		self.out.write_all(&member)
+			.with_context(|| "unable to write header")
+	}
+
+	/// Compresses the full blocks of pending points, and the rest too if
+	/// `all`.
+	fn flush(&mut self, all: bool) -> Result<()> {
+		let strides = section_strides(&self.header);
+		let mut block_starts: Vec<usize> = (0..self.pending_points)
+			.step_by(self.block_points)
+			.filter(|&start| all || start + self.block_points <= self.pending_points)
+			.collect();
+
+		if block_starts.is_empty() {
+			return Ok(());
+		}
+		let flushed = self
+			.pending_points
+			.min(block_starts.len() * self.block_points);
+
+		block_starts.push(flushed);
+
+		// one member per non-empty section of every block
+		let mut members: Vec<[Vec<u8>; 6]> =
+			vec![Default::default(); block_starts.len() - 1];
+		let mut jobs = Vec::new();
+
+		for (points, block) in block_starts.windows(2).zip(&mut members) {
+			for ((pending, stride), member) in
+				self.pending.iter().zip(strides).zip(block)
+			{
+				let bytes = &pending[points[0] * stride..points[1] * stride];
+
+				if !bytes.is_empty() {
+					jobs.push((bytes, member));
+				}
+			}
+		}
+		let mut stage =
+			instrument::enter(Stage::Deflate, flushed * strides.iter().sum::<usize>());
+		let threads = parallel::available_threads(self.opts.threads).min(jobs.len());
+		let level = self.opts.level;
+		let slack_percent = self.slack_percent;
+
+		stage.threads(threads);
+
+		parallel::try_run(parallel::deal(jobs, threads), |jobs| {
+			for (bytes, member) in jobs {
+				gzip::compress_member(bytes, level, member)?;
+				pad_slack(member, slack_percent);
+			}
+			Ok(())
+		})?;
+		stage.bytes_out(members.iter().flatten().map(Vec::len).sum());
+		drop(stage);
+
+		for (pending, stride) in self.pending.iter_mut().zip(strides) {
+			pending.drain(..flushed * stride);
+		}
+		self.pending_points -= flushed;
+
+		for [positions, rest @ ..] in members {
+			self.out.write_all(&positions)
+				.with_context(|| "unable to write positions")?;
+
+			for (section, member) in rest.iter().enumerate() {
+				self.spool.push(section, member)?;
+			}
+		}
+		Ok(())
+	}
+}
+
+/// Compressed members waiting in a temporary file for the sections before
+/// them, removed when dropped.
+struct Spool {
+	file: File,
+	path: PathBuf,
+	len: u64,
+	/// Byte ranges in `file` of the members of each section, in order.
+	members: [Vec<Range<u64>>; 5],
+}
+
+impl Spool {
+	fn new() -> Result<Self> {
+		static SPOOLS: AtomicUsize = AtomicUsize::new(0);
+
+		let path = std::env::temp_dir().join(format!(
+			"spz-spool.{}.{}.tmp",
+			std::process::id(),
+			SPOOLS.fetch_add(1, Ordering::Relaxed)
+		));
+		let file = OpenOptions::new()
+			.read(true)
+			.write(true)
+			.create_new(true)
+			.open(&path)
+			.with_context(|| {
+				format!("unable to create spool file: {}", path.display())
+			})?;
+
+		Ok(Self {
+			file,
+			path,
+			len: 0,
+			members: Default::default(),
+		})
+	}
+
+	/// Appends a member of `section`, counted from the one after the
+	/// positions.
+	fn push(&mut self, section: usize, member: &[u8]) -> Result<()> {
+		if member.is_empty() {
+			return Ok(());
+		}
+		self.file
+			.write_all(member)
+			.with_context(|| "unable to write to spool file")?;
+
+		let end = self.len + member.len() as u64;
+
+		self.members[section].push(self.len..end);
+		self.len = end;
+
+		Ok(())
+	}
+
+	/// Copies every member out, section after section.
+	fn copy_to<W>(&mut self, out: &mut W) -> Result<()>
+	where
+		W: Write,
+	{
+		for range in self.members.iter().flatten() {
+			self.file.seek(SeekFrom::Start(range.start))?;
+
+			let copied = std::io::copy(
+				&mut (&mut self.file).take(range.end - range.start),
+				out,
+			)?;
+
+			if unlikely(copied != range.end - range.start) {
+				bail!("spool file is truncated");
+			}
+		}
+		Ok(())
+	}
+}
+
+impl Drop for Spool {
+	fn drop(&mut self) {
+		let _ = std::fs::remove_file(&self.path);
+	}
+}
+
+/// Pads a member written by [`gzip::compress_member`] by `slack_percent` of
+/// its size, if the padding fits its extra field.
+#[inline]
+fn pad_slack(member: &mut Vec<u8>, slack_percent: usize) {
+	let slack = member.len() * slack_percent / 100;
+
+	// padding needs room for a subfield header
+	if slack >= 4 {
+		gzip::pad_member(member, member.len() + slack);
+	}
+}
+
+/// Where a gzip member is in the file and what it inflates to.
+#[derive(Clone, Copy, Debug)]
+struct Member {
+	offset: u64,
+	size: usize,
+	/// Offset of its inflated data in the decompressed stream.
+	start: usize,
+	isize: usize,
+}
+
+/// Edits the packed attributes of an SPZ file in place, see the
+/// [module](self) docs.
+///
+/// Edits are not crash-safe, an interrupted one can leave the file corrupt.
+pub struct SpzEditor {
+	file: File,
+	header: Header,
+	members: Vec<Member>,
+	level: CompressionLevel,
+	threads: usize,
+	slack_percent: usize,
+}
+
+impl SpzEditor {
+	/// Opens an indexed multi-member SPZ file for editing, reading only the
+	/// headers and trailers of its members and inflating the header.
+	pub fn open<F>(filepath: F) -> Result<Self>
+	where
+		F: AsRef<Path>,
+	{
+		let mut file = OpenOptions::new()
+			.read(true)
+			.write(true)
+			.open(filepath.as_ref())
+			.with_context(|| {
+				format!("unable to open file: {}", filepath.as_ref().display())
+			})?;
+		let len = file.metadata()?.len();
+		let mut members = Vec::new();
+		let mut head = Vec::new();
+		let (mut offset, mut start) = (0_u64, 0_usize);
+
+		while offset < len {
+			head.resize(12, 0);
+			read_at(&mut file, offset, &mut head)?;
+
+			let xlen = u16::from_le_bytes([head[10], head[11]]) as usize;
+
+			head.resize(12 + xlen, 0);
+			read_at(&mut file, offset + 12, &mut head[12..])?;
+
+			let Some((size, data_start)) = gzip::member_size(&head) else {
+				bail!(
+					"not an indexed multi-member gzip stream, members need their sizes"
+				);
+			};
+			if unlikely(
+				size < data_start + gzip::MEMBER_TRAILER_SIZE
+					|| offset + size as u64 > len,
+			) {
+				bail!("gzip member at {offset} is truncated");
+			}
+			let mut isize = [0_u8; 4];
+
+			read_at(&mut file, offset + size as u64 - 4, &mut isize)?;
+
+			let isize = u32::from_le_bytes(isize) as usize;
+
+			members.push(Member {
+				offset,
+				size,
+				start,
+				isize,
+			});
+			offset += size as u64;
+			start += isize;
+		}
+		let mut editor = Self {
+			file,
+			header: Header::default(),
+			members,
+			level: CompressionLevel::Default,
+			threads: 0,
+			slack_percent: DEFAULT_SLACK_PERCENT,
+		};
+		let covering = editor.covering(0..HEADER_SIZE);
+		let header = Header::try_from(&editor.inflate(covering)?[..HEADER_SIZE])?;
+
+		if unlikely(!header.is_valid()) {
+			bail!("invalid header");
+		}
+		let expected = HEADER_SIZE
+			+ header.num_points as usize
+				* section_strides(&header).iter().sum::<usize>();
+
+		if unlikely(start != expected) {
+			bail!("decompressed size mismatch: expected {expected} bytes, got {start}");
+		}
+		editor.header = header;
+
+		Ok(editor)
+	}
+
+	/// Sets the compression level of re-encoded members. Defaults to
+	/// [`CompressionLevel::Default`].
+	#[inline]
+	pub fn set_level(&mut self, level: CompressionLevel) {
+		self.level = level;
+	}
+
+	/// Sets the number of threads to inflate and re-encode members on, `0`
+	/// uses all available cores, the default.
+	#[inline]
+	pub fn set_threads(&mut self, threads: usize) {
+		self.threads = threads;
+	}
+
+	/// Sets the padding given to a member that outgrows its size, in
+	/// percent of its new compressed size, see [`SpzWriter::slack_percent`].
+	/// Defaults to [`DEFAULT_SLACK_PERCENT`].
+	#[inline]
+	pub fn set_slack_percent(&mut self, slack_percent: usize) {
+		self.slack_percent = slack_percent;
+	}
+
+	#[inline]
+	pub fn header(&self) -> &Header {
+		&self.header
+	}
+
+	/// Number of gzip members in the file.
+	#[inline]
+	pub fn num_members(&self) -> usize {
+		self.members.len()
+	}
+
+	/// Edits the packed bytes of one attribute section for a range of points,
+	/// re-encoding the members holding them.
+	///
+	/// # Args
+	///
+	/// `attribute` - a single attribute.
+	/// `points` - the points to edit.
+	/// `f` - edits the packed bytes of the points, see
+	/// [`PackedGaussianSplat`](crate::packed::PackedGaussianSplat) for their
+	/// layout. Positions, rotations and spherical harmonics are in the SPZ
+	/// coordinate system (RightUpBack).
+	pub fn edit<F>(
+		&mut self,
+		attribute: AttributeMask,
+		points: Range<usize>,
+		f: F,
+	) -> Result<()>
+	where
+		F: FnOnce(&mut [u8]),
+	{
+		let range = self.section_range(attribute, points)?;
+
+		if range.is_empty() {
+			return Ok(());
+		}
+		let covering = self.covering(range.clone());
+		let base = self.members[covering.start].start;
+		let mut data = self.inflate(covering.clone())?;
+
+		f(&mut data[range.start - base..range.end - base]);
+
+		self.rewrite(covering, &data)
+	}
+
+	/// Quantizes `alphas`, in the same form as
+	/// [`GaussianSplat::alphas`], over the points from `start` on.
+	pub fn set_alphas(&mut self, start: usize, alphas: &[f32]) -> Result<()> {
+		self.edit(
+			AttributeMask::ALPHAS,
+			start..start + alphas.len(),
+			|bytes| kernels::encode_alphas(alphas, bytes),
+		)
+	}
+
+	/// Quantizes `colors`, in the same form as
+	/// [`GaussianSplat::colors`], over the points from `start` on.
+	pub fn set_colors(&mut self, start: usize, colors: &[f32]) -> Result<()> {
+		if unlikely(!colors.len().is_multiple_of(3)) {
+			bail!("colors are 3 values per point, got {}", colors.len());
+		}
+		self.edit(
+			AttributeMask::COLORS,
+			start..start + colors.len() / 3,
+			|bytes| kernels::encode_colors(colors, bytes),
+		)
+	}
+
+	/// Byte range of `points` of the section of `attribute` in the
+	/// decompressed stream.
+	fn section_range(
+		&self,
+		attribute: AttributeMask,
+		points: Range<usize>,
+	) -> Result<Range<usize>> {
+		let num_points = self.header.num_points as usize;
+
+		if unlikely(points.start > points.end || points.end > num_points) {
+			bail!("points {points:?} out of range of {num_points} points");
+		}
+		let Some(index) = SECTIONS.iter().position(|&section| section == attribute) else {
+			bail!("edit one attribute at a time, got {attribute:?}");
+		};
+		let strides = section_strides(&self.header);
+		let offset = HEADER_SIZE + num_points * strides[..index].iter().sum::<usize>();
+		let stride = strides[index];
+
+		Ok(offset + points.start * stride..offset + points.end * stride)
+	}
+
+	/// Indices of the members holding the bytes of `range` of the
+	/// decompressed stream.
+	fn covering(&self, range: Range<usize>) -> Range<usize> {
+		let first = self
+			.members
+			.partition_point(|member| member.start + member.isize <= range.start);
+		let last = self
+			.members
+			.partition_point(|member| member.start < range.end);
+
+		first..last.max(first)
+	}
+
+	/// Reads and inflates the members of `covering`.
+	fn inflate(&mut self, covering: Range<usize>) -> Result<Vec<u8>> {
+		let members = &self.members[covering];
+		let (Some(first), Some(last)) = (members.first(), members.last()) else {
+			bail!("no gzip member to inflate");
+		};
+		let mut compressed = vec![0; (last.offset - first.offset) as usize + last.size];
+
+		read_at(&mut self.file, first.offset, &mut compressed)?;
+
+		let mut data = Vec::new();
+
+		gzip::decompress_parallel(&compressed, &mut data, self.threads)?;
+
+		if unlikely(data.len() != members.iter().map(|member| member.isize).sum::<usize>())
+		{
+			bail!("gzip members inflated to an unexpected size");
+		}
+		Ok(data)
+	}
+
+	/// Compresses `data` back into the members of `covering`, each member
+	/// keeping its span of the decompressed stream.
+	fn rewrite(&mut self, covering: Range<usize>, data: &[u8]) -> Result<()> {
+		let old: Vec<Member> = self.members[covering.clone()].to_vec();
+		let mut members = vec![Vec::new(); old.len()];
+		let mut jobs = Vec::with_capacity(old.len());
+		let mut rest = data;
+
+		for (member, out) in old.iter().zip(&mut members) {
+			let (block, tail) = rest.split_at(member.isize);
+
+			jobs.push((block, out, member.size));
+			rest = tail;
+		}
+		let threads = parallel::available_threads(self.threads).min(jobs.len());
+		let level = self.level;
+		let slack_percent = self.slack_percent;
+
+		parallel::try_run(parallel::deal(jobs, threads), |jobs| {
+			for (block, out, size) in jobs {
+				gzip::compress_member(block, level, out)?;
+
+				// a fitting member keeps its size, a grown one gets slack
+				// for the next edits
+				if out.len() < size {
+					gzip::pad_member(out, size);
+				} else if out.len() > size {
+					pad_slack(out, slack_percent);
+				}
+			}
+			Ok(())
+		})?;
+
+		let start = old[0].offset;
+		let old_end = old[old.len() - 1].offset + old[old.len() - 1].size as u64;
+		let new_end = start + members.iter().map(Vec::len).sum::<usize>() as u64;
+
+		if new_end != old_end {
+			move_tail(&mut self.file, old_end, new_end)?;
+
+			for member in &mut self.members[covering.end..] {
+				member.offset = member.offset - old_end + new_end;
+			}
+		}
+		self.file.seek(SeekFrom::Start(start))?;
+
+		let mut offset = start;
+
+		for (member, bytes) in self.members[covering].iter_mut().zip(&members) {
+			self.file
+				.write_all(bytes)
+				.with_context(|| "unable to write gzip member")?;
+
+			member.offset = offset;
+			member.size = bytes.len();
+			offset += bytes.len() as u64;
+		}
+		self.file.flush()?;
+
+		Ok(())
+	}
+}
+
+#[inline]
+fn read_at(file: &mut File, offset: u64, buf: &mut [u8]) -> Result<()> {
+	file.seek(SeekFrom::Start(offset))?;
+	file.read_exact(buf)
+		.with_context(|| format!("unable to read {} bytes at {offset}", buf.len()))
+}
+
+/// Moves the bytes of `file` from `from` on to start at `to`, truncating or
+/// growing the file.
+fn move_tail(file: &mut File, from: u64, to: u64) -> Result<()> {
+	const BLOCK_SIZE: u64 = 1024 * 1024;
+
+	let len = file.metadata()?.len();
+	let mut buf = vec![0_u8; BLOCK_SIZE as usize];
+
+	if to < from {
+		let mut pos = from;
+
+		while pos < len {
+			let n = BLOCK_SIZE.min(len - pos) as usize;
+
+			read_at(file, pos, &mut buf[..n])?;
+			file.seek(SeekFrom::Start(pos - from + to))?;
+			file.write_all(&buf[..n])?;
+			pos += n as u64;
+		}
+		file.set_len(len - from + to)?;
+	} else {
+		// back to front, so no byte is overwritten before it moved
+		let mut end = len;
+
+		while end > from {
+			let n = BLOCK_SIZE.min(end - from) as usize;
+			let pos = end - n as u64;
+
+			read_at(file, pos, &mut buf[..n])?;
+			file.seek(SeekFrom::Start(pos - from + to))?;
+			file.write_all(&buf[..n])?;
+			end = pos;
+		}
+	}
+	Ok(())
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+	use crate::{gaussian_splat::LoadOptions, test_util::splat_range};
+	use rstest::rstest;
+
+	fn written(
+		batches: &[(usize, usize)],
+		block_points: usize,
+		slack_percent: usize,
+	) -> Vec<u8> {
+		let mut writer = SpzWriter::new(
+			std::io::Cursor::new(Vec::new()),
+			1,
+			false,
+			&SaveOptions::default(),
+		)
+		.unwrap()
+		.block_points(block_points)
+		.slack_percent(slack_percent);
+
+		for &(first, num_points) in batches {
+			writer.append(&splat_range(first..first + num_points, 1))
+				.unwrap();
+		}
+		let spool = writer.spool.path.clone();
+		let compressed = writer.finish().unwrap().into_inner();
+
+		assert!(!spool.exists());
+
+		compressed
+	}
+
+	#[test]
+	fn test_appended_batches_match_save() {
+		let compressed = written(
+			&[(0, 100), (100, 1), (101, 250), (351, 0)],
+			64,
+			DEFAULT_SLACK_PERCENT,
+		);
+		let whole = splat_range(0..351, 1)
+			.serialize_to_packed_bytes(&SaveOptions::default())
+			.unwrap();
+
+		assert!(gzip::is_indexed_multi_member(&compressed));
+
+		let mut expected = Vec::new();
+		let mut actual = Vec::new();
+
+		gzip::decompress_end(&whole, &mut expected).unwrap();
+		gzip::decompress_parallel(&compressed, &mut actual, 0).unwrap();
+		assert_eq!(actual, expected);
+
+		let loaded = GaussianSplat::read_from_bytes(&compressed, &LoadOptions::default())
+			.unwrap();
+
+		assert_eq!(loaded.header.num_points, 351);
+	}
+
+	#[test]
+	fn test_edit_rewrites_touched_members() {
+		let path =
+			std::env::temp_dir().join(format!("spz-edit-{}.spz", std::process::id()));
+
+		std::fs::write(&path, written(&[(0, 1000)], 128, DEFAULT_SLACK_PERCENT)).unwrap();
+
+		let mut editor = SpzEditor::open(&path).unwrap();
+		let num_members = editor.num_members();
+
+		assert_eq!(editor.header().num_points, 1000);
+		// incompressible, so the members grow
+		let alphas: Vec<f32> = (0..300)
+			.map(|i| ((i * 104729) % 255) as f32 / 20.0 - 6.0)
+			.collect();
+		let colors = vec![0.25; 30];
+
+		editor.set_alphas(200, &alphas).unwrap();
+		editor.set_colors(990, &colors).unwrap();
+		editor.edit(AttributeMask::SCALES, 0..0, |_| unreachable!())
+			.unwrap();
+		assert!(editor.set_colors(995, &colors).is_err());
+		assert!(editor.edit(AttributeMask::all(), 0..1, |_| ()).is_err());
+		assert_eq!(editor.num_members(), num_members);
+		drop(editor);
+
+		let mut expected = splat_range(0..1000, 1);
+
+		expected.alphas[200..500].copy_from_slice(&alphas);
+		expected.colors[2970..].copy_from_slice(&colors);
+
+		let compressed = std::fs::read(&path).unwrap();
+		let expected = GaussianSplat::read_from_bytes(
+			&expected
+				.serialize_to_packed_bytes(&SaveOptions::default())
+				.unwrap(),
+			&LoadOptions::default(),
+		)
+		.unwrap();
+		let loaded = GaussianSplat::read_from_bytes(&compressed, &LoadOptions::default())
+			.unwrap();
+
+		std::fs::remove_file(&path).unwrap();
+		assert!(gzip::is_indexed_multi_member(&compressed));
+		assert_eq!(loaded, expected);
+	}
+
+	#[rstest]
+	#[case(0)]
+	#[case(50)]
+	fn test_edit_within_slack_stays_in_place(#[case] slack_percent: usize) {
+		let path = std::env::temp_dir().join(format!(
+			"spz-edit-slack-{slack_percent}-{}.spz",
+			std::process::id()
+		));
+		let compressed = written(&[(0, 1000)], 128, slack_percent);
+
+		std::fs::write(&path, &compressed).unwrap();
+
+		let mut editor = SpzEditor::open(&path).unwrap();
+		// a few points of a member, far less than half of it
+		let colors: Vec<f32> = (0..30).map(|i| (i % 7) as f32 / 7.0).collect();
+
+		editor.set_colors(300, &colors).unwrap();
+		drop(editor);
+
+		let edited = std::fs::read(&path).unwrap();
+		let mut expected = splat_range(0..1000, 1);
+
+		expected.colors[900..930].copy_from_slice(&colors);
+		std::fs::remove_file(&path).unwrap();
+
+		if slack_percent > 0 {
+			assert!(compressed.len() > written(&[(0, 1000)], 128, 0).len());
+			assert_eq!(edited.len(), compressed.len());
+			// only the edited member changed
+			assert!(edited
+				.iter()
+				.zip(&compressed)
+				.filter(|(a, b)| a != b)
+				.count() < compressed.len() / 8);
+		}
+		assert_eq!(
+			GaussianSplat::read_from_bytes(&edited, &LoadOptions::default()).unwrap(),
+			GaussianSplat::read_from_bytes(
+				&expected
+					.serialize_to_packed_bytes(&SaveOptions::default())
+					.unwrap(),
+				&LoadOptions::default(),
+			)
+			.unwrap()
+		);
+	}
+
+	#[test]
+	fn test_pad_member_keeps_stream_valid() {
+		let block = vec![7_u8; 4096];
+		let mut member = Vec::new();
+
+		gzip::compress_member(&block, CompressionLevel::Default, &mut member).unwrap();
+
+		let size = member.len() + 100;
+
+		assert!(gzip::pad_member(&mut member, size));
+		assert_eq!(member.len(), size);
+		assert!(!gzip::pad_member(&mut member.clone(), size + 2));
+
+		let mut inflated = Vec::new();
+
+		gzip::decompress_parallel(&member, &mut inflated, 1).unwrap();
+		assert_eq!(inflated, block);
+		inflated.clear();
+		gzip::decompress_end(&member, &mut inflated).unwrap();
+		assert_eq!(inflated, block);
+	}
+}
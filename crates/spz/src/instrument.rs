@@ -0,0 +1,293 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+//! Opt-in timing of the stages of loading and saving.
+//!
+//! [`collect`] records, for the calls it wraps on the current thread, the
+//! wall time, bytes read and written, bytes allocated and threads used of
+//! each [`Stage`]. Outside of it a stage costs one thread local lookup.
+//!
+//! With the `tracing` feature each stage is also a `tracing` span at debug
+//! level, named `spz` with a `stage` field, whether collecting or not.
+//!
+//! Stages fused into one pass are timed as one: decoding packed data in
+//! memory converts coordinates while dequantizing, streaming decodes time
+//! inflating and dequantizing each window separately.
+
+use std::cell::RefCell;
+use std::time::{Duration, Instant};
+
+/// A stage of loading or saving.
+#[derive(Clone, Copy, Debug, PartialEq, Eq, Hash)]
+pub enum Stage {
+	/// Reading or mapping the file.
+	Read,
+	/// Decompressing, gzip or zstd.
+	Inflate,
+	/// Reading the header and sections of decompressed data.
+	Parse,
+	/// Turning the quantized values into floats.
+	Dequantize,
+	/// Axis flips applied as a pass of their own.
+	ConvertCoordinates,
+	/// Turning the floats into quantized values.
+	Quantize,
+	/// Compressing, gzip or zstd.
+	Deflate,
+	/// Writing the file.
+	Write,
+}
+
+impl Stage {
+	/// Every stage, in pipeline order.
+	pub const ALL: [Stage; 8] = [
+		Stage::Read,
+		Stage::Inflate,
+		Stage::Parse,
+		Stage::Dequantize,
+		Stage::ConvertCoordinates,
+		Stage::Quantize,
+		Stage::Deflate,
+		Stage::Write,
+	];
+
+	#[inline]
+	pub const fn as_str(&self) -> &'static str {
+		match self {
+			Stage::Read => "read",
+			Stage::Inflate => "inflate",
+			Stage::Parse => "parse",
+			Stage::Dequantize => "dequantize",
+			Stage::ConvertCoordinates => "convert_coordinates",
+			Stage::Quantize => "quantize",
+			Stage::Deflate => "deflate",
+			Stage::Write => "write",
+		}
+	}
+}
+
+/// What a [`Stage`] did, summed over the times it ran.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct StageStats {
+	/// Number of times the stage ran.
+	pub calls: u32,
+	pub wall: Duration,
+	pub bytes_in: u64,
+	pub bytes_out: u64,
+	/// Bytes of the buffers the stage allocated for its output.
+	pub allocated: u64,
+	/// Most threads the stage ran on at once.
+	pub threads: u32,
+}
+
+/// Per stage statistics, see [`collect`].
+#[derive(Clone, Debug, Default, PartialEq, Eq)]
+pub struct LoadStats {
+	stages: [StageStats; Stage::ALL.len()],
+}
+
+impl LoadStats {
+	#[inline]
+	pub fn stage(&self, stage: Stage) -> &StageStats {
+		&self.stages[stage as usize]
+	}
+
+	/// Wall time of all stages.
+	pub fn total_wall(&self) -> Duration {
+		self.stages.iter().map(|stage| stage.wall).sum()
+	}
+}
+
+thread_local! {
+	static COLLECTED: RefCell<Option<LoadStats>> = const { RefCell::new(None) };
+}
+
+/// Runs `f`, recording the stages it runs on the current thread.
+///
+/// Work handed to other threads, e.g. by a
+/// [`BatchLoader`](crate::batch::BatchLoader), is only recorded by a
+/// collection on those threads. Collections don't nest, an inner one takes
+/// the stages recorded so far.
+pub fn collect<T, F>(f: F) -> (T, LoadStats)
+where
+	F: FnOnce() -> T,
+{
+	start();
+
+	let ret = f();
+
+	(ret, finish().unwrap_or_default())
+}
+
+/// Starts recording the stages run on the current thread, dropping the ones
+/// recorded so far. See [`collect`].
+pub fn start() {
+	COLLECTED.with_borrow_mut(|collected| *collected = Some(LoadStats::default()));
+}
+
+/// Stops recording, returning the stages recorded since [`start`], `None` if
+/// it wasn't called.
+pub fn finish() -> Option<LoadStats> {
+	COLLECTED.with_borrow_mut(Option::take)
+}
+
+#[inline]
+pub(crate) fn is_collecting() -> bool {
+	COLLECTED.with_borrow(Option::is_some)
+}
+
+/// Adds to the statistics of `stage`, if collecting.
+pub(crate) fn record<F>(stage: Stage, f: F)
+where
+	F: FnOnce(&mut StageStats),
+{
+	COLLECTED.with_borrow_mut(|collected| {
+		if let Some(collected) = collected {
+			f(&mut collected.stages[stage as usize]);
+		}
+	});
+}
+
+/// Times a stage until it is dropped, see [`enter`].
+pub(crate) struct StageGuard {
+	stage: Stage,
+	start: Option<Instant>,
+	bytes_in: u64,
+	bytes_out: u64,
+	allocated: u64,
+	threads: u32,
+	#[cfg(feature = "tracing")]
+	span: tracing::span::EnteredSpan,
+}
+
+/// Enters `stage`, which reads `bytes_in` bytes.
+#[inline]
+pub(crate) fn enter(stage: Stage, bytes_in: usize) -> StageGuard {
+	StageGuard {
+		stage,
+		start: is_collecting().then(Instant::now),
+		bytes_in: bytes_in as u64,
+		bytes_out: 0,
+		allocated: 0,
+		threads: 1,
+		#[cfg(feature = "tracing")]
+		span: tracing::debug_span!(
+			"spz",
+			stage = stage.as_str(),
+			bytes_in,
+			bytes_out = tracing::field::Empty,
+		)
+		.entered(),
+	}
+}
+
+impl StageGuard {
+	#[inline]
+	pub(crate) fn bytes_out(&mut self, bytes: usize) {
+		self.bytes_out = bytes as u64;
+	}
+
+	#[inline]
+	pub(crate) fn allocated(&mut self, bytes: usize) {
+		self.allocated = bytes as u64;
+	}
+
+	#[inline]
+	pub(crate) fn threads(&mut self, threads: usize) {
+		self.threads = threads as u32;
+	}
+}
+
+impl Drop for StageGuard {
+	fn drop(&mut self) {
+		#[cfg(feature = "tracing")]
+		self.span.record("bytes_out", self.bytes_out);
+
+		let Some(start) = self.start else {
+			return;
+		};
+		let wall = start.elapsed();
+
+		record(self.stage, |stats| {
+			stats.calls += 1;
+			stats.wall += wall;
+			stats.bytes_in += self.bytes_in;
+			stats.bytes_out += self.bytes_out;
+			stats.allocated += self.allocated;
+			stats.threads = stats.threads.max(self.threads);
+		});
+	}
+}
+
+/// A `tracing` span, without the `tracing` feature nothing.
+pub(crate) struct SpanGuard {
+	#[cfg(feature = "tracing")]
+	_span: tracing::span::EnteredSpan,
+}
+
+/// Enters a span for work that records its stages itself, see [`record`].
+#[inline]
+pub(crate) fn span(name: &'static str) -> SpanGuard {
+	#[cfg(not(feature = "tracing"))]
+	let _ = name;
+
+	SpanGuard {
+		#[cfg(feature = "tracing")]
+		_span: tracing::debug_span!("spz", stage = name).entered(),
+	}
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+	use crate::gaussian_splat::{GaussianSplat, LoadOptions, SaveOptions};
+	use crate::header::Header;
+
+	fn splat(num_points: usize) -> GaussianSplat {
+		GaussianSplat {
+			header: Header {
+				num_points: num_points as i32,
+				spherical_harmonics_degree: 1,
+				..Default::default()
+			},
+			positions: (0..num_points * 3).map(|i| i as f32 * 0.01).collect(),
+			scales: vec![-3.0; num_points * 3],
+			rotations: [0.0, 0.0, 0.0, 1.0].repeat(num_points),
+			alphas: vec![0.5; num_points],
+			colors: vec![0.1; num_points * 3],
+			spherical_harmonics: vec![0.0; num_points * 9],
+		}
+	}
+
+	#[test]
+	fn test_collect_records_stages() {
+		let gs = splat(1000);
+		let (compressed, saved) = collect(|| {
+			gs.serialize_to_packed_bytes(&SaveOptions::default())
+				.unwrap()
+		});
+
+		assert_eq!(saved.stage(Stage::Quantize).calls, 1);
+		assert_eq!(saved.stage(Stage::Deflate).calls, 1);
+		assert_eq!(
+			saved.stage(Stage::Deflate).bytes_out,
+			compressed.len() as u64
+		);
+		assert_eq!(saved.stage(Stage::Dequantize).calls, 0);
+
+		let (decoded, loaded) = collect(|| {
+			GaussianSplat::read_from_bytes(&compressed, &LoadOptions::default())
+		});
+
+		decoded.unwrap();
+		assert_eq!(
+			loaded.stage(Stage::Inflate).bytes_in,
+			compressed.len() as u64
+		);
+		assert_eq!(
+			loaded.stage(Stage::Dequantize).bytes_out,
+			(1000 * (3 + 3 + 4 + 1 + 3 + 9) * 4) as u64
+		);
+		assert!(loaded.total_wall() >= loaded.stage(Stage::Inflate).wall);
+		assert!(!is_collecting());
+	}
+}
@@ -0,0 +1,1241 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+//! Per-attribute decode kernels, turning packed SPZ section bytes into floats.
+//!
+//! Every kernel works on any contiguous run of whole elements of its section,
+//! so the same code serves whole-buffer decoding and streaming decoding of
+//! partially inflated data. Each kernel decodes `min(src, dst)` elements.
+//!
+//! - Positions are decoded with SIMD where available: AVX2 or SSSE3 (picked
+//!   at runtime) on `x86_64`, NEON on `aarch64`.
+//! - The `u8` to `f32` maps of scales, alphas, colors and spherical harmonics
+//!   are 256-entry lookup tables, built once from the [`scalar`] formulas.
+//!
+//! The encode kernels are their inverse, quantizing floats into section
+//! bytes. On `x86_64` they use SSE2 for positions, scales, rotations, colors
+//! and spherical harmonics; alphas stay scalar, as their sigmoid needs the
+//! exact `exp` of the scalar path.
+//!
+//! The flip kernels apply [`AxisFlips`](crate::coord::AxisFlips) to section
+//! bytes in place, as sign changes of the quantized values, so coordinates
+//! can be converted without decoding.
+//!
+//! All kernels produce bit-identical results to the [`scalar`] reference
+//! implementations.
+
+use std::sync::LazyLock;
+
+use crate::{consts, math};
+
+/// Decodes 24-bit fixed point coordinates (3 bytes each) into `dst`.
+#[inline]
+pub fn decode_positions(src: &[u8], dst: &mut [f32], fractional_bits: i32) {
+	let scale = position_scale(fractional_bits);
+	let done = simd::decode_positions(src, dst, scale);
+
+	scalar::decode_positions_scaled(&src[done * 3..], &mut dst[done..], scale);
+}
+
+/// Decodes log-encoded scales into `dst`.
+#[inline]
+pub fn decode_scales(src: &[u8], dst: &mut [f32]) {
+	decode_lut(src, dst, &SCALE_LUT);
+}
+
+/// Decodes quaternions into `dst` (4 floats each), from either 4 byte
+/// smallest-three or 3 byte first-three encoded rotations.
+#[inline]
+pub fn decode_rotations(src: &[u8], dst: &mut [f32], uses_quaternion_smallest_three: bool) {
+	scalar::decode_rotations(src, dst, uses_quaternion_smallest_three);
+}
+
+/// Decodes opacities into pre-activation (inverse sigmoid) alphas in `dst`.
+#[inline]
+pub fn decode_alphas(src: &[u8], dst: &mut [f32]) {
+	decode_lut(src, dst, &ALPHA_LUT);
+}
+
+/// Decodes DC colors into `dst`.
+#[inline]
+pub fn decode_colors(src: &[u8], dst: &mut [f32]) {
+	decode_lut(src, dst, &COLOR_LUT);
+}
+
+/// Decodes spherical harmonics coefficients into `dst`.
+#[inline]
+pub fn decode_spherical_harmonics(src: &[u8], dst: &mut [f32]) {
+	decode_lut(src, dst, &SH_LUT);
+}
+
+/// Decodes the first `dst_stride` of every `src_stride` spherical harmonics
+/// bytes into `dst`, dropping the coefficients of the higher degrees.
+#[inline]
+pub fn decode_spherical_harmonics_truncated(
+	src: &[u8],
+	dst: &mut [f32],
+	src_stride: usize,
+	dst_stride: usize,
+) {
+	if src_stride == dst_stride {
+		return decode_spherical_harmonics(src, dst);
+	}
+	if dst_stride == 0 {
+		return;
+	}
+	for (src, dst) in src
+		.chunks_exact(src_stride)
+		.zip(dst.chunks_exact_mut(dst_stride))
+	{
+		decode_spherical_harmonics(&src[..dst_stride], dst);
+	}
+}
+
+/// Encodes coordinates into 24-bit fixed point (3 bytes each), applying the
+/// per-axis `flip`. `src` must start at the first coordinate of a point.
+#[inline]
+pub fn encode_positions(src: &[f32], dst: &mut [u8], flip: [f32; 3], fractional_bits: i32) {
+	let scale = (1_i32 << fractional_bits) as f32;
+	let done = simd_encode::encode_positions(src, dst, flip, scale);
+
+	scalar::encode_positions_scaled(&src[done..], &mut dst[done * 3..], flip, scale);
+}
+
+/// Encodes scales into log-encoded bytes.
+#[inline]
+pub fn encode_scales(src: &[f32], dst: &mut [u8]) {
+	let done = simd_encode::encode_scales(src, dst);
+
+	scalar::encode_scales(&src[done..], &mut dst[done..]);
+}
+
+/// Encodes quaternions (4 floats each) into 4 byte smallest-three rotations,
+/// applying the `flip` of the x, y and z components.
+#[inline]
+pub fn encode_rotations(src: &[f32], dst: &mut [u8], flip: [f32; 3]) {
+	let done = simd_encode::encode_rotations(src, dst, flip);
+
+	scalar::encode_rotations(&src[done * 4..], &mut dst[done * 4..], flip);
+}
+
+/// Encodes pre-activation alphas into opacity bytes.
+#[inline]
+pub fn encode_alphas(src: &[f32], dst: &mut [u8]) {
+	scalar::encode_alphas(src, dst);
+}
+
+/// Encodes DC colors into bytes.
+#[inline]
+pub fn encode_colors(src: &[f32], dst: &mut [u8]) {
+	let done = simd_encode::encode_colors(src, dst);
+
+	scalar::encode_colors(&src[done..], &mut dst[done..]);
+}
+
+/// Encodes spherical harmonics coefficients of `sh_dim` coefficients per
+/// point into bytes, applying the per-coefficient `flip`. `src` must start at
+/// the first coefficient of a point.
+#[inline]
+pub fn encode_spherical_harmonics(src: &[f32], dst: &mut [u8], flip: &[f32; 15], sh_dim: usize) {
+	let done = simd_encode::encode_spherical_harmonics(src, dst, flip, sh_dim);
+
+	scalar::encode_spherical_harmonics(&src[done..], &mut dst[done..], flip, sh_dim);
+}
+
+/// Negates the 24-bit fixed point coordinates (3 bytes each) of the axes
+/// whose `flip` is negative, in place. `bytes` must start at the first
+/// coordinate of a point.
+///
+/// Like encoding a negated float, the most negative value wraps to itself.
+pub fn flip_positions(bytes: &mut [u8], flip: [f32; 3]) {
+	if flip.iter().all(|f| *f > 0.0) {
+		return;
+	}
+	for point in bytes.chunks_exact_mut(9) {
+		for (coord, f) in point.chunks_exact_mut(3).zip(flip) {
+			if f < 0.0 {
+				let fixed = u32::from_le_bytes([coord[0], coord[1], coord[2], 0]);
+
+				coord.copy_from_slice(&fixed.wrapping_neg().to_le_bytes()[..3]);
+			}
+		}
+	}
+}
+
+/// Negates the x, y and z components of packed rotations whose `flip` is
+/// negative, in place.
+///
+/// Smallest-three rotations (4 bytes each) get sign bits toggled: when the
+/// omitted largest component is flipped, the whole quaternion is negated
+/// instead, keeping it implicitly positive. First-three rotations (3 bytes
+/// each) are reflected around the midpoint of their byte range.
+pub fn flip_rotations(bytes: &mut [u8], flip: [f32; 3], uses_quaternion_smallest_three: bool) {
+	if flip.iter().all(|f| *f > 0.0) {
+		return;
+	}
+	if !uses_quaternion_smallest_three {
+		for rotation in bytes.chunks_exact_mut(3) {
+			for (c, f) in rotation.iter_mut().zip(flip) {
+				if f < 0.0 {
+					*c = 255 - *c;
+				}
+			}
+		}
+		return;
+	}
+	let negated = [flip[0] < 0.0, flip[1] < 0.0, flip[2] < 0.0, false];
+	// sign bits to toggle, per index of the largest component
+	let masks: [u32; 4] = std::array::from_fn(|largest| {
+		let mut mask = 0_u32;
+		let mut shift = 0;
+
+		for i in (0..4).rev() {
+			if i == largest {
+				continue;
+			}
+			if negated[i] != negated[largest] {
+				mask |= 1 << (shift + 9);
+			}
+			shift += 10;
+		}
+		mask
+	});
+	for rotation in bytes.chunks_exact_mut(4) {
+		let comp = u32::from_le_bytes([rotation[0], rotation[1], rotation[2], rotation[3]]);
+
+		rotation.copy_from_slice(&(comp ^ masks[(comp >> 30) as usize]).to_le_bytes());
+	}
+}
+
+/// Negates the spherical harmonics coefficients of `sh_dim` coefficients per
+/// point whose `flip` is negative, in place, reflecting their bytes around
+/// 128. `bytes` must start at the first coefficient of a point.
+///
+/// Like encoding a negated float, 0 becomes the largest value, 255.
+pub fn flip_spherical_harmonics(bytes: &mut [u8], flip: &[f32; 15], sh_dim: usize) {
+	if sh_dim == 0 || flip[..sh_dim].iter().all(|f| *f > 0.0) {
+		return;
+	}
+	for point in bytes.chunks_exact_mut(sh_dim * 3) {
+		for (coeff, f) in point.chunks_exact_mut(3).zip(flip) {
+			if *f < 0.0 {
+				for c in coeff {
+					*c = (256 - *c as u16).min(255) as u8;
+				}
+			}
+		}
+	}
+}
+
+static SCALE_LUT: LazyLock<[f32; 256]> = LazyLock::new(|| build_lut(scalar::decode_scale));
+static ALPHA_LUT: LazyLock<[f32; 256]> = LazyLock::new(|| build_lut(scalar::decode_alpha));
+static COLOR_LUT: LazyLock<[f32; 256]> = LazyLock::new(|| build_lut(scalar::decode_color));
+static SH_LUT: LazyLock<[f32; 256]> = LazyLock::new(|| build_lut(math::unquantize_sh));
+
+#[inline]
+fn build_lut(f: fn(u8) -> f32) -> [f32; 256] {
+	std::array::from_fn(|i| f(i as u8))
+}
+
+#[inline]
+fn decode_lut(src: &[u8], dst: &mut [f32], lut: &[f32; 256]) {
+	for (dst, src) in dst.iter_mut().zip(src) {
+		*dst = lut[*src as usize];
+	}
+}
+
+#[inline]
+pub(crate) fn position_scale(fractional_bits: i32) -> f32 {
+	1.0_f32 / (1_u32 << (fractional_bits as u32)) as f32
+}
+
+/// Bits of precision kept for the degree 1 spherical harmonics coefficients.
+pub const SH1_BITS: i32 = 5;
+
+/// Bits of precision kept for the degree 2 and 3 spherical harmonics
+/// coefficients.
+pub const SH_REST_BITS: i32 = 4;
+
+/// Scalar reference implementations of the kernels.
+pub mod scalar {
+	use super::*;
+
+	/// Decodes 24-bit fixed point coordinates (3 bytes each) into `dst`.
+	#[inline]
+	pub fn decode_positions(src: &[u8], dst: &mut [f32], fractional_bits: i32) {
+		decode_positions_scaled(src, dst, position_scale(fractional_bits));
+	}
+
+	#[inline]
+	pub(super) fn decode_positions_scaled(src: &[u8], dst: &mut [f32], scale: f32) {
+		for (value, src) in dst.iter_mut().zip(src.chunks_exact(3)) {
+			let mut fixed32 =
+				src[0] as i32 | ((src[1] as i32) << 8) | ((src[2] as i32) << 16);
+
+			if (fixed32 & 0x800000) != 0 {
+				fixed32 |= 0xff000000_u32 as i32;
+			}
+			*value = fixed32 as f32 * scale;
+		}
+	}
+
+	/// Decodes log-encoded scales into `dst`.
+	#[inline]
+	pub fn decode_scales(src: &[u8], dst: &mut [f32]) {
+		for (dst, src) in dst.iter_mut().zip(src) {
+			*dst = decode_scale(*src);
+		}
+	}
+
+	/// Decodes quaternions into `dst` (4 floats each), from either 4 byte
+	/// smallest-three or 3 byte first-three encoded rotations.
+	#[inline]
+	pub fn decode_rotations(src: &[u8], dst: &mut [f32], uses_quaternion_smallest_three: bool) {
+		if uses_quaternion_smallest_three {
+			for (dst, src) in dst.chunks_exact_mut(4).zip(src.chunks_exact(4)) {
+				math::unpack_quaternion_smallest_three(dst, src);
+			}
+		} else {
+			for (dst, src) in dst.chunks_exact_mut(4).zip(src.chunks_exact(3)) {
+				math::unpack_quaternion_first_three(dst, src);
+			}
+		}
+	}
+
+	/// Decodes opacities into pre-activation (inverse sigmoid) alphas in `dst`.
+	#[inline]
+	pub fn decode_alphas(src: &[u8], dst: &mut [f32]) {
+		for (dst, src) in dst.iter_mut().zip(src) {
+			*dst = decode_alpha(*src);
+		}
+	}
+
+	/// Decodes DC colors into `dst`.
+	#[inline]
+	pub fn decode_colors(src: &[u8], dst: &mut [f32]) {
+		for (dst, src) in dst.iter_mut().zip(src) {
+			*dst = decode_color(*src);
+		}
+	}
+
+	/// Decodes spherical harmonics coefficients into `dst`.
+	#[inline]
+	pub fn decode_spherical_harmonics(src: &[u8], dst: &mut [f32]) {
+		for (dst, src) in dst.iter_mut().zip(src) {
+			*dst = math::unquantize_sh(*src);
+		}
+	}
+
+	/// Encodes coordinates into 24-bit fixed point (3 bytes each), applying
+	/// the per-axis `flip`. `src` must start at the first coordinate of a point.
+	#[inline]
+	pub fn encode_positions(src: &[f32], dst: &mut [u8], flip: [f32; 3], fractional_bits: i32) {
+		encode_positions_scaled(src, dst, flip, (1_i32 << fractional_bits) as f32);
+	}
+
+	#[inline]
+	pub(super) fn encode_positions_scaled(
+		src: &[f32],
+		dst: &mut [u8],
+		flip: [f32; 3],
+		scale: f32,
+	) {
+		for (i, (dst, src)) in dst.chunks_exact_mut(3).zip(src).enumerate() {
+			let fixed32 = (flip[i % 3] * src * scale).round() as i32;
+
+			dst.copy_from_slice(&fixed32.to_le_bytes()[..3]);
+		}
+	}
+
+	/// Encodes scales into log-encoded bytes.
+	#[inline]
+	pub fn encode_scales(src: &[f32], dst: &mut [u8]) {
+		for (dst, src) in dst.iter_mut().zip(src) {
+			*dst = math::to_u8((src + 10.0) * 16.0);
+		}
+	}
+
+	/// Encodes quaternions (4 floats each) into 4 byte smallest-three
+	/// rotations, applying the `flip` of the x, y and z components.
+	#[inline]
+	pub fn encode_rotations(src: &[f32], dst: &mut [u8], flip: [f32; 3]) {
+		for (dst, src) in dst.chunks_exact_mut(4).zip(src.chunks_exact(4)) {
+			let src = [src[0], src[1], src[2], src[3]];
+
+			dst.copy_from_slice(&math::pack_quaternion_smallest_three(&src, flip));
+		}
+	}
+
+	/// Encodes pre-activation alphas into opacity bytes.
+	#[inline]
+	pub fn encode_alphas(src: &[f32], dst: &mut [u8]) {
+		for (dst, src) in dst.iter_mut().zip(src) {
+			*dst = math::to_u8(math::sigmoid(*src) * 255.0);
+		}
+	}
+
+	/// Encodes DC colors into bytes.
+	#[inline]
+	pub fn encode_colors(src: &[f32], dst: &mut [u8]) {
+		for (dst, src) in dst.iter_mut().zip(src) {
+			*dst = math::to_u8(src * (consts::COLOR_SCALE * 255.0) + (0.5 * 255.0));
+		}
+	}
+
+	/// Encodes spherical harmonics coefficients of `sh_dim` coefficients
+	/// per point into bytes, applying the per-coefficient `flip`. `src` must
+	/// start at the first coefficient of a point.
+	///
+	/// The first 3 coefficients keep [`SH1_BITS`] bits of precision, the
+	/// rest [`SH_REST_BITS`].
+	#[inline]
+	pub fn encode_spherical_harmonics(
+		src: &[f32],
+		dst: &mut [u8],
+		flip: &[f32; 15],
+		sh_dim: usize,
+	) {
+		let stride = sh_dim * 3;
+
+		if stride == 0 {
+			return;
+		}
+		for (dst, src) in dst.chunks_mut(stride).zip(src.chunks(stride)) {
+			for (j, (dst, src)) in dst.iter_mut().zip(src).enumerate() {
+				*dst = math::quantize_sh(flip[j / 3] * src, sh_step(j));
+			}
+		}
+	}
+
+	/// Quantization step of the `j`-th float of a point's spherical harmonics.
+	#[inline]
+	pub(super) fn sh_step(j: usize) -> i32 {
+		if j < 9 {
+			1_i32 << (8 - SH1_BITS)
+		} else {
+			1_i32 << (8 - SH_REST_BITS)
+		}
+	}
+
+	#[inline]
+	pub(super) fn decode_scale(b: u8) -> f32 {
+		b as f32 / 16.0 - 10.0
+	}
+
+	#[inline]
+	pub(super) fn decode_alpha(b: u8) -> f32 {
+		math::inv_sigmoid(b as f32 / 255.0)
+	}
+
+	#[inline]
+	pub(super) fn decode_color(b: u8) -> f32 {
+		((b as f32 / 255.0) - 0.5) / consts::COLOR_SCALE
+	}
+}
+
+/// SIMD position kernels.
+///
+/// Each vector step loads 16 bytes, shuffles the 3 bytes of 4 coordinates
+/// into the top 3 bytes of 4 `i32` lanes and arithmetic shifts them right by
+/// 8, which sign extends the 24-bit values. The lanes are then converted to
+/// `f32` and scaled, exactly like the scalar path.
+///
+/// The kernels return how many coordinates they decoded, the caller decodes
+/// the rest (at least the last few, as loads read past the consumed bytes)
+/// with the scalar kernel.
+mod simd {
+	/// Shuffle mask placing coordinate `i`'s bytes `3i..3i + 3` into bytes
+	/// `4i + 1..4i + 4` of the vector, with byte `4i` zeroed.
+	#[cfg(any(target_arch = "x86_64", target_arch = "aarch64"))]
+	const SHUFFLE: [u8; 16] = [0x80, 0, 1, 2, 0x80, 3, 4, 5, 0x80, 6, 7, 8, 0x80, 9, 10, 11];
+
+	#[cfg(target_arch = "x86_64")]
+	#[inline]
+	pub(super) fn decode_positions(src: &[u8], dst: &mut [f32], scale: f32) -> usize {
+		if is_x86_feature_detected!("avx2") {
+			// SAFETY: The CPU supports AVX2, checked above.
+			unsafe { x86::decode_positions_avx2(src, dst, scale) }
+		} else if is_x86_feature_detected!("ssse3") {
+			// SAFETY: The CPU supports SSSE3, checked above.
+			unsafe { x86::decode_positions_ssse3(src, dst, scale) }
+		} else {
+			0
+		}
+	}
+
+	#[cfg(target_arch = "aarch64")]
+	#[inline]
+	pub(super) fn decode_positions(src: &[u8], dst: &mut [f32], scale: f32) -> usize {
+		arm::decode_positions_neon(src, dst, scale)
+	}
+
+	#[cfg(not(any(target_arch = "x86_64", target_arch = "aarch64")))]
+	#[inline]
+	pub(super) fn decode_positions(_src: &[u8], _dst: &mut [f32], _scale: f32) -> usize {
+		0
+	}
+
+	#[cfg(target_arch = "x86_64")]
+	mod x86 {
+		use std::arch::x86_64::*;
+
+		use super::SHUFFLE;
+
+		/// # Safety
+		///
+		/// The CPU must support AVX2.
+		#[target_feature(enable = "avx2")]
+		pub(super) unsafe fn decode_positions_avx2(
+			src: &[u8],
+			dst: &mut [f32],
+			scale: f32,
+		) -> usize {
+			let n = dst.len().min(src.len() / 3);
+			let mut i = 0_usize;
+
+			// SAFETY: Every iteration reads src[3i..3i + 28] and writes
+			// dst[i..i + 8], both kept in bounds by the loop condition.
+			unsafe {
+				let shuffle = _mm_loadu_si128(SHUFFLE.as_ptr() as *const __m128i);
+				let shuffle = _mm256_set_m128i(shuffle, shuffle);
+				let scale = _mm256_set1_ps(scale);
+
+				while i + 8 <= n && 3 * i + 28 <= src.len() {
+					let p = src.as_ptr().add(3 * i);
+					let lo = _mm_loadu_si128(p as *const __m128i);
+					let hi = _mm_loadu_si128(p.add(12) as *const __m128i);
+					let v = _mm256_shuffle_epi8(
+						_mm256_set_m128i(hi, lo),
+						shuffle,
+					);
+					let v = _mm256_cvtepi32_ps(_mm256_srai_epi32::<8>(v));
+
+					_mm256_storeu_ps(
+						dst.as_mut_ptr().add(i),
+						_mm256_mul_ps(v, scale),
+					);
+
+					i += 8;
+				}
+			}
+			i
+		}
+
+		/// # Safety
+		///
+		/// The CPU must support SSSE3.
+		#[target_feature(enable = "ssse3")]
+		pub(super) unsafe fn decode_positions_ssse3(
+			src: &[u8],
+			dst: &mut [f32],
+			scale: f32,
+		) -> usize {
+			let n = dst.len().min(src.len() / 3);
+			let mut i = 0_usize;
+
+			// SAFETY: Every iteration reads src[3i..3i + 16] and writes
+			// dst[i..i + 4], both kept in bounds by the loop condition.
+			unsafe {
+				let shuffle = _mm_loadu_si128(SHUFFLE.as_ptr() as *const __m128i);
+				let scale = _mm_set1_ps(scale);
+
+				while i + 4 <= n && 3 * i + 16 <= src.len() {
+					let v = _mm_loadu_si128(
+						src.as_ptr().add(3 * i) as *const __m128i
+					);
+					let v = _mm_shuffle_epi8(v, shuffle);
+					let v = _mm_cvtepi32_ps(_mm_srai_epi32::<8>(v));
+
+					_mm_storeu_ps(
+						dst.as_mut_ptr().add(i),
+						_mm_mul_ps(v, scale),
+					);
+
+					i += 4;
+				}
+			}
+			i
+		}
+	}
+
+	#[cfg(target_arch = "aarch64")]
+	mod arm {
+		use std::arch::aarch64::*;
+
+		use super::SHUFFLE;
+
+		pub(super) fn decode_positions_neon(
+			src: &[u8],
+			dst: &mut [f32],
+			scale: f32,
+		) -> usize {
+			let n = dst.len().min(src.len() / 3);
+			let mut i = 0_usize;
+
+			// SAFETY: NEON is always available on aarch64. Every iteration
+			// reads src[3i..3i + 16] and writes dst[i..i + 4], both kept in
+			// bounds by the loop condition. Out of range table indices (0x80)
+			// produce zero bytes.
+			unsafe {
+				let shuffle = vld1q_u8(SHUFFLE.as_ptr());
+
+				while i + 4 <= n && 3 * i + 16 <= src.len() {
+					let v = vqtbl1q_u8(
+						vld1q_u8(src.as_ptr().add(3 * i)),
+						shuffle,
+					);
+					let v = vshrq_n_s32::<8>(vreinterpretq_s32_u8(v));
+
+					vst1q_f32(
+						dst.as_mut_ptr().add(i),
+						vmulq_n_f32(vcvtq_f32_s32(v), scale),
+					);
+					i += 4;
+				}
+			}
+			i
+		}
+	}
+}
+
+/// SIMD encode kernels.
+///
+/// The float math follows the scalar path operation by operation, and
+/// `round() as i32` is emulated exactly: truncate, add one away from zero
+/// when the dropped fraction is at least one half, and saturate like the
+/// scalar cast does (`NaN` to `0`). Quantized lanes are narrowed to bytes
+/// with saturating packs, which also performs the final clamp to `0..=255`.
+///
+/// The kernels return how many source elements they encoded (whole points
+/// for positions and spherical harmonics, quaternions for rotations), the
+/// caller encodes the rest with the scalar kernel.
+mod simd_encode {
+	#[cfg(not(target_arch = "x86_64"))]
+	pub(super) use fallback::*;
+
+	#[cfg(target_arch = "x86_64")]
+	#[inline]
+	pub(super) fn encode_positions(
+		src: &[f32],
+		dst: &mut [u8],
+		flip: [f32; 3],
+		scale: f32,
+	) -> usize {
+		// SAFETY: SSE2 is part of the x86_64 baseline.
+		unsafe { x86::encode_positions(src, dst, flip, scale) }
+	}
+
+	#[cfg(target_arch = "x86_64")]
+	#[inline]
+	pub(super) fn encode_scales(src: &[f32], dst: &mut [u8]) -> usize {
+		// SAFETY: SSE2 is part of the x86_64 baseline.
+		unsafe { x86::encode_scales(src, dst) }
+	}
+
+	#[cfg(target_arch = "x86_64")]
+	#[inline]
+	pub(super) fn encode_colors(src: &[f32], dst: &mut [u8]) -> usize {
+		// SAFETY: SSE2 is part of the x86_64 baseline.
+		unsafe { x86::encode_colors(src, dst) }
+	}
+
+	#[cfg(target_arch = "x86_64")]
+	#[inline]
+	pub(super) fn encode_rotations(src: &[f32], dst: &mut [u8], flip: [f32; 3]) -> usize {
+		// SAFETY: SSE2 is part of the x86_64 baseline.
+		unsafe { x86::encode_rotations(src, dst, flip) }
+	}
+
+	#[cfg(target_arch = "x86_64")]
+	#[inline]
+	pub(super) fn encode_spherical_harmonics(
+		src: &[f32],
+		dst: &mut [u8],
+		flip: &[f32; 15],
+		sh_dim: usize,
+	) -> usize {
+		// SAFETY: SSE2 is part of the x86_64 baseline.
+		unsafe { x86::encode_spherical_harmonics(src, dst, flip, sh_dim) }
+	}
+
+	#[cfg(target_arch = "x86_64")]
+	mod x86 {
+		use std::arch::x86_64::*;
+		use std::f32::consts::FRAC_1_SQRT_2;
+
+		use crate::consts;
+		use crate::kernels::scalar::sh_step;
+
+		/// Largest number of floats in 4 points of spherical harmonics.
+		const MAX_SH_BLOCK: usize = 4 * 15 * 3;
+
+		#[target_feature(enable = "sse2")]
+		pub(super) fn encode_positions(
+			src: &[f32],
+			dst: &mut [u8],
+			flip: [f32; 3],
+			scale: f32,
+		) -> usize {
+			let n = src.len().min(dst.len() / 3);
+			// 4 points are 12 coordinates, 3 vectors whose lanes cycle
+			// through the axes.
+			let flips = [0, 4, 8].map(|i| {
+				_mm_setr_ps(
+					flip[i % 3],
+					flip[(i + 1) % 3],
+					flip[(i + 2) % 3],
+					flip[(i + 3) % 3],
+				)
+			});
+			let scale = _mm_set1_ps(scale);
+			let mut lanes = [0_i32; 4];
+			let mut i = 0_usize;
+
+			while i + 12 <= n {
+				for (k, flip) in flips.iter().enumerate() {
+					let j = i + 4 * k;
+
+					// SAFETY: Reads src[j..j + 4], in bounds as j + 4 <= i + 12 <= n,
+					// and writes the 4 lanes into `lanes`.
+					unsafe {
+						let v = _mm_loadu_ps(src.as_ptr().add(j));
+						let v = round_to_i32(_mm_mul_ps(
+							_mm_mul_ps(*flip, v),
+							scale,
+						));
+
+						_mm_storeu_si128(
+							lanes.as_mut_ptr() as *mut __m128i,
+							v,
+						);
+					}
+					for (dst, fixed32) in dst[j * 3..(j + 4) * 3]
+						.chunks_exact_mut(3)
+						.zip(lanes)
+					{
+						dst.copy_from_slice(&fixed32.to_le_bytes()[..3]);
+					}
+				}
+				i += 12;
+			}
+			i
+		}
+
+		#[target_feature(enable = "sse2")]
+		pub(super) fn encode_scales(src: &[f32], dst: &mut [u8]) -> usize {
+			let offset = _mm_set1_ps(10.0);
+			let factor = _mm_set1_ps(16.0);
+
+			encode_u8(src, dst, |v| _mm_mul_ps(_mm_add_ps(v, offset), factor))
+		}
+
+		#[target_feature(enable = "sse2")]
+		pub(super) fn encode_colors(src: &[f32], dst: &mut [u8]) -> usize {
+			let factor = _mm_set1_ps(consts::COLOR_SCALE * 255.0);
+			let offset = _mm_set1_ps(0.5 * 255.0);
+
+			encode_u8(src, dst, |v| _mm_add_ps(_mm_mul_ps(v, factor), offset))
+		}
+
+		#[target_feature(enable = "sse2")]
+		pub(super) fn encode_rotations(
+			src: &[f32],
+			dst: &mut [u8],
+			flip: [f32; 3],
+		) -> usize {
+			let n = (src.len() / 4).min(dst.len() / 4);
+			let flip = flip.map(|v| _mm_set1_ps(v));
+			let mut i = 0_usize;
+
+			while i + 4 <= n {
+				// SAFETY: Reads src[4i..4i + 16] and writes dst[4i..4i + 16],
+				// in bounds as i + 4 <= n.
+				unsafe {
+					let p = src.as_ptr().add(4 * i);
+					let q = transpose([
+						_mm_loadu_ps(p),
+						_mm_loadu_ps(p.add(4)),
+						_mm_loadu_ps(p.add(8)),
+						_mm_loadu_ps(p.add(12)),
+					]);
+					let comp = pack_quaternions_smallest_three(q, flip);
+
+					_mm_storeu_si128(
+						dst.as_mut_ptr().add(4 * i) as *mut __m128i,
+						comp,
+					);
+				}
+				i += 4;
+			}
+			i
+		}
+
+		#[target_feature(enable = "sse2")]
+		pub(super) fn encode_spherical_harmonics(
+			src: &[f32],
+			dst: &mut [u8],
+			flip: &[f32; 15],
+			sh_dim: usize,
+		) -> usize {
+			let stride = sh_dim * 3;
+			// 4 points are a multiple of 4 floats.
+			let block = stride * 4;
+
+			if block == 0 || block > MAX_SH_BLOCK {
+				return 0;
+			}
+			let mut flips = [0.0_f32; MAX_SH_BLOCK];
+			let mut masks = [0_i32; MAX_SH_BLOCK];
+
+			for j in 0..block {
+				flips[j] = flip[(j % stride) / 3];
+				// Truncating a non-negative value to a multiple of the
+				// power of two step, negative values saturate to 0 on packing.
+				masks[j] = !(sh_step(j % stride) - 1);
+			}
+			let n = src.len().min(dst.len());
+			let half = _mm_set1_ps(128.0);
+			let mut i = 0_usize;
+
+			while i + block <= n {
+				for j in (0..block).step_by(4) {
+					// SAFETY: Reads src[i + j..i + j + 4] and writes
+					// dst[i + j..i + j + 4], in bounds as i + block <= n, and
+					// reads 4 lanes of `flips` and `masks` below `block`.
+					unsafe {
+						let v = _mm_mul_ps(
+							_mm_loadu_ps(flips.as_ptr().add(j)),
+							_mm_loadu_ps(src.as_ptr().add(i + j)),
+						);
+						let v = round_to_i32(_mm_add_ps(
+							_mm_mul_ps(v, half),
+							half,
+						));
+						let v = _mm_and_si128(
+							v,
+							_mm_loadu_si128(masks.as_ptr().add(j)
+								as *const __m128i),
+						);
+						let v = _mm_packus_epi16(_mm_packs_epi32(v, v), v);
+
+						(dst.as_mut_ptr().add(i + j) as *mut i32)
+							.write_unaligned(_mm_cvtsi128_si32(v));
+					}
+				}
+				i += block;
+			}
+			i
+		}
+
+		/// Maps 16 floats per step with `f` and quantizes them with [`to_u8`].
+		#[inline]
+		#[target_feature(enable = "sse2")]
+		fn encode_u8<F>(src: &[f32], dst: &mut [u8], f: F) -> usize
+		where
+			F: Fn(__m128) -> __m128,
+		{
+			let n = src.len().min(dst.len());
+			let mut i = 0_usize;
+
+			while i + 16 <= n {
+				// SAFETY: Reads src[i..i + 16] and writes dst[i..i + 16], in
+				// bounds as i + 16 <= n.
+				unsafe {
+					let p = src.as_ptr().add(i);
+					let [a, b, c, d] = [0, 4, 8, 12]
+						.map(|k| to_u8(f(_mm_loadu_ps(p.add(k)))));
+					let v = _mm_packus_epi16(
+						_mm_packs_epi32(a, b),
+						_mm_packs_epi32(c, d),
+					);
+
+					_mm_storeu_si128(
+						dst.as_mut_ptr().add(i) as *mut __m128i,
+						v,
+					);
+				}
+				i += 16;
+			}
+			i
+		}
+
+		/// [`math::to_u8`](crate::math::to_u8) of each lane, as `i32` lanes.
+		#[inline]
+		#[target_feature(enable = "sse2")]
+		fn to_u8(x: __m128) -> __m128i {
+			// `maxps` returns its second operand for `NaN` lanes, mapping them
+			// to 0 like the scalar cast.
+			round_to_i32(_mm_min_ps(
+				_mm_max_ps(x, _mm_setzero_ps()),
+				_mm_set1_ps(255.0),
+			))
+		}
+
+		/// `x.round() as i32` of each lane, bit for bit.
+		#[inline]
+		#[target_feature(enable = "sse2")]
+		fn round_to_i32(x: __m128) -> __m128i {
+			let sign = _mm_set1_ps(-0.0);
+			let trunc = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+			let frac = _mm_andnot_ps(sign, _mm_sub_ps(x, trunc));
+			let away = _mm_and_ps(
+				_mm_cmpge_ps(frac, _mm_set1_ps(0.5)),
+				_mm_or_ps(_mm_set1_ps(1.0), _mm_and_ps(sign, x)),
+			);
+			// From 2^23 up every float is integral, and the truncation above
+			// may be out of range.
+			let integral = _mm_cmpge_ps(_mm_andnot_ps(sign, x), _mm_set1_ps(8388608.0));
+			let rounded = select(integral, x, _mm_add_ps(trunc, away));
+			// Out of range conversions yield i32::MIN, which is correct for
+			// negative overflow, flip it to i32::MAX for positive overflow.
+			let overflow =
+				_mm_castps_si128(_mm_cmpge_ps(rounded, _mm_set1_ps(2147483648.0)));
+			let nan = _mm_castps_si128(_mm_cmpunord_ps(x, x));
+
+			_mm_andnot_si128(nan, _mm_xor_si128(_mm_cvttps_epi32(rounded), overflow))
+		}
+
+		/// Packs 4 quaternions, given as x, y, z and w lanes, like
+		/// [`math::pack_quaternion_smallest_three`](crate::math::pack_quaternion_smallest_three).
+		#[inline]
+		#[target_feature(enable = "sse2")]
+		fn pack_quaternions_smallest_three(q: [__m128; 4], flip: [__m128; 3]) -> __m128i {
+			let [x, y, z, w] = q;
+
+			// Normalize, degenerate quaternions become the identity.
+			let norm_sq = _mm_add_ps(
+				_mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)),
+					_mm_mul_ps(z, z),
+				),
+				_mm_mul_ps(w, w),
+			);
+			let degenerate = _mm_cmplt_ps(norm_sq, _mm_set1_ps(f32::EPSILON));
+			let inv_norm = _mm_div_ps(_mm_set1_ps(1.0), _mm_sqrt_ps(norm_sq));
+			let normed =
+				|v, identity| select(degenerate, identity, _mm_mul_ps(v, inv_norm));
+			let q = [
+				_mm_mul_ps(normed(x, _mm_setzero_ps()), flip[0]),
+				_mm_mul_ps(normed(y, _mm_setzero_ps()), flip[1]),
+				_mm_mul_ps(normed(z, _mm_setzero_ps()), flip[2]),
+				normed(w, _mm_set1_ps(1.0)),
+			];
+			let sign = _mm_set1_ps(-0.0);
+			let abs = q.map(|v| _mm_andnot_ps(sign, v));
+
+			// First index of the largest magnitude.
+			let mut largest = _mm_setzero_si128();
+			let mut largest_abs = abs[0];
+			let mut largest_value = q[0];
+
+			for i in 1..4 {
+				let greater = _mm_cmpgt_ps(abs[i], largest_abs);
+
+				largest_abs = select(greater, abs[i], largest_abs);
+				largest_value = select(greater, q[i], largest_value);
+				largest = select_i32(
+					_mm_castps_si128(greater),
+					_mm_set1_epi32(i as i32),
+					largest,
+				);
+			}
+			let negate = _mm_cmplt_ps(largest_value, _mm_setzero_ps());
+
+			// 10 bits per component: a sign bit and a 9 bit magnitude.
+			let c_mask = ((1_u32 << 9) - 1) as f32;
+			let encoded = [0, 1, 2, 3].map(|i| {
+				let negbit = _mm_and_si128(
+					_mm_castps_si128(_mm_xor_ps(
+						_mm_cmplt_ps(q[i], _mm_setzero_ps()),
+						negate,
+					)),
+					_mm_set1_epi32(1 << 9),
+				);
+				let mag = _mm_add_ps(
+					_mm_mul_ps(
+						_mm_set1_ps(c_mask),
+						_mm_div_ps(abs[i], _mm_set1_ps(FRAC_1_SQRT_2)),
+					),
+					_mm_set1_ps(0.5),
+				);
+				// Non-negative, so truncating is flooring.
+				let mag = _mm_cvttps_epi32(_mm_min_ps(
+					_mm_max_ps(mag, _mm_setzero_ps()),
+					_mm_set1_ps(c_mask),
+				));
+				_mm_or_si128(negbit, mag)
+			});
+			// The three smaller components follow the index in order, the
+			// first one in the highest bits.
+			let gt = |i| _mm_cmpgt_epi32(largest, _mm_set1_epi32(i));
+			let (gt0, gt1, gt2) = (gt(0), gt(1), gt(2));
+
+			let c0 = _mm_and_si128(gt0, _mm_slli_epi32::<20>(encoded[0]));
+			let c1 = select_i32(
+				gt1,
+				_mm_slli_epi32::<10>(encoded[1]),
+				_mm_andnot_si128(gt0, _mm_slli_epi32::<20>(encoded[1])),
+			);
+			let c2 = select_i32(
+				gt2,
+				encoded[2],
+				_mm_andnot_si128(gt1, _mm_slli_epi32::<10>(encoded[2])),
+			);
+			let c3 = _mm_andnot_si128(gt2, encoded[3]);
+
+			_mm_or_si128(
+				_mm_or_si128(_mm_slli_epi32::<30>(largest), c0),
+				_mm_or_si128(c1, _mm_or_si128(c2, c3)),
+			)
+		}
+
+		/// Transposes 4 rows of 4 lanes into 4 columns.
+		#[inline]
+		#[target_feature(enable = "sse2")]
+		fn transpose(rows: [__m128; 4]) -> [__m128; 4] {
+			let [r0, r1, r2, r3] = rows;
+			let t0 = _mm_unpacklo_ps(r0, r1);
+			let t1 = _mm_unpacklo_ps(r2, r3);
+			let t2 = _mm_unpackhi_ps(r0, r1);
+			let t3 = _mm_unpackhi_ps(r2, r3);
+
+			[
+				_mm_movelh_ps(t0, t1),
+				_mm_movehl_ps(t1, t0),
+				_mm_movelh_ps(t2, t3),
+				_mm_movehl_ps(t3, t2),
+			]
+		}
+
+		#[inline]
+		#[target_feature(enable = "sse2")]
+		fn select(mask: __m128, a: __m128, b: __m128) -> __m128 {
+			_mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b))
+		}
+
+		#[inline]
+		#[target_feature(enable = "sse2")]
+		fn select_i32(mask: __m128i, a: __m128i, b: __m128i) -> __m128i {
+			_mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b))
+		}
+	}
+
+	#[cfg(not(target_arch = "x86_64"))]
+	mod fallback {
+		#[inline]
+		pub(in crate::kernels) fn encode_positions(
+			_src: &[f32],
+			_dst: &mut [u8],
+			_flip: [f32; 3],
+			_scale: f32,
+		) -> usize {
+			0
+		}
+
+		#[inline]
+		pub(in crate::kernels) fn encode_scales(_src: &[f32], _dst: &mut [u8]) -> usize {
+			0
+		}
+
+		#[inline]
+		pub(in crate::kernels) fn encode_colors(_src: &[f32], _dst: &mut [u8]) -> usize {
+			0
+		}
+
+		#[inline]
+		pub(in crate::kernels) fn encode_rotations(
+			_src: &[f32],
+			_dst: &mut [u8],
+			_flip: [f32; 3],
+		) -> usize {
+			0
+		}
+
+		#[inline]
+		pub(in crate::kernels) fn encode_spherical_harmonics(
+			_src: &[f32],
+			_dst: &mut [u8],
+			_flip: &[f32; 15],
+			_sh_dim: usize,
+		) -> usize {
+			0
+		}
+	}
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+	use rstest::rstest;
+
+	fn bytes(len: usize) -> Vec<u8> {
+		(0..len).map(|i| (i.wrapping_mul(2654435761) >> 7) as u8)
+			.collect()
+	}
+
+	#[rstest]
+	#[case(0)]
+	#[case(1)]
+	#[case(5)]
+	#[case(8)]
+	#[case(9)]
+	#[case(1000)]
+	#[case(1003)]
+	fn test_decode_positions_matches_scalar(#[case] num_coords: usize) {
+		let src = bytes(num_coords * 3);
+
+		for fractional_bits in [0, 12, 20] {
+			let mut expected = vec![0.0_f32; num_coords];
+			let mut actual = vec![0.0_f32; num_coords];
+
+			scalar::decode_positions(&src, &mut expected, fractional_bits);
+			decode_positions(&src, &mut actual, fractional_bits);
+
+			assert_eq!(
+				actual.iter().map(|v| v.to_bits()).collect::<Vec<_>>(),
+				expected.iter().map(|v| v.to_bits()).collect::<Vec<_>>(),
+			);
+		}
+	}
+
+	#[test]
+	fn test_decode_positions_extremes() {
+		let src = [
+			0xff, 0xff, 0x7f, 0x00, 0x00, 0x80, 0xff, 0xff, 0xff, 0, 0, 0,
+		];
+		let mut dst = [0.0_f32; 4];
+
+		decode_positions(&src, &mut dst, 0);
+
+		assert_eq!(dst, [8388607.0, -8388608.0, -1.0, 0.0]);
+	}
+
+	#[test]
+	fn test_lut_kernels_match_scalar() {
+		let src: Vec<u8> = (0..=255).collect();
+		let kernels: [(fn(&[u8], &mut [f32]), fn(&[u8], &mut [f32])); 4] = [
+			(decode_scales, scalar::decode_scales),
+			(decode_alphas, scalar::decode_alphas),
+			(decode_colors, scalar::decode_colors),
+			(
+				decode_spherical_harmonics,
+				scalar::decode_spherical_harmonics,
+			),
+		];
+		for (kernel, reference) in kernels {
+			let mut expected = [0.0_f32; 256];
+			let mut actual = [0.0_f32; 256];
+
+			reference(&src, &mut expected);
+			kernel(&src, &mut actual);
+
+			assert_eq!(actual.map(f32::to_bits), expected.map(f32::to_bits));
+		}
+	}
+
+	/// Floats covering rounding ties, saturation, `NaN` and infinities, mixed
+	/// with values in `-range..range`.
+	fn floats(len: usize, range: f32) -> Vec<f32> {
+		const SPECIAL: [f32; 16] = [
+			f32::NAN,
+			f32::INFINITY,
+			f32::NEG_INFINITY,
+			-0.0,
+			0.5,
+			-0.5,
+			2.5,
+			-2.5,
+			0.49999997,
+			127.5,
+			255.5,
+			8388608.5,
+			2147483520.0,
+			2147483648.0,
+			-2147483648.0,
+			1e30,
+		];
+		(0..len).map(|i| {
+			let h = i.wrapping_mul(2654435761) >> 7;
+
+			if h % 7 == 0 {
+				SPECIAL[h % SPECIAL.len()]
+			} else {
+				((h % 65536) as f32 / 32768.0 - 1.0) * range
+			}
+		})
+		.collect()
+	}
+
+	#[rstest]
+	#[case(0)]
+	#[case(1)]
+	#[case(4)]
+	#[case(5)]
+	#[case(17)]
+	#[case(1000)]
+	fn test_encode_kernels_match_scalar(#[case] num_points: usize) {
+		let flip = [-1.0, 1.0, -1.0];
+		let sh_flip: [f32; 15] =
+			std::array::from_fn(|i| if i % 3 == 0 { -1.0 } else { 1.0 });
+
+		for range in [1.0, 300.0, 1e7] {
+			let src = floats(num_points * 3, range);
+			let mut expected = vec![0_u8; num_points * 9];
+			let mut actual = vec![0_u8; num_points * 9];
+
+			scalar::encode_positions(&src, &mut expected, flip, 12);
+			encode_positions(&src, &mut actual, flip, 12);
+			assert_eq!(actual, expected);
+
+			let bytes: [(fn(&[f32], &mut [u8]), fn(&[f32], &mut [u8])); 3] = [
+				(encode_scales, scalar::encode_scales),
+				(encode_alphas, scalar::encode_alphas),
+				(encode_colors, scalar::encode_colors),
+			];
+			for (kernel, reference) in bytes {
+				let mut expected = vec![0_u8; src.len()];
+				let mut actual = vec![0_u8; src.len()];
+
+				reference(&src, &mut expected);
+				kernel(&src, &mut actual);
+				assert_eq!(actual, expected);
+			}
+			let src = floats(num_points * 4, range);
+			let mut expected = vec![0_u8; num_points * 4];
+			let mut actual = vec![0_u8; num_points * 4];
+
+			scalar::encode_rotations(&src, &mut expected, flip);
+			encode_rotations(&src, &mut actual, flip);
+			assert_eq!(actual, expected);
+
+			for sh_dim in [0, 3, 8, 15] {
+				let src = floats(num_points * sh_dim * 3, range);
+				let mut expected = vec![0_u8; src.len()];
+				let mut actual = vec![0_u8; src.len()];
+
+				scalar::encode_spherical_harmonics(
+					&src,
+					&mut expected,
+					&sh_flip,
+					sh_dim,
+				);
+				encode_spherical_harmonics(&src, &mut actual, &sh_flip, sh_dim);
+				assert_eq!(actual, expected);
+			}
+		}
+	}
+
+	#[test]
+	fn test_encode_rotations_degenerate_and_ties() {
+		let src = [
+			0.0, 0.0, 0.0, 0.0, 0.5, 0.5, 0.5, 0.5, -0.5, 0.5, -0.5, 0.5, 0.0, -1.0,
+			0.0, 0.0,
+		];
+		let mut expected = [0_u8; 16];
+		let mut actual = [0_u8; 16];
+
+		scalar::encode_rotations(&src, &mut expected, [1.0, -1.0, 1.0]);
+		encode_rotations(&src, &mut actual, [1.0, -1.0, 1.0]);
+
+		assert_eq!(actual, expected);
+	}
+}
@@ -0,0 +1,546 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+//! Interleaved, GPU ready point records decoded straight from packed data.
+//!
+//! [`GaussianSplat`](crate::gaussian_splat::GaussianSplat) holds one array
+//! per attribute. Renderers usually want one record per point instead, so
+//! [`decode_records`] writes a [`Layout`] of records in a single pass over
+//! the packed attributes, without the float arrays in between:
+//!
+//! - [`SplatF32`], 64 bytes: `f32` position, scale, rotation and RGBA, each
+//!   16 byte aligned as `std430` `vec3`/`vec4` members are.
+//! - [`SplatF16`], 32 bytes: the same as halves.
+//! - [`SplatQuantized`], 32 bytes: `f32` position, unorm8 RGBA, half
+//!   scales and snorm16 rotation.
+//!
+//! Records hold no spherical harmonics. [`Activation`] picks whether values
+//! are the raw ones a splat holds, or activated as shaders use them.
+
+use std::path::Path;
+use std::sync::LazyLock;
+
+use anyhow::{Result, bail};
+use arbitrary::Arbitrary;
+use likely_stable::unlikely;
+use serde::{Deserialize, Serialize};
+use zerocopy::{FromBytes, Immutable, IntoBytes, KnownLayout};
+
+use crate::{
+	consts,
+	coord::{AxisFlips, CoordinateSystem},
+	decoder::Decoder,
+	gaussian_splat::LoadOptions,
+	header::Header,
+	kernels,
+	math::{self, dim_for_degree},
+	packed::PackedGaussians,
+	parallel,
+};
+
+static_assertions::const_assert_eq!(std::mem::size_of::<SplatF32>(), 64);
+static_assertions::const_assert_eq!(std::mem::size_of::<SplatF16>(), 32);
+static_assertions::const_assert_eq!(std::mem::size_of::<SplatQuantized>(), 32);
+
+/// Memory layout of decoded points.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq, Hash, Serialize, Deserialize, Arbitrary)]
+pub enum Layout {
+	/// One `f32` array per attribute, as in
+	/// [`GaussianSplat`](crate::gaussian_splat::GaussianSplat).
+	#[default]
+	Columns,
+	/// [`SplatF32`] records.
+	InterleavedF32,
+	/// [`SplatF16`] records.
+	InterleavedF16,
+	/// [`SplatQuantized`] records.
+	Quantized32,
+}
+
+impl Layout {
+	/// Bytes per point record, `0` for [`Layout::Columns`].
+	#[inline]
+	pub const fn record_size(self) -> usize {
+		match self {
+			Layout::Columns => 0,
+			Layout::InterleavedF32 => std::mem::size_of::<SplatF32>(),
+			Layout::InterleavedF16 => std::mem::size_of::<SplatF16>(),
+			Layout::Quantized32 => std::mem::size_of::<SplatQuantized>(),
+		}
+	}
+}
+
+/// Transform applied to the values of point records.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq, Hash, Serialize, Deserialize, Arbitrary)]
+pub enum Activation {
+	/// The values a splat holds: log scales, alphas before the sigmoid and
+	/// degree 0 spherical harmonics coefficients as colors.
+	#[default]
+	Raw,
+	/// `exp` of the scales, sigmoid of the alphas and colors as RGB,
+	/// `0.5 + SH_C0 * c`.
+	Activated,
+	/// Like [`Activation::Activated`], with RGB multiplied by alpha.
+	Premultiplied,
+}
+
+/// Point record of 32-bit floats.
+#[repr(C, align(16))]
+#[derive(Clone, Copy, Debug, Default, PartialEq, FromBytes, IntoBytes, Immutable, KnownLayout)]
+pub struct SplatF32 {
+	pub position: [f32; 3],
+	/// Zero.
+	pub pad0: f32,
+	pub scale: [f32; 3],
+	/// Zero.
+	pub pad1: f32,
+	/// `x, y, z, w`.
+	pub rotation: [f32; 4],
+	/// `r, g, b, a`.
+	pub color: [f32; 4],
+}
+
+/// Point record of IEEE 754 halves, stored as their bits.
+#[repr(C, align(16))]
+#[derive(Clone, Copy, Debug, Default, PartialEq, FromBytes, IntoBytes, Immutable, KnownLayout)]
+pub struct SplatF16 {
+	/// `x, y, z` and a zero.
+	pub position: [u16; 4],
+	/// `x, y, z` and a zero.
+	pub scale: [u16; 4],
+	/// `x, y, z, w`.
+	pub rotation: [u16; 4],
+	/// `r, g, b, a`.
+	pub color: [u16; 4],
+}
+
+/// Quantized point record.
+///
+/// Colors and alphas are always [activated](Activation::Activated), to fit
+/// unorm8, even with [`Activation::Raw`], and premultiplied with
+/// [`Activation::Premultiplied`]; scales follow the [`Activation`].
+#[repr(C, align(16))]
+#[derive(Clone, Copy, Debug, Default, PartialEq, FromBytes, IntoBytes, Immutable, KnownLayout)]
+pub struct SplatQuantized {
+	pub position: [f32; 3],
+	/// `r, g, b, a` as unorm8.
+	pub color: [u8; 4],
+	/// `x, y, z` as the bits of halves.
+	pub scale: [u16; 3],
+	/// Zero.
+	pub pad: u16,
+	/// `x, y, z, w` as snorm16.
+	pub rotation: [i16; 4],
+}
+
+/// Decodes packed gaussians into point records of [`LoadOptions::layout`].
+///
+/// With [`LoadOptions::threads`] other than 1, the points are split into
+/// ranges decoded in parallel; the output is the same either way.
+///
+/// # Args
+///
+/// `packed` - the packed gaussian data to decode.
+/// `opts` - options for loading, the layout must not be
+/// [`Layout::Columns`].
+/// `out` - destination, at least `num_points * record_size` bytes, and only
+/// that prefix is written. It needn't be aligned.
+///
+/// # Returns
+///
+/// The header describing the decoded data.
+pub fn decode_records<P>(packed: &P, opts: &LoadOptions, out: &mut [u8]) -> Result<Header>
+where
+	P: PackedGaussians + ?Sized,
+{
+	let record_size = opts.layout.record_size();
+	let num_points = packed.num_points().max(0) as usize;
+	let sh_dim = dim_for_degree(packed.sh_degree() as u8);
+
+	if unlikely(record_size == 0) {
+		bail!("the columns layout has no point records");
+	}
+	if unlikely(packed.num_points() < 0 || !packed.check_sizes(num_points, sh_dim)) {
+		bail!("inconsistent sizes");
+	}
+	let len = num_points * record_size;
+
+	if unlikely(out.len() < len) {
+		bail!(
+			"records buffer too small: expected at least {len} bytes, got {}",
+			out.len()
+		);
+	}
+	let source = Source {
+		positions: packed.positions(),
+		scales: packed.scales(),
+		rotations: packed.rotations(),
+		alphas: packed.alphas(),
+		colors: packed.colors(),
+		rotation_size: if packed.uses_quaternion_smallest_three() {
+			4
+		} else {
+			3
+		},
+		position_scale: 1.0
+			/ (1_u32 << packed.fractional_bits().clamp(0, 23) as u32) as f32,
+		flips: opts.coord_sys.axis_flips_to(CoordinateSystem::RightUpBack),
+		scale_luts: match opts.activation {
+			Activation::Raw => &RAW_LUTS,
+			Activation::Activated | Activation::Premultiplied => &ACTIVATED_LUTS,
+		},
+		// raw colors and alphas don't fit unorm8
+		color_luts: match (opts.layout, opts.activation) {
+			(Layout::Quantized32, _) => &ACTIVATED_LUTS,
+			(_, Activation::Raw) => &RAW_LUTS,
+			(_, Activation::Activated | Activation::Premultiplied) => &ACTIVATED_LUTS,
+		},
+		activation: opts.activation,
+	};
+	let threads = parallel::thread_count(opts.threads, num_points);
+	let points_per_job = num_points.div_ceil(threads).max(1);
+	let jobs: Vec<_> = out[..len]
+		.chunks_mut(points_per_job * record_size)
+		.enumerate()
+		.map(|(i, out)| (i * points_per_job, out))
+		.collect();
+
+	parallel::run(jobs, |(first, out): (usize, &mut [u8])| {
+		for (i, record) in out.chunks_exact_mut(record_size).enumerate() {
+			let point = source.point(first + i);
+
+			match opts.layout {
+				Layout::Columns => unreachable!(),
+				Layout::InterleavedF32 => {
+					record.copy_from_slice(point.f32().as_bytes())
+				},
+				Layout::InterleavedF16 => {
+					record.copy_from_slice(point.f16().as_bytes())
+				},
+				Layout::Quantized32 => {
+					record.copy_from_slice(point.quantized().as_bytes())
+				},
+			}
+		}
+	});
+	Ok(packed.to_header())
+}
+
+/// Loads an SPZ file into point records of [`LoadOptions::layout`], see
+/// [`decode_records`].
+///
+/// # Args
+///
+/// `filepath` - gzip or zstd compressed, packed gaussian data file.
+/// `opts` - options for loading.
+pub fn load_records<F>(filepath: F, opts: &LoadOptions) -> Result<(Header, Vec<u8>)>
+where
+	F: AsRef<Path>,
+{
+	let mut records = Vec::new();
+	let header = Decoder::new().load_records_into(filepath, opts, &mut records)?;
+
+	Ok((header, records))
+}
+
+/// Byte to value maps of the attributes that activation changes.
+struct Luts {
+	scales: [f32; 256],
+	alphas: [f32; 256],
+	colors: [f32; 256],
+}
+
+static RAW_LUTS: LazyLock<Luts> = LazyLock::new(|| {
+	let bytes: [u8; 256] = std::array::from_fn(|i| i as u8);
+	let mut luts = Luts {
+		scales: [0.0; 256],
+		alphas: [0.0; 256],
+		colors: [0.0; 256],
+	};
+	kernels::decode_scales(&bytes, &mut luts.scales);
+	kernels::decode_alphas(&bytes, &mut luts.alphas);
+	kernels::decode_colors(&bytes, &mut luts.colors);
+
+	luts
+});
+
+static ACTIVATED_LUTS: LazyLock<Luts> = LazyLock::new(|| Luts {
+	scales: RAW_LUTS.scales.map(f32::exp),
+	alphas: std::array::from_fn(|i| i as f32 / 255.0),
+	colors: RAW_LUTS.colors.map(|c| 0.5 + consts::SH_C0 * c),
+});
+
+/// The packed attributes records are decoded from.
+struct Source<'a> {
+	positions: &'a [u8],
+	scales: &'a [u8],
+	rotations: &'a [u8],
+	alphas: &'a [u8],
+	colors: &'a [u8],
+	rotation_size: usize,
+	position_scale: f32,
+	flips: AxisFlips,
+	/// Maps of the scales.
+	scale_luts: &'a Luts,
+	/// Maps of the alphas and colors.
+	color_luts: &'a Luts,
+	activation: Activation,
+}
+
+/// A decoded point.
+struct Point {
+	position: [f32; 3],
+	scale: [f32; 3],
+	rotation: [f32; 4],
+	color: [f32; 4],
+}
+
+impl Source<'_> {
+	#[inline]
+	fn point(&self, i: usize) -> Point {
+		let p = &self.positions[i * 9..i * 9 + 9];
+		let s = &self.scales[i * 3..i * 3 + 3];
+		let c: [u8; 3] = self.colors[i * 3..i * 3 + 3].try_into().unwrap_or_default();
+		let r = &self.rotations[i * self.rotation_size..(i + 1) * self.rotation_size];
+
+		let position = std::array::from_fn(|axis| {
+			let b = &p[axis * 3..axis * 3 + 3];
+			// sign extend the 24-bit value
+			let fixed = i32::from_le_bytes([0, b[0], b[1], b[2]]) >> 8;
+
+			fixed as f32 * self.position_scale * self.flips.position[axis]
+		});
+		let mut rotation = [0.0; 4];
+
+		if self.rotation_size == 4 {
+			math::unpack_quaternion_smallest_three_with_flip(
+				&mut rotation,
+				r,
+				self.flips.rotation,
+			);
+		} else {
+			math::unpack_quaternion_first_three_with_flip(
+				&mut rotation,
+				r,
+				self.flips.rotation,
+			);
+		}
+		let alpha = self.color_luts.alphas[self.alphas[i] as usize];
+		let mut rgb = c.map(|c| self.color_luts.colors[c as usize]);
+
+		if self.activation == Activation::Premultiplied {
+			rgb = rgb.map(|c| c * alpha);
+		}
+		Point {
+			position,
+			scale: std::array::from_fn(|axis| self.scale_luts.scales[s[axis] as usize]),
+			rotation,
+			color: [rgb[0], rgb[1], rgb[2], alpha],
+		}
+	}
+}
+
+impl Point {
+	#[inline]
+	fn f32(&self) -> SplatF32 {
+		SplatF32 {
+			position: self.position,
+			pad0: 0.0,
+			scale: self.scale,
+			pad1: 0.0,
+			rotation: self.rotation,
+			color: self.color,
+		}
+	}
+
+	#[inline]
+	fn f16(&self) -> SplatF16 {
+		let [x, y, z] = self.position.map(math::f32_to_f16);
+		let [sx, sy, sz] = self.scale.map(math::f32_to_f16);
+
+		SplatF16 {
+			position: [x, y, z, 0],
+			scale: [sx, sy, sz, 0],
+			rotation: self.rotation.map(math::f32_to_f16),
+			color: self.color.map(math::f32_to_f16),
+		}
+	}
+
+	#[inline]
+	fn quantized(&self) -> SplatQuantized {
+		SplatQuantized {
+			position: self.position,
+			color: self
+				.color
+				.map(|c| (c.clamp(0.0, 1.0) * 255.0).round() as u8),
+			scale: self.scale.map(math::f32_to_f16),
+			pad: 0,
+			rotation: self
+				.rotation
+				.map(|r| (r.clamp(-1.0, 1.0) * 32767.0).round() as i16),
+		}
+	}
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+	use crate::gaussian_splat::{GaussianSplat, SaveOptions};
+	use crate::math::{f16_to_f32, sigmoid};
+	use crate::test_util::splat;
+	use approx::assert_relative_eq;
+	use rstest::rstest;
+
+	fn records<T: FromBytes + Copy>(bytes: &[u8]) -> Vec<T> {
+		bytes.chunks_exact(std::mem::size_of::<T>())
+			.map(|b| T::read_from_bytes(b).unwrap())
+			.collect()
+	}
+
+	#[rstest]
+	#[case(CoordinateSystem::Unspecified, 1)]
+	#[case(CoordinateSystem::RightDownFront, 0)]
+	fn test_decode_records_f32_matches_columns(
+		#[case] coord_sys: CoordinateSystem,
+		#[case] threads: usize,
+	) {
+		let packed = splat(3000, 1)
+			.to_packed_gaussians(&SaveOptions::default())
+			.unwrap();
+		let opts = LoadOptions::builder()
+			.coord_sys(coord_sys)
+			.threads(threads)
+			.layout(Layout::InterleavedF32)
+			.build();
+		let columns = GaussianSplat::new_from_packed_gaussians(&packed, &opts).unwrap();
+		let mut out = vec![0; 3000 * 64];
+
+		let header = decode_records(&packed, &opts, &mut out).unwrap();
+
+		assert_eq!(header, columns.header);
+
+		for (i, record) in records::<SplatF32>(&out).iter().enumerate() {
+			assert_eq!(record.position[..], columns.positions[i * 3..i * 3 + 3]);
+			assert_eq!(record.scale[..], columns.scales[i * 3..i * 3 + 3]);
+			assert_eq!(record.rotation[..], columns.rotations[i * 4..i * 4 + 4]);
+			assert_eq!(record.color[..3], columns.colors[i * 3..i * 3 + 3]);
+			assert_eq!(record.color[3], columns.alphas[i]);
+		}
+	}
+
+	#[test]
+	fn test_decode_records_activated() {
+		let packed = splat(100, 1)
+			.to_packed_gaussians(&SaveOptions::default())
+			.unwrap();
+		let columns =
+			GaussianSplat::new_from_packed_gaussians(&packed, &LoadOptions::default())
+				.unwrap();
+		let decode = |layout, activation| {
+			let opts = LoadOptions::builder()
+				.layout(layout)
+				.activation(activation)
+				.build();
+			let mut out = vec![0; 100 * layout.record_size()];
+
+			decode_records(&packed, &opts, &mut out).unwrap();
+			out
+		};
+		let premultiplied = records::<SplatF16>(&decode(
+			Layout::InterleavedF16,
+			Activation::Premultiplied,
+		));
+		let quantized = records::<SplatQuantized>(&decode(
+			Layout::Quantized32,
+			Activation::Activated,
+		));
+
+		for i in 0..100 {
+			let alpha = sigmoid(columns.alphas[i]);
+			let rgb: Vec<_> = columns.colors[i * 3..i * 3 + 3]
+				.iter()
+				.map(|c| (0.5 + consts::SH_C0 * c).clamp(0.0, 1.0))
+				.collect();
+
+			for (axis, rgb) in rgb.iter().enumerate() {
+				let scale = columns.scales[i * 3 + axis].exp();
+
+				assert_relative_eq!(
+					f16_to_f32(premultiplied[i].scale[axis]),
+					scale,
+					max_relative = 1e-3
+				);
+				assert_relative_eq!(
+					f16_to_f32(premultiplied[i].color[axis]),
+					rgb * alpha,
+					epsilon = 1e-3
+				);
+				assert_relative_eq!(
+					f16_to_f32(quantized[i].scale[axis]),
+					scale,
+					max_relative = 1e-3
+				);
+				assert_eq!(quantized[i].color[axis], (rgb * 255.0).round() as u8);
+			}
+			assert_relative_eq!(
+				f16_to_f32(premultiplied[i].color[3]),
+				alpha,
+				epsilon = 1e-3
+			);
+			assert_eq!(quantized[i].color[3], packed.alphas[i]);
+			assert_eq!(
+				quantized[i].position[..],
+				columns.positions[i * 3..i * 3 + 3]
+			);
+		}
+	}
+
+	#[test]
+	fn test_decode_records_quantized_raw_activates_colors() {
+		let packed = splat(100, 1)
+			.to_packed_gaussians(&SaveOptions::default())
+			.unwrap();
+		let columns =
+			GaussianSplat::new_from_packed_gaussians(&packed, &LoadOptions::default())
+				.unwrap();
+		let decode = |activation| {
+			let opts = LoadOptions::builder()
+				.layout(Layout::Quantized32)
+				.activation(activation)
+				.build();
+			let mut out = vec![0; 100 * 32];
+
+			decode_records(&packed, &opts, &mut out).unwrap();
+			records::<SplatQuantized>(&out)
+		};
+		let raw = decode(Activation::Raw);
+		let activated = decode(Activation::Activated);
+
+		for i in 0..100 {
+			assert_eq!(raw[i].color, activated[i].color);
+
+			for axis in 0..3 {
+				assert_relative_eq!(
+					f16_to_f32(raw[i].scale[axis]),
+					columns.scales[i * 3 + axis],
+					max_relative = 1e-3
+				);
+			}
+		}
+	}
+
+	#[test]
+	fn test_decode_records_rejects_columns_and_short_buffers() {
+		let packed = splat(10, 1)
+			.to_packed_gaussians(&SaveOptions::default())
+			.unwrap();
+		let mut out = vec![0; 10 * 32 - 1];
+
+		assert!(decode_records(&packed, &LoadOptions::default(), &mut out).is_err());
+		assert!(decode_records(
+			&packed,
+			&LoadOptions::builder().layout(Layout::Quantized32).build(),
+			&mut out
+		)
+		.is_err());
+	}
+}
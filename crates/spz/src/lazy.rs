@@ -0,0 +1,440 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+//! Lazy, per-attribute decoding of SPZ data.
+//!
+//! A [`LazyGaussianSplat`] keeps the decompressed, packed gaussian data and
+//! dequantizes an attribute only the first time it is asked for. Callers that
+//! only need positions (a bounding box, culling, a point preview) never pay
+//! for rotations or spherical harmonics.
+
+use std::path::Path;
+use std::sync::OnceLock;
+
+use anyhow::{Context, Result, bail};
+use likely_stable::unlikely;
+
+use crate::{
+	container,
+	coord::{AxisFlips, CoordinateSystem},
+	gaussian_splat::{self, AttributeMask, BoundingBox, GaussianSplat, LoadOptions},
+	header::Header,
+	kernels,
+	math::dim_for_degree,
+	mmap,
+	packed::{PackedGaussianSplatView, PackedGaussians, Sections},
+	stats::{self, Statistics},
+};
+
+/// A splat that decodes each attribute on first access.
+///
+/// The decoded attributes have the same layout and coordinate system as the
+/// fields of [`GaussianSplat`] loaded with the same [`LoadOptions`].
+#[derive(Debug)]
+pub struct LazyGaussianSplat {
+	decompressed: Vec<u8>,
+	/// Where the sections of `decompressed` are, validated on creation.
+	sections: Sections,
+	header: Header,
+	flips: AxisFlips,
+	mask: AttributeMask,
+	sh_degree: u8,
+
+	positions: OnceLock<Vec<f32>>,
+	scales: OnceLock<Vec<f32>>,
+	rotations: OnceLock<Vec<f32>>,
+	alphas: OnceLock<Vec<f32>>,
+	colors: OnceLock<Vec<f32>>,
+	spherical_harmonics: OnceLock<Vec<f32>>,
+	statistics: OnceLock<Statistics>,
+}
+
+impl LazyGaussianSplat {
+	/// Loads a [`LazyGaussianSplat`] from a file.
+	///
+	/// # Args
+	///
+	/// `filepath` - gzip or zstd compressed, packed gaussian data file.
+	/// `opts` - options for loading the splat.
+	/// `mask` - attributes that can be decoded, the others stay empty.
+	pub fn load<F>(filepath: F, opts: &LoadOptions, mask: AttributeMask) -> Result<Self>
+	where
+		F: AsRef<Path>,
+	{
+		let compressed = mmap::read_or_map(filepath)?;
+
+		Self::from_bytes(&compressed, opts, mask)
+			.with_context(|| "unable to load packed file")
+	}
+
+	/// Decompresses `bytes` and validates the packed data, without decoding
+	/// any attribute.
+	///
+	/// # Args
+	///
+	/// `bytes` - gzip or zstd compressed, packed gaussian data, or a
+	/// progressive file. Chunked files have no single packed stream and are
+	/// rejected.
+	/// `opts` - options for loading the splat.
+	/// `mask` - attributes that can be decoded, the others stay empty. Only
+	/// those also in [`LoadOptions::attributes`] are decoded, and the
+	/// sections after the last of them, or after the scales the statistics
+	/// read, aren't inflated when the data allows reading a prefix.
+	pub fn from_bytes(bytes: &[u8], opts: &LoadOptions, mask: AttributeMask) -> Result<Self> {
+		let bytes = container::stream(bytes)?;
+
+		if unlikely(bytes.is_empty()) {
+			bail!("data is empty");
+		}
+		// the statistics read the positions and scales, whichever get decoded
+		let kept = LoadOptions {
+			attributes: (opts.attributes & mask)
+				| AttributeMask::POSITIONS | AttributeMask::SCALES,
+			..opts.clone()
+		};
+		let mut decompressed = Vec::new();
+		let sections = kept.decompress_decoded(bytes, &mut decompressed, 0)?;
+		let sections = Sections::of_prefix(&decompressed, sections)
+			.with_context(|| "unable to parse packed gaussian data")?;
+		let header = sections.view(&decompressed).to_header();
+
+		Ok(Self {
+			decompressed,
+			sections,
+			flips: opts.coord_sys.axis_flips_to(CoordinateSystem::RightUpBack),
+			mask: mask & opts.decoded_attributes(header.spherical_harmonics_degree),
+			sh_degree: opts.decoded_sh_degree(header.spherical_harmonics_degree),
+			header,
+			positions: OnceLock::new(),
+			scales: OnceLock::new(),
+			rotations: OnceLock::new(),
+			alphas: OnceLock::new(),
+			colors: OnceLock::new(),
+			spherical_harmonics: OnceLock::new(),
+			statistics: OnceLock::new(),
+		})
+	}
+
+	#[inline]
+	pub fn header(&self) -> &Header {
+		&self.header
+	}
+
+	#[inline]
+	pub fn mask(&self) -> AttributeMask {
+		self.mask
+	}
+
+	#[inline]
+	pub fn num_points(&self) -> usize {
+		self.header.num_points.max(0) as usize
+	}
+
+	/// Positions as (x, y, z), decoded on first access.
+	pub fn positions(&self) -> &[f32] {
+		self.positions.get_or_init(|| {
+			self.decode(AttributeMask::POSITIONS, 3, |view, dst| {
+				kernels::decode_positions(
+					view.positions,
+					dst,
+					view.fractional_bits,
+				);
+				gaussian_splat::apply_axis_flips(
+					&self.flips,
+					dst,
+					&mut [],
+					&mut [],
+					0,
+				);
+			})
+		})
+	}
+
+	/// Log-scales as (x, y, z), decoded on first access.
+	pub fn scales(&self) -> &[f32] {
+		self.scales.get_or_init(|| {
+			self.decode(AttributeMask::SCALES, 3, |view, dst| {
+				kernels::decode_scales(view.scales, dst);
+			})
+		})
+	}
+
+	/// Rotation quaternions as (x, y, z, w), decoded on first access.
+	pub fn rotations(&self) -> &[f32] {
+		self.rotations.get_or_init(|| {
+			self.decode(AttributeMask::ROTATIONS, 4, |view, dst| {
+				kernels::decode_rotations(
+					view.rotations,
+					dst,
+					view.uses_quaternion_smallest_three,
+				);
+				gaussian_splat::apply_axis_flips(
+					&self.flips,
+					&mut [],
+					dst,
+					&mut [],
+					0,
+				);
+			})
+		})
+	}
+
+	/// Opacities before the sigmoid, decoded on first access.
+	pub fn alphas(&self) -> &[f32] {
+		self.alphas.get_or_init(|| {
+			self.decode(AttributeMask::ALPHAS, 1, |view, dst| {
+				kernels::decode_alphas(view.alphas, dst);
+			})
+		})
+	}
+
+	/// Base colors as (r, g, b), decoded on first access.
+	pub fn colors(&self) -> &[f32] {
+		self.colors.get_or_init(|| {
+			self.decode(AttributeMask::COLORS, 3, |view, dst| {
+				kernels::decode_colors(view.colors, dst);
+			})
+		})
+	}
+
+	/// Spherical harmonics coefficients, decoded on first access up to
+	/// [`LoadOptions::max_sh_degree`].
+	pub fn spherical_harmonics(&self) -> &[f32] {
+		let sh_dim = dim_for_degree(self.header.spherical_harmonics_degree) as usize;
+		let kept_sh_dim = dim_for_degree(self.sh_degree) as usize;
+
+		self.spherical_harmonics.get_or_init(|| {
+			self.decode(
+				AttributeMask::SPHERICAL_HARMONICS,
+				kept_sh_dim * 3,
+				|view, dst| {
+					kernels::decode_spherical_harmonics_truncated(
+						view.spherical_harmonics,
+						dst,
+						sh_dim * 3,
+						kept_sh_dim * 3,
+					);
+					gaussian_splat::apply_axis_flips(
+						&self.flips,
+						&mut [],
+						&mut [],
+						dst,
+						kept_sh_dim,
+					);
+				},
+			)
+		})
+	}
+
+	/// Bounding box and median ellipsoid volume, computed from the quantized
+	/// data on first access, without decoding any attribute.
+	///
+	/// They are those of the whole splat, the mask doesn't apply.
+	pub fn statistics(&self) -> &Statistics {
+		self.statistics.get_or_init(|| {
+			Statistics::from_packed(
+				&self.sections.view(&self.decompressed),
+				&self.flips,
+			)
+		})
+	}
+
+	/// Bounding box of the positions, see [`LazyGaussianSplat::statistics`].
+	#[inline]
+	pub fn bbox(&self) -> BoundingBox {
+		self.statistics().bbox.clone()
+	}
+
+	/// Formats the header and statistics like
+	/// [`GaussianSplat::pretty_fmt`], without decoding any attribute.
+	pub fn pretty_fmt(&self) -> String {
+		stats::pretty_fmt(&self.header, self.statistics())
+	}
+
+	/// Decodes the remaining attributes and copies them into a
+	/// [`GaussianSplat`].
+	///
+	/// Attributes outside of the mask are left empty, a splat loaded without
+	/// spherical harmonics reports degree 0 and one loaded with fewer
+	/// degrees the degree it was decoded with.
+	pub fn to_gaussian_splat(&self) -> GaussianSplat {
+		let spherical_harmonics = self.spherical_harmonics().to_vec();
+		let spherical_harmonics_degree = if spherical_harmonics.is_empty() {
+			0
+		} else {
+			self.sh_degree
+		};
+
+		GaussianSplat {
+			header: Header {
+				num_points: self.header.num_points,
+				spherical_harmonics_degree,
+				fractional_bits: self.header.fractional_bits,
+				flags: self.header.flags,
+				..Default::default()
+			},
+			positions: self.positions().to_vec(),
+			scales: self.scales().to_vec(),
+			rotations: self.rotations().to_vec(),
+			alphas: self.alphas().to_vec(),
+			colors: self.colors().to_vec(),
+			spherical_harmonics,
+		}
+	}
+
+	/// Decodes one attribute of `stride` floats per point, or nothing if it
+	/// is outside of the mask.
+	fn decode<F>(&self, attribute: AttributeMask, stride: usize, decode: F) -> Vec<f32>
+	where
+		F: FnOnce(&PackedGaussianSplatView<'_>, &mut [f32]),
+	{
+		if !self.mask.contains(attribute) {
+			return Vec::new();
+		}
+		let view = self.sections.view(&self.decompressed);
+		let mut dst = vec![0_f32; (view.num_points.max(0) as usize).saturating_mul(stride)];
+
+		decode(&view, &mut dst);
+
+		dst
+	}
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+	use crate::{compression, gaussian_splat::SaveOptions, test_util::splat};
+
+	#[test]
+	fn test_lazy_matches_eager_decode() {
+		let bytes = splat(1000, 3)
+			.serialize_to_packed_bytes(&SaveOptions::default())
+			.unwrap();
+		let opts = LoadOptions::builder()
+			.coord_sys(CoordinateSystem::LeftUpFront)
+			.build();
+
+		let expected = GaussianSplat::read_from_bytes(&bytes, &opts).unwrap();
+		let lazy =
+			LazyGaussianSplat::from_bytes(&bytes, &opts, AttributeMask::all()).unwrap();
+
+		assert_eq!(lazy.num_points(), 1000);
+		assert_eq!(lazy.positions(), expected.positions.as_slice());
+		assert_eq!(lazy.bbox(), expected.bbox());
+		assert_eq!(lazy.to_gaussian_splat(), expected);
+	}
+
+	#[test]
+	fn test_lazy_masked_attributes_stay_empty() {
+		let bytes = splat(100, 3)
+			.serialize_to_packed_bytes(&SaveOptions::default())
+			.unwrap();
+		let lazy = LazyGaussianSplat::from_bytes(
+			&bytes,
+			&LoadOptions::default(),
+			AttributeMask::all() - AttributeMask::SPHERICAL_HARMONICS,
+		)
+		.unwrap();
+
+		assert!(lazy.spherical_harmonics().is_empty());
+		assert_eq!(lazy.rotations().len(), 400);
+
+		let splat = lazy.to_gaussian_splat();
+
+		assert_eq!(splat.header.spherical_harmonics_degree, 0);
+		assert!(splat.check_sizes());
+	}
+
+	#[test]
+	fn test_lazy_mask_skips_inflating_sections() {
+		let bytes = splat(1000, 3)
+			.serialize_to_packed_bytes(&SaveOptions::default())
+			.unwrap();
+		let opts = LoadOptions::default();
+		let whole =
+			LazyGaussianSplat::from_bytes(&bytes, &opts, AttributeMask::all()).unwrap();
+		let lazy = LazyGaussianSplat::from_bytes(
+			&bytes,
+			&opts,
+			AttributeMask::all() - AttributeMask::SPHERICAL_HARMONICS,
+		)
+		.unwrap();
+
+		// the spherical harmonics are the last section, and most of the data
+		assert!(lazy.decompressed.len() < whole.decompressed.len() / 2);
+		assert_eq!(lazy.positions(), whole.positions());
+		assert_eq!(lazy.rotations(), whole.rotations());
+		assert_eq!(lazy.statistics(), whole.statistics());
+
+		// the statistics still read the positions and scales
+		let lazy = LazyGaussianSplat::from_bytes(&bytes, &opts, AttributeMask::ALPHAS)
+			.unwrap();
+
+		assert_eq!(lazy.statistics(), whole.statistics());
+		assert_eq!(lazy.alphas(), whole.alphas());
+		assert!(lazy.decompressed.len() < whole.decompressed.len() / 2);
+	}
+
+	#[test]
+	fn test_lazy_honours_load_options_selection() {
+		let bytes = splat(100, 3)
+			.serialize_to_packed_bytes(&SaveOptions::default())
+			.unwrap();
+		let opts = LoadOptions::builder()
+			.max_sh_degree(1)
+			.attributes(AttributeMask::all() - AttributeMask::COLORS)
+			.build();
+		let lazy =
+			LazyGaussianSplat::from_bytes(&bytes, &opts, AttributeMask::all()).unwrap();
+
+		assert!(lazy.colors().is_empty());
+		assert_eq!(lazy.spherical_harmonics().len(), 100 * 9);
+		assert_eq!(
+			lazy.to_gaussian_splat(),
+			GaussianSplat::read_from_bytes(&bytes, &opts).unwrap()
+		);
+	}
+
+	#[test]
+	fn test_lazy_resolves_containers() {
+		let gs = splat(300, 3);
+		let save = SaveOptions::default();
+		let opts = LoadOptions::default();
+		let progressive =
+			crate::lod::serialize_progressive(&gs, &save, &Default::default()).unwrap();
+		let lazy = LazyGaussianSplat::from_bytes(&progressive, &opts, AttributeMask::all())
+			.unwrap();
+
+		assert_eq!(
+			lazy.to_gaussian_splat(),
+			GaussianSplat::read_from_bytes(&progressive, &opts).unwrap()
+		);
+
+		let chunked = crate::chunked::serialize_chunked(&gs, &save, 100).unwrap();
+
+		assert!(
+			LazyGaussianSplat::from_bytes(&chunked, &opts, AttributeMask::all())
+				.is_err()
+		);
+	}
+
+	#[test]
+	fn test_lazy_truncated_fails() {
+		let mut packed = splat(10, 3)
+			.to_packed_gaussians(&SaveOptions::default())
+			.unwrap()
+			.to_bytes_vec()
+			.unwrap();
+
+		packed.truncate(packed.len() / 2);
+
+		let mut gz = Vec::new();
+		compression::gzip::compress_bytes(&packed, &mut gz).unwrap();
+
+		assert!(LazyGaussianSplat::from_bytes(
+			&gz,
+			&LoadOptions::default(),
+			AttributeMask::all()
+		)
+		.is_err());
+	}
+}
@@ -5,22 +5,59 @@
 #![deny(clippy::undocumented_unsafe_blocks)]
 #![deny(unsafe_op_in_unsafe_fn)]
 
+pub mod batch;
+pub mod cache;
+pub mod chunked;
 pub mod compression;
 pub mod consts;
+pub mod container;
 pub mod coord;
+pub mod decoder;
 pub mod gaussian_splat;
 pub mod header;
+pub mod incremental;
+pub mod instrument;
+pub mod kernels;
+pub mod layout;
+pub mod lazy;
+pub mod lod;
 pub mod math;
 pub mod mmap;
 pub mod packed;
+pub mod parallel;
+pub mod spatial;
+pub mod stats;
+pub mod stream;
+#[cfg(any(test, feature = "test-util"))]
+#[doc(hidden)]
+pub mod test_util;
+pub mod transcode;
 pub mod unpacked;
 
 pub mod prelude {
 	pub use super::*;
 
+	pub use super::batch::{BatchLoader, LoadPool};
+	pub use super::cache::CachedGaussianSplat;
+	pub use super::chunked::{ChunkInfo, ChunkedSpz};
+	pub use super::compression::{Codec, CompressionLevel};
 	pub use super::coord::{AxisFlips, CoordinateSystem};
-	pub use super::gaussian_splat::{BoundingBox, GaussianSplat, LoadOptions, SaveOptions};
+	pub use super::decoder::Decoder;
+	pub use super::gaussian_splat::{
+		AttributeBuffersMut, AttributeLens, AttributeMask, BoundingBox, GaussianSplat,
+		LoadOptions, SaveOptions,
+	};
 	pub use super::header::Header;
-	pub use super::packed::{PackedGaussian, PackedGaussianSplat};
+	pub use super::incremental::{SpzEditor, SpzWriter};
+	pub use super::instrument::{LoadStats, Stage, StageStats};
+	pub use super::layout::{Activation, Layout, SplatF16, SplatF32, SplatQuantized};
+	pub use super::lazy::LazyGaussianSplat;
+	pub use super::lod::{LodOptions, ProgressiveReader};
+	pub use super::packed::{
+		PackedGaussian, PackedGaussianSplat, PackedGaussianSplatView, PackedGaussians,
+		PointOrder,
+	};
+	pub use super::spatial::{Frustum, SpatialIndex};
+	pub use super::stats::Statistics;
 	pub use super::unpacked::UnpackedGaussian;
 }
@@ -0,0 +1,905 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+//! Levels of detail and progressive SPZ files.
+//!
+//! [`coarsen`] reduces a splat to fewer, larger gaussians by merging those
+//! that share a cell of an octree over the Morton order, then pruning the
+//! least important merged gaussians, importance being opacity times volume.
+//!
+//! A progressive file stores such levels coarse to fine, the last one the
+//! full splat, each a complete, independently compressed SPZ stream. A
+//! [`ProgressiveReader`] surfaces a usable splat once the first, small level
+//! has arrived and refines it with every further level:
+//!
+//! | Bytes     | Content                                   |
+//! |-----------|-------------------------------------------|
+//! | 16        | [`MAGIC`], version, levels, reserved      |
+//! | 16 each   | level entry: compressed length, points    |
+//! | remaining | the compressed levels, coarsest first     |
+//!
+//! With the default [`LodOptions`] the coarser levels add about a third to
+//! the size of the file.
+
+use std::io::Read;
+use std::path::Path;
+
+use anyhow::{Context, Result, bail};
+use likely_stable::unlikely;
+use zerocopy::{FromBytes, Immutable, IntoBytes, KnownLayout};
+
+use crate::{
+	decoder::Decoder,
+	gaussian_splat::{BoundingBox, GaussianSplat, LoadOptions, SaveOptions},
+	header::Header,
+	math::{self, MORTON_BITS, dim_for_degree, morton_encode},
+};
+
+/// Magic bytes starting a progressive SPZ file.
+pub const MAGIC: [u8; 4] = *b"SPZL";
+
+/// The container version written by this crate.
+pub const VERSION: u32 = 1;
+
+/// Most levels a progressive file may hold.
+pub const MAX_LEVELS: usize = 32;
+
+static_assertions::const_assert_eq!(16, size_of::<RawHeader>());
+static_assertions::const_assert_eq!(16, size_of::<RawEntry>());
+
+#[derive(Clone, Copy, Debug, FromBytes, IntoBytes, Immutable, KnownLayout)]
+#[repr(C)]
+struct RawHeader {
+	magic: [u8; 4],
+	version: u32,
+	num_levels: u32,
+	reserved: u32,
+}
+
+#[derive(Clone, Copy, Debug, Default, FromBytes, IntoBytes, Immutable, KnownLayout)]
+#[repr(C)]
+struct RawEntry {
+	len: u64,
+	num_points: u32,
+	reserved: u32,
+}
+
+/// How many levels to build and how quickly they shrink.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct LodOptions {
+	/// Number of levels including the full splat, at least 1. Defaults to 4.
+	pub levels: usize,
+	/// Each level has at most `1 / ratio` of the points of the next finer
+	/// one, at least 2. Defaults to 4.
+	pub ratio: usize,
+	/// No level is built below this many points, which may leave fewer
+	/// levels. Defaults to 1024.
+	pub min_points: usize,
+}
+
+impl Default for LodOptions {
+	#[inline]
+	fn default() -> Self {
+		Self {
+			levels: 4,
+			ratio: 4,
+			min_points: 1024,
+		}
+	}
+}
+
+/// One level of a progressive file.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct LevelInfo {
+	/// Bytes of the compressed level.
+	pub len: usize,
+	pub num_points: usize,
+}
+
+/// Whether `bytes` start like a progressive SPZ file.
+#[inline]
+pub fn is_progressive(bytes: &[u8]) -> bool {
+	bytes.starts_with(&MAGIC)
+}
+
+/// Reduces `splat` to at most `target_points` gaussians.
+///
+/// The splat is returned unchanged when it is small enough already. The
+/// merged gaussians are axis aligned and hold the opacity times volume of
+/// the gaussians they replace; the output is in Morton order.
+///
+/// # Args
+///
+/// `splat` - the splat to reduce.
+/// `target_points` - upper bound of points of the result, at least 1.
+pub fn coarsen(splat: &GaussianSplat, target_points: usize) -> Result<GaussianSplat> {
+	if unlikely(!splat.check_sizes()) {
+		bail!("inconsistent sizes");
+	}
+	if unlikely(target_points == 0) {
+		bail!("invalid number of target points: 0");
+	}
+	if splat.header.num_points as usize <= target_points {
+		return Ok(splat.clone());
+	}
+	Ok(Clusters::new(splat).coarsen(splat, target_points))
+}
+
+/// Builds the coarser levels of `splat`, coarsest first; the splat itself is
+/// the finest level.
+///
+/// Every level is reduced from the full splat, not from the next finer
+/// level, so errors don't add up.
+///
+/// # Args
+///
+/// `splat` - the full splat.
+/// `opts` - number and sizes of the levels.
+pub fn build_levels(splat: &GaussianSplat, opts: &LodOptions) -> Result<Vec<GaussianSplat>> {
+	if unlikely(!splat.check_sizes()) {
+		bail!("inconsistent sizes");
+	}
+	if unlikely(opts.levels == 0 || opts.levels > MAX_LEVELS || opts.ratio < 2) {
+		bail!("invalid level of detail options: {opts:?}");
+	}
+	let mut targets = Vec::with_capacity(opts.levels - 1);
+	let mut target = splat.header.num_points as usize;
+
+	for _ in 1..opts.levels {
+		target /= opts.ratio;
+
+		if target < opts.min_points.max(1) {
+			break;
+		}
+		targets.push(target);
+	}
+	if targets.is_empty() {
+		return Ok(Vec::new());
+	}
+	let clusters = Clusters::new(splat);
+
+	Ok(targets
+		.iter()
+		.rev()
+		.map(|&target| clusters.coarsen(splat, target))
+		.collect())
+}
+
+/// Serializes `splat` and its coarser levels into a progressive file.
+///
+/// # Args
+///
+/// `splat` - the splat to write, the finest level.
+/// `opts` - options for saving each level.
+/// `lod` - number and sizes of the levels.
+pub fn serialize_progressive(
+	splat: &GaussianSplat,
+	opts: &SaveOptions,
+	lod: &LodOptions,
+) -> Result<Vec<u8>> {
+	let levels = build_levels(splat, lod)?;
+	let payloads = levels
+		.iter()
+		.chain(std::iter::once(splat))
+		.map(|level| level.serialize_to_packed_bytes(opts))
+		.collect::<Result<Vec<_>>>()?;
+
+	let index_len = payloads.len() * size_of::<RawEntry>();
+	let data_len = payloads.iter().map(Vec::len).sum::<usize>();
+	let mut out = Vec::with_capacity(size_of::<RawHeader>() + index_len + data_len);
+
+	out.extend_from_slice(
+		RawHeader {
+			magic: MAGIC,
+			version: VERSION,
+			num_levels: payloads.len() as u32,
+			reserved: 0,
+		}
+		.as_bytes(),
+	);
+	for (level, payload) in levels.iter().chain(std::iter::once(splat)).zip(&payloads) {
+		out.extend_from_slice(
+			RawEntry {
+				len: payload.len() as u64,
+				num_points: level.header.num_points as u32,
+				reserved: 0,
+			}
+			.as_bytes(),
+		);
+	}
+	for payload in &payloads {
+		out.extend_from_slice(payload);
+	}
+	Ok(out)
+}
+
+/// Writes `splat` to a progressive file, see [`serialize_progressive`].
+///
+/// # Args
+///
+/// `splat` - the splat to write, the finest level.
+/// `filepath` - file path to save the progressive file to.
+/// `opts` - options for saving each level.
+/// `lod` - number and sizes of the levels.
+pub fn save_progressive<F>(
+	splat: &GaussianSplat,
+	filepath: F,
+	opts: &SaveOptions,
+	lod: &LodOptions,
+) -> Result<()>
+where
+	F: AsRef<Path>,
+{
+	let bytes = serialize_progressive(splat, opts, lod)?;
+
+	std::fs::write(filepath, bytes).with_context(|| "unable to write to file")
+}
+
+/// Decodes the finest level of a progressive file held in memory, skipping
+/// the coarser ones.
+///
+/// # Args
+///
+/// `bytes` - the whole progressive file.
+/// `opts` - options for loading the splat.
+pub fn read_finest_from_bytes(bytes: &[u8], opts: &LoadOptions) -> Result<GaussianSplat> {
+	Decoder::new().decode(finest_level(bytes)?, opts)
+}
+
+/// Borrows the compressed finest level of a progressive file held in
+/// memory.
+///
+/// Levels are plain SPZ streams, one that is a chunked or progressive file
+/// itself is rejected rather than unpacked, so crafted files can't nest
+/// containers without bound.
+///
+/// # Args
+///
+/// `bytes` - the whole progressive file.
+pub fn finest_level(bytes: &[u8]) -> Result<&[u8]> {
+	let (header, rest) = RawHeader::read_from_prefix(bytes)
+		.map_err(|_| anyhow::anyhow!("progressive header is truncated"))?;
+	let levels = parse_index(&header, rest)?;
+	let (finest, coarser) = levels
+		.split_last()
+		.ok_or_else(|| anyhow::anyhow!("progressive file has no levels"))?;
+	let start = coarser
+		.iter()
+		.try_fold(
+			size_of::<RawHeader>() + levels.len() * size_of::<RawEntry>(),
+			|start, level| start.checked_add(level.len),
+		)
+		.and_then(|start| Some(start..start.checked_add(finest.len)?));
+
+	let Some(level) = start.and_then(|range| bytes.get(range)) else {
+		bail!("finest level is truncated");
+	};
+	if unlikely(is_progressive(level) || crate::chunked::is_chunked(level)) {
+		bail!("finest level is not an SPZ stream");
+	}
+	Ok(level)
+}
+
+/// Validates the header and reads the index entries following it.
+fn parse_index(header: &RawHeader, index: &[u8]) -> Result<Vec<LevelInfo>> {
+	if unlikely(header.magic != MAGIC) {
+		bail!("not a progressive SPZ file");
+	}
+	if unlikely(header.version != VERSION) {
+		bail!("unsupported progressive SPZ version: {}", header.version);
+	}
+	let num_levels = header.num_levels as usize;
+
+	if unlikely(num_levels == 0 || num_levels > MAX_LEVELS) {
+		bail!("invalid number of levels: {num_levels}");
+	}
+	if unlikely(index.len() / size_of::<RawEntry>() < num_levels) {
+		bail!("level index is truncated");
+	}
+	index.chunks_exact(size_of::<RawEntry>())
+		.take(num_levels)
+		.map(|entry| {
+			let entry = RawEntry::read_from_bytes(entry)
+				.map_err(|_| anyhow::anyhow!("invalid level index entry"))?;
+			let Ok(len) = usize::try_from(entry.len) else {
+				bail!("level is too large: {} bytes", entry.len);
+			};
+			Ok(LevelInfo {
+				len,
+				num_points: entry.num_points as usize,
+			})
+		})
+		.collect()
+}
+
+/// Reads a progressive file level by level, as its bytes arrive.
+///
+/// Each level is decoded into a complete [`GaussianSplat`], replacing the
+/// coarser one. As an iterator it yields the levels coarsest first and
+/// stops after the first error.
+#[derive(Debug)]
+pub struct ProgressiveReader<R> {
+	reader: R,
+	opts: LoadOptions,
+	levels: Vec<LevelInfo>,
+	next: usize,
+	compressed: Vec<u8>,
+	decoder: Decoder,
+}
+
+impl<R> ProgressiveReader<R>
+where
+	R: Read,
+{
+	/// Reads the header and level index from `reader`, nothing else.
+	///
+	/// # Args
+	///
+	/// `reader` - source of the progressive file, e.g. a socket.
+	/// `opts` - options for loading every level.
+	pub fn new(mut reader: R, opts: LoadOptions) -> Result<Self> {
+		let mut header = [0_u8; size_of::<RawHeader>()];
+
+		reader.read_exact(&mut header)
+			.with_context(|| "progressive header is truncated")?;
+
+		let header = RawHeader::read_from_bytes(&header)
+			.map_err(|_| anyhow::anyhow!("invalid progressive header"))?;
+		let num_levels = (header.num_levels as usize).min(MAX_LEVELS);
+		let mut index = vec![0_u8; num_levels * size_of::<RawEntry>()];
+
+		if header.magic == MAGIC {
+			reader.read_exact(&mut index)
+				.with_context(|| "level index is truncated")?;
+		}
+		let levels = parse_index(&header, &index)?;
+
+		Ok(Self {
+			reader,
+			opts,
+			levels,
+			next: 0,
+			compressed: Vec::new(),
+			decoder: Decoder::new(),
+		})
+	}
+
+	/// Every level of the file, coarsest first.
+	#[inline]
+	pub fn levels(&self) -> &[LevelInfo] {
+		&self.levels
+	}
+
+	/// Number of levels read so far.
+	#[inline]
+	pub fn levels_read(&self) -> usize {
+		self.next
+	}
+
+	/// Reads the next level and decodes it into `splat`, replacing its
+	/// contents and reusing its buffers.
+	///
+	/// # Returns
+	///
+	/// `false` once every level has been read, `splat` is left untouched
+	/// then. On error `splat` is unspecified and no further level is read.
+	pub fn next_level_into(&mut self, splat: &mut GaussianSplat) -> Result<bool> {
+		let Some(level) = self.levels.get(self.next).copied() else {
+			return Ok(false);
+		};
+		let index = self.next;
+		let result = self.read_level(level, splat);
+
+		self.next = if result.is_ok() {
+			index + 1
+		} else {
+			self.levels.len()
+		};
+		result.with_context(|| format!("unable to read level {index}"))?;
+
+		Ok(true)
+	}
+
+	/// Reads and decodes the next level, `None` once every level has been
+	/// read.
+	pub fn next_level(&mut self) -> Result<Option<GaussianSplat>> {
+		let mut splat = GaussianSplat::default();
+
+		Ok(self.next_level_into(&mut splat)?.then_some(splat))
+	}
+
+	fn read_level(&mut self, level: LevelInfo, splat: &mut GaussianSplat) -> Result<()> {
+		self.compressed.clear();
+
+		// grows with the bytes that actually arrive, not the claimed length
+		(&mut self.reader)
+			.take(level.len as u64)
+			.read_to_end(&mut self.compressed)?;
+
+		if unlikely(self.compressed.len() != level.len) {
+			bail!(
+				"level is truncated: {} of {} bytes",
+				self.compressed.len(),
+				level.len
+			);
+		}
+		// levels are plain streams, never containers themselves
+		self.decoder
+			.decode_stream_into(&self.compressed, &self.opts, splat)?;
+
+		if unlikely(splat.header.num_points as usize != level.num_points) {
+			bail!(
+				"level holds {} points, the index {}",
+				splat.header.num_points,
+				level.num_points
+			);
+		}
+		Ok(())
+	}
+}
+
+impl<R> Iterator for ProgressiveReader<R>
+where
+	R: Read,
+{
+	type Item = Result<GaussianSplat>;
+
+	#[inline]
+	fn next(&mut self) -> Option<Self::Item> {
+		self.next_level().transpose()
+	}
+}
+
+/// The points of a splat sorted along a Morton curve, shared by all the
+/// levels built from it.
+struct Clusters {
+	/// Sorted Morton codes.
+	codes: Vec<u64>,
+	/// Point index per code.
+	order: Vec<u32>,
+}
+
+impl Clusters {
+	fn new(splat: &GaussianSplat) -> Self {
+		let bbox = BoundingBox::from_positions(&splat.positions);
+		let (sx, sy, sz) = bbox.size();
+		let size = sx.max(sy).max(sz);
+		let max_cell = ((1_u32 << MORTON_BITS) - 1) as f32;
+		// cubic cells, so merged gaussians stay round
+		let cell = |v: f32, min: f32| {
+			if size > 0.0 {
+				((v - min) / size * max_cell) as u32
+			} else {
+				0
+			}
+		};
+		let mut keyed: Vec<(u64, u32)> = splat
+			.positions
+			.chunks_exact(3)
+			.enumerate()
+			.map(|(i, p)| {
+				let code = morton_encode(
+					cell(p[0], bbox.min_x),
+					cell(p[1], bbox.min_y),
+					cell(p[2], bbox.min_z),
+				);
+				(code, i as u32)
+			})
+			.collect();
+
+		keyed.sort_unstable();
+
+		let (codes, order) = keyed.into_iter().unzip();
+
+		Self { codes, order }
+	}
+
+	/// Number of octree cells holding points when cells span `shift` bits
+	/// of the codes.
+	fn count_cells(&self, shift: u32) -> usize {
+		let cells = self
+			.codes
+			.windows(2)
+			.filter(|pair| pair[0] >> shift != pair[1] >> shift)
+			.count();
+
+		cells + usize::from(!self.codes.is_empty())
+	}
+
+	fn coarsen(&self, splat: &GaussianSplat, target_points: usize) -> GaussianSplat {
+		// the coarsest cut of the octree with at least the target cells
+		let shift = (0..=3 * MORTON_BITS)
+			.step_by(3)
+			.take_while(|&shift| self.count_cells(shift) >= target_points)
+			.last()
+			.unwrap_or(0);
+		let sh_dim = dim_for_degree(splat.header.spherical_harmonics_degree) as usize * 3;
+		let mut merged = Merged::with_capacity(self.count_cells(shift), sh_dim);
+		let mut start = 0;
+
+		while start < self.codes.len() {
+			let cell = self.codes[start] >> shift;
+			let end = start + self.codes[start..]
+				.iter()
+				.take_while(|&&code| code >> shift == cell)
+				.count();
+
+			merged.push(splat, &self.order[start..end], sh_dim);
+			start = end;
+		}
+		merged.prune(target_points, sh_dim);
+
+		GaussianSplat {
+			header: Header {
+				num_points: merged.importance.len() as i32,
+				..splat.header
+			},
+			positions: merged.positions,
+			scales: merged.scales,
+			rotations: merged.rotations,
+			alphas: merged.alphas,
+			colors: merged.colors,
+			spherical_harmonics: merged.spherical_harmonics,
+		}
+	}
+}
+
+/// Attributes of the merged gaussians, with their importance.
+#[derive(Default)]
+struct Merged {
+	positions: Vec<f32>,
+	scales: Vec<f32>,
+	rotations: Vec<f32>,
+	alphas: Vec<f32>,
+	colors: Vec<f32>,
+	spherical_harmonics: Vec<f32>,
+	/// Opacity times volume, up to a constant.
+	importance: Vec<f32>,
+}
+
+impl Merged {
+	fn with_capacity(num_points: usize, sh_dim: usize) -> Self {
+		Self {
+			positions: Vec::with_capacity(num_points * 3),
+			scales: Vec::with_capacity(num_points * 3),
+			rotations: Vec::with_capacity(num_points * 4),
+			alphas: Vec::with_capacity(num_points),
+			colors: Vec::with_capacity(num_points * 3),
+			spherical_harmonics: Vec::with_capacity(num_points * sh_dim),
+			importance: Vec::with_capacity(num_points),
+		}
+	}
+
+	/// Appends the gaussian replacing the points `members` of `splat`.
+	fn push(&mut self, splat: &GaussianSplat, members: &[u32], sh_dim: usize) {
+		let opacity = |i: usize| math::sigmoid(splat.alphas[i]);
+		// ellipsoid volume without the 4/3 pi, see `median_volume`
+		let volume = |i: usize| splat.scales[i * 3..i * 3 + 3].iter().sum::<f32>().exp();
+
+		if let [i] = *members {
+			let i = i as usize;
+
+			self.positions
+				.extend_from_slice(&splat.positions[i * 3..i * 3 + 3]);
+			self.scales
+				.extend_from_slice(&splat.scales[i * 3..i * 3 + 3]);
+			self.rotations
+				.extend_from_slice(&splat.rotations[i * 4..i * 4 + 4]);
+			self.alphas.push(splat.alphas[i]);
+			self.colors
+				.extend_from_slice(&splat.colors[i * 3..i * 3 + 3]);
+			self.spherical_harmonics.extend_from_slice(
+				&splat.spherical_harmonics[i * sh_dim..(i + 1) * sh_dim],
+			);
+			self.importance.push(opacity(i) * volume(i));
+			return;
+		}
+		let weights: Vec<f32> = members
+			.iter()
+			.map(|&i| {
+				let w = opacity(i as usize) * volume(i as usize);
+
+				if w.is_finite() { w } else { 0.0 }
+			})
+			.collect();
+		let total: f32 = weights.iter().sum();
+		// fully transparent or degenerate members count alike
+		let (weights, total) = if total > 0.0 {
+			(weights, total)
+		} else {
+			(vec![1.0; members.len()], members.len() as f32)
+		};
+		let mean = |src: &[f32], stride: usize, k: usize| -> f32 {
+			members.iter()
+				.zip(&weights)
+				.map(|(&i, w)| src[i as usize * stride + k] * w)
+				.sum::<f32>() / total
+		};
+		let center = [0, 1, 2].map(|k| mean(&splat.positions, 3, k));
+
+		// diagonal of the covariance of the mixture, axis aligned
+		let mut variance = [0.0_f32; 3];
+
+		for (&i, w) in members.iter().zip(&weights) {
+			let i = i as usize;
+			let rotation = rotation_matrix(&splat.rotations[i * 4..i * 4 + 4]);
+			let scale = [0, 1, 2].map(|k| (2.0 * splat.scales[i * 3 + k]).exp());
+
+			for k in 0..3 {
+				let spread: f32 =
+					(0..3).map(|j| rotation[k][j].powi(2) * scale[j]).sum();
+				let offset = splat.positions[i * 3 + k] - center[k];
+
+				variance[k] += w * (spread + offset * offset);
+			}
+		}
+		let sigma = variance.map(|v| (v / total).sqrt().max(1e-7));
+		let merged_volume = sigma[0] * sigma[1] * sigma[2];
+		let mass: f32 = members
+			.iter()
+			.map(|&i| opacity(i as usize) * volume(i as usize))
+			.filter(|m| m.is_finite())
+			.sum();
+		let alpha = (mass / merged_volume).clamp(0.0, 1.0);
+
+		self.positions.extend_from_slice(&center);
+		self.scales.extend(sigma.map(f32::ln));
+		self.rotations.extend_from_slice(&[0.0, 0.0, 0.0, 1.0]);
+		self.alphas.push(math::inv_sigmoid(alpha));
+		self.colors
+			.extend((0..3).map(|k| mean(&splat.colors, 3, k)));
+		self.spherical_harmonics
+			.extend((0..sh_dim).map(|k| mean(&splat.spherical_harmonics, sh_dim, k)));
+		self.importance.push(alpha * merged_volume);
+	}
+
+	/// Keeps the `target_points` most important gaussians, in their order.
+	fn prune(&mut self, target_points: usize, sh_dim: usize) {
+		let num_points = self.importance.len();
+
+		if num_points <= target_points {
+			return;
+		}
+		let mut keep: Vec<u32> = (0..num_points as u32).collect();
+
+		keep.select_nth_unstable_by(target_points, |&a, &b| {
+			self.importance[b as usize].total_cmp(&self.importance[a as usize])
+		});
+		keep.truncate(target_points);
+		keep.sort_unstable();
+
+		let gather = |src: &mut Vec<f32>, stride: usize| {
+			*src = keep
+				.iter()
+				.flat_map(|&i| &src[i as usize * stride..(i as usize + 1) * stride])
+				.copied()
+				.collect();
+		};
+		gather(&mut self.positions, 3);
+		gather(&mut self.scales, 3);
+		gather(&mut self.rotations, 4);
+		gather(&mut self.alphas, 1);
+		gather(&mut self.colors, 3);
+		gather(&mut self.spherical_harmonics, sh_dim);
+		gather(&mut self.importance, 1);
+	}
+}
+
+/// Rotation matrix of an `(x, y, z, w)` quaternion, normalized first.
+#[inline]
+fn rotation_matrix(q: &[f32]) -> [[f32; 3]; 3] {
+	let [x, y, z, w] = math::normalize_quaternion(&[q[0], q[1], q[2], q[3]]);
+
+	[
+		[
+			1.0 - 2.0 * (y * y + z * z),
+			2.0 * (x * y - z * w),
+			2.0 * (x * z + y * w),
+		],
+		[
+			2.0 * (x * y + z * w),
+			1.0 - 2.0 * (x * x + z * z),
+			2.0 * (y * z - x * w),
+		],
+		[
+			2.0 * (x * z - y * w),
+			2.0 * (y * z + x * w),
+			1.0 - 2.0 * (x * x + y * y),
+		],
+	]
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+
+	/// Points on a 40 x 40 x 10 grid, 0.1 apart, with colors smooth in x.
+	fn splat() -> GaussianSplat {
+		let num_points = 16_000;
+
+		GaussianSplat {
+			header: Header {
+				num_points: num_points as i32,
+				spherical_harmonics_degree: 1,
+				..Default::default()
+			},
+			positions: (0..num_points)
+				.flat_map(|i| {
+					[(i % 40) as f32, (i / 40 % 40) as f32, (i / 1600) as f32]
+						.map(|v| v / 10.0)
+				})
+				.collect(),
+			scales: vec![(0.05_f32).ln(); num_points * 3],
+			rotations: (0..num_points).flat_map(|_| [0.0, 0.0, 0.0, 1.0]).collect(),
+			alphas: vec![0.0; num_points],
+			colors: (0..num_points)
+				.flat_map(|i| [(i % 40) as f32 / 40.0, 0.5, 0.25])
+				.collect(),
+			spherical_harmonics: vec![0.1; num_points * 9],
+		}
+	}
+
+	#[test]
+	fn test_coarsen_merges_and_prunes() {
+		let gs = splat();
+		let bbox = gs.bbox();
+
+		assert_eq!(coarsen(&gs, 100_000).unwrap(), gs);
+
+		for target in [4000, 1000, 10] {
+			let coarse = coarsen(&gs, target).unwrap();
+
+			assert!(coarse.check_sizes());
+			assert!(coarse.header.num_points as usize <= target);
+			assert!(coarse.header.num_points as usize > target / 8);
+
+			// merged gaussians grow and stay within the scene
+			assert!(coarse.median_volume() > gs.median_volume());
+
+			let coarse_bbox = coarse.bbox();
+
+			assert!(coarse_bbox.min_x >= bbox.min_x && coarse_bbox.max_x <= bbox.max_x);
+			assert!(coarse_bbox.min_z >= bbox.min_z && coarse_bbox.max_z <= bbox.max_z);
+
+			// colors are averaged, so they stay in range
+			assert!(coarse.colors.iter().all(|c| (0.0..=1.0).contains(c)));
+			assert!(coarse
+				.spherical_harmonics
+				.iter()
+				.all(|sh| (sh - 0.1).abs() < 1e-5));
+		}
+		assert!(coarsen(&gs, 0).is_err());
+	}
+
+	#[test]
+	fn test_build_levels_coarse_to_fine() {
+		let gs = splat();
+		// 16000 / 4^2 = 1000 is below the default minimum
+		assert_eq!(build_levels(&gs, &LodOptions::default()).unwrap().len(), 1);
+
+		let lod = LodOptions {
+			min_points: 100,
+			..Default::default()
+		};
+		let levels = build_levels(&gs, &lod).unwrap();
+		let points: Vec<i32> = levels.iter().map(|l| l.header.num_points).collect();
+
+		assert_eq!(levels.len(), 3);
+		assert!(points[0] <= 250 && points[1] <= 1000 && points[2] <= 4000);
+		assert!(points.windows(2).all(|pair| pair[0] < pair[1]));
+
+		assert!(build_levels(
+			&gs,
+			&LodOptions {
+				ratio: 1,
+				..Default::default()
+			}
+		)
+		.is_err());
+	}
+
+	#[test]
+	fn test_progressive_roundtrip() {
+		let gs = splat();
+		let opts = SaveOptions::default();
+		let lod = LodOptions {
+			min_points: 500,
+			..Default::default()
+		};
+		let bytes = serialize_progressive(&gs, &opts, &lod).unwrap();
+		let expected = GaussianSplat::read_from_bytes(
+			&gs.serialize_to_packed_bytes(&opts).unwrap(),
+			&LoadOptions::default(),
+		)
+		.unwrap();
+
+		assert!(is_progressive(&bytes));
+		assert_eq!(
+			GaussianSplat::read_from_bytes(&bytes, &LoadOptions::default()).unwrap(),
+			expected
+		);
+
+		let reader =
+			ProgressiveReader::new(bytes.as_slice(), LoadOptions::default()).unwrap();
+		let infos = reader.levels().to_vec();
+		let levels = reader.collect::<Result<Vec<_>>>().unwrap();
+
+		assert_eq!(levels.len(), 3);
+		assert_eq!(levels.last(), Some(&expected));
+
+		for (level, info) in levels.iter().zip(&infos) {
+			assert_eq!(level.header.num_points as usize, info.num_points);
+		}
+
+		// a cut off stream still yields the levels that arrived
+		let cut = bytes.len() - infos[2].len / 2;
+		let mut reader =
+			ProgressiveReader::new(&bytes[..cut], LoadOptions::default()).unwrap();
+		let mut splat = GaussianSplat::default();
+
+		assert!(reader.next_level_into(&mut splat).unwrap());
+		assert!(reader.next_level_into(&mut splat).unwrap());
+		assert_eq!(splat.header.num_points as usize, infos[1].num_points);
+		assert!(reader.next_level_into(&mut splat).is_err());
+		assert!(!reader.next_level_into(&mut splat).unwrap());
+
+		assert!(ProgressiveReader::new(&bytes[..8], LoadOptions::default()).is_err());
+	}
+
+	/// A progressive file of `levels`, with the index entries given.
+	fn container(entries: &[RawEntry], levels: &[u8]) -> Vec<u8> {
+		let mut out = RawHeader {
+			magic: MAGIC,
+			version: VERSION,
+			num_levels: entries.len() as u32,
+			reserved: 0,
+		}
+		.as_bytes()
+		.to_vec();
+
+		for entry in entries {
+			out.extend_from_slice(entry.as_bytes());
+		}
+		out.extend_from_slice(levels);
+		out
+	}
+
+	#[test]
+	fn test_malformed_progressive_fails() {
+		let plain = splat()
+			.serialize_to_packed_bytes(&SaveOptions::default())
+			.unwrap();
+		let entry = |len: usize| RawEntry {
+			len: len as u64,
+			num_points: 16_000,
+			reserved: 0,
+		};
+
+		let progressive = container(&[entry(plain.len())], &plain);
+
+		assert!(read_finest_from_bytes(&progressive, &LoadOptions::default()).is_ok());
+
+		// a level that is a container itself isn't unpacked, however deep
+		for inner in [
+			progressive.clone(),
+			crate::chunked::serialize_chunked(&splat(), &SaveOptions::default(), 4000)
+				.unwrap(),
+		] {
+			let nested = container(&[entry(inner.len())], &inner);
+
+			assert!(finest_level(&nested).is_err());
+			assert!(
+				GaussianSplat::read_from_bytes(&nested, &LoadOptions::default())
+					.is_err()
+			);
+		}
+
+		// offsets past the end of the address space
+		let overflowing = container(&[entry(usize::MAX), entry(plain.len())], &plain);
+
+		assert!(finest_level(&overflowing).is_err());
+
+		let overflowing = container(&[entry(usize::MAX - 16)], &plain);
+
+		assert!(finest_level(&overflowing).is_err());
+	}
+}
@@ -2,6 +2,8 @@
 
 use std::f32::consts::FRAC_1_SQRT_2;
 
+use likely_stable::unlikely;
+
 #[inline]
 pub fn degree_for_dim(dim: u8) -> u8 {
 	if dim < 3 {
@@ -185,6 +187,133 @@ pub fn to_u8(x: f32) -> u8 {
 	x.clamp(0.0, 255.0).round() as u8
 }
 
+/// Bits per axis of a [`morton_encode`] code.
+pub const MORTON_BITS: u32 = 21;
+
+/// Interleaves the low [`MORTON_BITS`] bits of `x`, `y` and `z` into a
+/// Z-order (Morton) code, `x` in the lowest bit.
+#[inline]
+pub fn morton_encode(x: u32, y: u32, z: u32) -> u64 {
+	spread_bits(x) | (spread_bits(y) << 1) | (spread_bits(z) << 2)
+}
+
+/// Moves bit `i` of the low 21 bits of `v` to bit `3 * i`.
+#[inline]
+fn spread_bits(v: u32) -> u64 {
+	let mut v = u64::from(v) & 0x1f_ffff;
+
+	v = (v | v << 32) & 0x001f_0000_0000_ffff;
+	v = (v | v << 16) & 0x001f_0000_ff00_00ff;
+	v = (v | v << 8) & 0x100f_00f0_0f00_f00f;
+	v = (v | v << 4) & 0x10c3_0c30_c30c_30c3;
+	v = (v | v << 2) & 0x1249_2492_4924_9249;
+	v
+}
+
+/// Index of the cell `(x, y, z)` along a Hilbert curve over
+/// [`MORTON_BITS`] bits per axis.
+///
+/// Unlike Morton codes, consecutive indices are always neighbouring cells.
+/// Uses Skilling's transpose, "Programming the Hilbert curve" (2004).
+pub fn hilbert_encode(x: u32, y: u32, z: u32) -> u64 {
+	let mask = (1_u32 << MORTON_BITS) - 1;
+	let mut axes = [x & mask, y & mask, z & mask];
+
+	// undo the excess work of the Gray code, from the top bit down
+	let mut q = 1_u32 << (MORTON_BITS - 1);
+
+	while q > 1 {
+		let p = q - 1;
+
+		for i in 0..3 {
+			if axes[i] & q != 0 {
+				axes[0] ^= p;
+			} else {
+				let t = (axes[0] ^ axes[i]) & p;
+
+				axes[0] ^= t;
+				axes[i] ^= t;
+			}
+		}
+		q >>= 1;
+	}
+
+	// Gray encode
+	axes[1] ^= axes[0];
+	axes[2] ^= axes[1];
+
+	let mut t = 0;
+	let mut q = 1_u32 << (MORTON_BITS - 1);
+
+	while q > 1 {
+		if axes[2] & q != 0 {
+			t ^= q - 1;
+		}
+		q >>= 1;
+	}
+	for axis in &mut axes {
+		*axis ^= t;
+	}
+
+	// the first axis holds the most significant bit of every triple
+	morton_encode(axes[2], axes[1], axes[0])
+}
+
+/// Converts `x` to the bits of an IEEE 754 half, rounding to nearest even.
+///
+/// Values out of the half range become infinities, NaNs stay NaNs.
+pub fn f32_to_f16(x: f32) -> u16 {
+	let bits = x.to_bits();
+	let sign = ((bits >> 16) & 0x8000) as u16;
+	let exponent = ((bits >> 23) & 0xff) as i32;
+	let mantissa = bits & 0x7f_ffff;
+
+	if unlikely(exponent == 0xff) {
+		return sign | 0x7c00 | if mantissa != 0 { 0x200 } else { 0 };
+	}
+	let exponent = exponent - 127 + 15;
+
+	if unlikely(exponent >= 0x1f) {
+		return sign | 0x7c00;
+	}
+	// subnormal halves keep the implicit bit in the mantissa
+	let (mantissa, shift, high) = if exponent <= 0 {
+		if exponent < -10 {
+			return sign;
+		}
+		(mantissa | 0x80_0000, (14 - exponent) as u32, 0)
+	} else {
+		(mantissa, 13, (exponent as u32) << 10)
+	};
+	let half = high | (mantissa >> shift);
+	let rest = mantissa & ((1 << shift) - 1);
+	let halfway = 1 << (shift - 1);
+	let round = u32::from(rest > halfway || (rest == halfway && half & 1 == 1));
+
+	// a carry out of the mantissa correctly bumps the exponent
+	sign | (half + round) as u16
+}
+
+/// Converts the bits of an IEEE 754 half to `f32`, exactly.
+pub fn f16_to_f32(h: u16) -> f32 {
+	let sign = ((h as u32) & 0x8000) << 16;
+	let exponent = ((h >> 10) & 0x1f) as u32;
+	let mantissa = (h & 0x3ff) as u32;
+
+	let bits = match (exponent, mantissa) {
+		(0, 0) => sign,
+		(0, _) => {
+			// normalize the subnormal half
+			let shift = mantissa.leading_zeros() - 21;
+
+			sign | ((113 - shift) << 23) | ((mantissa << shift) & 0x3ff) << 13
+		},
+		(0x1f, _) => sign | 0x7f80_0000 | (mantissa << 13),
+		_ => sign | ((exponent + 112) << 23) | (mantissa << 13),
+	};
+	f32::from_bits(bits)
+}
+
 #[cfg(test)]
 mod tests {
 	use super::*;
@@ -238,6 +367,32 @@ mod tests {
 		assert_relative_eq!(sigmoid(x), expected, epsilon = 1e-5);
 	}
 
+	#[test]
+	fn test_f16_round_trip() {
+		for (x, h) in [
+			(0.0, 0x0000),
+			(-0.0, 0x8000),
+			(1.0, 0x3c00),
+			(-2.0, 0xc000),
+			(65504.0, 0x7bff),
+			(65536.0, 0x7c00),
+			(f32::INFINITY, 0x7c00),
+			(6.103_515_6e-5, 0x0400),
+			(5.960_464_5e-8, 0x0001),
+			(1.0e-9, 0x0000),
+			(1.000_976_6, 0x3c01),
+			// halfway between 0x3c00 and 0x3c01, rounds to even
+			(1.000_488_3, 0x3c00),
+		] {
+			assert_eq!(f32_to_f16(x), h, "{x}");
+		}
+		assert!(f16_to_f32(f32_to_f16(f32::NAN)).is_nan());
+
+		for h in (0..0x7c00_u16).chain(0x8000..0xfc00) {
+			assert_eq!(f32_to_f16(f16_to_f32(h)), h);
+		}
+	}
+
 	#[test]
 	fn test_sigmoid_monotonic() {
 		let values: Vec<f32> = (-50..=50).map(|x| sigmoid(x as f32 * 0.1)).collect();
@@ -382,6 +537,49 @@ mod tests {
 		assert_relative_eq!(expected[3], 1.0, epsilon = 0.01);
 	}
 
+	#[rstest]
+	#[case(0, 0, 0, 0)]
+	#[case(1, 0, 0, 0b001)]
+	#[case(0, 1, 0, 0b010)]
+	#[case(0, 0, 1, 0b100)]
+	#[case(3, 0, 1, 0b001_101)]
+	#[case(0x1f_ffff, 0x1f_ffff, 0x1f_ffff, (1 << 63) - 1)]
+	#[case(0x20_0000, 0, 0, 0)] // bits past MORTON_BITS are dropped
+	fn test_morton_encode(
+		#[case] x: u32,
+		#[case] y: u32,
+		#[case] z: u32,
+		#[case] expected: u64,
+	) {
+		assert_eq!(morton_encode(x, y, z), expected);
+	}
+
+	#[test]
+	fn test_hilbert_encode_visits_neighbours() {
+		// the curve fills the cube at the origin before leaving it
+		let mut cells: Vec<(u64, [i32; 3])> = (0..64)
+			.map(|i| {
+				let cell = [i % 4, i / 4 % 4, i / 16];
+
+				(
+					hilbert_encode(cell[0], cell[1], cell[2]),
+					cell.map(|v| v as i32),
+				)
+			})
+			.collect();
+
+		cells.sort_unstable();
+
+		for (i, pair) in cells.windows(2).enumerate() {
+			let distance: i32 =
+				(0..3).map(|k| (pair[0].1[k] - pair[1].1[k]).abs()).sum();
+
+			assert_eq!(pair[0].0, i as u64);
+			assert_eq!(distance, 1);
+		}
+		assert_eq!(hilbert_encode(0, 0, 0), 0);
+	}
+
 	#[test]
 	fn test_unpack_quaternion_first_three_w_derived() {
 		let r = [200_u8, 150, 140];
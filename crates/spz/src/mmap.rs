@@ -1,5 +1,7 @@
 // SPDX-License-Identifier: Apache-2.0 OR MIT
 
+use std::io::{Read, Seek, SeekFrom};
+use std::ops::Deref;
 use std::{fs::File, path::Path};
 
 use anyhow::Context;
@@ -44,3 +46,65 @@ where
 			})
 	}
 }
+
+/// The contents of a file, read into memory or memory-mapped.
+#[derive(Debug)]
+pub enum FileBytes {
+	Read(Vec<u8>),
+	Mapped(Mmap),
+}
+
+impl Deref for FileBytes {
+	type Target = [u8];
+
+	#[inline]
+	fn deref(&self) -> &[u8] {
+		match self {
+			Self::Read(bytes) => bytes,
+			Self::Mapped(mmap) => mmap,
+		}
+	}
+}
+
+/// Reads a file on macOS, where mmap isn't great according to ripgrep, and
+/// memory-maps it elsewhere.
+#[inline]
+pub fn read_or_map<F>(filepath: F) -> Result<FileBytes>
+where
+	F: AsRef<Path>,
+{
+	read_or_map_into(filepath, Vec::new())
+}
+
+/// Like [`read_or_map`], reading into `buf`, cleared first, so that it can
+/// be reused across files. [`FileBytes::Read`] hands it back.
+pub fn read_or_map_into<F>(filepath: F, mut buf: Vec<u8>) -> Result<FileBytes>
+where
+	F: AsRef<Path>,
+{
+	if cfg!(target_os = "macos") {
+		buf.clear();
+		File::open(filepath.as_ref())?.read_to_end(&mut buf)?;
+
+		return Ok(FileBytes::Read(buf));
+	}
+	mmap(filepath).map(FileBytes::Mapped)
+}
+
+/// Reads `len` bytes at `offset` of a file on macOS, see [`read_or_map`],
+/// and memory-maps them elsewhere.
+pub fn read_or_map_range<F>(filepath: F, offset: usize, len: usize) -> Result<FileBytes>
+where
+	F: AsRef<Path>,
+{
+	if cfg!(target_os = "macos") {
+		let mut infile = File::open(filepath.as_ref())?;
+		let mut buf = vec![0_u8; len];
+
+		infile.seek(SeekFrom::Start(offset as u64))?;
+		infile.read_exact(&mut buf)?;
+
+		return Ok(FileBytes::Read(buf));
+	}
+	mmap_range(filepath, offset, len).map(FileBytes::Mapped)
+}
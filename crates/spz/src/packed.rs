@@ -12,19 +12,23 @@
 //! - byte-quantized values for spherical harmonics,
 //!   achieving significant size reduction compared to raw floats.
 
-use std::io::BufReader;
-use std::io::Read;
 use std::io::Write;
+use std::ops::Range;
+use std::str::FromStr;
 
-use anyhow::bail;
-use anyhow::{Context, Result};
+use anyhow::{Context, Error, Result};
+use anyhow::{anyhow, bail};
 use arbitrary::Arbitrary;
-use likely_stable::{if_unlikely, unlikely};
+use likely_stable::unlikely;
 use serde::{Deserialize, Serialize};
 
-use crate::header::Header;
+use crate::gaussian_splat::AttributeMask;
+use crate::header::{HEADER_SIZE, Header};
 use crate::{consts, math};
-use crate::{coord::AxisFlips, unpacked::UnpackedGaussian};
+use crate::{
+	coord::{AxisFlips, CoordinateSystem},
+	unpacked::UnpackedGaussian,
+};
 
 static_assertions::const_assert_eq!(std::mem::size_of::<PackedGaussian>(), 65);
 
@@ -124,6 +128,38 @@ impl PackedGaussian {
 	}
 }
 
+/// Order of the points in packed data.
+///
+/// Sorting along a space filling curve puts nearby gaussians next to each
+/// other, so their quantized bytes correlate, which compresses better, and
+/// traversing them in order stays in cache.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq, Hash, Serialize, Deserialize, Arbitrary)]
+pub enum PointOrder {
+	/// The order of the source data.
+	#[default]
+	Original,
+	/// Z-order over the quantized positions, see
+	/// [`morton_encode`](crate::math::morton_encode).
+	Morton,
+	/// Hilbert order over the quantized positions, slightly better locality
+	/// than [`PointOrder::Morton`] for a slower sort key.
+	Hilbert,
+}
+
+impl FromStr for PointOrder {
+	type Err = Error;
+
+	#[inline]
+	fn from_str(s: &str) -> Result<Self, Self::Err> {
+		match s.to_lowercase().as_ref() {
+			"original" | "none" => Ok(PointOrder::Original),
+			"morton" | "z" => Ok(PointOrder::Morton),
+			"hilbert" => Ok(PointOrder::Hilbert),
+			_ => Err(anyhow!("invalid point order: {}", s)),
+		}
+	}
+}
+
 /// Represents a full splat with lower precision.
 ///
 /// Stores all splat data in non-interleaved arrays for efficient compression.
@@ -164,37 +200,10 @@ impl PackedGaussianSplat {
 	where
 		B: AsRef<[u8]>,
 	{
-		if unlikely(bytes.as_ref().is_empty()) {
-			// we cannot return an empty struct as there is no header
-			bail!("data is empty");
-		}
 		let mut decompressed = Vec::<u8>::new();
 
-		crate::compression::gzip::decompress_end(bytes, &mut decompressed)
-			.with_context(|| "unable to decompress gzip data")?;
-
-		let packed: Self = decompressed
-			.try_into()
-			.with_context(|| "unable to parse packed gaussian data")?;
-
-		Ok(packed)
-	}
-
-	/// Constructs an SPZ header from this packed data's metadata.
-	#[inline]
-	pub fn to_header(&self) -> Header {
-		Header {
-			num_points: self.num_points,
-			spherical_harmonics_degree: self.sh_degree as u8,
-			fractional_bits: self.fractional_bits as u8,
-			flags: if self.antialiased {
-				crate::header::Flags::ANTIALIASED
-			} else {
-				crate::header::Flags(0)
-			},
-			reserved: 0,
-			..Default::default()
-		}
+		PackedGaussianSplatView::from_compressed(bytes.as_ref(), &mut decompressed)
+			.map(Self::from)
 	}
 
 	/// Serializes to a complete SPZ file as a byte vector.
@@ -232,9 +241,235 @@ impl PackedGaussianSplat {
 		Ok(())
 	}
 
+	/// Borrows this packed data as a [`PackedGaussianSplatView`].
+	#[inline]
+	pub fn view(&self) -> PackedGaussianSplatView<'_> {
+		PackedGaussianSplatView {
+			num_points: self.num_points,
+			sh_degree: self.sh_degree,
+			fractional_bits: self.fractional_bits,
+			antialiased: self.antialiased,
+			uses_quaternion_smallest_three: self.uses_quaternion_smallest_three,
+			positions: &self.positions,
+			scales: &self.scales,
+			rotations: &self.rotations,
+			alphas: &self.alphas,
+			colors: &self.colors,
+			spherical_harmonics: &self.spherical_harmonics,
+		}
+	}
+
+	/// Constructs an SPZ header from this packed data's metadata.
+	#[inline]
+	pub fn to_header(&self) -> Header {
+		PackedGaussians::to_header(self)
+	}
+
 	/// Returns the packed data for a single splat at index `i`.
+	#[inline]
 	pub fn at(&self, i: usize) -> Result<PackedGaussian> {
-		if unlikely(i >= self.num_points as usize) {
+		PackedGaussians::at(self, i)
+	}
+
+	/// Unpacks a single splat at index `i` with coordinate transformation.
+	///
+	/// Applies the given axis flips during decompression.
+	#[inline]
+	pub fn unpack(&self, i: usize, coord_flip: &AxisFlips) -> Result<UnpackedGaussian> {
+		PackedGaussians::unpack(self, i, coord_flip)
+	}
+
+	/// Validates that all internal arrays have the expected sizes.
+	#[inline]
+	pub fn check_sizes(&self, num_points: usize, sh_dim: u8) -> bool {
+		PackedGaussians::check_sizes(self, num_points, sh_dim)
+	}
+
+	/// Converts the packed data between coordinate systems, in place, without
+	/// decoding it, see [`transcode`](crate::transcode).
+	///
+	/// # Args
+	///
+	/// `source_cs` - the coordinate system the data is in.
+	/// `target_cs` - the coordinate system to convert to.
+	pub fn convert_coordinates(
+		&mut self,
+		source_cs: CoordinateSystem,
+		target_cs: CoordinateSystem,
+	) {
+		let sh_dim = math::dim_for_degree(self.sh_degree.clamp(0, 3) as u8) as usize;
+
+		crate::transcode::flip_sections(
+			&source_cs.axis_flips_to(target_cs),
+			&mut self.positions,
+			&mut self.rotations,
+			&mut self.spherical_harmonics,
+			sh_dim,
+			self.uses_quaternion_smallest_three,
+		);
+	}
+
+	/// Sorts the points along the curve of `order`, in place, permuting every
+	/// attribute alike.
+	///
+	/// The sort key is computed from the quantized 24-bit positions, scaled
+	/// to the bounds of the points, so the result only depends on the packed
+	/// data.
+	///
+	/// # Returns
+	///
+	/// The new order, source point index per point, or `None` when the order
+	/// is [`PointOrder::Original`] and nothing moved.
+	pub fn reorder(&mut self, order: PointOrder) -> Result<Option<Vec<u32>>> {
+		let num_points = self.num_points.max(0) as usize;
+		let sh_dim = math::dim_for_degree(self.sh_degree as u8);
+
+		if unlikely(!self.check_sizes(num_points, sh_dim)) {
+			bail!("inconsistent sizes");
+		}
+		let encode: fn(u32, u32, u32) -> u64 = match order {
+			PointOrder::Original => return Ok(None),
+			PointOrder::Morton => math::morton_encode,
+			PointOrder::Hilbert => math::hilbert_encode,
+		};
+		// offset binary, so the unsigned fixed point sorts like the signed
+		let cells: Vec<[u32; 3]> = self
+			.positions
+			.chunks_exact(9)
+			.map(|p| {
+				[0, 3, 6].map(|i| {
+					(u32::from(p[i])
+						| u32::from(p[i + 1]) << 8 | u32::from(p[i + 2]) << 16)
+						^ 0x80_0000
+				})
+			})
+			.collect();
+		let (min, max) = cells
+			.iter()
+			.fold(([u32::MAX; 3], [0; 3]), |(min, max), cell| {
+				(
+					[0, 1, 2].map(|k| min[k].min(cell[k])),
+					[0, 1, 2].map(|k| max[k].max(cell[k])),
+				)
+			});
+		// the same shift on every axis keeps the curve's cells cubes
+		let span = (0..3)
+			.map(|k| max[k].saturating_sub(min[k]))
+			.max()
+			.unwrap_or(0);
+		let shift = (u32::BITS - span.leading_zeros()).saturating_sub(math::MORTON_BITS);
+
+		let mut keyed: Vec<(u64, u32)> = cells
+			.iter()
+			.enumerate()
+			.map(|(i, cell)| {
+				let [x, y, z] = [0, 1, 2].map(|k| (cell[k] - min[k]) >> shift);
+
+				(encode(x, y, z), i as u32)
+			})
+			.collect();
+
+		keyed.sort_unstable();
+
+		let permutation: Vec<u32> = keyed.into_iter().map(|(_, i)| i).collect();
+
+		for attribute in [
+			&mut self.positions,
+			&mut self.scales,
+			&mut self.rotations,
+			&mut self.alphas,
+			&mut self.colors,
+			&mut self.spherical_harmonics,
+		] {
+			permute(attribute, num_points, &permutation);
+		}
+		Ok(Some(permutation))
+	}
+}
+
+/// Reorders the `num_points` equally sized records of `bytes`, record `i` of
+/// the result is record `permutation[i]` of the source.
+fn permute(bytes: &mut Vec<u8>, num_points: usize, permutation: &[u32]) {
+	if num_points == 0 || bytes.is_empty() {
+		return;
+	}
+	let stride = bytes.len() / num_points;
+	let mut permuted = Vec::with_capacity(bytes.len());
+
+	for &i in permutation {
+		let i = i as usize * stride;
+
+		permuted.extend_from_slice(&bytes[i..i + stride]);
+	}
+	*bytes = permuted;
+}
+
+impl TryFrom<Vec<u8>> for PackedGaussianSplat {
+	type Error = anyhow::Error;
+
+	fn try_from(b: Vec<u8>) -> Result<Self, Self::Error> {
+		Self::try_from(b.as_slice())
+	}
+}
+
+impl TryFrom<&[u8]> for PackedGaussianSplat {
+	type Error = anyhow::Error;
+
+	#[inline]
+	fn try_from(b: &[u8]) -> Result<Self, Self::Error> {
+		PackedGaussianSplatView::try_from(b).map(Self::from)
+	}
+}
+
+/// Packed gaussian data, either owned ([`PackedGaussianSplat`]) or borrowed
+/// from a decompressed buffer ([`PackedGaussianSplatView`]).
+///
+/// Attribute sections are in the layout of [`PackedGaussianSplat`].
+pub trait PackedGaussians {
+	/// Total number of Gaussians.
+	fn num_points(&self) -> i32;
+	/// Spherical harmonics degree (0-3).
+	fn sh_degree(&self) -> i32;
+	/// Bits used for fractional part of fixed-point positions.
+	fn fractional_bits(&self) -> i32;
+	/// Whether antialiasing is used.
+	fn antialiased(&self) -> bool;
+	/// Whether rotations use smallest-three quaternion encoding.
+	fn uses_quaternion_smallest_three(&self) -> bool;
+
+	/// Quantized positions (9 bytes per splat).
+	fn positions(&self) -> &[u8];
+	/// Quantized log-scales (3 bytes per splat).
+	fn scales(&self) -> &[u8];
+	/// Packed quaternion rotations (3 or 4 bytes per splat).
+	fn rotations(&self) -> &[u8];
+	/// Quantized opacity (1 byte per splat).
+	fn alphas(&self) -> &[u8];
+	/// Quantized RGB colors (3 bytes per splat).
+	fn colors(&self) -> &[u8];
+	/// Quantized spherical harmonics (variable size based on degree).
+	fn spherical_harmonics(&self) -> &[u8];
+
+	/// Constructs an SPZ header from this packed data's metadata.
+	#[inline]
+	fn to_header(&self) -> Header {
+		Header {
+			num_points: self.num_points(),
+			spherical_harmonics_degree: self.sh_degree() as u8,
+			fractional_bits: self.fractional_bits() as u8,
+			flags: if self.antialiased() {
+				crate::header::Flags::ANTIALIASED
+			} else {
+				crate::header::Flags(0)
+			},
+			reserved: 0,
+			..Default::default()
+		}
+	}
+
+	/// Returns the packed data for a single splat at index `i`.
+	fn at(&self, i: usize) -> Result<PackedGaussian> {
+		if unlikely(i >= self.num_points() as usize) {
 			bail!("index out of bounds: {}", i);
 		}
 		const POSITION_BYTES: usize = 9;
@@ -244,16 +479,16 @@ impl PackedGaussianSplat {
 		let p_start = idx.saturating_mul(POSITION_BYTES);
 
 		if p_start != usize::MAX
-			&& let Some(slice) = self.positions.get(p_start..p_start + POSITION_BYTES)
+			&& let Some(slice) = self.positions().get(p_start..p_start + POSITION_BYTES)
 		{
 			result.position[..POSITION_BYTES].copy_from_slice(slice);
 		}
 		let start3 = idx.saturating_mul(3);
 
-		if let Some(slice) = self.scales.get(start3..start3 + 3) {
+		if let Some(slice) = self.scales().get(start3..start3 + 3) {
 			result.scale.copy_from_slice(slice);
 		}
-		let rotation_bytes = if self.uses_quaternion_smallest_three {
+		let rotation_bytes = if self.uses_quaternion_smallest_three() {
 			4
 		} else {
 			3
@@ -261,23 +496,23 @@ impl PackedGaussianSplat {
 		let r_start = idx.saturating_mul(rotation_bytes);
 
 		if r_start != usize::MAX
-			&& let Some(slice) = self.rotations.get(r_start..r_start + rotation_bytes)
+			&& let Some(slice) = self.rotations().get(r_start..r_start + rotation_bytes)
 		{
 			result.rotation[..rotation_bytes].copy_from_slice(slice);
 		}
-		if let Some(slice) = self.colors.get(start3..start3 + 3) {
+		if let Some(slice) = self.colors().get(start3..start3 + 3) {
 			result.color.copy_from_slice(slice);
 		}
-		if let Some(a) = self.alphas.get(idx) {
+		if let Some(a) = self.alphas().get(idx) {
 			result.alpha = *a;
 		}
-		let sh_dim = math::dim_for_degree(self.sh_degree as u8) as usize;
+		let sh_dim = math::dim_for_degree(self.sh_degree() as u8) as usize;
 		let base_point_sh = idx.saturating_mul(sh_dim).saturating_mul(3);
 
 		for j in 0..sh_dim {
 			let base = base_point_sh.saturating_add(j.saturating_mul(3));
 
-			if let Some(slice) = self.spherical_harmonics.get(base..base + 3) {
+			if let Some(slice) = self.spherical_harmonics().get(base..base + 3) {
 				result.sh_r[j] = slice[0];
 				result.sh_g[j] = slice[1];
 				result.sh_b[j] = slice[2];
@@ -299,10 +534,10 @@ impl PackedGaussianSplat {
 	///
 	/// Applies the given axis flips during decompression.
 	#[inline]
-	pub fn unpack(&self, i: usize, coord_flip: &AxisFlips) -> Result<UnpackedGaussian> {
-		self.at(i)?.unpack(
-			self.uses_quaternion_smallest_three,
-			self.fractional_bits,
+	fn unpack(&self, i: usize, coord_flip: &AxisFlips) -> Result<UnpackedGaussian> {
+		PackedGaussians::at(self, i)?.unpack(
+			self.uses_quaternion_smallest_three(),
+			self.fractional_bits(),
 			coord_flip,
 		)
 	}
@@ -311,11 +546,11 @@ impl PackedGaussianSplat {
 	///
 	/// Returns `true` if sizes match the expected layout for the given
 	/// number of points and spherical harmonics dimension.
-	pub fn check_sizes(&self, num_points: usize, sh_dim: u8) -> bool {
+	fn check_sizes(&self, num_points: usize, sh_dim: u8) -> bool {
 		let pos_expected = num_points * 9;
 		let scales_expected = num_points * 3;
 		let rot_expected = num_points
-			* if self.uses_quaternion_smallest_three {
+			* if self.uses_quaternion_smallest_three() {
 				4
 			} else {
 				3
@@ -324,12 +559,12 @@ impl PackedGaussianSplat {
 		let colors_expected = num_points * 3;
 		let sh_expected = num_points * (sh_dim as usize) * 3;
 
-		if self.positions.len() != pos_expected
-			|| self.scales.len() != scales_expected
-			|| self.rotations.len() != rot_expected
-			|| self.alphas.len() != alphas_expected
-			|| self.colors.len() != colors_expected
-			|| self.spherical_harmonics.len() != sh_expected
+		if self.positions().len() != pos_expected
+			|| self.scales().len() != scales_expected
+			|| self.rotations().len() != rot_expected
+			|| self.alphas().len() != alphas_expected
+			|| self.colors().len() != colors_expected
+			|| self.spherical_harmonics().len() != sh_expected
 		{
 			return false;
 		}
@@ -337,82 +572,297 @@ impl PackedGaussianSplat {
 	}
 }
 
-impl TryFrom<Vec<u8>> for PackedGaussianSplat {
-	type Error = anyhow::Error;
+/// Implements [`PackedGaussians`] by forwarding to the struct fields.
+macro_rules! impl_packed_gaussians {
+	($ty:ty) => {
+		impl PackedGaussians for $ty {
+			#[inline]
+			fn num_points(&self) -> i32 {
+				self.num_points
+			}
 
-	fn try_from(b: Vec<u8>) -> Result<Self, Self::Error> {
-		Self::try_from(b.as_slice())
+			#[inline]
+			fn sh_degree(&self) -> i32 {
+				self.sh_degree
+			}
+
+			#[inline]
+			fn fractional_bits(&self) -> i32 {
+				self.fractional_bits
+			}
+
+			#[inline]
+			fn antialiased(&self) -> bool {
+				self.antialiased
+			}
+
+			#[inline]
+			fn uses_quaternion_smallest_three(&self) -> bool {
+				self.uses_quaternion_smallest_three
+			}
+
+			#[inline]
+			fn positions(&self) -> &[u8] {
+				&self.positions
+			}
+
+			#[inline]
+			fn scales(&self) -> &[u8] {
+				&self.scales
+			}
+
+			#[inline]
+			fn rotations(&self) -> &[u8] {
+				&self.rotations
+			}
+
+			#[inline]
+			fn alphas(&self) -> &[u8] {
+				&self.alphas
+			}
+
+			#[inline]
+			fn colors(&self) -> &[u8] {
+				&self.colors
+			}
+
+			#[inline]
+			fn spherical_harmonics(&self) -> &[u8] {
+				&self.spherical_harmonics
+			}
+		}
+	};
+}
+
+impl_packed_gaussians!(PackedGaussianSplat);
+impl_packed_gaussians!(PackedGaussianSplatView<'_>);
+
+/// Borrowed [`PackedGaussianSplat`]: the attribute sections are sub-slices of
+/// a decompressed SPZ buffer, found from its header without copying.
+#[derive(Clone, Copy, Debug, Default, PartialEq)]
+pub struct PackedGaussianSplatView<'a> {
+	/// Total number of Gaussians.
+	pub num_points: i32,
+	/// Spherical harmonics degree (0-3).
+	pub sh_degree: i32,
+	/// Bits used for fractional part of fixed-point positions.
+	pub fractional_bits: i32,
+	/// Whether antialiasing is used.
+	pub antialiased: bool,
+	/// Whether rotations use smallest-three quaternion encoding.
+	pub uses_quaternion_smallest_three: bool,
+
+	/// Quantized positions (9 bytes per splat).
+	pub positions: &'a [u8],
+	/// Quantized log-scales (3 bytes per splat).
+	pub scales: &'a [u8],
+	/// Packed quaternion rotations (3 or 4 bytes per splat).
+	pub rotations: &'a [u8],
+	/// Quantized opacity (1 byte per splat).
+	pub alphas: &'a [u8],
+	/// Quantized RGB colors (3 bytes per splat).
+	pub colors: &'a [u8],
+	/// Quantized spherical harmonics (variable size based on degree).
+	pub spherical_harmonics: &'a [u8],
+}
+
+impl<'a> PackedGaussianSplatView<'a> {
+	/// Decompresses gzip or zstd compressed, packed gaussian data into
+	/// `decompressed` and borrows a view of it.
+	///
+	/// # Args
+	///
+	/// `compressed` - compressed, packed gaussian data.
+	/// `decompressed` - buffer for the decompressed data, cleared first. It
+	/// can be reused across loads.
+	pub fn from_compressed(compressed: &[u8], decompressed: &'a mut Vec<u8>) -> Result<Self> {
+		if unlikely(compressed.is_empty()) {
+			bail!("data is empty");
+		}
+		decompressed.clear();
+
+		crate::compression::decompress(compressed, decompressed, 0)
+			.with_context(|| "unable to decompress data")?;
+
+		Self::try_from(decompressed.as_slice())
+			.with_context(|| "unable to parse packed gaussian data")
 	}
 }
 
-impl TryFrom<&[u8]> for PackedGaussianSplat {
+impl<'a> TryFrom<&'a [u8]> for PackedGaussianSplatView<'a> {
 	type Error = anyhow::Error;
 
-	fn try_from(b: &[u8]) -> Result<Self, Self::Error> {
-		let mut from_reader = BufReader::new(b);
+	/// Borrows the attribute sections of decompressed, packed gaussian data:
+	/// the header followed by the sections in file order.
+	#[inline]
+	fn try_from(b: &'a [u8]) -> Result<Self, Self::Error> {
+		Self::from_prefix(b, SECTIONS.len())
+	}
+}
+
+impl<'a> PackedGaussianSplatView<'a> {
+	/// Borrows the first `sections` attribute sections, in file order, of
+	/// the start of decompressed, packed gaussian data, e.g. as
+	/// [`LoadOptions::decompress_decoded`] leaves it. The later sections are
+	/// left empty.
+	///
+	/// [`LoadOptions::decompress_decoded`]: crate::gaussian_splat::LoadOptions::decompress_decoded
+	#[inline]
+	pub fn from_prefix(b: &'a [u8], sections: usize) -> Result<Self> {
+		Ok(Sections::of_prefix(b, sections)?.view(b))
+	}
+}
+
+/// Where the attribute sections of decompressed, packed gaussian data are,
+/// found once so that views of the same data are borrowed without parsing
+/// and checking it again.
+#[derive(Clone, Debug, Default, PartialEq)]
+pub(crate) struct Sections {
+	header: Header,
+	/// Byte ranges of the sections, in file order.
+	ranges: [Range<usize>; 6],
+}
 
-		let header = Header::read_from(&mut from_reader)
+impl Sections {
+	/// Checks the header of `b` and finds its first `sections` attribute
+	/// sections, in file order. The later sections are left empty.
+	pub(crate) fn of_prefix(b: &[u8], sections: usize) -> Result<Self> {
+		let header = Header::try_from(b)
 			.with_context(|| "unable to read packed gaussians header")?;
 
 		if unlikely(!header.is_valid()) {
 			bail!("invalid header");
 		}
-		let num_points = header.num_points;
-		let uses_quaternion_smallest_three =
-			is_encoding_quaternion_smallest_three_used(header.version);
-
-		let mut result = PackedGaussianSplat {
-			num_points,
-			sh_degree: header.spherical_harmonics_degree as i32,
-			fractional_bits: header.fractional_bits as i32,
-			antialiased: header.flags.is_antialiased(),
-			uses_quaternion_smallest_three,
-
-			positions: vec![0; num_points as usize * 9],
-			scales: vec![0; (num_points as usize) * 3],
-			rotations: vec![
-				0;
-				num_points as usize
-					* if uses_quaternion_smallest_three { 4 } else { 3 }
-			],
-			alphas: vec![0; num_points as usize],
-			colors: vec![0; (num_points as usize) * 3],
-			spherical_harmonics: vec![
-				0;
-				num_points as usize
-					* math::dim_for_degree(header.spherical_harmonics_degree)
-						as usize * 3
-			],
-		};
-		// despite the `err` from `let Err(err) = ...` is used in the if
-		// block, it produces an `unused_variables` warning because of a
-		// bug in the `likely` crate.
-		// https://gitlab.com/okannen/likely/-/merge_requests/1
-		#[allow(unused_variables)]
+		let num_points = header.num_points.max(0) as usize;
+		let strides = section_strides(&header);
+
+		let mut start = HEADER_SIZE;
+		let mut ranges: [Range<usize>; 6] = Default::default();
+
+		for (i, (range, stride)) in
+			ranges.iter_mut().zip(strides).take(sections).enumerate()
 		{
-			if_unlikely! { let Err(err) = from_reader.read_exact(&mut result.positions) => {
-				bail!("read error (positions): {}", err);
-			}};
-			if_unlikely! { let Err(err) = from_reader.read_exact(&mut result.alphas) => {
-				bail!("read error (alphas): {}", err);
-			}};
-			if_unlikely! { let Err(err) = from_reader.read_exact(&mut result.colors) => {
-				bail!("read error (colors): {}", err);
-			}};
-			if_unlikely! { let Err(err) = from_reader.read_exact(&mut result.scales) => {
-				bail!("read error (scales): {}", err);
-			}};
-			if_unlikely! { let Err(err) = from_reader.read_exact(&mut result.rotations) => {
-				bail!("read error (rotations): {}", err);
-			}};
-			if_unlikely! { let Err(err) = from_reader.read_exact(&mut result.spherical_harmonics) => {
-				bail!("read error (spherical harmonics): {}", err);
-			}};
+			let len = num_points.saturating_mul(stride);
+			let rest = b.len() - start;
+
+			if unlikely(rest < len) {
+				bail!(
+					"read error ({}): expected {len} bytes, got {rest}",
+					SECTION_NAMES[i],
+				);
+			}
+			*range = start..start + len;
+			start += len;
+		}
+		Ok(Self { header, ranges })
+	}
+
+	/// Borrows the sections of `b`.
+	///
+	/// # Panics
+	///
+	/// If `b` is shorter than the data the sections were found in.
+	pub(crate) fn view<'a>(&self, b: &'a [u8]) -> PackedGaussianSplatView<'a> {
+		let [
+			positions,
+			alphas,
+			colors,
+			scales,
+			rotations,
+			spherical_harmonics,
+		] = self.ranges.clone().map(|range| &b[range]);
+
+		PackedGaussianSplatView {
+			num_points: self.header.num_points,
+			sh_degree: self.header.spherical_harmonics_degree as i32,
+			fractional_bits: self.header.fractional_bits as i32,
+			antialiased: self.header.flags.is_antialiased(),
+			uses_quaternion_smallest_three: is_encoding_quaternion_smallest_three_used(
+				self.header.version,
+			),
+			positions,
+			scales,
+			rotations,
+			alphas,
+			colors,
+			spherical_harmonics,
+		}
+	}
+}
+
+impl From<PackedGaussianSplatView<'_>> for PackedGaussianSplat {
+	#[inline]
+	fn from(view: PackedGaussianSplatView<'_>) -> Self {
+		PackedGaussianSplat {
+			num_points: view.num_points,
+			sh_degree: view.sh_degree,
+			fractional_bits: view.fractional_bits,
+			antialiased: view.antialiased,
+			uses_quaternion_smallest_three: view.uses_quaternion_smallest_three,
+			positions: view.positions.to_vec(),
+			scales: view.scales.to_vec(),
+			rotations: view.rotations.to_vec(),
+			alphas: view.alphas.to_vec(),
+			colors: view.colors.to_vec(),
+			spherical_harmonics: view.spherical_harmonics.to_vec(),
 		}
-		Ok(result)
 	}
 }
 
+/// The attribute sections in file order.
+pub(crate) const SECTIONS: [AttributeMask; 6] = [
+	AttributeMask::POSITIONS,
+	AttributeMask::ALPHAS,
+	AttributeMask::COLORS,
+	AttributeMask::SCALES,
+	AttributeMask::ROTATIONS,
+	AttributeMask::SPHERICAL_HARMONICS,
+];
+
+/// Names of the attribute sections in file order, for error messages.
+pub(crate) const SECTION_NAMES: [&str; 6] = [
+	"positions",
+	"alphas",
+	"colors",
+	"scales",
+	"rotations",
+	"spherical harmonics",
+];
+
+/// Bytes per point of each section, in file order.
+pub(crate) fn section_strides(header: &Header) -> [usize; 6] {
+	let rotation = if is_encoding_quaternion_smallest_three_used(header.version) {
+		4
+	} else {
+		3
+	};
+	let sh_dim = math::dim_for_degree(header.spherical_harmonics_degree) as usize;
+
+	[9, 1, 3, 3, rotation, sh_dim * 3]
+}
+
+/// Number of leading sections, in file order, that hold every attribute of
+/// `attributes`. The sections after them never need to be read.
+#[inline]
+pub(crate) fn leading_sections(attributes: AttributeMask) -> usize {
+	SECTIONS.iter()
+		.rposition(|&section| attributes.contains(section))
+		.map_or(0, |i| i + 1)
+}
+
+/// Bytes of decompressed data, header included, up to the end of the first
+/// `sections` sections of packed data described by `header`.
+#[inline]
+pub(crate) fn prefix_len(header: &Header, sections: usize) -> usize {
+	let num_points = header.num_points.max(0) as usize;
+
+	section_strides(header)[..sections]
+		.iter()
+		.fold(HEADER_SIZE, |len, stride| {
+			len.saturating_add(num_points.saturating_mul(*stride))
+		})
+}
+
 /// Returns `true` if _smallest-three quaternion encoding_ is used in the given
 /// version.
 #[inline]
@@ -664,4 +1114,53 @@ mod tests {
 	fn test_from_bytes_errors(#[case] bytes: Vec<u8>) {
 		assert!(PackedGaussianSplat::from_bytes(&bytes).is_err());
 	}
+
+	#[test]
+	fn test_view_matches_owned() {
+		let packed = PackedGaussianSplat {
+			num_points: 2,
+			sh_degree: 1,
+			fractional_bits: 12,
+			antialiased: true,
+			uses_quaternion_smallest_three: true,
+			positions: (0..18).collect(),
+			scales: (18..24).collect(),
+			rotations: (24..32).collect(),
+			alphas: vec![32, 33],
+			colors: (34..40).collect(),
+			spherical_harmonics: (40..58).collect(),
+		};
+		let bytes = packed.to_bytes_vec().expect("serialization failed");
+		let view =
+			PackedGaussianSplatView::try_from(bytes.as_slice()).expect("valid bytes");
+
+		assert_eq!(view, packed.view());
+		assert_eq!(PackedGaussianSplat::from(view), packed);
+		assert_eq!(
+			PackedGaussians::at(&view, 1).unwrap(),
+			packed.at(1).unwrap()
+		);
+		assert_eq!(PackedGaussians::to_header(&view), packed.to_header());
+		assert!(bytes
+			.as_ptr_range()
+			.contains(&view.spherical_harmonics.as_ptr()));
+	}
+
+	#[test]
+	fn test_view_truncated_fails() {
+		let packed = PackedGaussianSplat {
+			num_points: 1,
+			uses_quaternion_smallest_three: true,
+			fractional_bits: 12,
+			positions: vec![0; 9],
+			scales: vec![0; 3],
+			rotations: vec![0; 4],
+			alphas: vec![0],
+			colors: vec![0; 3],
+			..Default::default()
+		};
+		let bytes = packed.to_bytes_vec().expect("serialization failed");
+
+		assert!(PackedGaussianSplatView::try_from(&bytes[..bytes.len() - 1]).is_err());
+	}
 }
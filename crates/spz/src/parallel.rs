@@ -0,0 +1,159 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+//! Splitting per-point work across scoped threads.
+
+use std::{num::NonZeroUsize, thread};
+
+use anyhow::Result;
+
+/// Fewest points handed to a thread, below this spawning costs more than it
+/// saves.
+pub const MIN_POINTS_PER_THREAD: usize = 16 * 1024;
+
+/// Resolves a `threads` option, where `0` means all available cores.
+#[inline]
+pub fn available_threads(threads: usize) -> usize {
+	if threads == 0 {
+		thread::available_parallelism().map_or(1, NonZeroUsize::get)
+	} else {
+		threads
+	}
+}
+
+/// Resolves a `threads` option to the number of threads to split
+/// `num_points` points over.
+///
+/// # Args
+///
+/// `threads` - requested number of threads, `0` uses all available cores.
+/// `num_points` - number of points to split.
+///
+/// # Returns
+///
+/// At least 1, and no more than leaves every thread
+/// [`MIN_POINTS_PER_THREAD`] points.
+#[inline]
+pub fn thread_count(threads: usize, num_points: usize) -> usize {
+	available_threads(threads)
+		.min(num_points / MIN_POINTS_PER_THREAD)
+		.max(1)
+}
+
+/// Runs `f` on every job, each on its own scoped thread except the last one,
+/// which runs on the calling thread.
+///
+/// # Args
+///
+/// `jobs` - the units of work.
+/// `f` - the work to do on each job.
+pub fn run<T, F>(jobs: Vec<T>, f: F)
+where
+	T: Send,
+	F: Fn(T) + Sync,
+{
+	let mut jobs = jobs;
+	let Some(last) = jobs.pop() else {
+		return;
+	};
+	if jobs.is_empty() {
+		return f(last);
+	}
+	let f = &f;
+
+	thread::scope(|s| {
+		for job in jobs {
+			s.spawn(move || f(job));
+		}
+		f(last);
+	});
+}
+
+/// Like [`run`], for fallible work.
+///
+/// # Returns
+///
+/// The error of the first failed job, in job order, after all jobs ran.
+pub fn try_run<T, F>(jobs: Vec<T>, f: F) -> Result<()>
+where
+	T: Send,
+	F: Fn(T) -> Result<()> + Sync,
+{
+	let mut jobs = jobs;
+	let Some(last) = jobs.pop() else {
+		return Ok(());
+	};
+	if jobs.is_empty() {
+		return f(last);
+	}
+	let f = &f;
+
+	thread::scope(|s| {
+		let handles: Vec<_> = jobs
+			.into_iter()
+			.map(|job| s.spawn(move || f(job)))
+			.collect();
+		let last = f(last);
+
+		handles.into_iter()
+			.map(|handle| {
+				handle.join()
+					.unwrap_or_else(|e| std::panic::resume_unwind(e))
+			})
+			.chain([last])
+			.collect()
+	})
+}
+
+/// Deals `jobs` round robin into up to `threads` groups, e.g. to [`run`]
+/// more jobs than threads.
+pub fn deal<T>(jobs: Vec<T>, threads: usize) -> Vec<Vec<T>> {
+	let threads = threads.clamp(1, jobs.len().max(1));
+	let mut groups: Vec<Vec<T>> = (0..threads).map(|_| Vec::new()).collect();
+
+	for (i, job) in jobs.into_iter().enumerate() {
+		groups[i % threads].push(job);
+	}
+	groups
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+	use rstest::rstest;
+	use std::sync::atomic::{AtomicUsize, Ordering};
+
+	#[rstest]
+	#[case(1, 0, 1)]
+	#[case(8, 0, 1)]
+	#[case(8, MIN_POINTS_PER_THREAD - 1, 1)]
+	#[case(8, MIN_POINTS_PER_THREAD * 3, 3)]
+	#[case(2, MIN_POINTS_PER_THREAD * 3, 2)]
+	fn test_thread_count(
+		#[case] threads: usize,
+		#[case] num_points: usize,
+		#[case] expected: usize,
+	) {
+		assert_eq!(thread_count(threads, num_points), expected);
+	}
+
+	#[test]
+	fn test_run_visits_every_job() {
+		let sum = AtomicUsize::new(0);
+
+		run((1..=10).collect(), |job: usize| {
+			sum.fetch_add(job, Ordering::Relaxed);
+		});
+		assert_eq!(sum.into_inner(), 55);
+	}
+
+	#[test]
+	fn test_try_run_returns_first_error() {
+		let result = try_run((0..8).collect(), |job: usize| {
+			if job % 3 == 2 {
+				anyhow::bail!("job {job} failed");
+			}
+			Ok(())
+		});
+		assert_eq!(result.unwrap_err().to_string(), "job 2 failed");
+	}
+}
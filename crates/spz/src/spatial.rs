@@ -0,0 +1,550 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+//! Spatial index over the points of a splat, for culling.
+//!
+//! A [`SpatialIndex`] sorts the points along a Morton curve and builds a
+//! bounding volume hierarchy over runs of consecutive points. Each point is
+//! bounded by a sphere of [`EXTENT_SIGMAS`] times its largest scale, so a
+//! node's bounds cover the visible extent of its gaussians, not just their
+//! centers. Queries return the points inside an axis-aligned box or a view
+//! frustum, either as exact point indices or as conservative ranges of the
+//! Morton order.
+
+use std::ops::Range;
+
+use crate::{
+	gaussian_splat::{BoundingBox, GaussianSplat},
+	math::{MORTON_BITS, morton_encode},
+};
+
+/// Default maximum number of points per leaf.
+pub const DEFAULT_LEAF_SIZE: usize = 32;
+
+/// Radius of the sphere bounding a gaussian, in standard deviations.
+pub const EXTENT_SIGMAS: f32 = 3.0;
+
+/// A view frustum as six planes `(a, b, c, d)`, the inside of each
+/// satisfying `a * x + b * y + c * z + d >= 0`.
+#[derive(Clone, Copy, Debug, PartialEq)]
+pub struct Frustum {
+	/// Left, right, bottom, top, near, far, normalized.
+	pub planes: [[f32; 4]; 6],
+}
+
+impl Frustum {
+	/// Extracts the frustum planes of a view-projection matrix.
+	///
+	/// The matrix is column-major and maps to clip space with
+	/// `-w <= x, y, z <= w`. For a `0 <= z <= w` depth range the near plane
+	/// is conservative.
+	///
+	/// # Args
+	///
+	/// `m` - view-projection matrix, in the coordinate system of the splat.
+	pub fn from_view_projection(m: &[f32; 16]) -> Self {
+		let row = |i: usize| [m[i], m[4 + i], m[8 + i], m[12 + i]];
+		let (x, y, z, w) = (row(0), row(1), row(2), row(3));
+		let plane = |r: [f32; 4], sign: f32| {
+			let p = [0, 1, 2, 3].map(|k| w[k] + sign * r[k]);
+			let len = (p[0] * p[0] + p[1] * p[1] + p[2] * p[2]).sqrt();
+
+			if len > 0.0 { p.map(|v| v / len) } else { p }
+		};
+
+		Self {
+			planes: [
+				plane(x, 1.0),
+				plane(x, -1.0),
+				plane(y, 1.0),
+				plane(y, -1.0),
+				plane(z, 1.0),
+				plane(z, -1.0),
+			],
+		}
+	}
+
+	#[inline]
+	fn classify_box(&self, bbox: &BoundingBox) -> Overlap {
+		let mut overlap = Overlap::Inside;
+
+		for [a, b, c, d] in self.planes {
+			// the corners furthest along and against the plane normal
+			let far = a * pick(a, bbox.min_x, bbox.max_x)
+				+ b * pick(b, bbox.min_y, bbox.max_y)
+				+ c * pick(c, bbox.min_z, bbox.max_z)
+				+ d;
+			let near = a * pick(a, bbox.max_x, bbox.min_x)
+				+ b * pick(b, bbox.max_y, bbox.min_y)
+				+ c * pick(c, bbox.max_z, bbox.min_z)
+				+ d;
+
+			if far < 0.0 {
+				return Overlap::Outside;
+			}
+			if near < 0.0 {
+				overlap = Overlap::Partial;
+			}
+		}
+		overlap
+	}
+
+	#[inline]
+	fn contains_sphere(&self, point: &[f32; 4]) -> bool {
+		let [x, y, z, r] = *point;
+
+		self.planes
+			.iter()
+			.all(|[a, b, c, d]| a * x + b * y + c * z + d >= -r)
+	}
+}
+
+/// `max` when `sign` is positive, else `min`.
+#[inline]
+fn pick(sign: f32, min: f32, max: f32) -> f32 {
+	if sign >= 0.0 { max } else { min }
+}
+
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+enum Overlap {
+	Outside,
+	Partial,
+	Inside,
+}
+
+#[derive(Clone, Debug, PartialEq)]
+struct Node {
+	bbox: BoundingBox,
+	/// Points below the node, in the Morton order.
+	start: u32,
+	end: u32,
+	/// Child nodes, `None` for leaves.
+	children: Option<[u32; 2]>,
+}
+
+/// Bounding volume hierarchy over the points of a splat in Morton order.
+///
+/// The index borrows nothing, it stays valid as long as the positions and
+/// scales it was built from don't change.
+#[derive(Clone, Debug, Default, PartialEq)]
+pub struct SpatialIndex {
+	/// Point indices, sorted along the Morton curve.
+	order: Vec<u32>,
+	/// Center and bounding radius of the points, in the Morton order.
+	points: Vec<[f32; 4]>,
+	/// The root first.
+	nodes: Vec<Node>,
+}
+
+impl SpatialIndex {
+	/// Builds the index over the positions and scales of `splat`, with
+	/// [`DEFAULT_LEAF_SIZE`] points per leaf.
+	#[inline]
+	pub fn build(splat: &GaussianSplat) -> Self {
+		Self::build_with(&splat.positions, &splat.scales, DEFAULT_LEAF_SIZE)
+	}
+
+	/// Builds the index over `(x, y, z)` positions.
+	///
+	/// # Args
+	///
+	/// `positions` - point centers, `(x, y, z)` per point.
+	/// `scales` - log-scales, `(x, y, z)` per point, or empty to index the
+	/// centers only.
+	/// `leaf_size` - maximum number of points per leaf, at least 1.
+	pub fn build_with(positions: &[f32], scales: &[f32], leaf_size: usize) -> Self {
+		let num_points = (positions.len() / 3).min(u32::MAX as usize);
+		let root = BoundingBox::from_positions(&positions[..num_points * 3]);
+		let (sx, sy, sz) = root.size();
+		let max_cell = ((1_u32 << MORTON_BITS) - 1) as f32;
+		let cell = |v: f32, min: f32, size: f32| {
+			if size > 0.0 {
+				((v - min) / size * max_cell) as u32
+			} else {
+				0
+			}
+		};
+		let mut keyed: Vec<(u64, u32)> = positions
+			.chunks_exact(3)
+			.take(num_points)
+			.enumerate()
+			.map(|(i, p)| {
+				let code = morton_encode(
+					cell(p[0], root.min_x, sx),
+					cell(p[1], root.min_y, sy),
+					cell(p[2], root.min_z, sz),
+				);
+				(code, i as u32)
+			})
+			.collect();
+
+		keyed.sort_unstable();
+
+		let order: Vec<u32> = keyed.into_iter().map(|(_, i)| i).collect();
+		let points = order
+			.iter()
+			.map(|&i| {
+				let i = i as usize * 3;
+				let radius = scales.get(i..i + 3).map_or(0.0, |s| {
+					EXTENT_SIGMAS * s[0].max(s[1]).max(s[2]).exp()
+				});
+
+				[positions[i], positions[i + 1], positions[i + 2], radius]
+			})
+			.collect();
+
+		let mut index = Self {
+			order,
+			points,
+			nodes: Vec::new(),
+		};
+		if num_points > 0 {
+			index.nodes
+				.reserve(num_points.div_ceil(leaf_size.max(1)) * 2);
+			index.build_node(0, num_points, leaf_size.max(1));
+		}
+		index
+	}
+
+	/// Appends the node over points `start..end` and its descendants.
+	fn build_node(&mut self, start: usize, end: usize, leaf_size: usize) -> (u32, BoundingBox) {
+		let id = self.nodes.len() as u32;
+
+		self.nodes.push(Node {
+			bbox: BoundingBox::from_positions(&[]),
+			start: start as u32,
+			end: end as u32,
+			children: None,
+		});
+		let bbox = if end - start <= leaf_size {
+			sphere_bounds(&self.points[start..end])
+		} else {
+			// split on a leaf boundary, so the leaves stay full
+			let leaves = (end - start).div_ceil(leaf_size);
+			let mid = start + leaves / 2 * leaf_size;
+			let (left, left_bbox) = self.build_node(start, mid, leaf_size);
+			let (right, right_bbox) = self.build_node(mid, end, leaf_size);
+
+			self.nodes[id as usize].children = Some([left, right]);
+
+			union(&left_bbox, &right_bbox)
+		};
+		self.nodes[id as usize].bbox = bbox.clone();
+
+		(id, bbox)
+	}
+
+	#[inline]
+	pub fn num_points(&self) -> usize {
+		self.order.len()
+	}
+
+	/// Point indices sorted along the Morton curve, the ranges returned by
+	/// the queries index into it.
+	#[inline]
+	pub fn order(&self) -> &[u32] {
+		&self.order
+	}
+
+	/// Bounds of every gaussian, including their extents; `None` without
+	/// points.
+	#[inline]
+	pub fn bounds(&self) -> Option<&BoundingBox> {
+		self.nodes.first().map(|node| &node.bbox)
+	}
+
+	/// Indices of the points whose bounding sphere intersects `bbox`.
+	pub fn query_box(&self, bbox: &BoundingBox) -> Vec<u32> {
+		let mut indices = Vec::new();
+
+		self.visit(
+			|node| classify_box(bbox, node),
+			|point| sphere_intersects_box(point, bbox),
+			|range| indices.extend_from_slice(&self.order[range]),
+		);
+		indices
+	}
+
+	/// Ranges of [`SpatialIndex::order`] holding every point whose bounding
+	/// sphere intersects `bbox`, and possibly some close by.
+	pub fn query_box_ranges(&self, bbox: &BoundingBox) -> Vec<Range<usize>> {
+		let mut ranges = Vec::new();
+
+		self.visit_ranges(|node| classify_box(bbox, node), &mut ranges);
+		ranges
+	}
+
+	/// Indices of the points whose bounding sphere is at least partly inside
+	/// `frustum`.
+	pub fn query_frustum(&self, frustum: &Frustum) -> Vec<u32> {
+		let mut indices = Vec::new();
+
+		self.visit(
+			|node| frustum.classify_box(node),
+			|point| frustum.contains_sphere(point),
+			|range| indices.extend_from_slice(&self.order[range]),
+		);
+		indices
+	}
+
+	/// Ranges of [`SpatialIndex::order`] holding every point whose bounding
+	/// sphere is at least partly inside `frustum`, and possibly some close by.
+	pub fn query_frustum_ranges(&self, frustum: &Frustum) -> Vec<Range<usize>> {
+		let mut ranges = Vec::new();
+
+		self.visit_ranges(|node| frustum.classify_box(node), &mut ranges);
+		ranges
+	}
+
+	/// Calls `found` with runs of the Morton order in the query, testing
+	/// the points one by one only in partially covered leaves.
+	fn visit<C, P, F>(&self, classify: C, contains: P, mut found: F)
+	where
+		C: Fn(&BoundingBox) -> Overlap,
+		P: Fn(&[f32; 4]) -> bool,
+		F: FnMut(Range<usize>),
+	{
+		self.walk(&classify, |node, overlap| {
+			let range = node.start as usize..node.end as usize;
+
+			if overlap == Overlap::Inside {
+				return found(range);
+			}
+			for i in range {
+				if contains(&self.points[i]) {
+					found(i..i + 1);
+				}
+			}
+		});
+	}
+
+	fn visit_ranges<C>(&self, classify: C, ranges: &mut Vec<Range<usize>>)
+	where
+		C: Fn(&BoundingBox) -> Overlap,
+	{
+		self.walk(&classify, |node, _| {
+			let range = node.start as usize..node.end as usize;
+
+			match ranges.last_mut() {
+				Some(last) if last.end == range.start => last.end = range.end,
+				_ => ranges.push(range),
+			}
+		});
+	}
+
+	/// Calls `found` in Morton order with the nodes fully inside and the
+	/// leaves partly inside the query.
+	fn walk<C, F>(&self, classify: &C, mut found: F)
+	where
+		C: Fn(&BoundingBox) -> Overlap,
+		F: FnMut(&Node, Overlap),
+	{
+		let mut stack = Vec::with_capacity(64);
+
+		if !self.nodes.is_empty() {
+			stack.push(0_u32);
+		}
+		while let Some(id) = stack.pop() {
+			let node = &self.nodes[id as usize];
+
+			match (classify(&node.bbox), node.children) {
+				(Overlap::Outside, _) => {},
+				(Overlap::Partial, Some([left, right])) => {
+					stack.push(right);
+					stack.push(left);
+				},
+				(overlap, _) => found(node, overlap),
+			}
+		}
+	}
+}
+
+#[inline]
+fn classify_box(query: &BoundingBox, bbox: &BoundingBox) -> Overlap {
+	if !query.intersects(bbox) {
+		Overlap::Outside
+	} else if query.min_x <= bbox.min_x
+		&& bbox.max_x <= query.max_x
+		&& query.min_y <= bbox.min_y
+		&& bbox.max_y <= query.max_y
+		&& query.min_z <= bbox.min_z
+		&& bbox.max_z <= query.max_z
+	{
+		Overlap::Inside
+	} else {
+		Overlap::Partial
+	}
+}
+
+#[inline]
+fn sphere_intersects_box(point: &[f32; 4], bbox: &BoundingBox) -> bool {
+	let [x, y, z, r] = *point;
+	let dx = x - x.clamp(bbox.min_x, bbox.max_x);
+	let dy = y - y.clamp(bbox.min_y, bbox.max_y);
+	let dz = z - z.clamp(bbox.min_z, bbox.max_z);
+
+	dx * dx + dy * dy + dz * dz <= r * r
+}
+
+fn sphere_bounds(points: &[[f32; 4]]) -> BoundingBox {
+	points.iter()
+		.map(|&[x, y, z, r]| BoundingBox {
+			min_x: x - r,
+			max_x: x + r,
+			min_y: y - r,
+			max_y: y + r,
+			min_z: z - r,
+			max_z: z + r,
+		})
+		.reduce(|a, b| union(&a, &b))
+		.unwrap_or_else(|| BoundingBox::from_positions(&[]))
+}
+
+#[inline]
+fn union(a: &BoundingBox, b: &BoundingBox) -> BoundingBox {
+	BoundingBox {
+		min_x: a.min_x.min(b.min_x),
+		max_x: a.max_x.max(b.max_x),
+		min_y: a.min_y.min(b.min_y),
+		max_y: a.max_y.max(b.max_y),
+		min_z: a.min_z.min(b.min_z),
+		max_z: a.max_z.max(b.max_z),
+	}
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+
+	/// A 20 x 20 x 20 grid of points, one unit apart, with a tiny extent.
+	fn grid() -> (Vec<f32>, Vec<f32>) {
+		let positions: Vec<f32> = (0..8000)
+			.flat_map(|i| [(i % 20) as f32, (i / 20 % 20) as f32, (i / 400) as f32])
+			.collect();
+		let scales = vec![(0.01_f32).ln(); positions.len()];
+
+		(positions, scales)
+	}
+
+	fn brute_force<P>(positions: &[f32], scales: &[f32], inside: P) -> Vec<u32>
+	where
+		P: Fn(&[f32; 4]) -> bool,
+	{
+		(0..positions.len() / 3)
+			.filter(|&i| {
+				let r = EXTENT_SIGMAS * scales[i * 3].exp();
+
+				inside(&[
+					positions[i * 3],
+					positions[i * 3 + 1],
+					positions[i * 3 + 2],
+					r,
+				])
+			})
+			.map(|i| i as u32)
+			.collect()
+	}
+
+	#[test]
+	fn test_spatial_index_box_matches_brute_force() {
+		let (positions, scales) = grid();
+		let index = SpatialIndex::build_with(&positions, &scales, 16);
+
+		assert_eq!(index.num_points(), 8000);
+
+		let mut sorted = index.order().to_vec();
+
+		sorted.sort_unstable();
+		assert_eq!(sorted, (0..8000).collect::<Vec<u32>>());
+
+		let query = BoundingBox {
+			min_x: 2.5,
+			max_x: 7.0,
+			min_y: -1.0,
+			max_y: 3.2,
+			min_z: 10.0,
+			max_z: 10.0,
+		};
+		let mut found = index.query_box(&query);
+
+		found.sort_unstable();
+
+		let expected = brute_force(&positions, &scales, |point| {
+			sphere_intersects_box(point, &query)
+		});
+
+		assert_eq!(found, expected);
+		assert_eq!(found.len(), 5 * 4);
+
+		// ranges cover at least the exact result
+		let covered: Vec<u32> = index
+			.query_box_ranges(&query)
+			.into_iter()
+			.flat_map(|range| index.order()[range].to_vec())
+			.collect();
+
+		assert!(expected.iter().all(|i| covered.contains(i)));
+		assert!(covered.len() < 8000);
+	}
+
+	#[test]
+	fn test_spatial_index_frustum_matches_brute_force() {
+		let (positions, scales) = grid();
+		let index = SpatialIndex::build(&GaussianSplat {
+			header: crate::header::Header {
+				num_points: 8000,
+				..Default::default()
+			},
+			positions: positions.clone(),
+			scales: scales.clone(),
+			..Default::default()
+		});
+
+		// orthographic projection of x, y in [0, 10], z in [0, 5], column-major
+		let (l, r, b, t, n, f) = (0.0_f32, 10.0_f32, 0.0_f32, 10.0_f32, 0.0_f32, 5.0_f32);
+		#[rustfmt::skip]
+		let m = [
+			2.0 / (r - l), 0.0, 0.0, 0.0,
+			0.0, 2.0 / (t - b), 0.0, 0.0,
+			0.0, 0.0, 2.0 / (f - n), 0.0,
+			-(r + l) / (r - l), -(t + b) / (t - b), -(f + n) / (f - n), 1.0,
+		];
+		let frustum = Frustum::from_view_projection(&m);
+		let mut found = index.query_frustum(&frustum);
+
+		found.sort_unstable();
+
+		assert_eq!(
+			found,
+			brute_force(&positions, &scales, |point| frustum.contains_sphere(point))
+		);
+		assert_eq!(found.len(), 11 * 11 * 6);
+	}
+
+	#[test]
+	fn test_spatial_index_empty_and_radii() {
+		let index = SpatialIndex::build(&GaussianSplat::default());
+
+		assert!(index.bounds().is_none());
+		assert!(index
+			.query_box(&BoundingBox::from_positions(&[]))
+			.is_empty());
+
+		// a large gaussian reaches into the query without its center
+		let index = SpatialIndex::build_with(&[0.0, 0.0, 0.0], &[0.0, 0.0, 0.0], 4);
+		let query = BoundingBox {
+			min_x: 2.0,
+			max_x: 3.0,
+			min_y: -1.0,
+			max_y: 1.0,
+			min_z: -1.0,
+			max_z: 1.0,
+		};
+		assert_eq!(index.query_box(&query), vec![0]);
+		assert_eq!(index.bounds().unwrap().max_x, EXTENT_SIGMAS);
+
+		// without scales only the centers count
+		let index = SpatialIndex::build_with(&[0.0, 0.0, 0.0], &[], 4);
+
+		assert!(index.query_box(&query).is_empty());
+	}
+}
@@ -0,0 +1,257 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+//! Summary statistics of a splat, the bounding box and median ellipsoid
+//! volume, in a single pass and without allocating.
+//!
+//! Log-scales decode from bytes as `b / 16 - 10`, so the sum of the three
+//! scales of a point, which the ellipsoid volume is the exponential of, is
+//! one of the 766 values `k / 16 - 30`. A histogram over these finds the
+//! exact median in place of sorting one sum per point. Splats whose scales
+//! are off that grid, e.g. built in memory, fall back to a selection.
+
+use std::fmt::Write;
+
+use likely_stable::unlikely;
+
+use crate::{
+	coord::AxisFlips,
+	gaussian_splat::{BoundingBox, GaussianSplat},
+	header::Header,
+	kernels,
+	packed::PackedGaussianSplatView,
+};
+
+/// Number of distinct sums of three scale bytes.
+const NUM_SUMS: usize = 3 * 255 + 1;
+
+/// Median volume reported when there are no (finite) scales.
+const DEFAULT_MEDIAN_VOLUME: f32 = 0.01;
+
+/// Bounding box and median ellipsoid volume of a splat.
+#[derive(Clone, Debug, PartialEq)]
+pub struct Statistics {
+	/// Bounding box of the positions.
+	pub bbox: BoundingBox,
+	/// See [`GaussianSplat::median_volume`].
+	pub median_volume: f32,
+}
+
+impl Statistics {
+	/// Computes the statistics of a splat, reading each position and scale
+	/// once.
+	pub fn from_splat(splat: &GaussianSplat) -> Self {
+		Self {
+			bbox: BoundingBox::from_positions(&splat.positions),
+			median_volume: median_volume(&splat.scales),
+		}
+	}
+
+	/// Computes the statistics straight from packed data, as they would be
+	/// for the decoded splat, without decoding it.
+	///
+	/// # Args
+	///
+	/// `view` - the packed data.
+	/// `flips` - axis flips from RightUpBack into the coordinate system of the
+	/// decoded splat.
+	pub fn from_packed(view: &PackedGaussianSplatView, flips: &AxisFlips) -> Self {
+		let mut histogram = [0_u32; NUM_SUMS];
+
+		for point in view.scales.chunks_exact(3) {
+			histogram[point[0] as usize + point[1] as usize + point[2] as usize] += 1;
+		}
+		let median_volume =
+			median_sum(&histogram).map_or(DEFAULT_MEDIAN_VOLUME, |k| volume(sum_of(k)));
+
+		Self {
+			bbox: packed_bbox(view, flips),
+			median_volume,
+		}
+	}
+}
+
+/// The median ellipsoid volume of log-scales, see
+/// [`GaussianSplat::median_volume`].
+pub(crate) fn median_volume(scales: &[f32]) -> f32 {
+	let mut histogram = [0_u32; NUM_SUMS];
+
+	for point in scales.chunks_exact(3) {
+		let k = (point[0] + point[1] + point[2] + 30.0) * 16.0;
+
+		// also false for NaN
+		if unlikely(!(k >= 0.0 && k < NUM_SUMS as f32) || k.fract() != 0.0) {
+			return select_median_volume(scales);
+		}
+		histogram[k as usize] += 1;
+	}
+	median_sum(&histogram).map_or(DEFAULT_MEDIAN_VOLUME, |k| volume(sum_of(k)))
+}
+
+/// Formats the summary printed by `spz info`.
+pub(crate) fn pretty_fmt(header: &Header, stats: &Statistics) -> String {
+	let bbox = &stats.bbox;
+	let (size_x, size_y, size_z) = bbox.size();
+	let (center_x, center_y, center_z) = bbox.center();
+
+	let mut ret = String::new();
+
+	let _ = writeln!(ret, "GaussianSplat:");
+	let _ = writeln!(ret, "\tNumber of points:\t\t{}", header.num_points);
+	let _ = writeln!(
+		ret,
+		"\tSpherical harmonics degree:\t{}",
+		header.spherical_harmonics_degree
+	);
+	let _ = writeln!(ret, "\tAntialiased:\t\t\t{}", header.flags.is_antialiased());
+	let _ = writeln!(ret, "\tMedian ellipsoid volume:\t{:}", stats.median_volume);
+	let _ = writeln!(
+		ret,
+		"\tBounding box:\n\t\tx: {:} to {:} (size {:}, center {:})\n",
+		bbox.min_x, bbox.max_x, size_x, center_x
+	);
+	let _ = writeln!(
+		ret,
+		"\t\ty: {:} to {:} (size {:}, center {:})",
+		bbox.min_y, bbox.max_y, size_y, center_y
+	);
+	let _ = writeln!(
+		ret,
+		"\t\tz: {:} to {:} (size {:}, center {:})",
+		bbox.min_z, bbox.max_z, size_z, center_z
+	);
+	ret
+}
+
+/// Index of the median of the sums in a histogram, the upper one for an even
+/// count, `None` if it is empty.
+fn median_sum(histogram: &[u32; NUM_SUMS]) -> Option<usize> {
+	let total: u64 = histogram.iter().map(|&count| count as u64).sum();
+
+	if unlikely(total == 0) {
+		return None;
+	}
+	let mut seen = 0_u64;
+
+	histogram.iter().position(|&count| {
+		seen += count as u64;
+		seen > total / 2
+	})
+}
+
+#[inline]
+fn sum_of(k: usize) -> f32 {
+	k as f32 / 16.0 - 30.0
+}
+
+fn volume(median: f32) -> f32 {
+	if unlikely(!median.is_finite() || median <= f32::MIN_POSITIVE.ln()) {
+		return DEFAULT_MEDIAN_VOLUME;
+	}
+	(std::f32::consts::PI * 4.0 / 3.0) * median.exp()
+}
+
+/// The median ellipsoid volume of arbitrary log-scales, sorting their sums.
+fn select_median_volume(scales: &[f32]) -> f32 {
+	// The volume of an ellipsoid is 4/3 * pi * x * y * z,
+	// where x, y, and z are the radii on each axis.
+	// Scales are stored on a log scale, and
+	// 	exp(x) * exp(y) * exp(z) = exp(x + y + z).
+	// So we can sort by value = (x + y + z) and compute
+	// 	volume = 4/3 * pi * exp(value) later.
+	let mut sums = scales
+		.chunks_exact(3)
+		.map(|c| c[0] + c[1] + c[2])
+		.filter(|s| s.is_finite())
+		.collect::<Vec<_>>();
+
+	if unlikely(sums.is_empty()) {
+		return DEFAULT_MEDIAN_VOLUME;
+	}
+	let n = sums.len() / 2;
+
+	sums.select_nth_unstable_by(n, |a, b| {
+		a.partial_cmp(b).unwrap_or(std::cmp::Ordering::Equal)
+	});
+	volume(sums[n])
+}
+
+/// Bounding box of 24-bit fixed point positions, compared as integers.
+fn packed_bbox(view: &PackedGaussianSplatView, flips: &AxisFlips) -> BoundingBox {
+	let mut min = [i32::MAX; 3];
+	let mut max = [i32::MIN; 3];
+
+	for point in view.positions.chunks_exact(9) {
+		for (axis, fixed) in point.chunks_exact(3).enumerate() {
+			// sign extends the 24-bit value
+			let value = i32::from_le_bytes([0, fixed[0], fixed[1], fixed[2]]) >> 8;
+
+			min[axis] = min[axis].min(value);
+			max[axis] = max[axis].max(value);
+		}
+	}
+	if unlikely(min[0] > max[0]) {
+		return BoundingBox::from_positions(&[]);
+	}
+	let scale = kernels::position_scale(view.fractional_bits);
+	// decoding is monotonic, a flipped axis swaps its bounds
+	let [(min_x, max_x), (min_y, max_y), (min_z, max_z)] = std::array::from_fn(|axis| {
+		let lo = min[axis] as f32 * scale * flips.position[axis];
+		let hi = max[axis] as f32 * scale * flips.position[axis];
+
+		(lo.min(hi), lo.max(hi))
+	});
+
+	BoundingBox {
+		min_x,
+		max_x,
+		min_y,
+		max_y,
+		min_z,
+		max_z,
+	}
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+	use crate::coord::CoordinateSystem;
+	use crate::gaussian_splat::{AttributeMask, LoadOptions, SaveOptions};
+	use crate::lazy::LazyGaussianSplat;
+	use crate::test_util::splat;
+
+	#[test]
+	fn test_histogram_median_matches_selection() {
+		let compressed = splat(1001, 0)
+			.serialize_to_packed_bytes(&SaveOptions::default())
+			.unwrap();
+		let opts = LoadOptions::builder()
+			.coord_sys(CoordinateSystem::LeftDownFront)
+			.build();
+		let decoded = GaussianSplat::read_from_bytes(&compressed, &opts).unwrap();
+		let expected = select_median_volume(&decoded.scales);
+
+		assert_eq!(median_volume(&decoded.scales), expected);
+		// off the grid, selected
+		assert_eq!(
+			median_volume(&splat(1001, 0).scales),
+			select_median_volume(&splat(1001, 0).scales)
+		);
+
+		let lazy =
+			LazyGaussianSplat::from_bytes(&compressed, &opts, AttributeMask::empty())
+				.unwrap();
+		let stats = lazy.statistics();
+
+		assert_eq!(stats.median_volume, expected);
+		assert_eq!(stats.bbox, decoded.bbox());
+		assert_eq!(*stats, Statistics::from_splat(&decoded));
+	}
+
+	#[test]
+	fn test_empty_statistics() {
+		let stats = Statistics::from_splat(&GaussianSplat::default());
+
+		assert_eq!(stats.median_volume, DEFAULT_MEDIAN_VOLUME);
+		assert_eq!(stats.bbox, BoundingBox::from_positions(&[]));
+	}
+}
@@ -0,0 +1,442 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+//! Streaming decode of gzip compressed SPZ data.
+//!
+//! Instead of inflating the whole file into memory before decoding it, the
+//! decoder pulls inflated bytes through a small fixed-size window and
+//! dequantizes each attribute section (positions, alphas, colors, scales,
+//! rotations and spherical harmonics, in file order) straight into its final
+//! float buffer while inflating. Peak memory is the decoded splat plus the
+//! window, and float work starts with the first inflated block.
+
+use std::cell::Cell;
+use std::io::Read;
+use std::time::{Duration, Instant};
+
+use anyhow::{Context, Result};
+use likely_stable::unlikely;
+
+use crate::{
+	compression,
+	coord::CoordinateSystem,
+	gaussian_splat::{self, AttributeLens, GaussianSplat, LoadOptions},
+	header::{HEADER_SIZE, Header},
+	instrument::{self, Stage},
+	kernels,
+	math::dim_for_degree,
+	packed::{self, is_encoding_quaternion_smallest_three_used},
+};
+
+/// Default size of the window of inflated bytes, in bytes.
+pub const DEFAULT_WINDOW_SIZE: usize = 64 * 1024;
+
+/// Largest per-point stride of any section, 45 bytes of degree 3 spherical
+/// harmonics. Windows are never smaller than this.
+const MIN_WINDOW_SIZE: usize = 45;
+
+/// Decodes a [`GaussianSplat`] from gzip compressed, packed gaussian data,
+/// using a window of [`DEFAULT_WINDOW_SIZE`] bytes.
+///
+/// # Args
+///
+/// `compressed` - gzip compressed, packed gaussian data.
+/// `opts` - options for loading the splat.
+#[inline]
+pub fn decode_from<R>(compressed: R, opts: &LoadOptions) -> Result<GaussianSplat>
+where
+	R: Read,
+{
+	decode_from_with_window(compressed, opts, DEFAULT_WINDOW_SIZE)
+}
+
+/// Decodes a [`GaussianSplat`] from gzip compressed, packed gaussian data.
+///
+/// Multi-member streams are inflated member after member, zstd data (see
+/// [`compression::zstd`]) is detected and inflated as well.
+///
+/// When every section gets decoded, the stream is read to its end so its
+/// checksums are verified. A selection of attributes or a
+/// [`LoadOptions::max_decompressed_len`] stops inflating after the last
+/// decoded section, like buffered loads do.
+///
+/// # Args
+///
+/// `compressed` - gzip or zstd compressed, packed gaussian data.
+/// `opts` - options for loading the splat.
+/// `window_size` - size of the window of inflated bytes, in bytes.
+#[inline]
+pub fn decode_from_with_window<R>(
+	compressed: R,
+	opts: &LoadOptions,
+	window_size: usize,
+) -> Result<GaussianSplat>
+where
+	R: Read,
+{
+	let read = Cell::new(0);
+	let mut decoder = compression::decoder(CountingReader {
+		inner: compressed,
+		read: &read,
+	})?;
+	let result = decode_sections(&mut decoder, opts, window_size, Stage::Inflate);
+
+	instrument::record(Stage::Inflate, |stats| stats.bytes_in += read.get());
+
+	result
+}
+
+/// Decodes a [`GaussianSplat`] from already decompressed, packed gaussian
+/// data: the header followed by the attribute sections.
+///
+/// # Args
+///
+/// `decompressed` - decompressed, packed gaussian data.
+/// `opts` - options for loading the splat.
+/// `window_size` - size of the window of read bytes, in bytes.
+#[inline]
+pub fn decode_decompressed_from<R>(
+	decompressed: &mut R,
+	opts: &LoadOptions,
+	window_size: usize,
+) -> Result<GaussianSplat>
+where
+	R: Read,
+{
+	decode_sections(decompressed, opts, window_size, Stage::Parse)
+}
+
+/// Decodes the header and sections read from `decompressed`, timing the
+/// reads as `read_stage` when collecting [`instrument`] statistics.
+fn decode_sections<R>(
+	decompressed: &mut R,
+	opts: &LoadOptions,
+	window_size: usize,
+	read_stage: Stage,
+) -> Result<GaussianSplat>
+where
+	R: Read,
+{
+	let _span = instrument::span("decode_stream");
+	let mut times = instrument::is_collecting().then(SectionTimes::default);
+	let start = times.is_some().then(Instant::now);
+	let header = Header::read_from(decompressed)
+		.with_context(|| "unable to read packed gaussians header")?;
+
+	if let (Some(times), Some(start)) = (times.as_mut(), start) {
+		times.read += start.elapsed();
+		times.bytes += HEADER_SIZE;
+	}
+
+	opts.check_limits(&header)?;
+
+	let num_points = header.num_points.max(0) as usize;
+	let sh_degree = opts.decoded_sh_degree(header.spherical_harmonics_degree);
+	let sh_dim = dim_for_degree(header.spherical_harmonics_degree) as usize;
+	let kept_sh_dim = dim_for_degree(sh_degree) as usize;
+	// the sections after the last decoded one are never read
+	let sections = packed::leading_sections(
+		opts.decoded_attributes(header.spherical_harmonics_degree),
+	);
+	let lens = AttributeLens::decoded(&header, opts);
+	let fractional_bits = header.fractional_bits as i32;
+	let uses_quaternion_smallest_three =
+		is_encoding_quaternion_smallest_three_used(header.version);
+
+	let mut sections_reader = SectionReader {
+		window: vec![0_u8; window_size.max(MIN_WINDOW_SIZE)],
+		num_points,
+		times,
+	};
+	let mut result = GaussianSplat {
+		header: Header {
+			num_points: header.num_points,
+			spherical_harmonics_degree: sh_degree,
+			fractional_bits: header.fractional_bits,
+			flags: header.flags,
+			..Default::default()
+		},
+		// the buffers grow as their sections are read, truncated data never
+		// gets the allocations its header claims
+		..Default::default()
+	};
+	let mut section = |i: usize,
+	                   strides: (usize, usize),
+	                   dst: &mut Vec<f32>,
+	                   len: usize,
+	                   decode: &mut dyn FnMut(&[u8], &mut [f32])| {
+		if i >= sections {
+			return Ok(());
+		}
+		sections_reader.read(
+			decompressed,
+			packed::SECTION_NAMES[i],
+			strides,
+			dst,
+			len,
+			decode,
+		)
+	};
+	section(
+		0,
+		(9, 3),
+		&mut result.positions,
+		lens.positions,
+		&mut |src, dst| kernels::decode_positions(src, dst, fractional_bits),
+	)?;
+	section(
+		1,
+		(1, 1),
+		&mut result.alphas,
+		lens.alphas,
+		&mut kernels::decode_alphas,
+	)?;
+	section(
+		2,
+		(3, 3),
+		&mut result.colors,
+		lens.colors,
+		&mut kernels::decode_colors,
+	)?;
+	section(
+		3,
+		(3, 3),
+		&mut result.scales,
+		lens.scales,
+		&mut kernels::decode_scales,
+	)?;
+	section(
+		4,
+		(if uses_quaternion_smallest_three { 4 } else { 3 }, 4),
+		&mut result.rotations,
+		lens.rotations,
+		&mut |src, dst| kernels::decode_rotations(src, dst, uses_quaternion_smallest_three),
+	)?;
+	section(
+		5,
+		(sh_dim * 3, kept_sh_dim * 3),
+		&mut result.spherical_harmonics,
+		lens.spherical_harmonics,
+		&mut |src, dst| {
+			kernels::decode_spherical_harmonics_truncated(
+				src,
+				dst,
+				sh_dim * 3,
+				kept_sh_dim * 3,
+			)
+		},
+	)?;
+
+	// gzip checks its CRC-32 and length trailer at the end of the stream
+	// and rejects trailing garbage there, which reading only the sections
+	// never reaches
+	if opts.inflates_everything(header.spherical_harmonics_degree) {
+		std::io::copy(decompressed, &mut std::io::sink())
+			.with_context(|| "unable to read the end of the data")?;
+	}
+	if let Some(times) = sections_reader.times {
+		let float_bytes = lens.total() * size_of::<f32>();
+
+		instrument::record(read_stage, |stats| {
+			stats.calls += 1;
+			stats.wall += times.read;
+			stats.bytes_out += times.bytes as u64;
+			stats.allocated += sections_reader.window.len() as u64;
+			stats.threads = stats.threads.max(1);
+		});
+		instrument::record(Stage::Dequantize, |stats| {
+			stats.calls += 1;
+			stats.wall += times.decode;
+			stats.bytes_in += times.decoded as u64;
+			stats.bytes_out += float_bytes as u64;
+			stats.allocated += float_bytes as u64;
+			stats.threads = stats.threads.max(1);
+		});
+	}
+	if header.num_points > 0 {
+		let flipped = (result.positions.len()
+			+ result.rotations.len()
+			+ result.spherical_harmonics.len())
+			* size_of::<f32>();
+		let mut stage = instrument::enter(Stage::ConvertCoordinates, flipped);
+
+		gaussian_splat::apply_axis_flips(
+			&opts.coord_sys.axis_flips_to(CoordinateSystem::RightUpBack),
+			&mut result.positions,
+			&mut result.rotations,
+			&mut result.spherical_harmonics,
+			kept_sh_dim,
+		);
+		stage.bytes_out(flipped);
+	}
+	Ok(result)
+}
+
+/// Time spent reading and dequantizing sections, and bytes read.
+#[derive(Default)]
+struct SectionTimes {
+	read: Duration,
+	decode: Duration,
+	bytes: usize,
+	decoded: usize,
+}
+
+/// Counts the bytes read from the inner reader.
+struct CountingReader<'a, R> {
+	inner: R,
+	read: &'a Cell<u64>,
+}
+
+impl<R> Read for CountingReader<'_, R>
+where
+	R: Read,
+{
+	#[inline]
+	fn read(&mut self, buf: &mut [u8]) -> std::io::Result<usize> {
+		let n = self.inner.read(buf)?;
+
+		self.read.set(self.read.get() + n as u64);
+
+		Ok(n)
+	}
+}
+
+/// Reads attribute sections through a window of bytes.
+struct SectionReader {
+	window: Vec<u8>,
+	/// Points of every section.
+	num_points: usize,
+	times: Option<SectionTimes>,
+}
+
+impl SectionReader {
+	/// Reads the section of [`SectionReader::num_points`] points of one
+	/// attribute and decodes
+	/// it into `dst`, growing it to `len` floats as the points are read, or
+	/// skips it if `len` is 0.
+	///
+	/// `strides` is the per-point (source bytes, destination floats) pair of
+	/// the section, the window is filled with as many whole points as fit.
+	fn read<R>(
+		&mut self,
+		reader: &mut R,
+		name: &str,
+		strides: (usize, usize),
+		dst: &mut Vec<f32>,
+		len: usize,
+		decode: &mut dyn FnMut(&[u8], &mut [f32]),
+	) -> Result<()>
+	where
+		R: Read,
+	{
+		let (src_stride, dst_stride) = strides;
+		let num_points = self.num_points;
+
+		if unlikely(num_points == 0 || src_stride == 0) {
+			return Ok(());
+		}
+		let skip = len == 0 || dst_stride == 0;
+		let points_per_window = (self.window.len() / src_stride).max(1);
+		let mut done = 0_usize;
+
+		while done < num_points {
+			let n = points_per_window.min(num_points - done);
+			let src = &mut self.window[..n * src_stride];
+
+			let start = self.times.is_some().then(Instant::now);
+
+			reader.read_exact(src)
+				.with_context(|| format!("read error ({name})"))?;
+
+			let read = self.times.is_some().then(Instant::now);
+
+			if !skip {
+				let end = (done + n) * dst_stride;
+
+				if dst.capacity() < end {
+					// doubles with the points read, up to exactly `len`
+					dst.reserve_exact(
+						end.max(dst.capacity() * 2).min(len) - dst.len(),
+					);
+				}
+				dst.resize(end, 0.0);
+				decode(src, &mut dst[done * dst_stride..end]);
+			}
+			if let (Some(times), Some(start), Some(read)) =
+				(self.times.as_mut(), start, read)
+			{
+				times.read += read - start;
+				times.bytes += src.len();
+
+				if !skip {
+					times.decode += read.elapsed();
+					times.decoded += src.len();
+				}
+			}
+			done += n;
+		}
+		Ok(())
+	}
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+	use crate::{gaussian_splat::SaveOptions, packed::PackedGaussianSplat, test_util::splat};
+	use rstest::rstest;
+
+	#[rstest]
+	#[case(0, DEFAULT_WINDOW_SIZE)]
+	#[case(1000, DEFAULT_WINDOW_SIZE)]
+	#[case(1000, 1)]
+	#[case(1000, 100)]
+	fn test_stream_decode_matches_buffered_decode(
+		#[case] num_points: usize,
+		#[case] window_size: usize,
+	) {
+		let bytes = splat(num_points, 2)
+			.serialize_to_packed_bytes(&SaveOptions::default())
+			.unwrap();
+		let opts = LoadOptions::builder()
+			.coord_sys(CoordinateSystem::LeftUpFront)
+			.build();
+
+		let expected = GaussianSplat::new_from_packed_gaussians(
+			&PackedGaussianSplat::from_bytes(&bytes).unwrap(),
+			&opts,
+		)
+		.unwrap();
+		let streamed =
+			decode_from_with_window(bytes.as_slice(), &opts, window_size).unwrap();
+
+		assert_eq!(streamed, expected);
+	}
+
+	#[test]
+	fn test_stream_decode_checks_trailer() {
+		let bytes = splat(100, 2)
+			.serialize_to_packed_bytes(&SaveOptions::default())
+			.unwrap();
+		let opts = LoadOptions::default();
+		let mut corrupt_crc = bytes.clone();
+		let crc = corrupt_crc.len() - 8;
+
+		corrupt_crc[crc] ^= 0xff;
+
+		let mut trailing = bytes.clone();
+
+		trailing.extend_from_slice(b"garbage");
+
+		assert!(decode_from(bytes.as_slice(), &opts).is_ok());
+		assert!(decode_from(corrupt_crc.as_slice(), &opts).is_err());
+		assert!(decode_from(trailing.as_slice(), &opts).is_err());
+	}
+
+	#[test]
+	fn test_stream_decode_truncated_fails() {
+		let bytes = splat(100, 2)
+			.serialize_to_packed_bytes(&SaveOptions::default())
+			.unwrap();
+
+		assert!(decode_from(&bytes[..bytes.len() / 2], &LoadOptions::default()).is_err());
+	}
+}
@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+//! Deterministic splats for tests, shared by the unit tests, the
+//! integration tests and the crates depending on this one through the
+//! `test-util` feature.
+
+use std::ops::Range;
+
+use crate::{gaussian_splat::GaussianSplat, header::Header, math::dim_for_degree};
+
+/// A pseudo random value in `[-1, 1)`, the same for the same `i`.
+#[inline]
+pub fn unit(i: usize) -> f32 {
+	let h = (i as u64 + 1).wrapping_mul(0x9e37_79b9_7f4a_7c15);
+
+	((h >> 40) as f32 / (1 << 24) as f32) * 2.0 - 1.0
+}
+
+/// A splat of `num_points` points with spherical harmonics of degree
+/// `sh_degree`, see [`splat_range`].
+#[inline]
+pub fn splat(num_points: usize, sh_degree: u8) -> GaussianSplat {
+	splat_range(0..num_points, sh_degree)
+}
+
+/// The points `points` of a deterministic splat. Every value only depends on
+/// its point and component, so the splats of consecutive ranges add up to
+/// the splat of their union.
+///
+/// Positions are within 10 of the origin, log scales in `[-4, -2)`,
+/// rotations normalized, alphas in `[-2, 2)`, colors in `[-1, 1)` and
+/// spherical harmonics in `[-0.5, 0.5)`.
+pub fn splat_range(points: Range<usize>, sh_degree: u8) -> GaussianSplat {
+	let values = |stride: usize, seed: usize, scale: f32, bias: f32| -> Vec<f32> {
+		points.clone()
+			.flat_map(|p| {
+				(0..stride).map(move |c| {
+					unit((p * stride + c) * 8 + seed) * scale + bias
+				})
+			})
+			.collect()
+	};
+	let sh_dim = dim_for_degree(sh_degree) as usize;
+
+	GaussianSplat {
+		header: Header {
+			num_points: points.len() as i32,
+			spherical_harmonics_degree: sh_degree,
+			..Default::default()
+		},
+		positions: values(3, 0, 10.0, 0.0),
+		scales: values(3, 1, 1.0, -3.0),
+		rotations: values(4, 2, 1.0, 0.0)
+			.chunks_exact(4)
+			.flat_map(|q| {
+				// away from zero, so every quaternion normalizes
+				let q = [q[0], q[1], q[2], q[3].abs() + 0.5];
+				let n = q.iter().map(|v| v * v).sum::<f32>().sqrt();
+
+				q.map(|v| v / n)
+			})
+			.collect(),
+		alphas: values(1, 3, 2.0, 0.0),
+		colors: values(3, 4, 1.0, 0.0),
+		spherical_harmonics: values(sh_dim * 3, 5, 0.5, 0.0),
+	}
+}
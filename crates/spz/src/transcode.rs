@@ -0,0 +1,271 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+//! Converting packed gaussian data between coordinate systems without
+//! decoding it.
+//!
+//! An axis flip only changes signs, which the quantized values can take
+//! directly: positions are negated 24-bit integers, rotations get sign bits
+//! toggled and spherical harmonics are reflected around 128, see the flip
+//! kernels of [`kernels`]. Scales, alphas and colors are left as they are.
+//!
+//! Unlike decoding, converting the floats and encoding again, nothing is
+//! quantized twice, so rotations keep exactly the precision they had.
+
+use std::path::Path;
+
+use anyhow::{Context, Result, bail};
+use likely_stable::unlikely;
+
+use crate::{
+	chunked,
+	compression::{self, Codec, CompressionLevel},
+	coord::{AxisFlips, CoordinateSystem},
+	header::HEADER_SIZE,
+	kernels, lod,
+	math::dim_for_degree,
+	mmap,
+	packed::{PackedGaussianSplatView, SECTIONS},
+};
+
+/// Converts decompressed, packed gaussian data between coordinate systems,
+/// in place.
+///
+/// # Args
+///
+/// `decompressed` - the header followed by the attribute sections.
+/// `source_cs` - the coordinate system the data is in.
+/// `target_cs` - the coordinate system to convert to.
+#[inline]
+pub fn convert_coordinates_in_place(
+	decompressed: &mut [u8],
+	source_cs: CoordinateSystem,
+	target_cs: CoordinateSystem,
+) -> Result<()> {
+	convert_prefix_in_place(decompressed, SECTIONS.len(), source_cs, target_cs)
+}
+
+/// Like [`convert_coordinates_in_place`], for the start of decompressed data
+/// holding only its first `sections` attribute sections, in file order, as
+/// [`LoadOptions::decompress_decoded`] leaves it.
+///
+/// [`LoadOptions::decompress_decoded`]: crate::gaussian_splat::LoadOptions::decompress_decoded
+pub fn convert_prefix_in_place(
+	decompressed: &mut [u8],
+	sections: usize,
+	source_cs: CoordinateSystem,
+	target_cs: CoordinateSystem,
+) -> Result<()> {
+	let view = PackedGaussianSplatView::from_prefix(&*decompressed, sections)?;
+	let sh_dim = dim_for_degree(view.sh_degree as u8) as usize;
+	let uses_quaternion_smallest_three = view.uses_quaternion_smallest_three;
+	let positions_len = view.positions.len();
+	let skipped_len = view.alphas.len() + view.colors.len() + view.scales.len();
+	let rotations_len = view.rotations.len();
+	let spherical_harmonics_len = view.spherical_harmonics.len();
+
+	let (positions, rest) = decompressed[HEADER_SIZE..].split_at_mut(positions_len);
+	let (rotations, rest) = rest[skipped_len..].split_at_mut(rotations_len);
+
+	flip_sections(
+		&source_cs.axis_flips_to(target_cs),
+		positions,
+		rotations,
+		&mut rest[..spherical_harmonics_len],
+		sh_dim,
+		uses_quaternion_smallest_three,
+	);
+	Ok(())
+}
+
+/// Converts gzip or zstd compressed, packed gaussian data between coordinate
+/// systems, compressing the result with the codec of the input.
+///
+/// # Args
+///
+/// `compressed` - compressed, packed gaussian data.
+/// `source_cs` - the coordinate system the data is in.
+/// `target_cs` - the coordinate system to convert to.
+/// `level` - compression level of the result.
+pub fn convert_coordinates(
+	compressed: &[u8],
+	source_cs: CoordinateSystem,
+	target_cs: CoordinateSystem,
+	level: CompressionLevel,
+) -> Result<Vec<u8>> {
+	if unlikely(chunked::is_chunked(compressed) || lod::is_progressive(compressed)) {
+		bail!("chunked and progressive files can't be transcoded");
+	}
+	let mut decompressed = Vec::new();
+
+	compression::decompress(compressed, &mut decompressed, 0)
+		.with_context(|| "unable to decompress data")?;
+	convert_coordinates_in_place(&mut decompressed, source_cs, target_cs)?;
+
+	let mut out = Vec::new();
+
+	compression::compress(&decompressed, &mut out, Codec::detect(compressed), level)?;
+
+	Ok(out)
+}
+
+/// Converts an SPZ file between coordinate systems, see
+/// [`convert_coordinates`].
+///
+/// # Args
+///
+/// `input` - the file to read.
+/// `output` - the file to write, may be `input`.
+/// `source_cs` - the coordinate system the data is in.
+/// `target_cs` - the coordinate system to convert to.
+/// `level` - compression level of the result.
+pub fn convert_file<I, O>(
+	input: I,
+	output: O,
+	source_cs: CoordinateSystem,
+	target_cs: CoordinateSystem,
+	level: CompressionLevel,
+) -> Result<()>
+where
+	I: AsRef<Path>,
+	O: AsRef<Path>,
+{
+	let compressed = mmap::read_or_map(input)?;
+	let converted = convert_coordinates(&compressed, source_cs, target_cs, level)?;
+
+	// `output` may be `input`, unmap it before writing
+	drop(compressed);
+	std::fs::write(output, converted).with_context(|| "unable to write to file")
+}
+
+/// Applies `flip` to the sections of packed data that change with the
+/// coordinate system.
+pub(crate) fn flip_sections(
+	flip: &AxisFlips,
+	positions: &mut [u8],
+	rotations: &mut [u8],
+	spherical_harmonics: &mut [u8],
+	sh_dim: usize,
+	uses_quaternion_smallest_three: bool,
+) {
+	kernels::flip_positions(positions, flip.position);
+	kernels::flip_rotations(rotations, flip.rotation, uses_quaternion_smallest_three);
+	kernels::flip_spherical_harmonics(spherical_harmonics, &flip.spherical_harmonics, sh_dim);
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+	use crate::gaussian_splat::{GaussianSplat, LoadOptions, SaveOptions};
+	use crate::test_util;
+	use rstest::rstest;
+
+	fn splat(num_points: usize, sh_range: f32) -> GaussianSplat {
+		let mut splat = test_util::splat(num_points, 3);
+
+		// the coefficients are within 0.5
+		for v in &mut splat.spherical_harmonics {
+			*v *= sh_range * 2.0;
+		}
+		splat
+	}
+
+	#[rstest]
+	#[case(CoordinateSystem::RightDownFront)]
+	#[case(CoordinateSystem::LeftDownFront)]
+	#[case(CoordinateSystem::LeftUpBack)]
+	fn test_convert_coordinates_matches_float_round_trip(#[case] target: CoordinateSystem) {
+		let source = CoordinateSystem::RightUpBack;
+		// 255 is reflected exactly, unlike by the float path, which rounds the
+		// reflection to the quantization step
+		let compressed = splat(500, 0.9)
+			.serialize_to_packed_bytes(&SaveOptions::default())
+			.unwrap();
+		let load = LoadOptions::default();
+
+		let transcoded = GaussianSplat::read_from_bytes(
+			&convert_coordinates(&compressed, source, target, CompressionLevel::Fast)
+				.unwrap(),
+			&load,
+		)
+		.unwrap();
+		let mut expected = GaussianSplat::read_from_bytes(&compressed, &load).unwrap();
+
+		expected.convert_coordinates(source, target);
+		expected = GaussianSplat::read_from_bytes(
+			&expected
+				.serialize_to_packed_bytes(&SaveOptions::default())
+				.unwrap(),
+			&load,
+		)
+		.unwrap();
+
+		assert_eq!(transcoded.header, expected.header);
+		assert_eq!(transcoded.positions, expected.positions);
+		assert_eq!(transcoded.scales, expected.scales);
+		assert_eq!(transcoded.alphas, expected.alphas);
+		assert_eq!(transcoded.colors, expected.colors);
+		assert_eq!(transcoded.spherical_harmonics, expected.spherical_harmonics);
+
+		for (a, b) in transcoded
+			.rotations
+			.chunks_exact(4)
+			.zip(expected.rotations.chunks_exact(4))
+		{
+			let dot: f32 = a.iter().zip(b).map(|(a, b)| a * b).sum();
+
+			assert!(dot.abs() > 0.999, "{a:?} vs {b:?}");
+		}
+	}
+
+	#[test]
+	fn test_convert_coordinates_in_place_twice_is_identity() {
+		// -1, byte 0, has no counterpart and is clamped to 255, stay clear of it
+		let packed = splat(300, 0.5)
+			.to_packed_gaussians(&SaveOptions::default())
+			.unwrap();
+		let original = packed.to_bytes_vec().unwrap();
+		let mut bytes = original.clone();
+
+		convert_coordinates_in_place(
+			&mut bytes,
+			CoordinateSystem::RightUpBack,
+			CoordinateSystem::LeftDownFront,
+		)
+		.unwrap();
+		assert_ne!(bytes, original);
+
+		convert_coordinates_in_place(
+			&mut bytes,
+			CoordinateSystem::LeftDownFront,
+			CoordinateSystem::RightUpBack,
+		)
+		.unwrap();
+		assert_eq!(bytes, original);
+	}
+	#[test]
+	fn test_convert_prefix_in_place_matches_whole_data() {
+		let packed = splat(300, 0.5)
+			.to_packed_gaussians(&SaveOptions::default())
+			.unwrap();
+		let mut whole = packed.to_bytes_vec().unwrap();
+		let (source, target) = (
+			CoordinateSystem::RightUpBack,
+			CoordinateSystem::LeftDownFront,
+		);
+
+		for sections in [0, 1, 5] {
+			let mut bytes = whole.clone();
+			let len = crate::packed::prefix_len(&packed.to_header(), sections);
+
+			bytes.truncate(len);
+			convert_prefix_in_place(&mut bytes, sections, source, target).unwrap();
+
+			let mut expected = whole.clone();
+
+			convert_coordinates_in_place(&mut expected, source, target).unwrap();
+			assert_eq!(bytes, expected[..len], "{sections} sections");
+		}
+		whole.truncate(100);
+		assert!(convert_prefix_in_place(&mut whole, 1, source, target).is_err());
+	}
+}
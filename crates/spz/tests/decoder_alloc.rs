@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+//! Counts heap allocations of steady state decoding, in a test binary of its
+//! own so the counting allocator doesn't slow down the other tests.
+
+use std::alloc::{GlobalAlloc, Layout, System};
+use std::cell::Cell;
+
+use spz::prelude::{Decoder, GaussianSplat, LoadOptions, SaveOptions};
+use spz::test_util::splat;
+
+struct CountingAllocator;
+
+thread_local! {
+	static ALLOCATIONS: Cell<usize> = const { Cell::new(0) };
+}
+
+// SAFETY: forwards to the system allocator, only counting the calls.
+unsafe impl GlobalAlloc for CountingAllocator {
+	unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+		ALLOCATIONS.with(|n| n.set(n.get() + 1));
+
+		// SAFETY: same contract as the caller's.
+		unsafe { System.alloc(layout) }
+	}
+
+	unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+		// SAFETY: `ptr` was allocated by `System` with `layout`.
+		unsafe { System.dealloc(ptr, layout) }
+	}
+
+	unsafe fn realloc(&self, ptr: *mut u8, layout: Layout, new_size: usize) -> *mut u8 {
+		ALLOCATIONS.with(|n| n.set(n.get() + 1));
+
+		// SAFETY: same contract as the caller's.
+		unsafe { System.realloc(ptr, layout, new_size) }
+	}
+}
+
+#[global_allocator]
+static GLOBAL: CountingAllocator = CountingAllocator;
+
+fn allocations() -> usize {
+	ALLOCATIONS.with(Cell::get)
+}
+
+#[test]
+fn test_decoder_steady_state_does_not_allocate() {
+	let files: Vec<Vec<u8>> = [2000, 1500, 2000]
+		.into_iter()
+		.map(|num_points| {
+			splat(num_points, 3)
+				.serialize_to_packed_bytes(&SaveOptions::default())
+				.unwrap()
+		})
+		.collect();
+	let opts = LoadOptions::default();
+	let mut decoder = Decoder::new();
+	let mut decoded = GaussianSplat::default();
+
+	// grows the buffers to the largest file
+	decoder.decode_into(&files[0], &opts, &mut decoded).unwrap();
+
+	let before = allocations();
+
+	for _ in 0..3 {
+		for file in &files {
+			decoder.decode_into(file, &opts, &mut decoded).unwrap();
+		}
+	}
+	assert_eq!(allocations() - before, 0);
+}
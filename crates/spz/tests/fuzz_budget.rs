@@ -0,0 +1,578 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+//! Runs fuzz inputs through the decoders one at a time and fails on inputs
+//! that take longer or allocate more than their budget, in a test binary of
+//! its own for its peak tracking allocator. The peak counts the allocations
+//! of every thread, those of the decoders' worker threads included.
+//!
+//! Besides the pathological inputs built here, the files of
+//! `fuzz/corpus/<target>/`, as kept by `cargo fuzz`, are run like their fuzz
+//! target runs them, and the files of the directories in `SPZ_FUZZ_CORPUS`,
+//! separated like `PATH`, are decoded as SPZ data. `SPZ_FUZZ_TIME_BUDGET_MS`
+//! and `SPZ_FUZZ_MEMORY_BUDGET` (bytes) override the budgets.
+//!
+//! An allocator counting for the whole process can't tell concurrent inputs
+//! apart, so the inputs are split into shards that run in parallel in child
+//! processes of this test binary, each running its inputs one at a time and
+//! printing its failures for the parent to collect. `SPZ_FUZZ_SHARDS` sets
+//! their number, by default the available cores up to [`MAX_SHARDS`], 1
+//! runs every input in the test process.
+
+use std::alloc::{GlobalAlloc, Layout, System};
+use std::panic::{self, AssertUnwindSafe};
+use std::path::{Path, PathBuf};
+use std::process::{Command, Stdio};
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::time::{Duration, Instant};
+
+use arbitrary::{Arbitrary, Unstructured};
+use spz::{
+	chunked, compression,
+	coord::CoordinateSystem,
+	gaussian_splat::{AttributeMask, GaussianSplat, LoadOptions, SaveOptions},
+	header::{HEADER_SIZE, Header},
+	lazy::LazyGaussianSplat,
+	lod::{self, LodOptions, ProgressiveReader},
+	packed::PackedGaussianSplat,
+	prelude::Decoder,
+	test_util::splat,
+};
+
+/// Wall time an input may take in one entry point.
+const TIME_BUDGET: Duration = Duration::from_secs(10);
+
+/// Bytes an input may keep allocated at once in one entry point.
+const MEMORY_BUDGET: usize = 256 << 20;
+
+/// Largest number of points the SPZ data is decoded with.
+const MAX_POINTS: usize = 1 << 18;
+
+/// Largest decompressed length the SPZ data is decoded with.
+const MAX_DECOMPRESSED_LEN: usize = 16 << 20;
+
+/// Default upper bound of shards, each may keep [`MEMORY_BUDGET`] allocated.
+const MAX_SHARDS: usize = 8;
+
+/// Environment variable naming the shard a child process runs, `i/n` for
+/// the `i`th of `n`.
+const SHARD_VAR: &str = "SPZ_FUZZ_SHARD";
+
+/// Start of the lines a shard reports a failure in.
+const FAILURE_PREFIX: &str = "spz-fuzz-failure: ";
+
+struct PeakAllocator;
+
+/// Bytes allocated by the whole process.
+static ALLOCATED: AtomicUsize = AtomicUsize::new(0);
+
+/// Most bytes allocated at once since the last [`measure`].
+static PEAK: AtomicUsize = AtomicUsize::new(0);
+
+#[inline]
+fn grow(n: usize) {
+	let allocated = ALLOCATED.fetch_add(n, Ordering::Relaxed) + n;
+
+	PEAK.fetch_max(allocated, Ordering::Relaxed);
+}
+
+#[inline]
+fn shrink(n: usize) {
+	ALLOCATED.fetch_sub(n, Ordering::Relaxed);
+}
+
+// SAFETY: forwards to the system allocator, only counting the bytes.
+unsafe impl GlobalAlloc for PeakAllocator {
+	unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+		grow(layout.size());
+
+		// SAFETY: same contract as the caller's.
+		unsafe { System.alloc(layout) }
+	}
+
+	unsafe fn alloc_zeroed(&self, layout: Layout) -> *mut u8 {
+		grow(layout.size());
+
+		// SAFETY: same contract as the caller's.
+		unsafe { System.alloc_zeroed(layout) }
+	}
+
+	unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+		shrink(layout.size());
+
+		// SAFETY: `ptr` was allocated by `System` with `layout`.
+		unsafe { System.dealloc(ptr, layout) }
+	}
+
+	unsafe fn realloc(&self, ptr: *mut u8, layout: Layout, new_size: usize) -> *mut u8 {
+		if new_size > layout.size() {
+			grow(new_size - layout.size());
+		} else {
+			shrink(layout.size() - new_size);
+		}
+		// SAFETY: same contract as the caller's.
+		unsafe { System.realloc(ptr, layout, new_size) }
+	}
+}
+
+#[global_allocator]
+static GLOBAL: PeakAllocator = PeakAllocator;
+
+/// A named way of running an input.
+type EntryPoint = (&'static str, fn(&[u8]));
+
+/// Entry points of SPZ data, as decoded by the `decode` fuzz target.
+const DECODE: &[EntryPoint] = &[
+	("read_from_bytes", |data| {
+		let _ = GaussianSplat::read_from_bytes(data, &limits());
+	}),
+	("read_from", |data| {
+		let _ = GaussianSplat::read_from(data, &limits());
+	}),
+	("decoder", |data| {
+		let _ = Decoder::new().decode(data, &limits());
+	}),
+	("selective", |data| {
+		let opts = LoadOptions {
+			max_sh_degree: 1,
+			attributes: AttributeMask::POSITIONS | AttributeMask::SPHERICAL_HARMONICS,
+			..limits()
+		};
+		let _ = GaussianSplat::read_from_bytes(data, &opts);
+		let _ = Decoder::new().decode(data, &opts);
+	}),
+	("progressive", |data| {
+		if let Ok(reader) = ProgressiveReader::new(data, limits()) {
+			reader.for_each(drop);
+		}
+	}),
+	("lazy", |data| {
+		if let Ok(lazy) =
+			LazyGaussianSplat::from_bytes(data, &limits(), AttributeMask::all())
+		{
+			let _ = lazy.to_gaussian_splat();
+		}
+	}),
+	("packed", |data| {
+		if let Ok(packed) = PackedGaussianSplat::from_bytes(data) {
+			let _ = GaussianSplat::new_from_packed_gaussians(&packed, &limits());
+		}
+	}),
+];
+
+/// Entry points of the inputs of `cargo fuzz` targets, by target name.
+const TARGETS: &[(&str, &[EntryPoint])] = &[
+	("decode", DECODE),
+	(
+		"compression",
+		&[("compression", |data| {
+			let _ = compression::gzip::decompress_end(data, &mut Vec::new());
+		})],
+	),
+	(
+		"header",
+		&[("header", |data| {
+			let _ = Header::try_from(data);
+		})],
+	),
+	(
+		"packed",
+		&[("packed", |data| {
+			let Ok((packed, opts)) =
+				<(PackedGaussianSplat, LoadOptions)>::arbitrary_take_rest(
+					Unstructured::new(data),
+				)
+			else {
+				return;
+			};
+			let _ = GaussianSplat::new_from_packed_gaussians(&packed, &opts);
+		})],
+	),
+	(
+		"splat",
+		&[("splat", |data| {
+			let Ok((splat, save_opts, load_opts)) =
+				<(GaussianSplat, SaveOptions, LoadOptions)>::arbitrary_take_rest(
+					Unstructured::new(data),
+				)
+			else {
+				return;
+			};
+			if let Ok(bytes) = splat.serialize_to_packed_bytes(&save_opts)
+				&& let Ok(packed) = PackedGaussianSplat::from_bytes(&bytes)
+			{
+				let _ = GaussianSplat::new_from_packed_gaussians(
+					&packed, &load_opts,
+				);
+			}
+		})],
+	),
+	(
+		"coord",
+		&[("coord", |data| {
+			let Ok((from, to)) =
+				<(CoordinateSystem, CoordinateSystem)>::arbitrary_take_rest(
+					Unstructured::new(data),
+				)
+			else {
+				return;
+			};
+			let _ = from.axis_flips_to(to);
+			let _ = from.axes_align(to);
+		})],
+	),
+];
+
+struct Input {
+	/// Where the input comes from, for the report.
+	name: String,
+	data: Vec<u8>,
+	entry_points: &'static [EntryPoint],
+}
+
+fn limits() -> LoadOptions {
+	LoadOptions::builder()
+		.max_points(MAX_POINTS)
+		.max_decompressed_len(MAX_DECOMPRESSED_LEN)
+		.build()
+}
+
+fn env_budget(name: &str) -> Option<u64> {
+	std::env::var(name).ok()?.parse().ok()
+}
+
+/// Runs `f`, returning the time it took and the most bytes allocated at
+/// once by the process while it ran, on top of what was allocated before.
+///
+/// Nothing else may allocate meanwhile, measurements don't overlap.
+fn measure(f: impl FnOnce()) -> (Duration, usize) {
+	let base = ALLOCATED.load(Ordering::Relaxed);
+
+	PEAK.store(base, Ordering::Relaxed);
+
+	let start = Instant::now();
+
+	f();
+
+	(
+		start.elapsed(),
+		PEAK.load(Ordering::Relaxed).saturating_sub(base),
+	)
+}
+
+/// Deterministic pseudo random numbers, xorshift64.
+fn rng(seed: u64) -> impl FnMut() -> usize {
+	let mut state = seed.wrapping_mul(0x9E37_79B9_7F4A_7C15) | 1;
+
+	move || {
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		state as usize
+	}
+}
+
+fn gzip(decompressed: &[u8]) -> Vec<u8> {
+	let mut compressed = Vec::new();
+
+	compression::gzip::compress_bytes(decompressed, &mut compressed).unwrap();
+
+	compressed
+}
+
+/// Packed data whose header claims `num_points` points of degree 3
+/// spherical harmonics, followed by `len` zero bytes.
+fn claiming(num_points: i32, len: usize) -> Vec<u8> {
+	let mut packed = Vec::new();
+
+	Header {
+		num_points,
+		spherical_harmonics_degree: 3,
+		..Default::default()
+	}
+	.serialize_to(&mut packed)
+	.unwrap();
+
+	packed.resize(HEADER_SIZE + len, 0);
+	packed
+}
+
+/// `level` wrapped into `depth` progressive files of a single level each.
+fn nested_progressive(level: &[u8], depth: usize) -> Vec<u8> {
+	let mut prefixes = Vec::with_capacity(depth * 32);
+	let mut len = level.len() as u64;
+
+	// innermost first, each the header and index of one level
+	for _ in 0..depth {
+		let mut prefix = Vec::with_capacity(32);
+
+		prefix.extend_from_slice(&lod::MAGIC);
+		prefix.extend_from_slice(&lod::VERSION.to_le_bytes());
+		prefix.extend_from_slice(&1_u32.to_le_bytes());
+		prefix.extend_from_slice(&0_u32.to_le_bytes());
+		prefix.extend_from_slice(&len.to_le_bytes());
+		prefix.extend_from_slice(&0_u64.to_le_bytes());
+
+		len += prefix.len() as u64;
+		prefixes.push(prefix);
+	}
+	prefixes.into_iter()
+		.rev()
+		.flatten()
+		.chain(level.iter().copied())
+		.collect()
+}
+
+/// Valid files, their truncations and mutations, headers claiming more than
+/// the data holds and data inflating to much more than its header claims.
+fn pathological_inputs() -> Vec<Input> {
+	let gs = splat(5000, 3);
+	let plain = gs
+		.serialize_to_packed_bytes(&SaveOptions::default())
+		.unwrap();
+	let parallel = gs
+		.serialize_to_packed_bytes(
+			&SaveOptions::builder()
+				.threads(4)
+				.parallel_compression(true)
+				.build(),
+		)
+		.unwrap();
+	let chunks = chunked::serialize_chunked(&gs, &SaveOptions::default(), 1000).unwrap();
+	let progressive =
+		lod::serialize_progressive(&gs, &SaveOptions::default(), &LodOptions::default())
+			.unwrap();
+	let decompressed = PackedGaussianSplat::from_bytes(&plain)
+		.unwrap()
+		.to_bytes_vec()
+		.unwrap();
+
+	// the budgets must leave room for decoding valid data
+	for valid in [&plain, &parallel, &chunks, &progressive] {
+		GaussianSplat::read_from_bytes(valid, &limits()).unwrap();
+	}
+	let mut inputs = Vec::new();
+	let mut input = |name: String, data: Vec<u8>| {
+		inputs.push(Input {
+			name,
+			data,
+			entry_points: DECODE,
+		})
+	};
+
+	for (name, valid) in [
+		("plain", &plain),
+		("parallel", &parallel),
+		("chunked", &chunks),
+		("progressive", &progressive),
+	] {
+		for len in [
+			0,
+			1,
+			10,
+			30,
+			valid.len() / 3,
+			valid.len() / 2,
+			valid.len() - 1,
+		] {
+			input(format!("{name} truncated to {len}"), valid[..len].to_vec());
+		}
+		input(name.to_owned(), valid.clone());
+	}
+	for seed in 0..32 {
+		let mut next = rng(seed);
+		let mut packed = decompressed.clone();
+		let mut compressed = plain.clone();
+		let mut chunks = chunks.clone();
+		let mut progressive = progressive.clone();
+
+		// half of the mutations hit the header
+		for _ in 0..4 {
+			let i = next() % packed.len();
+			let i = if seed % 2 == 0 { i % HEADER_SIZE } else { i };
+			packed[i] = next() as u8;
+
+			let i = next() % compressed.len();
+			compressed[i] = next() as u8;
+
+			// the container headers and the first index entries
+			let i = next() % 256;
+			chunks[i] = next() as u8;
+
+			let i = next() % 128;
+			progressive[i] = next() as u8;
+		}
+		input(format!("packed mutation {seed}"), gzip(&packed));
+		input(format!("compressed mutation {seed}"), compressed);
+		input(format!("chunked mutation {seed}"), chunks);
+		input(format!("progressive mutation {seed}"), progressive);
+	}
+	for num_points in [i32::MAX, i32::MAX / 45, MAX_POINTS as i32 + 1] {
+		input(
+			format!("header claiming {num_points} points"),
+			gzip(&claiming(num_points, 1000)),
+		);
+	}
+	input(
+		"data inflating to 64 MiB".to_owned(),
+		gzip(&claiming(16, 64 << 20)),
+	);
+	// recursing into every level would overflow the stack
+	input(
+		"progressive files nested 100000 deep".to_owned(),
+		nested_progressive(&plain, 100_000),
+	);
+	inputs
+}
+
+/// The files of `dir`, each run through `entry_points`.
+fn corpus_inputs(dir: &Path, entry_points: &'static [EntryPoint]) -> Vec<Input> {
+	let Ok(files) = std::fs::read_dir(dir) else {
+		return Vec::new();
+	};
+	files.filter_map(Result::ok)
+		.filter(|file| file.path().is_file())
+		.map(|file| Input {
+			name: file.path().display().to_string(),
+			data: std::fs::read(file.path()).unwrap(),
+			entry_points,
+		})
+		.collect()
+}
+
+/// Runs every input through its entry points, one at a time so the peak
+/// of each is its own.
+///
+/// # Returns
+///
+/// A line for every entry point an input panicked in or exceeded a budget
+/// in.
+fn run(inputs: &[Input], time_budget: Duration, memory_budget: usize) -> Vec<String> {
+	let mut failures = Vec::new();
+
+	for input in inputs {
+		for (entry_point, f) in input.entry_points {
+			let mut panicked = false;
+			let (elapsed, allocated) = measure(|| {
+				panicked = panic::catch_unwind(AssertUnwindSafe(|| f(&input.data)))
+					.is_err();
+			});
+
+			if panicked || elapsed > time_budget || allocated > memory_budget {
+				failures.push(format!(
+					"{} ({entry_point}): {}{elapsed:?}, {allocated} bytes",
+					input.name,
+					if panicked { "panicked, " } else { "" },
+				));
+			}
+		}
+	}
+	failures
+}
+
+/// Every input: the pathological ones, those of the `cargo fuzz` corpora
+/// and those of `SPZ_FUZZ_CORPUS`, always in the same order.
+fn inputs() -> Vec<Input> {
+	let corpus = PathBuf::from(env!("CARGO_MANIFEST_DIR")).join("../../fuzz/corpus");
+	let mut inputs = pathological_inputs();
+
+	for (target, entry_points) in TARGETS {
+		inputs.extend(corpus_inputs(&corpus.join(target), entry_points));
+	}
+	if let Some(dirs) = std::env::var_os("SPZ_FUZZ_CORPUS") {
+		for dir in std::env::split_paths(&dirs) {
+			inputs.extend(corpus_inputs(&dir, DECODE));
+		}
+	}
+	inputs
+}
+
+/// The shard `i/n` this process runs, if it is a child of the test.
+fn shard() -> Option<(usize, usize)> {
+	let shard = std::env::var(SHARD_VAR).ok()?;
+	let (i, n) = shard.split_once('/')?;
+
+	let (i, n) = (i.parse().ok()?, n.parse().ok()?);
+
+	(i < n).then_some((i, n))
+}
+
+/// Runs the test in `shards` child processes of this test binary at once.
+///
+/// # Returns
+///
+/// The failures the shards reported, and a line for every shard that
+/// didn't exit successfully.
+fn run_sharded(shards: usize) -> Vec<String> {
+	let exe = std::env::current_exe().unwrap();
+	let children =
+		(0..shards)
+			.map(|i| {
+				Command::new(&exe)
+					.args([
+						"--exact",
+						"test_fuzz_inputs_within_budgets",
+						"--nocapture",
+					])
+					.env(SHARD_VAR, format!("{i}/{shards}"))
+					.stdout(Stdio::piped())
+					.spawn()
+					.unwrap()
+			})
+			.collect::<Vec<_>>();
+
+	children.into_iter()
+		.enumerate()
+		.flat_map(|(i, child)| {
+			let output = child.wait_with_output().unwrap();
+			let mut failures = String::from_utf8_lossy(&output.stdout)
+				.lines()
+				.filter_map(|line| line.strip_prefix(FAILURE_PREFIX))
+				.map(str::to_owned)
+				.collect::<Vec<_>>();
+
+			if !output.status.success() {
+				failures.push(format!("shard {i}/{shards}: {}", output.status));
+			}
+			failures
+		})
+		.collect()
+}
+
+#[test]
+fn test_fuzz_inputs_within_budgets() {
+	let inputs = inputs();
+	let time_budget =
+		env_budget("SPZ_FUZZ_TIME_BUDGET_MS").map_or(TIME_BUDGET, Duration::from_millis);
+	let memory_budget =
+		env_budget("SPZ_FUZZ_MEMORY_BUDGET").map_or(MEMORY_BUDGET, |n| n as usize);
+
+	if let Some((i, n)) = shard() {
+		let inputs = inputs.into_iter().skip(i).step_by(n).collect::<Vec<_>>();
+
+		for failure in run(&inputs, time_budget, memory_budget) {
+			println!("{FAILURE_PREFIX}{failure}");
+		}
+		return;
+	}
+	let shards = env_budget("SPZ_FUZZ_SHARDS").map_or_else(
+		|| {
+			std::thread::available_parallelism()
+				.map_or(1, usize::from)
+				.min(MAX_SHARDS)
+		},
+		|n| n as usize,
+	);
+	let failures = if shards > 1 {
+		run_sharded(shards)
+	} else {
+		run(&inputs, time_budget, memory_budget)
+	};
+
+	assert!(
+		failures.is_empty(),
+		"{} runs of {} inputs over budget ({time_budget:?}, {memory_budget} bytes):\n{}",
+		failures.len(),
+		inputs.len(),
+		failures.join("\n")
+	);
+}
@@ -325,15 +325,19 @@ fn sample_sh_coefficients() -> Vec<f32> {
 	},
 	SaveOptions { // Save as RUB and load as RDF (180 degree rotation about X)
 		coord_sys: CoordinateSystem::RightUpBack,
+		..Default::default()
 	},
 	LoadOptions {
 		coord_sys: CoordinateSystem::RightDownFront,
+		..Default::default()
 	},
 	SaveOptions {
 		coord_sys: CoordinateSystem::RightDownFront,
+		..Default::default()
 	},
 	LoadOptions {
 		coord_sys: CoordinateSystem::RightDownFront,
+		..Default::default()
 	}
 )]
 fn test_spherical_harmonics_coordinate_transformation(
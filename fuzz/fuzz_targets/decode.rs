@@ -0,0 +1,23 @@
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+
+//! Fuzz target for loading SPZ data.
+//!
+//! Feeds arbitrary bytes to the in-memory, streamed and reusable decoders,
+//! with load limits. The time and memory each input of the corpus takes is
+//! checked by the `fuzz_budget` test of the spz crate.
+
+#![no_main]
+
+use libfuzzer_sys::fuzz_target;
+use spz::prelude::{Decoder, GaussianSplat, LoadOptions};
+
+fuzz_target!(|data: &[u8]| {
+	let opts = LoadOptions::builder()
+		.max_points(1 << 18)
+		.max_decompressed_len(16 << 20)
+		.build();
+
+	let _ = GaussianSplat::read_from_bytes(data, &opts);
+	let _ = GaussianSplat::read_from(data, &opts);
+	let _ = Decoder::new().decode(data, &opts);
+});